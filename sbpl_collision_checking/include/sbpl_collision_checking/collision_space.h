@@ -34,8 +34,11 @@
 #define SBPL_COLLISION_CHECKING_COLLISION_SPACE_H
 
 // standard includes
+#include <cstdint>
+#include <deque>
 #include <string>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 // system includes
@@ -57,7 +60,23 @@
 namespace smpl {
 namespace collision {
 
-class CollisionSpace : public CollisionChecker
+/// Hit and miss counts of the CollisionSpace validity cache.
+struct ValidityCacheStats
+{
+    std::uint64_t state_hits = 0;
+    std::uint64_t state_misses = 0;
+    std::uint64_t edge_hits = 0;
+    std::uint64_t edge_misses = 0;
+
+    /// Number of times the cache was cleared because the world, the attached
+    /// bodies, or the collision model configuration changed
+    std::uint64_t invalidations = 0;
+
+    double stateHitRate() const;
+    double edgeHitRate() const;
+};
+
+class CollisionSpace : public CollisionChecker, public ValidityCacheExtension
 {
 public:
 
@@ -109,6 +128,10 @@ public:
     bool moveShapes(const CollisionObject* object);
     bool insertShapes(const CollisionObject* object);
     bool removeShapes(const CollisionObject* object);
+
+    bool shiftOrigin(int dx, int dy, int dz);
+
+    void setVoxelCache(VoxelCache* cache);
     ///@}
 
     /// \name Attached Objects
@@ -122,6 +145,19 @@ public:
     bool detachObject(const std::string& id);
     ///@}
 
+    /// \name Validity Cache
+    ///@{
+    void setValidityCacheCapacity(size_t capacity) override;
+    auto validityCacheCapacity() const -> size_t { return m_state_cache.capacity; }
+
+    void clearValidityCache() override;
+
+    auto validityCacheStats() const -> const ValidityCacheStats&
+    { return m_cache_stats; }
+
+    void resetValidityCacheStats();
+    ///@}
+
     auto getReferenceFrame() const -> const std::string&
     { return m_grid->getReferenceFrame(); }
 
@@ -239,6 +275,33 @@ private:
     // Planning Joint Information
     std::vector<int>                m_planning_joint_to_collision_model_indices;
 
+    using CacheKey = std::vector<std::int64_t>;
+
+    struct CacheKeyHash
+    {
+        size_t operator()(const CacheKey& key) const;
+    };
+
+    // bounded map of validity results, evicting the oldest entries first
+    struct ValidityCache
+    {
+        size_t capacity = 0;
+        std::unordered_map<CacheKey, bool, CacheKeyHash> results;
+        std::deque<CacheKey> order;
+
+        bool lookup(const CacheKey& key, bool& valid) const;
+        void insert(CacheKey key, bool valid);
+        void clear();
+    };
+
+    // Validity Cache
+    ValidityCache                   m_state_cache;
+    ValidityCache                   m_edge_cache;
+    std::uint64_t                   m_cache_grid_version = 0;
+    bool                            m_cache_stale = false;
+    ValidityCacheStats              m_cache_stats;
+    CacheKey                        m_cache_key;
+
     size_t planningVariableCount() const {
         return m_planning_joint_to_collision_model_indices.size();
     }
@@ -257,6 +320,16 @@ private:
     void copyState();
 
     bool withinJointPositionLimits(const std::vector<double>& positions) const;
+
+    bool validityCacheEnabled() const { return m_state_cache.capacity != 0; }
+    void invalidateValidityCache() { m_cache_stale = true; }
+    void syncValidityCache();
+    void appendCacheKey(const RobotState& state, CacheKey& key) const;
+
+    bool checkStateToStateValid(
+        const RobotState& start,
+        const RobotState& finish,
+        bool verbose);
 };
 
 typedef std::shared_ptr<CollisionSpace> CollisionSpacePtr;
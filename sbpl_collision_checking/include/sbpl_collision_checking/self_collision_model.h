@@ -74,6 +74,8 @@ public:
 
     void setWorldToModelTransform(const Eigen::Affine3d& transform);
 
+    void insertEnteringVoxels(int dx, int dy, int dz);
+
     bool checkCollision(
         const RobotCollisionState& state,
         const AttachedBodiesCollisionState& ab_state,
@@ -0,0 +1,141 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2018, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#ifndef SBPL_COLLISION_CHECKING_VOXEL_CACHE_H
+#define SBPL_COLLISION_CHECKING_VOXEL_CACHE_H
+
+// standard includes
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// system includes
+#include <Eigen/Dense>
+
+// project includes
+#include <sbpl_collision_checking/shapes.h>
+
+namespace smpl {
+namespace collision {
+
+/// Identifies the voxelization of a shape by the inputs that determine it,
+/// serialized into a byte string, along with a hash of that string.
+struct VoxelCacheKey
+{
+    std::vector<std::uint8_t> data;
+    std::uint64_t hash = 0;
+
+    void computeHash();
+};
+
+inline
+bool operator==(const VoxelCacheKey& a, const VoxelCacheKey& b)
+{
+    return a.hash == b.hash && a.data == b.data;
+}
+
+inline
+bool operator!=(const VoxelCacheKey& a, const VoxelCacheKey& b)
+{
+    return !(a == b);
+}
+
+/// Compute the key of the voxelization of a shape from its geometry, its pose
+/// in the grid frame, the resolution and origin of the grid, the grid bounds
+/// (for unbounded shapes), and the padding. Returns false if the shape can not
+/// be keyed cheaply (octrees).
+bool MakeShapeVoxelizationKey(
+    const CollisionShape& shape,
+    const Eigen::Affine3d& pose,
+    double res,
+    const Eigen::Vector3d& go,
+    const Eigen::Vector3d& gmin,
+    const Eigen::Vector3d& gmax,
+    double padding,
+    VoxelCacheKey& key);
+
+/// A content-addressed cache of shape voxelizations with a least-recently-used
+/// eviction policy. The cache is bounded by the total number of voxels it
+/// stores and may be saved to and restored from disk.
+class VoxelCache
+{
+public:
+
+    static const size_t DefaultMaxVoxels = 50000000;
+
+    using VoxelList = std::vector<Eigen::Vector3d>;
+
+    VoxelCache(size_t max_voxels = DefaultMaxVoxels);
+
+    auto find(const VoxelCacheKey& key) -> const VoxelList*;
+    void insert(VoxelCacheKey key, VoxelList voxels);
+    void clear();
+
+    size_t size() const { return m_lookup.size(); }
+    size_t voxelCount() const { return m_voxel_count; }
+
+    size_t maxVoxels() const { return m_max_voxels; }
+    void setMaxVoxels(size_t max_voxels);
+
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+
+private:
+
+    struct Entry
+    {
+        VoxelCacheKey key;
+        VoxelList voxels;
+    };
+
+    using EntryIterator = std::list<Entry>::iterator;
+
+    // entries ordered from most- to least-recently used
+    std::list<Entry> m_entries;
+
+    // entries by key hash; entries whose keys collide share a hash
+    std::unordered_multimap<std::uint64_t, EntryIterator> m_lookup;
+
+    size_t m_voxel_count;
+    size_t m_max_voxels;
+
+    auto lookup(const VoxelCacheKey& key)
+        -> std::unordered_multimap<std::uint64_t, EntryIterator>::iterator;
+
+    void evict();
+};
+
+} // namespace collision
+} // namespace smpl
+
+#endif
@@ -46,6 +46,7 @@ namespace smpl {
 namespace collision {
 
 struct CollisionObject;
+class VoxelCache;
 
 class WorldCollisionModel
 {
@@ -71,12 +72,19 @@ public:
 
     void reset();
 
+    bool shiftOrigin(int dx, int dy, int dz);
+
     auto getWorldVisualization() const -> visualization_msgs::MarkerArray;
     auto getCollisionWorldVisualization() const -> visualization_msgs::MarkerArray;
 
     void setPadding(double padding) { m_padding = padding; }
     double padding() const { return m_padding; }
 
+    /// Share a cache of shape voxelizations across insertions. The cache must
+    /// outlive this model. A null cache disables caching.
+    void setVoxelCache(VoxelCache* cache) { m_voxel_cache = cache; }
+    auto voxelCache() const -> VoxelCache* { return m_voxel_cache; }
+
 private:
 
     OccupancyGrid* m_grid;
@@ -93,10 +101,16 @@ private:
 
     double m_padding;
 
+    VoxelCache* m_voxel_cache;
+
     ////////////////////
     // Generic Shapes //
     ////////////////////
 
+    bool voxelizeObject(
+        const CollisionObject* object,
+        std::vector<VoxelList>& all_voxels);
+
     bool haveObject(const CollisionObject* object) const;
 
     auto getObjectCollisionModel(const CollisionObject* object) const
@@ -32,6 +32,9 @@
 #ifndef sbpl_collision_collision_operations_h
 #define sbpl_collision_collision_operations_h
 
+// standard includes
+#include <limits>
+
 // system includes
 #include <ros/console.h>
 #include <smpl/occupancy_grid.h>
@@ -51,7 +54,8 @@ bool CheckSphereCollision(
 double SphereCollisionDistance(
     const OccupancyGrid& grid,
     const CollisionSphereState& s,
-    double padding);
+    double padding,
+    double max_dist = std::numeric_limits<double>::infinity());
 
 template <typename StateType>
 bool CheckVoxelsCollisions(
@@ -72,25 +76,64 @@ bool CheckSphereCollision(
     double& dist)
 {
     const double effective_radius = s.model->radius + padding;
+    if (grid.isClear(s.pos.x(), s.pos.y(), s.pos.z(), effective_radius)) {
+        dist = effective_radius * effective_radius;
+        return true;
+    }
     dist = grid.getSquaredDist(s.pos.x(), s.pos.y(), s.pos.z());
     return dist >= effective_radius * effective_radius;
 }
 
-/// Compute the closest distance between a sphere and an occupied voxel
+/// Compute the closest distance between a sphere and an occupied voxel. If the
+/// distance is known to be at least \p max_dist, \p max_dist may be returned
+/// instead.
 inline
 double SphereCollisionDistance(
     const OccupancyGrid& grid,
     const CollisionSphereState& s,
-    double padding)
+    double padding,
+    double max_dist)
 {
-    double dist = grid.getDistanceFromPoint(s.pos.x(), s.pos.y(), s.pos.z());
     const double effective_radius = s.model->radius + padding;
+    if (grid.isClear(s.pos.x(), s.pos.y(), s.pos.z(), max_dist + effective_radius)) {
+        return max_dist;
+    }
+    double dist = grid.getDistanceFromPoint(s.pos.x(), s.pos.y(), s.pos.z());
     return dist - effective_radius;
 }
 
 std::vector<SphereIndex> GatherSphereIndices(
     const RobotCollisionState& state, int gidx);
 
+/// Append the voxels that lie within the cells that entered the volume of an
+/// occupancy grid when its origin was last shifted by (dx, dy, dz) cells.
+inline
+void GatherEnteringVoxels(
+    const OccupancyGrid& grid,
+    int dx, int dy, int dz,
+    const std::vector<Eigen::Vector3d>& voxels,
+    std::vector<Eigen::Vector3d>& entering)
+{
+    const int xc = grid.numCellsX();
+    const int yc = grid.numCellsY();
+    const int zc = grid.numCellsZ();
+    for (auto& v : voxels) {
+        int gx, gy, gz;
+        grid.worldToGrid(v.x(), v.y(), v.z(), gx, gy, gz);
+        if (!grid.isInBounds(gx, gy, gz)) {
+            continue;
+        }
+
+        // coordinates of the cell before the shift
+        const int px = gx + dx;
+        const int py = gy + dy;
+        const int pz = gz + dz;
+        if (px < 0 || px >= xc || py < 0 || py >= yc || pz < 0 || pz >= zc) {
+            entering.push_back(v);
+        }
+    }
+}
+
 /// Check sphere hierarchies for collisions against an occupancy grid
 ///
 /// \param state The aggregate state of the collision trees. Must have a method
@@ -34,6 +34,7 @@
 
 // standard includes
 #include <assert.h>
+#include <cstring>
 #include <limits>
 #include <utility>
 #include <queue>
@@ -72,6 +73,66 @@ static const char* LOG = "cspace";
 /// within the CollisionSpace. This is done so that multiple insertions of the
 /// same CollisionObject or OctomapWithPose message do not create multiple
 /// objects within the WorldCollisionModel.
+///
+/// An optional cache of validity results may be enabled with
+/// setValidityCacheCapacity(). States are identified by the exact values of
+/// their joint positions, so a result is only reused for the same state, and
+/// checks made outside the search, such as shortcutting, see the same results
+/// as without the cache. Motions are identified by both endpoints, so that for
+/// a lattice, motions are remembered per parent state and action. The cache is
+/// cleared whenever the occupancy grid, the attached bodies, or the collision
+/// model configuration changes.
+
+double ValidityCacheStats::stateHitRate() const
+{
+    const std::uint64_t lookups = state_hits + state_misses;
+    return lookups ? (double)state_hits / (double)lookups : 0.0;
+}
+
+double ValidityCacheStats::edgeHitRate() const
+{
+    const std::uint64_t lookups = edge_hits + edge_misses;
+    return lookups ? (double)edge_hits / (double)lookups : 0.0;
+}
+
+size_t CollisionSpace::CacheKeyHash::operator()(const CacheKey& key) const
+{
+    size_t seed = 0;
+    for (std::int64_t k : key) {
+        seed ^= std::hash<std::int64_t>()(k) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    }
+    return seed;
+}
+
+bool CollisionSpace::ValidityCache::lookup(const CacheKey& key, bool& valid) const
+{
+    auto it = results.find(key);
+    if (it == results.end()) {
+        return false;
+    }
+    valid = it->second;
+    return true;
+}
+
+void CollisionSpace::ValidityCache::insert(CacheKey key, bool valid)
+{
+    if (capacity == 0) {
+        return;
+    }
+    while (order.size() >= capacity) {
+        results.erase(order.front());
+        order.pop_front();
+    }
+    if (results.emplace(key, valid).second) {
+        order.push_back(std::move(key));
+    }
+}
+
+void CollisionSpace::ValidityCache::clear()
+{
+    results.clear();
+    order.clear();
+}
 
 CollisionSpace::~CollisionSpace()
 {
@@ -87,7 +148,10 @@ bool CollisionSpace::setJointPosition(
 {
     if (m_rcm->hasJointVar(name)) {
         int jidx = m_rcm->jointVarIndex(name);
-        m_joint_vars[jidx] = position;
+        if (m_joint_vars[jidx] != position) {
+            m_joint_vars[jidx] = position;
+            invalidateValidityCache();
+        }
         return true;
     } else {
         return false;
@@ -107,6 +171,7 @@ void CollisionSpace::setWorldToModelTransform(
             m_rcs->getJointVarPositions() + vlidx,
             m_joint_vars.data() + vfidx);
     m_scm->setWorldToModelTransform(transform);
+    invalidateValidityCache();
 }
 
 /// \brief Set the padding applied to the collision model
@@ -114,6 +179,7 @@ void CollisionSpace::setPadding(double padding)
 {
     m_wcm->setPadding(padding);
     m_scm->setPadding(padding);
+    invalidateValidityCache();
 }
 
 /// \brief Return the allowed collision matrix
@@ -128,7 +194,8 @@ const AllowedCollisionMatrix& CollisionSpace::allowedCollisionMatrix() const
 void CollisionSpace::updateAllowedCollisionMatrix(
     const AllowedCollisionMatrix& acm)
 {
-    return m_scm->updateAllowedCollisionMatrix(acm);
+    m_scm->updateAllowedCollisionMatrix(acm);
+    invalidateValidityCache();
 }
 
 /// \brief Set the allowed collision matrix
@@ -137,6 +204,7 @@ void CollisionSpace::setAllowedCollisionMatrix(
     const AllowedCollisionMatrix& acm)
 {
     m_scm->setAllowedCollisionMatrix(acm);
+    invalidateValidityCache();
 }
 
 /// \brief Insert an object into the world
@@ -144,6 +212,7 @@ void CollisionSpace::setAllowedCollisionMatrix(
 /// \return true if the object was inserted; false otherwise
 bool CollisionSpace::insertObject(const CollisionObject* object)
 {
+    invalidateValidityCache();
     if (!m_wcm->insertObject(object)) {
         ROS_WARN_NAMED(LOG, "Reject insertion of object '%s'. Failed to add to world collision model.", object->id.c_str());
         return false;
@@ -158,6 +227,7 @@ bool CollisionSpace::insertObject(const CollisionObject* object)
 bool CollisionSpace::removeObject(const CollisionObject* object)
 {
     // don't need to check against object name here since it would be redundant
+    invalidateValidityCache();
 
     if (!m_wcm->removeObject(object)) {
         ROS_WARN_NAMED(LOG, "Reject removal of object '%s'. Failed to remove from world collision model.", object->id.c_str());
@@ -172,6 +242,7 @@ bool CollisionSpace::removeObject(const CollisionObject* object)
 /// \return true if the object was moved; false otherwise
 bool CollisionSpace::moveShapes(const CollisionObject* object)
 {
+    invalidateValidityCache();
     return m_wcm->moveShapes(object);
 }
 
@@ -180,6 +251,7 @@ bool CollisionSpace::moveShapes(const CollisionObject* object)
 /// \return true if the shapes were appended to the object; false otherwise
 bool CollisionSpace::insertShapes(const CollisionObject* object)
 {
+    invalidateValidityCache();
     return m_wcm->insertShapes(object);
 }
 
@@ -188,9 +260,37 @@ bool CollisionSpace::insertShapes(const CollisionObject* object)
 /// \return true if the shapes were removed; false otherwise
 bool CollisionSpace::removeShapes(const CollisionObject* object)
 {
+    invalidateValidityCache();
     return m_wcm->removeShapes(object);
 }
 
+/// \brief Move the volume covered by the occupancy grid by a whole number of
+///     cells along each axis
+///
+/// Obstacles within the cells that enter the volume, whether world objects or
+/// voxels models of the robot, are added to the grid, and obstacles leaving
+/// the volume are forgotten. The grid must support moving, e.g. a grid built
+/// on a HashedDistanceMap.
+///
+/// \return true if the grid was moved; false otherwise
+bool CollisionSpace::shiftOrigin(int dx, int dy, int dz)
+{
+    invalidateValidityCache();
+    if (!m_wcm->shiftOrigin(dx, dy, dz)) {
+        ROS_WARN_NAMED(LOG, "Failed to move the world collision model");
+        return false;
+    }
+    m_scm->insertEnteringVoxels(dx, dy, dz);
+    return true;
+}
+
+/// \brief Set the cache of shape voxelizations used by the world collision
+///     model
+void CollisionSpace::setVoxelCache(VoxelCache* cache)
+{
+    m_wcm->setVoxelCache(cache);
+}
+
 /// \brief Attach a collision object to the robot
 /// \param id The name of the object
 /// \param shapes The shapes composing the object
@@ -203,6 +303,7 @@ bool CollisionSpace::attachObject(
     const Affine3dVector& transforms,
     const std::string& link_name)
 {
+    invalidateValidityCache();
     return m_abcm->attachBody(id, shapes, transforms, link_name);
 }
 
@@ -211,9 +312,33 @@ bool CollisionSpace::attachObject(
 /// \return true if the object was detached; false otherwise
 bool CollisionSpace::detachObject(const std::string& id)
 {
+    invalidateValidityCache();
     return m_abcm->detachBody(id);
 }
 
+/// \brief Set the maximum number of states, and the maximum number of
+///     motions, whose validity is remembered. A capacity of 0, the default,
+///     disables the cache.
+void CollisionSpace::setValidityCacheCapacity(size_t capacity)
+{
+    m_state_cache.capacity = capacity;
+    m_edge_cache.capacity = capacity;
+    clearValidityCache();
+}
+
+void CollisionSpace::clearValidityCache()
+{
+    m_state_cache.clear();
+    m_edge_cache.clear();
+    m_cache_grid_version = m_grid ? m_grid->version() : 0;
+    m_cache_stale = false;
+}
+
+void CollisionSpace::resetValidityCacheStats()
+{
+    m_cache_stats = ValidityCacheStats();
+}
+
 /// \brief Return a visualization of the current world
 ///
 /// The visualization is of the set of collision object geometries
@@ -394,7 +519,9 @@ bool CollisionSpace::collisionDetails(
 
 Extension* CollisionSpace::getExtension(size_t class_code)
 {
-    if (class_code == GetClassCode<CollisionChecker>()) {
+    if (class_code == GetClassCode<CollisionChecker>() ||
+        class_code == GetClassCode<ValidityCacheExtension>())
+    {
         return this;
     }
     return nullptr;
@@ -403,13 +530,57 @@ Extension* CollisionSpace::getExtension(size_t class_code)
 bool CollisionSpace::isStateValid(const RobotState& state, bool verbose)
 {
     double dist = std::numeric_limits<double>::max();
-    return checkCollision(state, dist);
+    if (!validityCacheEnabled()) {
+        return checkCollision(state, dist);
+    }
+
+    syncValidityCache();
+    m_cache_key.clear();
+    appendCacheKey(state, m_cache_key);
+
+    bool valid;
+    if (m_state_cache.lookup(m_cache_key, valid)) {
+        ++m_cache_stats.state_hits;
+        return valid;
+    }
+
+    ++m_cache_stats.state_misses;
+    valid = checkCollision(state, dist);
+    m_state_cache.insert(m_cache_key, valid);
+    return valid;
 }
 
 bool CollisionSpace::isStateToStateValid(
     const RobotState& start,
     const RobotState& finish,
     bool verbose)
+{
+    if (!validityCacheEnabled()) {
+        return checkStateToStateValid(start, finish, verbose);
+    }
+
+    syncValidityCache();
+    m_cache_key.clear();
+    appendCacheKey(start, m_cache_key);
+    appendCacheKey(finish, m_cache_key);
+
+    bool valid;
+    if (m_edge_cache.lookup(m_cache_key, valid)) {
+        ++m_cache_stats.edge_hits;
+        return valid;
+    }
+
+    ++m_cache_stats.edge_misses;
+    CacheKey key = std::move(m_cache_key);
+    valid = checkStateToStateValid(start, finish, verbose);
+    m_edge_cache.insert(std::move(key), valid);
+    return valid;
+}
+
+bool CollisionSpace::checkStateToStateValid(
+    const RobotState& start,
+    const RobotState& finish,
+    bool verbose)
 {
     const double res = 0.05;
 
@@ -436,7 +607,8 @@ bool CollisionSpace::isStateToStateValid(
         for (int i = 0; i < inc_cc; i++) {
             for (size_t j = i; j < interp.waypointCount(); j = j + inc_cc) {
                 interp.interpolate(j, interm, m_planning_joint_to_collision_model_indices);
-                if (!isStateValid(interm, verbose)) {
+                double dist = std::numeric_limits<double>::max();
+                if (!checkCollision(interm, dist)) {
                     return false;
                 }
             }
@@ -444,7 +616,8 @@ bool CollisionSpace::isStateToStateValid(
     } else {
         for (size_t i = 0; i < interp.waypointCount(); i++) {
             interp.interpolate(i, interm, m_planning_joint_to_collision_model_indices);
-            if (!isStateValid(interm, verbose)) {
+            double dist = std::numeric_limits<double>::max();
+            if (!checkCollision(interm, dist)) {
                 return false;
             }
         }
@@ -654,6 +827,30 @@ bool CollisionSpace::withinJointPositionLimits(
     return true;
 }
 
+/// Clear the validity cache if anything that affects validity has changed
+/// since the cached results were computed.
+void CollisionSpace::syncValidityCache()
+{
+    if (m_cache_stale || m_grid->version() != m_cache_grid_version) {
+        if (!m_state_cache.results.empty() || !m_edge_cache.results.empty()) {
+            ROS_DEBUG_NAMED(LOG, "Invalidate validity cache (%zu states, %zu motions)", m_state_cache.results.size(), m_edge_cache.results.size());
+            ++m_cache_stats.invalidations;
+        }
+        clearValidityCache();
+    }
+}
+
+/// Append the identifier of a state, made up of the bit pattern of the
+/// position of each planning variable.
+void CollisionSpace::appendCacheKey(const RobotState& state, CacheKey& key) const
+{
+    for (double position : state) {
+        std::int64_t bits;
+        std::memcpy(&bits, &position, sizeof(bits));
+        key.push_back(bits);
+    }
+}
+
 auto BuildCollisionSpace(
     OccupancyGrid* grid,
     const std::string& urdf_string,
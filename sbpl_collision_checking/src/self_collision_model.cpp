@@ -203,6 +203,28 @@ void SelfCollisionModel::setWorldToModelTransform(
     (void)m_rcs.setWorldToModelTransform(transform);
 }
 
+/// Insert the voxels of the voxels models outside the current group that lie
+/// within the cells that entered the occupancy grid when its origin was last
+/// shifted by (dx, dy, dz) cells. The voxels elsewhere were either inserted
+/// already or fell outside of the grid.
+void SelfCollisionModel::insertEnteringVoxels(int dx, int dy, int dz)
+{
+    auto& v_ins = m_v_ins; v_ins.clear();
+    for (int vsidx : m_voxels_indices) {
+        GatherEnteringVoxels(
+                *m_grid, dx, dy, dz, m_rcs.voxelsState(vsidx).voxels, v_ins);
+    }
+    for (int vsidx : m_ab_voxels_indices) {
+        GatherEnteringVoxels(
+                *m_grid, dx, dy, dz, m_abcs.voxelsState(vsidx).voxels, v_ins);
+    }
+
+    if (!v_ins.empty()) {
+        ROS_DEBUG_NAMED(SCM_LOGGER, "  Insert %zu voxels entering the grid", v_ins.size());
+        m_grid->addPointsToField(v_ins);
+    }
+}
+
 bool SelfCollisionModel::checkCollision(
     const RobotCollisionState& state,
     const AttachedBodiesCollisionState& ab_state,
@@ -1417,7 +1439,7 @@ double SelfCollisionModel::robotVoxelsCollisionDistance()
 
         ROS_DEBUG_NAMED(SCM_LOGGER, "Checking sphere with radius %0.3f at (%0.3f, %0.3f, %0.3f)", s->model->radius, s->pos.x(), s->pos.y(), s->pos.z());
 
-        double obs_dist = SphereCollisionDistance(*m_grid, *s, m_padding);
+        double obs_dist = SphereCollisionDistance(*m_grid, *s, m_padding, d);
         if (obs_dist >= d) {
             continue; // further -> ok!
         }
@@ -0,0 +1,347 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2018, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#include <sbpl_collision_checking/voxel_cache.h>
+
+// standard includes
+#include <fstream>
+#include <iterator>
+#include <utility>
+
+// system includes
+#include <ros/console.h>
+
+namespace smpl {
+namespace collision {
+
+static const char* LOG = "voxel_cache";
+
+static const std::uint32_t VoxelCacheMagic = 0x48435653; // "SVCH"
+static const std::uint32_t VoxelCacheVersion = 2;
+
+// Appends the inputs of a voxelization to a key
+struct KeyWriter
+{
+    std::vector<std::uint8_t>& data;
+
+    void add(const void* bytes, size_t size)
+    {
+        auto* first = (const std::uint8_t*)bytes;
+        data.insert(end(data), first, first + size);
+    }
+
+    template <class T>
+    void add(const T& t) { add(&t, sizeof(T)); }
+};
+
+// 64-bit FNV-1a
+void VoxelCacheKey::computeHash()
+{
+    hash = 14695981039346656037ull;
+    for (std::uint8_t byte : data) {
+        hash ^= byte;
+        hash *= 1099511628211ull;
+    }
+}
+
+bool MakeShapeVoxelizationKey(
+    const CollisionShape& shape,
+    const Eigen::Affine3d& pose,
+    double res,
+    const Eigen::Vector3d& go,
+    const Eigen::Vector3d& gmin,
+    const Eigen::Vector3d& gmax,
+    double padding,
+    VoxelCacheKey& key)
+{
+    key.data.clear();
+    KeyWriter writer{ key.data };
+    writer.add(shape.type);
+
+    switch (shape.type) {
+    case ShapeType::Sphere: {
+        auto& sphere = static_cast<const SphereShape&>(shape);
+        writer.add(sphere.radius);
+        break;
+    }
+    case ShapeType::Cylinder: {
+        auto& cylinder = static_cast<const CylinderShape&>(shape);
+        writer.add(cylinder.radius);
+        writer.add(cylinder.height);
+        break;
+    }
+    case ShapeType::Cone: {
+        auto& cone = static_cast<const ConeShape&>(shape);
+        writer.add(cone.radius);
+        writer.add(cone.height);
+        break;
+    }
+    case ShapeType::Box: {
+        auto& box = static_cast<const BoxShape&>(shape);
+        writer.add(box.size);
+        break;
+    }
+    case ShapeType::Plane: {
+        auto& plane = static_cast<const PlaneShape&>(shape);
+        writer.add(plane.a);
+        writer.add(plane.b);
+        writer.add(plane.c);
+        writer.add(plane.d);
+        // planes are clipped to the grid bounds
+        writer.add(gmin.data(), 3 * sizeof(double));
+        writer.add(gmax.data(), 3 * sizeof(double));
+        break;
+    }
+    case ShapeType::Mesh: {
+        auto& mesh = static_cast<const MeshShape&>(shape);
+        writer.add(mesh.vertex_count);
+        writer.add(mesh.triangle_count);
+        writer.add(mesh.vertices, 3 * mesh.vertex_count * sizeof(double));
+        writer.add(mesh.triangles, 3 * mesh.triangle_count * sizeof(std::uint32_t));
+        break;
+    }
+    case ShapeType::OcTree:
+    default:
+        return false;
+    }
+
+    writer.add(pose.matrix().data(), 16 * sizeof(double));
+    writer.add(res);
+    writer.add(go.data(), 3 * sizeof(double));
+    writer.add(padding);
+
+    key.computeHash();
+    return true;
+}
+
+VoxelCache::VoxelCache(size_t max_voxels) :
+    m_entries(),
+    m_lookup(),
+    m_voxel_count(0),
+    m_max_voxels(max_voxels)
+{
+}
+
+/// Return the voxels cached under the given key, or nullptr if no entry
+/// exists. The entry is marked as most-recently used.
+auto VoxelCache::find(const VoxelCacheKey& key) -> const VoxelList*
+{
+    auto it = lookup(key);
+    if (it == end(m_lookup)) {
+        return nullptr;
+    }
+
+    m_entries.splice(begin(m_entries), m_entries, it->second);
+    return &it->second->voxels;
+}
+
+/// Insert or replace the entry for the given key, evicting least-recently used
+/// entries as necessary to respect the voxel budget. Voxel lists larger than
+/// the budget are not cached.
+void VoxelCache::insert(VoxelCacheKey key, VoxelList voxels)
+{
+    auto it = lookup(key);
+    if (it != end(m_lookup)) {
+        m_voxel_count -= it->second->voxels.size();
+        m_entries.erase(it->second);
+        m_lookup.erase(it);
+    }
+
+    if (voxels.size() > m_max_voxels) {
+        return;
+    }
+
+    m_voxel_count += voxels.size();
+    auto hash = key.hash;
+    m_entries.push_front(Entry{ std::move(key), std::move(voxels) });
+    m_lookup.emplace(hash, begin(m_entries));
+
+    evict();
+}
+
+void VoxelCache::clear()
+{
+    m_entries.clear();
+    m_lookup.clear();
+    m_voxel_count = 0;
+}
+
+void VoxelCache::setMaxVoxels(size_t max_voxels)
+{
+    m_max_voxels = max_voxels;
+    evict();
+}
+
+/// Write all entries to a binary file. Voxel positions are stored in single
+/// precision, which preserves the cell of every voxel center at any
+/// reasonable resolution.
+bool VoxelCache::save(const std::string& path) const
+{
+    std::ofstream ofs(path, std::ios::binary);
+    if (!ofs.is_open()) {
+        ROS_ERROR_NAMED(LOG, "Failed to open voxel cache '%s' for writing", path.c_str());
+        return false;
+    }
+
+    auto write = [&](const void* data, size_t size) {
+        ofs.write((const char*)data, size);
+    };
+
+    std::uint64_t entry_count = m_entries.size();
+    write(&VoxelCacheMagic, sizeof(VoxelCacheMagic));
+    write(&VoxelCacheVersion, sizeof(VoxelCacheVersion));
+    write(&entry_count, sizeof(entry_count));
+
+    // write least-recently used entries first so that loading restores the
+    // recency order
+    std::vector<float> coords;
+    for (auto it = m_entries.rbegin(); it != m_entries.rend(); ++it) {
+        std::uint64_t key_size = it->key.data.size();
+        std::uint64_t voxel_count = it->voxels.size();
+        write(&key_size, sizeof(key_size));
+        write(it->key.data.data(), key_size);
+        write(&voxel_count, sizeof(voxel_count));
+
+        coords.resize(3 * voxel_count);
+        for (size_t i = 0; i < it->voxels.size(); ++i) {
+            coords[3 * i + 0] = (float)it->voxels[i].x();
+            coords[3 * i + 1] = (float)it->voxels[i].y();
+            coords[3 * i + 2] = (float)it->voxels[i].z();
+        }
+        write(coords.data(), coords.size() * sizeof(float));
+    }
+
+    if (!ofs.good()) {
+        ROS_ERROR_NAMED(LOG, "Failed to write voxel cache '%s'", path.c_str());
+        return false;
+    }
+
+    ROS_DEBUG_NAMED(LOG, "Saved %zu voxel cache entries (%zu voxels) to '%s'", size(), voxelCount(), path.c_str());
+    return true;
+}
+
+/// Merge the entries stored in a binary file into the cache. Loaded entries
+/// are subject to the cache's voxel budget.
+bool VoxelCache::load(const std::string& path)
+{
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs.is_open()) {
+        ROS_ERROR_NAMED(LOG, "Failed to open voxel cache '%s' for reading", path.c_str());
+        return false;
+    }
+
+    auto read = [&](void* data, size_t size) {
+        ifs.read((char*)data, size);
+        return (bool)ifs;
+    };
+
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint64_t entry_count;
+    if (!read(&magic, sizeof(magic)) ||
+        !read(&version, sizeof(version)) ||
+        !read(&entry_count, sizeof(entry_count)))
+    {
+        ROS_ERROR_NAMED(LOG, "Failed to read voxel cache header from '%s'", path.c_str());
+        return false;
+    }
+
+    if (magic != VoxelCacheMagic || version != VoxelCacheVersion) {
+        ROS_ERROR_NAMED(LOG, "'%s' is not a compatible voxel cache", path.c_str());
+        return false;
+    }
+
+    std::vector<float> coords;
+    for (std::uint64_t n = 0; n < entry_count; ++n) {
+        VoxelCacheKey key;
+        std::uint64_t key_size;
+        std::uint64_t voxel_count;
+        if (!read(&key_size, sizeof(key_size))) {
+            ROS_ERROR_NAMED(LOG, "Truncated voxel cache '%s'", path.c_str());
+            return false;
+        }
+        key.data.resize(key_size);
+        if (!read(key.data.data(), key_size) ||
+            !read(&voxel_count, sizeof(voxel_count)))
+        {
+            ROS_ERROR_NAMED(LOG, "Truncated voxel cache '%s'", path.c_str());
+            return false;
+        }
+        key.computeHash();
+
+        coords.resize(3 * voxel_count);
+        if (!read(coords.data(), coords.size() * sizeof(float))) {
+            ROS_ERROR_NAMED(LOG, "Truncated voxel cache '%s'", path.c_str());
+            return false;
+        }
+
+        VoxelList voxels(voxel_count);
+        for (size_t i = 0; i < voxels.size(); ++i) {
+            voxels[i] = Eigen::Vector3d(
+                    coords[3 * i + 0], coords[3 * i + 1], coords[3 * i + 2]);
+        }
+        insert(std::move(key), std::move(voxels));
+    }
+
+    ROS_DEBUG_NAMED(LOG, "Loaded voxel cache '%s' (%zu entries, %zu voxels)", path.c_str(), size(), voxelCount());
+    return true;
+}
+
+auto VoxelCache::lookup(const VoxelCacheKey& key)
+    -> std::unordered_multimap<std::uint64_t, EntryIterator>::iterator
+{
+    auto range = m_lookup.equal_range(key.hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second->key.data == key.data) {
+            return it;
+        }
+    }
+    return end(m_lookup);
+}
+
+void VoxelCache::evict()
+{
+    while (m_voxel_count > m_max_voxels && !m_entries.empty()) {
+        auto last = std::prev(end(m_entries));
+        auto range = m_lookup.equal_range(last->key.hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second == last) {
+                m_lookup.erase(it);
+                break;
+            }
+        }
+        m_voxel_count -= last->voxels.size();
+        m_entries.erase(last);
+    }
+}
+
+} // namespace collision
+} // namespace smpl
@@ -41,14 +41,33 @@
 #include <ros/console.h>
 
 // project includes
+#include <sbpl_collision_checking/voxel_cache.h>
 #include <sbpl_collision_checking/voxel_operations.h>
 #include <sbpl_collision_checking/shape_visualization.h>
+#include "collision_operations.h"
 
 namespace smpl {
 namespace collision {
 
 static const char* LOG = "world";
 
+// Concatenate per-shape voxel lists so the distance map may be updated once
+// per object rather than once per shape.
+static
+void GatherVoxels(
+    const std::vector<std::vector<Eigen::Vector3d>>& voxel_lists,
+    std::vector<Eigen::Vector3d>& voxels)
+{
+    size_t count = voxels.size();
+    for (auto& voxel_list : voxel_lists) {
+        count += voxel_list.size();
+    }
+    voxels.reserve(count);
+    for (auto& voxel_list : voxel_lists) {
+        voxels.insert(end(voxels), begin(voxel_list), end(voxel_list));
+    }
+}
+
 /// \class WorldCollisionModel
 ///
 /// This class manages the collision representations for a set of objects in a
@@ -66,7 +85,8 @@ static const char* LOG = "world";
 
 WorldCollisionModel::WorldCollisionModel(OccupancyGrid* grid) :
     m_grid(grid),
-    m_padding(0.0)
+    m_padding(0.0),
+    m_voxel_cache(nullptr)
 {
 }
 
@@ -76,7 +96,8 @@ WorldCollisionModel::WorldCollisionModel(
 :
     m_grid(grid),
     m_object_models(o.m_object_models),
-    m_padding(o.m_padding)
+    m_padding(o.m_padding),
+    m_voxel_cache(o.m_voxel_cache)
 {
     // TODO: check for different voxel origin/resolution/etc here...if they
     // differ, need to do a deep copy + revoxelization of the objects over just
@@ -93,20 +114,8 @@ bool WorldCollisionModel::insertObject(const CollisionObject* object)
         return false;
     }
 
-    const double res = m_grid->resolution();
-    const Eigen::Vector3d origin(
-            m_grid->originX(), m_grid->originY(), m_grid->originZ());
-
-    const Eigen::Vector3d gmin(
-            m_grid->originX(), m_grid->originY(), m_grid->originZ());
-
-    const Eigen::Vector3d gmax(
-            m_grid->originX() + m_grid->sizeX(),
-            m_grid->originY() + m_grid->sizeY(),
-            m_grid->originZ() + m_grid->sizeZ());
-
     std::vector<std::vector<Eigen::Vector3d>> all_voxels;
-    if (!VoxelizeObject(*object, res, origin, gmin, gmax, all_voxels)) {
+    if (!voxelizeObject(object, all_voxels)) {
         ROS_ERROR_NAMED(LOG, "Failed to voxelize object '%s'", object->id.c_str());
         return false;
     }
@@ -118,10 +127,11 @@ bool WorldCollisionModel::insertObject(const CollisionObject* object)
         m_object_models.push_back(std::move(model));
     }
 
-    for (auto& voxel_list : m_object_models.back().cached_voxels) {
-        ROS_DEBUG_NAMED(LOG, "Adding %zu voxels from collision object '%s' to the distance transform", voxel_list.size(), object->id.c_str());
-        m_grid->addPointsToField(voxel_list);
-    }
+    // insert the voxels of all shapes with a single distance map update
+    std::vector<Eigen::Vector3d> voxels;
+    GatherVoxels(m_object_models.back().cached_voxels, voxels);
+    ROS_DEBUG_NAMED(LOG, "Adding %zu voxels from collision object '%s' to the distance transform", voxels.size(), object->id.c_str());
+    m_grid->addPointsToField(voxels);
 
     return true;
 }
@@ -138,10 +148,10 @@ bool WorldCollisionModel::removeObject(const CollisionObject* object)
     auto* model = getObjectCollisionModel(object);
     assert(model != NULL);
 
-    for (auto& voxel_list : model->cached_voxels) {
-        ROS_DEBUG_NAMED(LOG, "Removing %zu grid cells from the distance transform", voxel_list.size());
-        m_grid->removePointsFromField(voxel_list);
-    }
+    std::vector<Eigen::Vector3d> voxels;
+    GatherVoxels(model->cached_voxels, voxels);
+    ROS_DEBUG_NAMED(LOG, "Removing %zu grid cells from the distance transform", voxels.size());
+    m_grid->removePointsFromField(voxels);
 
     auto rit = std::remove_if(begin(m_object_models), end(m_object_models),
             [&](const ObjectCollisionModel& model) {
@@ -197,11 +207,59 @@ bool WorldCollisionModel::hasObjectWithName(const std::string& id) const
 void WorldCollisionModel::reset()
 {
     m_grid->reset();
+    std::vector<Eigen::Vector3d> voxels;
     for (auto& model : m_object_models) {
-        for (auto& voxel_list : model.cached_voxels) {
-            m_grid->addPointsToField(voxel_list);
+        GatherVoxels(model.cached_voxels, voxels);
+    }
+    m_grid->addPointsToField(voxels);
+}
+
+/// Move the volume covered by the occupancy grid by a whole number of cells
+/// along each axis. Each object forgets its voxels leaving the volume, keeps its
+/// voxels remaining in the volume, and is voxelized again to add its voxels
+/// within the cells entering the volume, so that the voxels of an object are
+/// always those it has added to the grid. Return false if the grid does not
+/// support moving, leaving it unchanged, or if an object fails to voxelize, in
+/// which case the object is missing from the entering cells.
+bool WorldCollisionModel::shiftOrigin(int dx, int dy, int dz)
+{
+    if (!m_grid->shiftOrigin(dx, dy, dz)) {
+        ROS_ERROR_NAMED(LOG, "Occupancy grid does not support moving");
+        return false;
+    }
+
+    auto leaving = [&](const Eigen::Vector3d& v) {
+        return !m_grid->isInBounds(v.x(), v.y(), v.z());
+    };
+
+    bool res = true;
+    std::vector<Eigen::Vector3d> voxels;
+    for (auto& model : m_object_models) {
+        for (auto& shape_voxels : model.cached_voxels) {
+            auto rit = std::remove_if(
+                    begin(shape_voxels), end(shape_voxels), leaving);
+            shape_voxels.erase(rit, end(shape_voxels));
+        }
+
+        std::vector<VoxelList> all_voxels;
+        if (!voxelizeObject(model.object, all_voxels)) {
+            ROS_ERROR_NAMED(LOG, "Failed to voxelize object '%s'", model.object->id.c_str());
+            res = false;
+            continue;
+        }
+
+        assert(all_voxels.size() == model.cached_voxels.size());
+        for (size_t i = 0; i < all_voxels.size(); ++i) {
+            auto& shape_voxels = model.cached_voxels[i];
+            auto first = shape_voxels.size();
+            GatherEnteringVoxels(*m_grid, dx, dy, dz, all_voxels[i], shape_voxels);
+            voxels.insert(end(voxels), begin(shape_voxels) + first, end(shape_voxels));
         }
     }
+
+    ROS_DEBUG_NAMED(LOG, "Adding %zu voxels entering the distance transform", voxels.size());
+    m_grid->addPointsToField(voxels);
+    return res;
 }
 
 /// Return a visualization of the objects in the collision model.
@@ -297,6 +355,58 @@ auto WorldCollisionModel::getCollisionWorldVisualization() const
     return ma;
 }
 
+/// Voxelize each shape of an object, reusing voxelizations from the voxel
+/// cache, if one is set, for shapes whose geometry and pose are unchanged.
+bool WorldCollisionModel::voxelizeObject(
+    const CollisionObject* object,
+    std::vector<VoxelList>& all_voxels)
+{
+    const double res = m_grid->resolution();
+    const Eigen::Vector3d origin(
+            m_grid->originX(), m_grid->originY(), m_grid->originZ());
+
+    const Eigen::Vector3d gmin(
+            m_grid->originX(), m_grid->originY(), m_grid->originZ());
+
+    const Eigen::Vector3d gmax(
+            m_grid->originX() + m_grid->sizeX(),
+            m_grid->originY() + m_grid->sizeY(),
+            m_grid->originZ() + m_grid->sizeZ());
+
+    if (!m_voxel_cache) {
+        return VoxelizeObject(*object, res, origin, gmin, gmax, all_voxels);
+    }
+
+    assert(object->shapes.size() == object->shape_poses.size());
+    for (size_t i = 0; i < object->shapes.size(); ++i) {
+        auto& shape = *object->shapes[i];
+        auto& pose = object->shape_poses[i];
+
+        VoxelCacheKey key;
+        auto cacheable = MakeShapeVoxelizationKey(
+                shape, pose, res, origin, gmin, gmax, m_padding, key);
+        if (cacheable) {
+            auto* voxels = m_voxel_cache->find(key);
+            if (voxels) {
+                all_voxels.push_back(*voxels);
+                continue;
+            }
+        }
+
+        VoxelList voxels;
+        if (!VoxelizeShape(shape, pose, res, origin, gmin, gmax, voxels)) {
+            all_voxels.clear();
+            return false;
+        }
+        if (cacheable) {
+            m_voxel_cache->insert(std::move(key), voxels);
+        }
+        all_voxels.push_back(std::move(voxels));
+    }
+
+    return true;
+}
+
 bool WorldCollisionModel::haveObject(const CollisionObject* object) const
 {
     auto it = std::find_if(begin(m_object_models), end(m_object_models),
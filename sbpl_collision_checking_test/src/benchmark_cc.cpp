@@ -40,6 +40,7 @@
 // system includes
 #include <ros/ros.h>
 #include <smpl/distance_map/distance_map.h>
+#include <smpl/distance_map/hashed_distance_map.h>
 #include <smpl/distance_map/sparse_distance_map.h>
 #include <smpl/distance_map/euclid_distance_map.h>
 #include <smpl/occupancy_grid.h>
@@ -106,7 +107,7 @@ auto CreateGrid(const ros::NodeHandle& nh, double max_dist)
     ROS_INFO("  res: %0.3f", res_m);
     ROS_INFO("  max_distance: %0.3f", max_distance_m);
 
-    const int dflib = 2; // 0 -> my dense, 1 -> my sparse, 2 -> df
+    const int dflib = 2; // 0 -> my dense, 1 -> my sparse, 2 -> df, 3 -> my hashed
 
     std::unique_ptr<smpl::OccupancyGrid> grid;
     if (dflib == 0) {
@@ -127,6 +128,14 @@ auto CreateGrid(const ros::NodeHandle& nh, double max_dist)
                 max_distance_m);
         grid = std::unique_ptr<smpl::OccupancyGrid>(
                 new smpl::OccupancyGrid(df, ref_counted));
+    } else if (dflib == 3) {
+        auto df = std::make_shared<smpl::HashedDistanceMap>(
+                origin_x, origin_y, origin_z,
+                size_x, size_y, size_z,
+                res_m,
+                max_distance_m);
+        grid = std::unique_ptr<smpl::OccupancyGrid>(
+                new smpl::OccupancyGrid(df, ref_counted));
     } else {
         grid = std::unique_ptr<smpl::OccupancyGrid>(
                 new smpl::OccupancyGrid(
@@ -0,0 +1,157 @@
+// standard includes
+#include <memory>
+#include <vector>
+
+#define BOOST_TEST_MODULE ShiftOriginTest
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+// system includes
+#include <sbpl_collision_checking/collision_space.h>
+#include <sbpl_collision_checking/shapes.h>
+#include <smpl/distance_map/hashed_distance_map.h>
+#include <smpl/occupancy_grid.h>
+
+// A sphere that slides along the x axis through the center of the grid
+static const char* SliderURDF = R"(
+<robot name="slider">
+  <link name="base"/>
+  <link name="body">
+    <collision>
+      <geometry><sphere radius="0.05"/></geometry>
+    </collision>
+  </link>
+  <joint name="x" type="prismatic">
+    <parent link="base"/>
+    <child link="body"/>
+    <origin xyz="0.5 0.5 0.5" rpy="0 0 0"/>
+    <axis xyz="1 0 0"/>
+    <limit lower="-0.5" upper="0.5" effort="0" velocity="1"/>
+  </joint>
+</robot>
+)";
+
+static const double Res = 0.02;
+
+struct SliderCollisionSpace
+{
+    smpl::OccupancyGrid grid;
+    smpl::collision::CollisionSpace cspace;
+
+    SliderCollisionSpace(double origin_x, double origin_y, double origin_z) :
+        grid(std::make_shared<smpl::HashedDistanceMap>(
+                origin_x, origin_y, origin_z, 1.0, 1.0, 1.0, Res, 0.2),
+             true)
+    {
+        smpl::collision::CollisionSphereConfig sphere;
+        sphere.name = "body0";
+        sphere.x = sphere.y = sphere.z = 0.0;
+        sphere.radius = 0.05;
+        sphere.priority = 1;
+
+        smpl::collision::CollisionSpheresModelConfig spheres;
+        spheres.link_name = "body";
+        spheres.autogenerate = false;
+        spheres.radius = 0.0;
+        spheres.spheres.push_back(sphere);
+
+        smpl::collision::CollisionGroupConfig group;
+        group.name = "slider";
+        group.links.push_back("body");
+
+        smpl::collision::CollisionModelConfig config;
+        config.world_joint.name = "world_joint";
+        config.world_joint.type = "fixed";
+        config.spheres_models.push_back(spheres);
+        config.groups.push_back(group);
+
+        BOOST_REQUIRE(cspace.init(&grid, SliderURDF, config, "slider", { "x" }));
+    }
+};
+
+// Boxes along the path of the slider, some of them beyond the initial volume
+// of the grid
+struct Obstacles
+{
+    std::vector<smpl::collision::BoxShape> boxes;
+    std::vector<smpl::collision::CollisionObject> objects;
+
+    Obstacles()
+    {
+        boxes.emplace_back(0.07, 0.13, 0.11);
+        boxes.emplace_back(0.05, 0.05, 0.05);
+        boxes.emplace_back(0.08, 0.07, 0.31);
+        boxes.emplace_back(0.11, 0.05, 0.09);
+        const Eigen::Vector3d centers[] = {
+            Eigen::Vector3d(0.21, 0.51, 0.49),
+            Eigen::Vector3d(0.73, 0.47, 0.53),
+            Eigen::Vector3d(1.05, 0.53, 0.51),
+            Eigen::Vector3d(-0.11, 0.49, 0.47),
+        };
+
+        objects.resize(boxes.size());
+        for (size_t i = 0; i < boxes.size(); ++i) {
+            objects[i].id = "box" + std::to_string(i);
+            objects[i].shapes.push_back(&boxes[i]);
+            objects[i].shape_poses.push_back(
+                    Eigen::Affine3d(Eigen::Translation3d(centers[i])));
+        }
+    }
+};
+
+// A moved CollisionSpace must agree with a CollisionSpace built at the new
+// origin, and removing its objects must leave the grid empty.
+BOOST_AUTO_TEST_CASE(ShiftMatchesFreshCollisionSpace)
+{
+    Obstacles obstacles;
+
+    SliderCollisionSpace s(0.0, 0.0, 0.0);
+    for (auto& object : obstacles.objects) {
+        BOOST_REQUIRE(s.cspace.insertObject(&object));
+    }
+
+    const int shifts[][3] = {
+        { 10, 0, 0 },
+        { 0, -5, 3 },
+        { -25, 5, -3 },
+        { 17, 2, 1 },
+    };
+
+    int valid_count = 0;
+    int invalid_count = 0;
+    int ox = 0, oy = 0, oz = 0;
+    for (auto& d : shifts) {
+        BOOST_REQUIRE(s.cspace.shiftOrigin(d[0], d[1], d[2]));
+        ox += d[0];
+        oy += d[1];
+        oz += d[2];
+
+        SliderCollisionSpace fresh(ox * Res, oy * Res, oz * Res);
+        for (auto& object : obstacles.objects) {
+            BOOST_REQUIRE(fresh.cspace.insertObject(&object));
+        }
+
+        BOOST_CHECK_EQUAL(
+                s.grid.getOccupiedVoxelCount(),
+                fresh.grid.getOccupiedVoxelCount());
+        for (int i = 0; i <= 100; ++i) {
+            const double x = -0.5 + 0.01 * i;
+            auto expected = fresh.cspace.isStateValid({ x });
+            BOOST_CHECK_EQUAL(s.cspace.isStateValid({ x }), expected);
+            if (expected) {
+                ++valid_count;
+            } else {
+                ++invalid_count;
+            }
+        }
+    }
+
+    // both outcomes are exercised
+    BOOST_CHECK(valid_count > 0);
+    BOOST_CHECK(invalid_count > 0);
+
+    for (auto& object : obstacles.objects) {
+        BOOST_REQUIRE(s.cspace.removeObject(&object));
+    }
+    BOOST_CHECK_EQUAL(s.grid.getOccupiedVoxelCount(), 0u);
+}
@@ -0,0 +1,130 @@
+// standard includes
+#include <memory>
+#include <string>
+#include <vector>
+
+#define BOOST_TEST_MODULE ValidityCacheTest
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+// system includes
+#include <sbpl_collision_checking/collision_space.h>
+#include <smpl/distance_map/sparse_distance_map.h>
+#include <smpl/occupancy_grid.h>
+
+// A sphere that slides along the x axis through the center of the grid
+static const char* SliderURDF = R"(
+<robot name="slider">
+  <link name="base"/>
+  <link name="body">
+    <collision>
+      <geometry><sphere radius="0.05"/></geometry>
+    </collision>
+  </link>
+  <joint name="x" type="prismatic">
+    <parent link="base"/>
+    <child link="body"/>
+    <origin xyz="0.5 0.5 0.5" rpy="0 0 0"/>
+    <axis xyz="1 0 0"/>
+    <limit lower="-0.5" upper="0.5" effort="0" velocity="1"/>
+  </joint>
+</robot>
+)";
+
+struct SliderCollisionSpace
+{
+    smpl::OccupancyGrid grid;
+    smpl::collision::CollisionSpace cspace;
+
+    SliderCollisionSpace() :
+        grid(std::make_shared<smpl::SparseDistanceMap>(
+                0.0, 0.0, 0.0, 1.0, 1.0, 1.0, 0.02, 0.2))
+    {
+        smpl::collision::CollisionSphereConfig sphere;
+        sphere.name = "body0";
+        sphere.x = sphere.y = sphere.z = 0.0;
+        sphere.radius = 0.05;
+        sphere.priority = 1;
+
+        smpl::collision::CollisionSpheresModelConfig spheres;
+        spheres.link_name = "body";
+        spheres.autogenerate = false;
+        spheres.radius = 0.0;
+        spheres.spheres.push_back(sphere);
+
+        smpl::collision::CollisionGroupConfig group;
+        group.name = "slider";
+        group.links.push_back("body");
+
+        smpl::collision::CollisionModelConfig config;
+        config.world_joint.name = "world_joint";
+        config.world_joint.type = "fixed";
+        config.spheres_models.push_back(spheres);
+        config.groups.push_back(group);
+
+        BOOST_REQUIRE(cspace.init(&grid, SliderURDF, config, "slider", { "x" }));
+    }
+};
+
+// Obstacles added through the OccupancyGrid, bypassing the CollisionSpace,
+// must invalidate remembered states and motions.
+BOOST_AUTO_TEST_CASE(OccupancyGridChangeInvalidatesCache)
+{
+    SliderCollisionSpace s;
+    auto& cspace = s.cspace;
+    cspace.setValidityCacheCapacity(16);
+
+    BOOST_CHECK(cspace.isStateValid({ 0.2 }));
+    BOOST_CHECK(cspace.isStateValid({ 0.2 }));
+    BOOST_CHECK(cspace.isStateToStateValid({ -0.2 }, { 0.2 }));
+    BOOST_CHECK(cspace.isStateToStateValid({ -0.2 }, { 0.2 }));
+    BOOST_CHECK_EQUAL(cspace.validityCacheStats().state_hits, 1u);
+    BOOST_CHECK_EQUAL(cspace.validityCacheStats().edge_hits, 1u);
+    BOOST_CHECK_EQUAL(cspace.validityCacheStats().invalidations, 0u);
+
+    s.grid.addPointsToField({ smpl::Vector3(0.7, 0.5, 0.5) });
+
+    BOOST_CHECK(!cspace.isStateValid({ 0.2 }));
+    BOOST_CHECK(!cspace.isStateToStateValid({ -0.2 }, { 0.2 }));
+    BOOST_CHECK_EQUAL(cspace.validityCacheStats().state_hits, 1u);
+    BOOST_CHECK_EQUAL(cspace.validityCacheStats().edge_hits, 1u);
+    BOOST_CHECK_EQUAL(cspace.validityCacheStats().invalidations, 1u);
+
+    // states differing from a remembered state by less than any
+    // discretization are checked, not looked up
+    BOOST_CHECK(cspace.isStateValid({ -0.2 }));
+    BOOST_CHECK(cspace.isStateValid({ -0.2 + 1e-9 }));
+    BOOST_CHECK_EQUAL(cspace.validityCacheStats().state_hits, 1u);
+}
+
+// The cache must remember at most `capacity` states, evicting the oldest.
+BOOST_AUTO_TEST_CASE(EvictionKeepsCapacity)
+{
+    SliderCollisionSpace s;
+    auto& cspace = s.cspace;
+    cspace.setValidityCacheCapacity(4);
+    BOOST_CHECK_EQUAL(cspace.validityCacheCapacity(), 4u);
+
+    for (int i = 0; i < 10; ++i) {
+        BOOST_CHECK(cspace.isStateValid({ -0.05 * i }));
+    }
+    BOOST_CHECK_EQUAL(cspace.validityCacheStats().state_misses, 10u);
+
+    // the four most recent states are remembered
+    for (int i = 9; i >= 6; --i) {
+        BOOST_CHECK(cspace.isStateValid({ -0.05 * i }));
+    }
+    BOOST_CHECK_EQUAL(cspace.validityCacheStats().state_hits, 4u);
+
+    // older states were evicted
+    for (int i = 0; i < 6; ++i) {
+        BOOST_CHECK(cspace.isStateValid({ -0.05 * i }));
+    }
+    BOOST_CHECK_EQUAL(cspace.validityCacheStats().state_hits, 4u);
+    BOOST_CHECK_EQUAL(cspace.validityCacheStats().state_misses, 16u);
+
+    // disabling the cache bypasses it
+    cspace.setValidityCacheCapacity(0);
+    BOOST_CHECK(cspace.isStateValid({ 0.0 }));
+    BOOST_CHECK_EQUAL(cspace.validityCacheStats().state_misses, 16u);
+}
@@ -0,0 +1,149 @@
+// standard includes
+#include <cstdio>
+#include <string>
+
+#define BOOST_TEST_MODULE VoxelCacheTest
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+// system includes
+#include <sbpl_collision_checking/voxel_cache.h>
+
+using smpl::collision::VoxelCache;
+using smpl::collision::VoxelCacheKey;
+
+static const double Res = 0.02;
+static const Eigen::Vector3d GridOrigin(0.0, 0.0, 0.0);
+static const Eigen::Vector3d GridMin(0.0, 0.0, 0.0);
+static const Eigen::Vector3d GridMax(1.0, 1.0, 1.0);
+
+static
+auto SphereKey(double radius, const Eigen::Affine3d& pose) -> VoxelCacheKey
+{
+    smpl::collision::SphereShape sphere(radius);
+    VoxelCacheKey key;
+    BOOST_REQUIRE(MakeShapeVoxelizationKey(
+            sphere, pose, Res, GridOrigin, GridMin, GridMax, 0.0, key));
+    return key;
+}
+
+static
+auto Voxels(size_t count) -> VoxelCache::VoxelList
+{
+    VoxelCache::VoxelList voxels;
+    for (size_t i = 0; i < count; ++i) {
+        voxels.emplace_back(Res * i, 0.5 * Res, 0.25);
+    }
+    return voxels;
+}
+
+BOOST_AUTO_TEST_CASE(PoseChangeMissesTest)
+{
+    VoxelCache cache;
+
+    Eigen::Affine3d pose(Eigen::Translation3d(0.5, 0.5, 0.5));
+    cache.insert(SphereKey(0.1, pose), Voxels(10));
+    BOOST_CHECK(cache.find(SphereKey(0.1, pose)) != nullptr);
+
+    // a different pose, a different radius, or a different shape type with
+    // the same parameters must not find the entry
+    Eigen::Affine3d moved(Eigen::Translation3d(0.5, 0.5, 0.5 + 1e-9));
+    BOOST_CHECK(cache.find(SphereKey(0.1, moved)) == nullptr);
+
+    BOOST_CHECK(cache.find(SphereKey(0.1 + 1e-9, pose)) == nullptr);
+
+    smpl::collision::CylinderShape cylinder(0.1, 0.0);
+    VoxelCacheKey cylinder_key;
+    BOOST_REQUIRE(MakeShapeVoxelizationKey(
+            cylinder, pose, Res, GridOrigin, GridMin, GridMax, 0.0, cylinder_key));
+    BOOST_CHECK(cache.find(cylinder_key) == nullptr);
+
+    // entries whose keys share a hash are told apart by their contents
+    VoxelCacheKey collision = SphereKey(0.1, moved);
+    collision.hash = SphereKey(0.1, pose).hash;
+    BOOST_CHECK(cache.find(collision) == nullptr);
+    cache.insert(collision, Voxels(3));
+    BOOST_CHECK_EQUAL(cache.size(), 2u);
+    BOOST_REQUIRE(cache.find(SphereKey(0.1, pose)) != nullptr);
+    BOOST_CHECK_EQUAL(cache.find(SphereKey(0.1, pose))->size(), 10u);
+    BOOST_REQUIRE(cache.find(collision) != nullptr);
+    BOOST_CHECK_EQUAL(cache.find(collision)->size(), 3u);
+}
+
+BOOST_AUTO_TEST_CASE(EvictionByVoxelCountTest)
+{
+    VoxelCache cache(100);
+
+    Eigen::Affine3d pose(Eigen::Translation3d(0.5, 0.5, 0.5));
+    cache.insert(SphereKey(0.1, pose), Voxels(40));
+    cache.insert(SphereKey(0.2, pose), Voxels(40));
+    BOOST_CHECK_EQUAL(cache.voxelCount(), 80u);
+
+    // touch the first entry so that the second is least-recently used
+    BOOST_CHECK(cache.find(SphereKey(0.1, pose)) != nullptr);
+
+    cache.insert(SphereKey(0.3, pose), Voxels(40));
+    BOOST_CHECK_EQUAL(cache.size(), 2u);
+    BOOST_CHECK_EQUAL(cache.voxelCount(), 80u);
+    BOOST_CHECK(cache.find(SphereKey(0.1, pose)) != nullptr);
+    BOOST_CHECK(cache.find(SphereKey(0.2, pose)) == nullptr);
+    BOOST_CHECK(cache.find(SphereKey(0.3, pose)) != nullptr);
+
+    // voxel lists larger than the budget are not cached
+    cache.insert(SphereKey(0.4, pose), Voxels(101));
+    BOOST_CHECK(cache.find(SphereKey(0.4, pose)) == nullptr);
+    BOOST_CHECK_EQUAL(cache.voxelCount(), 80u);
+
+    // shrinking the budget evicts down to it
+    cache.setMaxVoxels(50);
+    BOOST_CHECK_EQUAL(cache.size(), 1u);
+    BOOST_CHECK_EQUAL(cache.voxelCount(), 40u);
+    BOOST_CHECK(cache.find(SphereKey(0.3, pose)) != nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(SaveLoadTest)
+{
+    const std::string path = "/tmp/voxel_cache_test.bin";
+
+    Eigen::Affine3d pose(Eigen::Translation3d(0.5, 0.5, 0.5));
+    VoxelCache cache;
+    cache.insert(SphereKey(0.1, pose), Voxels(10));
+    cache.insert(SphereKey(0.2, pose), Voxels(20));
+    cache.insert(SphereKey(0.3, pose), Voxels(30));
+    BOOST_CHECK(cache.find(SphereKey(0.1, pose)) != nullptr);
+    BOOST_REQUIRE(cache.save(path));
+
+    VoxelCache loaded;
+    BOOST_REQUIRE(loaded.load(path));
+    std::remove(path.c_str());
+
+    BOOST_CHECK_EQUAL(loaded.size(), cache.size());
+    BOOST_CHECK_EQUAL(loaded.voxelCount(), cache.voxelCount());
+    for (double radius : { 0.1, 0.2, 0.3 }) {
+        auto* expected = cache.find(SphereKey(radius, pose));
+        auto* voxels = loaded.find(SphereKey(radius, pose));
+        BOOST_REQUIRE(expected && voxels);
+        BOOST_REQUIRE_EQUAL(voxels->size(), expected->size());
+        for (size_t i = 0; i < voxels->size(); ++i) {
+            BOOST_CHECK_SMALL(((*voxels)[i] - (*expected)[i]).norm(), 1e-6);
+        }
+    }
+    BOOST_CHECK(loaded.find(SphereKey(0.1, Eigen::Affine3d::Identity())) == nullptr);
+
+    // loading restores the recency order, so loading into a smaller cache
+    // evicts the least-recently used entries
+    VoxelCache recent;
+    recent.insert(SphereKey(0.1, pose), Voxels(10));
+    recent.insert(SphereKey(0.2, pose), Voxels(20));
+    recent.insert(SphereKey(0.3, pose), Voxels(30));
+    BOOST_CHECK(recent.find(SphereKey(0.1, pose)) != nullptr);
+    BOOST_REQUIRE(recent.save(path));
+
+    VoxelCache bounded(40);
+    BOOST_REQUIRE(bounded.load(path));
+    std::remove(path.c_str());
+    BOOST_CHECK_EQUAL(bounded.voxelCount(), 40u);
+    BOOST_CHECK(bounded.find(SphereKey(0.1, pose)) != nullptr);
+    BOOST_CHECK(bounded.find(SphereKey(0.2, pose)) == nullptr);
+    BOOST_CHECK(bounded.find(SphereKey(0.3, pose)) != nullptr);
+}
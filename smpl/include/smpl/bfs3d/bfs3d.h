@@ -96,6 +96,9 @@ public:
     int countUndiscovered() const;
     int countDiscovered() const;
 
+    /// \brief Return the number of bytes held by the grid and search queue.
+    size_t memoryUsage() const;
+
 private:
 
     std::thread m_search_thread;
@@ -111,6 +111,40 @@ public:
         const RobotState& finish) = 0;
 };
 
+/// Extension for collision checkers that can validate several motions in a
+/// single call, e.g. by distributing them across worker threads.
+class BatchCollisionCheckExtension : public virtual Extension
+{
+public:
+
+    /// \brief Check a batch of motions that share a start state.
+    ///
+    /// Motion i is the path from start through each waypoint of *motions[i].
+    /// On return, valid[i] is true iff each segment of motion i would be
+    /// reported valid by isStateToStateValid.
+    virtual void isMotionBatchValid(
+        const RobotState& start,
+        const std::vector<const Action*>& motions,
+        std::vector<bool>& valid) = 0;
+};
+
+/// Extension for collision checkers that can remember the results of
+/// isStateValid and isStateToStateValid across calls.
+class ValidityCacheExtension : public virtual Extension
+{
+public:
+
+    /// \brief Set the maximum number of remembered results.
+    ///
+    /// A capacity of 0 disables the cache. Results must only be reused for
+    /// the exact states and motions they were computed for, so that callers
+    /// outside the search, e.g. path validation and shortcutting, observe the
+    /// same results as with the cache disabled.
+    virtual void setValidityCacheCapacity(size_t capacity) = 0;
+
+    virtual void clearValidityCache() = 0;
+};
+
 } // namespace smpl
 
 #endif
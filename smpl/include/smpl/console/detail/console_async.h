@@ -0,0 +1,265 @@
+#ifndef SMPL_CONSOLE_ASYNC_H
+#define SMPL_CONSOLE_ASYNC_H
+
+// standard includes
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace smpl {
+namespace console {
+
+/// Counters for the asynchronous log sink, accumulated over all threads.
+struct AsyncStats
+{
+    uint64_t written;   ///< messages enqueued for the background writer
+    uint64_t dropped;   ///< messages dropped because a thread's buffer was full
+};
+
+auto GetAsyncStats() -> AsyncStats;
+
+/// Block until every message enqueued so far has been written.
+void flush();
+
+namespace detail {
+
+// When asynchronous logging is enabled, messages are captured on the calling
+// thread as the format string plus a binary encoding of each argument, and
+// are formatted and written by a background thread. Each encoded argument is
+// a one-byte type tag followed by its value.
+enum ArgType : uint8_t
+{
+    ARG_I32,
+    ARG_U32,
+    ARG_I64,
+    ARG_U64,
+    ARG_F64,
+    ARG_LF64,
+    ARG_STR,
+    ARG_PTR,
+};
+
+// Encodes printf arguments into a buffer, or only measures their encoded size
+// if the buffer is null.
+struct ArgEncoder
+{
+    uint8_t* data = nullptr;
+    size_t size = 0;
+
+    void put(ArgType type, const void* value, size_t len)
+    {
+        if (data) {
+            data[size] = type;
+            memcpy(data + size + 1, value, len);
+        }
+        size += 1 + len;
+    }
+
+    void put_str(const char* s)
+    {
+        if (!s) {
+            s = "(null)";
+        }
+        uint32_t len = (uint32_t)strlen(s);
+        if (data) {
+            data[size] = ARG_STR;
+            memcpy(data + size + 1, &len, sizeof(len));
+            memcpy(data + size + 1 + sizeof(len), s, len);
+        }
+        size += 1 + sizeof(len) + len;
+    }
+};
+
+// Arguments are encoded as the type they are promoted to when passed through
+// a C variadic argument list.
+template <class T>
+auto EncodeArg(ArgEncoder& enc, T val)
+    -> typename std::enable_if<std::is_integral<T>::value>::type
+{
+    if (sizeof(T) <= sizeof(int32_t)) {
+        if (std::is_signed<T>::value) {
+            int32_t v = (int32_t)val;
+            enc.put(ARG_I32, &v, sizeof(v));
+        } else {
+            uint32_t v = (uint32_t)val;
+            enc.put(ARG_U32, &v, sizeof(v));
+        }
+    } else {
+        if (std::is_signed<T>::value) {
+            int64_t v = (int64_t)val;
+            enc.put(ARG_I64, &v, sizeof(v));
+        } else {
+            uint64_t v = (uint64_t)val;
+            enc.put(ARG_U64, &v, sizeof(v));
+        }
+    }
+}
+
+template <class T>
+auto EncodeArg(ArgEncoder& enc, T val)
+    -> typename std::enable_if<std::is_enum<T>::value>::type
+{
+    EncodeArg(enc, (typename std::underlying_type<T>::type)val);
+}
+
+inline void EncodeArg(ArgEncoder& enc, float val)
+{
+    double v = val;
+    enc.put(ARG_F64, &v, sizeof(v));
+}
+
+inline void EncodeArg(ArgEncoder& enc, double val)
+{
+    enc.put(ARG_F64, &val, sizeof(val));
+}
+
+inline void EncodeArg(ArgEncoder& enc, long double val)
+{
+    enc.put(ARG_LF64, &val, sizeof(val));
+}
+
+inline void EncodeArg(ArgEncoder& enc, const char* val)
+{
+    enc.put_str(val);
+}
+
+inline void EncodeArg(ArgEncoder& enc, char* val)
+{
+    enc.put_str(val);
+}
+
+inline void EncodeArg(ArgEncoder& enc, std::nullptr_t)
+{
+    const void* v = nullptr;
+    enc.put(ARG_PTR, &v, sizeof(v));
+}
+
+template <class T>
+void EncodeArg(ArgEncoder& enc, T* val)
+{
+    const void* v = val;
+    enc.put(ARG_PTR, &v, sizeof(v));
+}
+
+inline void EncodeArgs(ArgEncoder& enc) { }
+
+template <class T, class... Args>
+void EncodeArgs(ArgEncoder& enc, const T& arg, const Args&... args)
+{
+    EncodeArg(enc, arg);
+    EncodeArgs(enc, args...);
+}
+
+extern std::atomic<bool> g_async;
+
+// Reserve space for a message in the calling thread's buffer and write its
+// header and format string. Returns a pointer to storage for the encoded
+// arguments, or null if the message must be dropped.
+auto BeginAsyncRecord(
+    int level,
+    const char* filename,
+    int line,
+    const char* fmt,
+    size_t args_size)
+    -> uint8_t*;
+
+// Publish the message started by the last call to BeginAsyncRecord.
+void CommitAsyncRecord();
+
+bool StartAsync(size_t buffer_size);
+
+// Records the values inserted by the stream logging macros so that they are
+// formatted by the background writer. Strings are copied into a generated
+// format string, and arithmetic values are encoded as its arguments. Values of
+// other types, and manipulators, are formatted on the calling thread, along
+// with everything inserted after them, since they may change the stream state.
+class AsyncStream
+{
+public:
+
+    AsyncStream& operator<<(const char* s);
+    AsyncStream& operator<<(char* s) { return *this << (const char*)s; }
+    AsyncStream& operator<<(const std::string& s) { return *this << s.c_str(); }
+
+    AsyncStream& operator<<(bool val) { return put("%d", (int)val, val); }
+    AsyncStream& operator<<(char val) { return put("%c", (int)val, val); }
+    AsyncStream& operator<<(signed char val) { return put("%c", (int)val, val); }
+    AsyncStream& operator<<(unsigned char val) { return put("%c", (int)val, val); }
+    AsyncStream& operator<<(short val) { return put("%d", val, val); }
+    AsyncStream& operator<<(unsigned short val) { return put("%u", val, val); }
+    AsyncStream& operator<<(int val) { return put("%d", val, val); }
+    AsyncStream& operator<<(unsigned int val) { return put("%u", val, val); }
+    AsyncStream& operator<<(long val) { return put("%lld", (long long)val, val); }
+    AsyncStream& operator<<(unsigned long val) { return put("%llu", (unsigned long long)val, val); }
+    AsyncStream& operator<<(long long val) { return put("%lld", val, val); }
+    AsyncStream& operator<<(unsigned long long val) { return put("%llu", val, val); }
+    AsyncStream& operator<<(float val) { return put("%g", val, val); }
+    AsyncStream& operator<<(double val) { return put("%g", val, val); }
+    AsyncStream& operator<<(long double val) { return put("%Lg", val, val); }
+
+    AsyncStream& operator<<(std::ostream& (*manip)(std::ostream&))
+    {
+        stream() << manip;
+        return *this;
+    }
+
+    template <class T>
+    AsyncStream& operator<<(const T& val)
+    {
+        stream() << val;
+        return *this;
+    }
+
+    // Enqueue the message. The stream must not be used afterwards.
+    void commit(int level, const char* filename, int line);
+
+private:
+
+    std::string m_fmt;
+    std::vector<uint8_t> m_args;
+
+    // formats the remainder of the message on the calling thread
+    std::unique_ptr<std::ostringstream> m_stream;
+
+    auto stream() -> std::ostringstream&
+    {
+        if (!m_stream) {
+            m_stream.reset(new std::ostringstream);
+        }
+        return *m_stream;
+    }
+
+    template <class Encoded, class T>
+    AsyncStream& put(const char* conversion, Encoded encoded, T val)
+    {
+        if (m_stream) {
+            *m_stream << val;
+            return *this;
+        }
+        m_fmt += conversion;
+        ArgEncoder sizer;
+        EncodeArg(sizer, encoded);
+        auto offset = m_args.size();
+        m_args.resize(offset + sizer.size);
+        ArgEncoder enc;
+        enc.data = m_args.data() + offset;
+        EncodeArg(enc, encoded);
+        return *this;
+    }
+};
+
+// Format and write a message on the calling thread.
+void WriteMessage(int level, const char* filename, int line, const char* msg);
+
+} // namespace detail
+} // namespace console
+} // namespace smpl
+
+#endif
@@ -8,6 +8,7 @@
 
 // project includes
 #include <smpl/time.h>
+#include <smpl/console/detail/console_async.h>
 
 namespace smpl {
 namespace console {
@@ -55,6 +56,36 @@ void print(Level level, const char* filename, int line, const std::stringstream&
 extern bool g_initialized;
 void initialize();
 
+/// Log a message. If asynchronous logging is enabled, the message is handed
+/// off to the background writer; fatal messages first flush all pending
+/// messages and are always written on the calling thread.
+template <class... Args>
+void log(
+    Level level,
+    const char* filename,
+    int line,
+    const char* fmt,
+    const Args&... args)
+{
+    if (detail::g_async.load(std::memory_order_acquire)) {
+        if (level < LEVEL_FATAL) {
+            detail::ArgEncoder sizer;
+            detail::EncodeArgs(sizer, args...);
+            auto* data = detail::BeginAsyncRecord(
+                    level, filename, line, fmt, sizer.size);
+            if (data) {
+                detail::ArgEncoder enc;
+                enc.data = data;
+                detail::EncodeArgs(enc, args...);
+                detail::CommitAsyncRecord();
+            }
+            return;
+        }
+        flush();
+    }
+    print(level, filename, line, fmt, args...);
+}
+
 } // namespace console
 } // namespace smpl
 
@@ -80,7 +111,7 @@ do { \
     do { \
         SMPL_LOG_DEFINE_LOCATION(cond, level, name); \
         if (__sc_define_location__enabled) { \
-            ::smpl::console::print(level, __FILE__, __LINE__, fmt, ##__VA_ARGS__); \
+            ::smpl::console::log(level, __FILE__, __LINE__, fmt, ##__VA_ARGS__); \
         } \
     } while (0)
 
@@ -91,9 +122,17 @@ do { \
     do { \
         SMPL_LOG_DEFINE_LOCATION(cond, level, name); \
         if (__sc_define_location__enabled) { \
-            std::stringstream _smpl_log_stream_ss_; \
-            _smpl_log_stream_ss_ << args; \
-            ::smpl::console::print(level, __FILE__, __LINE__, _smpl_log_stream_ss_); \
+            if (::smpl::console::detail::g_async.load(std::memory_order_acquire) && \
+                (level) < ::smpl::console::LEVEL_FATAL) \
+            { \
+                ::smpl::console::detail::AsyncStream _smpl_log_stream_as_; \
+                _smpl_log_stream_as_ << args; \
+                _smpl_log_stream_as_.commit(level, __FILE__, __LINE__); \
+            } else { \
+                std::stringstream _smpl_log_stream_ss_; \
+                _smpl_log_stream_ss_ << args; \
+                ::smpl::console::log(level, __FILE__, __LINE__, "%s", _smpl_log_stream_ss_.str().c_str()); \
+            } \
         } \
     } while (0)
 
@@ -104,7 +143,7 @@ do { \
         static bool hit = false; \
         if (!hit) { \
             hit = true; \
-            ::smpl::console::print(level, __FILE__, __LINE__, fmt, ##__VA_ARGS__); \
+            ::smpl::console::log(level, __FILE__, __LINE__, fmt, ##__VA_ARGS__); \
         } \
     } while (0)
 
@@ -116,7 +155,7 @@ do { \
         auto now = ::smpl::clock::now(); \
         if (last_hit + rate_dur <= now) { \
             last_hit = now; \
-            ::smpl::console::print(level, __FILE__, __LINE__, fmt, ##__VA_ARGS__); \
+            ::smpl::console::log(level, __FILE__, __LINE__, fmt, ##__VA_ARGS__); \
         } \
     } while (0)
 
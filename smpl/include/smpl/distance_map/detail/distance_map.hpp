@@ -525,6 +525,19 @@ bool DistanceMap<Derived>::isCellValid(int x, int y, int z) const
         z >= 0 && z < m_cells.zsize() - 2;
 }
 
+template <typename Derived>
+size_t DistanceMap<Derived>::memoryUsage() const
+{
+    size_t usage = m_cells.size() * sizeof(Cell) +
+            m_sqrt_table.capacity() * sizeof(double) +
+            m_open.capacity() * sizeof(bucket_type) +
+            m_rem_stack.capacity() * sizeof(Cell*);
+    for (auto& bucket : m_open) {
+        usage += bucket.capacity() * sizeof(Cell*);
+    }
+    return usage;
+}
+
 template <typename Derived>
 void DistanceMap<Derived>::rewire(const DistanceMap& o)
 {
@@ -101,6 +101,8 @@ public:
         int& x, int& y, int& z) const override;
 
     bool isCellValid(int x, int y, int z) const override;
+
+    size_t memoryUsage() const override;
     ///@}
 
     friend Derived;
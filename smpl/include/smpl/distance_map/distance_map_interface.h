@@ -86,6 +86,11 @@ public:
             const std::vector<Vector3>& old_points,
             const std::vector<Vector3>& new_points) = 0;
     virtual void reset() = 0;
+
+    /// Move the volume covered by the distance map by a whole number of cells
+    /// along each axis, retaining the obstacles that remain within it. Return
+    /// false if the implementation does not support moving the volume.
+    virtual bool shiftOrigin(int, int, int) { return false; }
     ///@}
 
     /// \name Properties
@@ -129,6 +134,10 @@ public:
     virtual bool isCellValid(int x, int y, int z) const = 0;
     ///@}
 
+    /// Return an estimate of the number of bytes held by the distance map, or
+    /// 0 if the implementation does not report its memory usage.
+    virtual size_t memoryUsage() const { return 0; }
+
 protected:
 
     double m_origin_x;
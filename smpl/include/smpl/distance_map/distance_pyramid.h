@@ -0,0 +1,119 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2018, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#ifndef SMPL_DISTANCE_PYRAMID_H
+#define SMPL_DISTANCE_PYRAMID_H
+
+// standard includes
+#include <vector>
+
+// project includes
+#include <smpl/distance_map/distance_map_interface.h>
+#include <smpl/spatial.h>
+
+namespace smpl {
+
+/// Conservative, downsampled copies of a distance map, used to prove that
+/// points are clear of obstacles without looking up the distance map itself.
+///
+/// Level i of the pyramid stores, for each block of 2^(i+1) cells along each
+/// axis, the minimum cell distance within the block less sqrt(3) * resolution,
+/// the most a cell distance may exceed the metric distance of a point within
+/// the cell. This is a lower bound on getMetricDistance() for any point within
+/// the block. The coarse levels are small enough to remain in cache when the
+/// distance map is not.
+///
+/// The pyramid does not observe the distance map. It must be updated, by
+/// update() or rebuild(), whenever the distance map changes.
+class DistancePyramid
+{
+public:
+
+    static const int MAX_LEVELS = 3;
+
+    DistancePyramid(int levels = MAX_LEVELS);
+
+    int levels() const { return m_num_levels; }
+
+    void rebuild(const DistanceMapInterface& dmap);
+
+    void update(
+        const DistanceMapInterface& dmap,
+        const std::vector<Vector3>& points);
+
+    void update(
+        const DistanceMapInterface& dmap,
+        int fx, int fy, int fz,
+        int tx, int ty, int tz);
+
+    bool isClear(int x, int y, int z, double dist) const;
+
+private:
+
+    struct Level
+    {
+        int size_x = 0;
+        int size_y = 0;
+        int size_z = 0;
+        std::vector<float> values;
+
+        void resize(int sx, int sy, int sz, float value);
+
+        float& operator()(int x, int y, int z)
+        { return values[(x * size_y + y) * size_z + z]; }
+
+        float operator()(int x, int y, int z) const
+        { return values[(x * size_y + y) * size_z + z]; }
+    };
+
+    int m_num_levels;
+
+    int m_cells_x = 0;
+    int m_cells_y = 0;
+    int m_cells_z = 0;
+
+    // cells within this distance of an obstacle may have their distances
+    // changed by the addition or removal of the obstacle
+    int m_update_radius = 0;
+
+    // bound on the amount a cell distance exceeds the metric distance of a
+    // point within the cell
+    double m_error = 0.0;
+
+    // m_levels[i] stores lower bounds for blocks of 2^(i+1) cells
+    std::vector<Level> m_levels;
+
+    std::vector<char> m_dirty;
+};
+
+} // namespace smpl
+
+#endif
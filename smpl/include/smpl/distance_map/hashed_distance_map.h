@@ -0,0 +1,347 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2018, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#ifndef SMPL_HASHED_DISTANCE_MAP_H
+#define SMPL_HASHED_DISTANCE_MAP_H
+
+// standard includes
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// system includes
+#include <Eigen/Core>       // explicit include here for Eigen::Vector3i
+#include <Eigen/StdVector>
+
+// project includes
+#include <smpl/distance_map/distance_map_interface.h>
+#include <smpl/spatial.h>
+#include "detail/distance_map_common.h"
+
+namespace smpl {
+
+/// A sparse distance map that stores cells in dense blocks of 8x8x8 cells,
+/// allocated on demand and indexed by a hash table. Blocks are only allocated
+/// for the regions of the map within the propagation distance of an obstacle,
+/// and are released again when the obstacles they were near to are removed.
+///
+/// Compared to SparseDistanceMap, a cell lookup costs one hash table probe,
+/// rather than a walk from the root of an octree, and neighboring cells are
+/// usually found in the same block. Queries that look up several nearby cells
+/// remember the last block visited so that the hash table is only consulted
+/// when the query crosses into another block.
+///
+/// Blocks are keyed by their position relative to the origin the map was
+/// constructed with, so the volume covered by the map may be moved by whole
+/// cells with shiftOrigin(). Only the cells entering the volume have their
+/// distances computed anew, and blocks leaving the volume are recycled.
+class HashedDistanceMap : public DistanceMapInterface
+{
+public:
+
+    struct Cell
+    {
+        int ox;
+        int oy;
+        int oz;
+
+        int dist;
+        int dist_new;
+#if SMPL_DMAP_RETURN_CHANGED_CELLS
+        int dist_old;
+#endif
+        Cell* obs;
+        int bucket;
+        int dir;
+
+        int pos;
+    };
+
+    static constexpr int BLOCK_BITS = 3;
+    static constexpr int BLOCK_DIM = 1 << BLOCK_BITS;
+    static constexpr int BLOCK_CELLS = BLOCK_DIM * BLOCK_DIM * BLOCK_DIM;
+
+    HashedDistanceMap(
+        double origin_x, double origin_y, double origin_z,
+        double size_x, double size_y, double size_z,
+        double resolution,
+        double max_dist);
+
+    HashedDistanceMap(const HashedDistanceMap& o);
+    HashedDistanceMap(HashedDistanceMap&& o) = default;
+
+    HashedDistanceMap& operator=(const HashedDistanceMap& rhs);
+    HashedDistanceMap& operator=(HashedDistanceMap&& rhs) = default;
+
+    double maxDistance() const;
+
+    double getDistance(double x, double y, double z) const;
+    double getDistance(int x, int y, int z) const;
+
+    /// Return the number of allocated blocks.
+    std::size_t numBlocks() const { return m_blocks.size(); }
+
+    /// \name Required Functions from DistanceMapInterface
+    ///@{
+    DistanceMapInterface* clone() const override;
+
+    void addPointsToMap(const std::vector<Vector3>& points) override;
+    void removePointsFromMap(const std::vector<Vector3>& points) override;
+    void updatePointsInMap(
+        const std::vector<Vector3>& old_points,
+        const std::vector<Vector3>& new_points) override;
+
+    void reset() override;
+
+    bool shiftOrigin(int dx, int dy, int dz) override;
+
+    int numCellsX() const override;
+    int numCellsY() const override;
+    int numCellsZ() const override;
+
+    double getUninitializedDistance() const override;
+
+    double getMetricDistance(double x, double y, double z) const override;
+    double getCellDistance(int x, int y, int z) const override;
+
+    double getMetricSquaredDistance(double x, double y, double z) const override;
+    double getCellSquaredDistance(int x, int y, int z) const override;
+
+    void gridToWorld(
+        int x, int y, int z,
+        double& world_x, double& world_y, double& world_z) const override;
+
+    void worldToGrid(
+        double world_x, double world_y, double world_z,
+        int& x, int& y, int& z) const override;
+
+    bool isCellValid(int x, int y, int z) const override;
+
+    size_t memoryUsage() const override;
+    ///@}
+
+    double resolution() const { return 1.0 / m_inv_res; }
+
+private:
+
+    static constexpr int NO_UPDATE_DIR = dirnum(0, 0, 0);
+
+    struct Block
+    {
+        std::array<Cell, BLOCK_CELLS> cells;
+    };
+
+    // block coordinates, offset to be non-negative, packed into 21 bits each
+    using BlockKey = std::uint64_t;
+
+    static constexpr int KEY_BITS = 21;
+    static constexpr int KEY_BIAS = 1 << (KEY_BITS - 1);
+    static constexpr BlockKey KEY_MASK = (BlockKey(1) << KEY_BITS) - 1;
+
+    struct BlockKeyHash
+    {
+        std::size_t operator()(BlockKey key) const
+        {
+            key ^= key >> 33;
+            key *= 0xff51afd7ed558ccdULL;
+            key ^= key >> 33;
+            return (std::size_t)key;
+        }
+    };
+
+    using BlockTable =
+            std::unordered_map<BlockKey, std::unique_ptr<Block>, BlockKeyHash>;
+
+    // The most recently visited block, to skip the hash table lookup for cells
+    // in the same block. Queries keep one of these on their own stack so that
+    // concurrent queries on the same map do not share any state.
+    struct BlockCursor
+    {
+        BlockKey key = ~BlockKey(0);
+        const Block* block = nullptr;
+    };
+
+    BlockTable m_blocks;
+
+    // released blocks, kept for reuse
+    std::vector<std::unique_ptr<Block>> m_spare_blocks;
+
+    // value of all cells in unallocated blocks
+    Cell m_free_cell;
+
+    // cursor used while modifying the map; reset by every modifier since
+    // blocks may have been released or the map moved since the last one
+    BlockKey m_last_key;
+    Block* m_last_block;
+
+    int m_cell_count_x;
+    int m_cell_count_y;
+    int m_cell_count_z;
+
+    // Cells are addressed internally by their position relative to the
+    // original origin of the map, which is shifted from the current origin by
+    // this many cells
+    int m_offset_x;
+    int m_offset_y;
+    int m_offset_z;
+
+    double m_anchor_x;
+    double m_anchor_y;
+    double m_anchor_z;
+
+    // max propagation distance in world units
+    double m_max_dist;
+    double m_inv_res;
+
+    // max propagation distance in cells
+    int m_dmax_int;
+    int m_dmax_sqrd_int;
+
+    int m_bucket;
+
+    // Direction offsets to each of the 27 neighbors, including (0, 0, 0).
+    // Indexed by a call to dirnum(x, y, z, 0);
+    std::array<Eigen::Vector3i, 27> m_neighbors;
+
+    // Indices of neighbor offsets that must have distance information
+    // propagated to them, grouped by source update direction. See
+    // SparseDistanceMap for the layout.
+    std::array<int, NEIGHBOR_LIST_SIZE> m_indices;
+
+    // Map from a source update direction to a range of m_indices
+    std::array<std::pair<int, int>, NUM_DIRECTIONS> m_neighbor_ranges;
+
+    // Map from a (source, target) update direction pair to the update direction
+    // index
+    std::array<int, NEIGHBOR_LIST_SIZE> m_neighbor_dirs;
+
+    std::vector<double> m_sqrt_table;
+
+    struct bucket_element
+    {
+        Cell* c;
+        int x;
+        int y;
+        int z;
+
+        bucket_element() = default;
+        bucket_element(Cell* c, int x, int y, int z) :
+            c(c), x(x), y(y), z(z)
+        { }
+    };
+
+    typedef std::vector<bucket_element> bucket_type;
+    typedef std::vector<bucket_type> bucket_list;
+    bucket_list m_open;
+
+    struct GridCoord {
+        int x;
+        int y;
+        int z;
+
+        GridCoord() = default;
+        GridCoord(int x, int y, int z) : x(x), y(y), z(z) { }
+    };
+    std::vector<GridCoord> m_rem_stack;
+
+    // blocks containing cells cleared by the last removal, to be checked for
+    // release once the removal has been propagated
+    std::vector<BlockKey> m_rem_blocks;
+
+    double m_error;
+
+    static BlockKey blockKey(int x, int y, int z)
+    {
+        return (((BlockKey)((x >> BLOCK_BITS) + KEY_BIAS) & KEY_MASK) << (2 * KEY_BITS)) |
+                (((BlockKey)((y >> BLOCK_BITS) + KEY_BIAS) & KEY_MASK) << KEY_BITS) |
+                ((BlockKey)((z >> BLOCK_BITS) + KEY_BIAS) & KEY_MASK);
+    }
+
+    // Return the coordinates of the first cell in a block.
+    static Eigen::Vector3i blockOrigin(BlockKey key)
+    {
+        return Eigen::Vector3i(
+                ((int)((key >> (2 * KEY_BITS)) & KEY_MASK) - KEY_BIAS) * BLOCK_DIM,
+                ((int)((key >> KEY_BITS) & KEY_MASK) - KEY_BIAS) * BLOCK_DIM,
+                ((int)(key & KEY_MASK) - KEY_BIAS) * BLOCK_DIM);
+    }
+
+    static int cellIndex(int x, int y, int z)
+    {
+        const int mask = BLOCK_DIM - 1;
+        return ((((z & mask) << BLOCK_BITS) | (y & mask)) << BLOCK_BITS) |
+                (x & mask);
+    }
+
+    // Test whether a cell, addressed relative to the original origin, lies
+    // within the current volume.
+    bool inVolume(int x, int y, int z) const
+    {
+        return x >= m_offset_x && x < m_offset_x + m_cell_count_x &&
+            y >= m_offset_y && y < m_offset_y + m_cell_count_y &&
+            z >= m_offset_z && z < m_offset_z + m_cell_count_z;
+    }
+
+    bool inVolume(const Eigen::Vector3i& p) const
+    {
+        return inVolume(p.x(), p.y(), p.z());
+    }
+
+    const Cell& getCell(int x, int y, int z, BlockCursor& cursor) const;
+    Cell& getCell(int x, int y, int z);
+
+    void releaseBlock(BlockTable::iterator it);
+    void resetCursor();
+    void relinkObstacles();
+    void releaseFreeBlocks();
+    void seedEnteringCells(const Eigen::Vector3i& lo, const Eigen::Vector3i& hi);
+
+    void updateVertex(Cell* c, int cx, int cy, int cz);
+
+    int distance(int nx, int ny, int nz, const Cell& s);
+
+    void lower(Cell* s, int sx, int sy, int sz);
+    void raise(Cell* s, int sx, int sy, int sz);
+    void waveout(Cell* n, int nx, int ny, int nz);
+    void propagate();
+
+    void propagateRemovals();
+    void propagateBorder();
+
+    double getTrueMetricSquaredDistance(double x, double y, double z) const;
+};
+
+} // namespace smpl
+
+#endif
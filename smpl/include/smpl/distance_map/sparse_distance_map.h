@@ -43,6 +43,7 @@
 
 // project includes
 #include <smpl/grid/sparse_grid.h>
+#include <smpl/octree/pool_allocator.h>
 #include <smpl/distance_map/distance_map_interface.h>
 #include <smpl/spatial.h>
 #include "detail/distance_map_common.h"
@@ -91,6 +92,8 @@ public:
 
     bool isCellValid(const Eigen::Vector3i& gp) const;
 
+    void compact();
+
     /// \name Required Functions from DistanceMapInterface
     ///@{
     DistanceMapInterface* clone() const override;
@@ -124,16 +127,20 @@ public:
         int& x, int& y, int& z) const override;
 
     bool isCellValid(int x, int y, int z) const override;
+
+    size_t memoryUsage() const override;
     ///@}
 
+    using CellGrid = SparseGrid<Cell, PoolAllocator<Cell>>;
+
     double resolution() const { return 1.0 / m_inv_res; }
-    auto cells() -> SparseGrid<Cell>& { return m_cells; }
+    auto cells() -> CellGrid& { return m_cells; }
 
 public:
 
     static constexpr int NO_UPDATE_DIR = dirnum(0, 0, 0);
 
-    SparseGrid<Cell> m_cells;
+    CellGrid m_cells;
 
     int m_cell_count_x;
     int m_cell_count_y;
@@ -204,6 +211,8 @@ public:
 
     void updateVertex(Cell* c, int cx, int cy, int cz);
 
+    void relinkObstacles();
+
     /// DistanceMap
     ///@{
     int distance(int nx, int ny, int nz, const Cell& s);
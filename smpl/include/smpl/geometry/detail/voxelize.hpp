@@ -30,6 +30,10 @@
 #ifndef SMPL_VOXELIZE_HPP
 #define SMPL_VOXELIZE_HPP
 
+// standard includes
+#include <algorithm>
+#include <cmath>
+
 #include <smpl/geometry/utils.h>
 
 namespace smpl {
@@ -48,6 +52,26 @@ void VoxelizeTriangle(
     const Vector3& b,
     const Vector3& c,
     VoxelGrid<Discretizer>& vg)
+{
+    const GridCoord min = vg.memoryToGrid(MemoryCoord(0, 0, 0));
+    const GridCoord max = vg.memoryToGrid(
+            MemoryCoord(vg.sizeX() - 1, vg.sizeY() - 1, vg.sizeZ() - 1));
+    VoxelizeTriangle(a, b, c, min, max, vg);
+}
+
+/// \brief Voxelize the part of a triangle that lies within the grid cells
+///     [min, max]
+///
+/// Voxels outside of [min, max] are neither read nor written, so disjoint
+/// ranges of the same grid may be voxelized concurrently.
+template <typename Discretizer>
+void VoxelizeTriangle(
+    const Vector3& a,
+    const Vector3& b,
+    const Vector3& c,
+    const GridCoord& min,
+    const GridCoord& max,
+    VoxelGrid<Discretizer>& vg)
 {
     Vector3 p1 = a;
     Vector3 p2 = b;
@@ -95,6 +119,10 @@ void VoxelizeTriangle(
     // get the distance from the origin for the triangle plane
     double d = -n.dot(p1);
 
+    // voxels farther than this from the triangle plane can be filled by
+    // neither a vertex, an edge, nor the interior of the triangle
+    const double plane_thresh = std::max(rc, t);
+
     // normal to the edge p2 - p1 pointing inwards
     Vector3 e1 = -u.cross(n);
     e1.normalize();
@@ -112,18 +140,20 @@ void VoxelizeTriangle(
     double d2 = -e2.dot(p2);
     double d3 = -e3.dot(p3);
 
-    Vector3 mintri;
-    Vector3 maxtri;
-    std::vector<Vector3> tri_verts(3);
-    tri_verts[0] = a;
-    tri_verts[1] = b;
-    tri_verts[2] = c;
-    ComputeAxisAlignedBoundingBox(tri_verts, mintri, maxtri);
+    const Vector3 mintri = a.cwiseMin(b).cwiseMin(c);
+    const Vector3 maxtri = a.cwiseMax(b).cwiseMax(c);
 
     const WorldCoord minwc(mintri.x(), mintri.y(), mintri.z());
     const WorldCoord maxwc(maxtri.x(), maxtri.y(), maxtri.z());
-    const GridCoord mingc = vg.worldToGrid(minwc);
-    const GridCoord maxgc = vg.worldToGrid(maxwc);
+    GridCoord mingc = vg.worldToGrid(minwc);
+    GridCoord maxgc = vg.worldToGrid(maxwc);
+
+    mingc.x = std::max(mingc.x, min.x);
+    mingc.y = std::max(mingc.y, min.y);
+    mingc.z = std::max(mingc.z, min.z);
+    maxgc.x = std::min(maxgc.x, max.x);
+    maxgc.y = std::min(maxgc.y, max.y);
+    maxgc.z = std::min(maxgc.z, max.z);
 
     // consider all voxels that this triangle can voxelize
     for (int gx = mingc.x; gx <= maxgc.x; gx++) {
@@ -136,11 +166,14 @@ void VoxelizeTriangle(
 
         const WorldCoord wc = vg.gridToWorld(gc);
 
-        // TODO: shortcut based off of distance to triangle plane?
+        const Vector3 voxel_p(wc.x, wc.y, wc.z);
+
+        if (std::fabs(n.dot(voxel_p) + d) > plane_thresh) {
+            continue;
+        }
 
         // check if the voxel point is in the plane of the triangle and
         // within the edges
-        const Vector3 voxel_p(wc.x, wc.y, wc.z);
 
         Vector3 dx1 = voxel_p - p1;
         Vector3 dx2 = voxel_p - p2;
@@ -162,8 +195,6 @@ void VoxelizeTriangle(
             vg[gc] = 1;
         }
         else {
-            double ddd = n.dot(voxel_p) + (d + t);
-            double ddd1 = n.dot(voxel_p) + (d - t);
             if (// then check for...
                 // ...inside triangle thickness
                 utils::sign(n.dot(voxel_p) + (d + t)) !=
@@ -251,6 +251,15 @@ void VoxelizeTriangle(
     const Vector3& c,
     VoxelGrid<Discretizer>& vg);
 
+template <typename Discretizer>
+void VoxelizeTriangle(
+    const Vector3& a,
+    const Vector3& b,
+    const Vector3& c,
+    const GridCoord& min,
+    const GridCoord& max,
+    VoxelGrid<Discretizer>& vg);
+
 } // namespace geometry
 } // namespace smpl
 
@@ -33,6 +33,7 @@
 #define SMPL_EXPERIENCE_GRAPH_H
 
 // standard includes
+#include <cstdint>
 #include <cstdlib>
 #include <vector>
 
@@ -157,6 +158,15 @@ struct ExperienceGraph
     // removal
     std::vector<std::ptrdiff_t> m_shift;
 
+    std::uint64_t m_version = next_version();
+
+    static auto next_version() -> std::uint64_t;
+
+    /// Return a value that changes whenever nodes or edges are inserted or
+    /// erased. No two graphs are assigned the same value, except for copies
+    /// of a graph that have not been modified since.
+    auto version() const -> std::uint64_t { return m_version; }
+
     auto nodes() const -> std::pair<node_iterator, node_iterator>;
     auto edges() const -> std::pair<edge_iterator, edge_iterator>;
 
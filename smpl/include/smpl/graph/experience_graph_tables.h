@@ -0,0 +1,79 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2018, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#ifndef SMPL_EXPERIENCE_GRAPH_TABLES_H
+#define SMPL_EXPERIENCE_GRAPH_TABLES_H
+
+// standard includes
+#include <cstdint>
+#include <vector>
+
+// project includes
+#include <smpl/graph/experience_graph.h>
+
+namespace smpl {
+
+/// Lookup tables derived from the contents of an experience graph alone,
+/// independent of the goal, so that they may be reused across goals until the
+/// graph changes.
+struct ExperienceGraphTables
+{
+    /// version of the graph the tables were last built from; versions are
+    /// unique across graphs, so 0 never matches
+    std::uint64_t graph_version = 0;
+
+    /// connected component of each experience graph node; components are
+    /// numbered in order of their lowest node id
+    std::vector<int> component_ids;
+    int component_count = 0;
+};
+
+/// Compute the connected components of an experience graph, distributing the
+/// edges across the available hardware threads. Return the number of
+/// components.
+int ComputeConnectedComponents(
+    const ExperienceGraph& eg,
+    std::vector<int>& component_ids);
+
+/// Build the tables for an experience graph.
+void BuildExperienceGraphTables(
+    const ExperienceGraph& eg,
+    ExperienceGraphTables& tables);
+
+/// Bring the tables up to date with an experience graph. The tables are only
+/// rebuilt if the graph has changed since they were last built.
+void UpdateExperienceGraphTables(
+    const ExperienceGraph& eg,
+    ExperienceGraphTables& tables);
+
+} // namespace smpl
+
+#endif
@@ -35,6 +35,8 @@
 
 // standard includes
 #include <time.h>
+#include <cstdint>
+#include <deque>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -47,6 +49,7 @@
 #include <smpl/angles.h>
 #include <smpl/time.h>
 #include <smpl/collision_checker.h>
+#include <smpl/memory_usage.h>
 #include <smpl/occupancy_grid.h>
 #include <smpl/planning_params.h>
 #include <smpl/robot_model.h>
@@ -92,7 +95,8 @@ namespace smpl {
 class ManipLattice :
     public RobotPlanningSpace,
     public PoseProjectionExtension,
-    public ExtractRobotStateExtension
+    public ExtractRobotStateExtension,
+    public MemoryUsageExtension
 {
 public:
 
@@ -117,6 +121,9 @@ public:
 
     void clearStates();
 
+    void setLazyActionCacheCapacity(size_t capacity);
+    auto lazyActionCacheCapacity() const -> size_t { return m_lazy_action_capacity; }
+
     /// \name Reimplemented Public Functions from RobotPlanningSpace
     ///@{
     void GetLazySuccs(
@@ -148,6 +155,12 @@ public:
         std::vector<RobotState>& path) override;
     ///@}
 
+    /// \name Required Public Functions from MemoryUsageExtension
+    ///@{
+    size_t memoryUsage() const override;
+    void releaseCaches() override;
+    ///@}
+
     /// \name Required Public Functions from Extension
     ///@{
     virtual Extension* getExtension(size_t class_code) override;
@@ -189,6 +202,11 @@ protected:
         bool bState2IsGoal) const;
 
     bool checkAction(const RobotState& state, const Action& action);
+    bool checkActionJointLimits(const Action& action);
+    void checkActions(
+        const RobotState& state,
+        const std::vector<Action>& actions,
+        std::vector<bool>& valid);
 
     bool isGoal(const RobotState& state);
 
@@ -198,6 +216,7 @@ protected:
 private:
 
     ForwardKinematicsInterface* m_fk_iface = nullptr;
+    BatchCollisionCheckExtension* m_batch_checker = nullptr;
     ActionSpace* m_actions = nullptr;
 
     // cached from robot model
@@ -209,6 +228,23 @@ private:
     std::vector<int> m_coord_vals;
     std::vector<double> m_coord_deltas;
 
+    // discretization of a variable, such that position = offset + delta *
+    // coordinate, stored contiguously for conversions between states and
+    // coordinates
+    struct VariableDiscretization
+    {
+        double offset;
+        double delta;
+        double round_neg;   // rounding bias below the offset
+        int wrap;           // number of coordinates of continuous variables
+        int bits;           // width of the coordinate in a packed key
+    };
+
+    std::vector<VariableDiscretization> m_var_disc;
+
+    // whether coordinates within the limits can be packed into a single key
+    bool m_pack_coords = false;
+
     int m_goal_state_id = -1;
     int m_start_state_id = -1;
 
@@ -218,9 +254,39 @@ private:
     typedef PointerValueEqual<StateKey> StateEqual;
     hash_map<StateKey*, int, StateHash, StateEqual> m_state_to_id;
 
+    // maps from packed coords to stateID
+    hash_map<std::uint64_t, int> m_packed_state_to_id;
+
     // maps from stateID to coords
     std::vector<ManipLatticeState*> m_states;
 
+    // an action generated by GetLazySuccs, and the id of the state it reaches
+    struct LazyAction
+    {
+        int succ_id;
+        Action action;
+    };
+
+    // the actions recorded for a lazy edge, and the expansion that recorded
+    // them
+    struct LazyEdge
+    {
+        std::uint64_t generation = 0;
+        std::vector<LazyAction> actions;
+    };
+
+    // actions generated by GetLazySuccs for each lazy edge, keyed by the
+    // parent and child state ids, to be checked by GetTrueCost without
+    // regenerating every action from the parent. At most
+    // m_lazy_action_capacity edges are kept, evicting the oldest first. The
+    // order holds the key and generation of each recorded edge; entries whose
+    // generation no longer matches the edge, because the edge was consumed or
+    // recorded again, are skipped.
+    hash_map<std::uint64_t, LazyEdge> m_lazy_actions;
+    std::deque<std::pair<std::uint64_t, std::uint64_t>> m_lazy_action_order;
+    std::uint64_t m_lazy_action_generation = 0;
+    size_t m_lazy_action_capacity = 32768;
+
     std::string m_viz_frame_id;
 
     bool setGoalPose(const GoalConstraint& goal);
@@ -230,6 +296,11 @@ private:
 
     void startNewSearch();
 
+    bool packCoord(const RobotCoord& coord, std::uint64_t& key) const;
+
+    void clearLazyActions();
+    void evictLazyActions();
+
     /// \name planning
     ///@{
     ///@}
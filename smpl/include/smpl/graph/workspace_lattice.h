@@ -35,6 +35,7 @@
 
 // standard includes
 #include <chrono>
+#include <cstdint>
 #include <vector>
 
 // system includes
@@ -54,6 +55,19 @@ namespace smpl {
 
 struct WorkspaceLatticeActionSpace;
 
+/// Counters for the inverse kinematics solved while checking actions. The IK
+/// solver does not report its iteration count, so each memo hit counts as one
+/// solve saved.
+struct WorkspaceLatticeIKStats
+{
+    std::uint64_t queries = 0;      // waypoints that required an IK solution
+    std::uint64_t memo_hits = 0;    // queries answered by the IK memo
+    std::uint64_t solves = 0;       // queries passed to the IK solver
+    std::uint64_t warm_starts = 0;  // solves seeded by the previous waypoint
+
+    double memoHitRate() const;
+};
+
 /// \class Discrete state lattice representation representing a robot as the
 ///     pose of one of its links and all redundant joint variables
 struct WorkspaceLattice :
@@ -83,11 +97,56 @@ struct WorkspaceLattice :
 
     std::string m_viz_frame_id;
 
+    // IK solutions of action waypoints, keyed by the discrete coordinate of
+    // the waypoint. The waypoint itself is stored to reject waypoints that fall
+    // in the same cell but do not have the same pose.
+    struct IKMemoEntry
+    {
+        WorkspaceState waypoint;
+        RobotState solution;
+    };
+    hash_map<WorkspaceCoord, IKMemoEntry, VectorHash<int>> m_ik_memo;
+    bool m_ik_memo_enabled = false;
+    bool m_ik_warm_start_enabled = false;
+    WorkspaceLatticeIKStats m_ik_stats;
+
+    // scratch buffers for checkAction
+    std::vector<RobotState> m_wptraj;
+    RobotState m_ik_seed;
+    WorkspaceCoord m_ik_coord;
+
     ~WorkspaceLattice();
 
     void setVisualizationFrameId(const std::string& frame_id);
     auto visualizationFrameId() const -> const std::string&;
 
+    /// \name IK Memo and Warm Start
+    ///@{
+
+    /// Remember the IK solution of each action waypoint, so that a waypoint
+    /// reached by several actions is solved once. Only solutions are
+    /// remembered, since a failed solve may succeed from another seed. A
+    /// remembered solution is returned regardless of the seed of later
+    /// queries, so with a seed-dependent solver the intermediate states of an
+    /// action may differ from those a fresh solve would produce.
+    void setIKMemoEnabled(bool enabled);
+    bool ikMemoEnabled() const { return m_ik_memo_enabled; }
+
+    /// Seed the IK of each action waypoint after the first with the solution
+    /// to the previous waypoint, rather than with the source state. The seed
+    /// is closer to the waypoint, but with a seed-dependent solver the
+    /// intermediate states of an action may differ from those solved from the
+    /// source state.
+    void setIKWarmStartEnabled(bool enabled) { m_ik_warm_start_enabled = enabled; }
+    bool ikWarmStartEnabled() const { return m_ik_warm_start_enabled; }
+
+    /// Clear the IK memo and reset the IK counters. Called whenever a new start
+    /// state is set.
+    void clearIKMemo();
+
+    auto ikStats() const -> const WorkspaceLatticeIKStats& { return m_ik_stats; }
+    ///@}
+
     /// \name Reimplemented Public Functions from WorkspaceLatticeBase
     ///@{
     bool init(
@@ -166,6 +225,12 @@ struct WorkspaceLattice :
         const WorkspaceAction& action,
         RobotState* final_rstate = NULL);
 
+    bool computeWaypointIK(
+        const WorkspaceState& waypoint,
+        const RobotState& seed,
+        bool warm_start,
+        RobotState& solution);
+
     int computeCost(
         const WorkspaceLatticeState& src,
         const WorkspaceLatticeState& dst);
@@ -243,6 +243,14 @@ void SparseGrid<T, Allocator>::prune(UnaryPredicate p)
     prune(m_tree.root(), p);
 }
 
+/// Rebuild the underlying octree in breadth-first order. See OcTree::compact.
+/// Invalidates all pointers and references to cells.
+template <class T, class Allocator>
+void SparseGrid<T, Allocator>::compact()
+{
+    m_tree.compact();
+}
+
 template <class T, class Allocator>
 void
 SparseGrid<T, Allocator>::resize(
@@ -68,6 +68,11 @@ namespace smpl {
 /// set() to skip automatic pruning of nodes. The underlying octree may then be
 /// explicitly pruned by calling the prune() function, which will prune all
 /// nodes where applicable for maximum compression.
+///
+/// Once a grid has been built, compact() may be called to lay out the
+/// underlying octree contiguously in breadth-first order. This is most useful
+/// with PoolAllocator, which also avoids a heap allocation on every node
+/// expansion.
 template <class T, class Allocator = std::allocator<T>>
 class SparseGrid
 {
@@ -133,6 +138,8 @@ public:
     template <class UnaryPredicate>
     void prune(UnaryPredicate p);
 
+    void compact();
+
     void resize(size_type size_x, size_type size_y, size_type size_z);
     void resize(size_type size_x, size_type size_y, size_type size_z, const T& value);
     ///@}
@@ -0,0 +1,254 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2018, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#ifndef SMPL_INDEX_HEAP_HPP
+#define SMPL_INDEX_HEAP_HPP
+
+#include "../index_heap.h"
+
+#include <assert.h>
+
+namespace smpl {
+
+template <class Key, class Position, class Compare>
+index_heap<Key, Position, Compare>::index_heap(
+    const position& pos,
+    const compare& comp)
+:
+    m_data(1),
+    m_pos(pos),
+    m_comp(comp)
+{
+}
+
+template <class Key, class Position, class Compare>
+int index_heap<Key, Position, Compare>::min() const
+{
+    assert(m_data.size() > 1);
+    return m_data[1].index;
+}
+
+template <class Key, class Position, class Compare>
+const Key& index_heap<Key, Position, Compare>::min_key() const
+{
+    assert(m_data.size() > 1);
+    return m_data[1].key;
+}
+
+template <class Key, class Position, class Compare>
+typename index_heap<Key, Position, Compare>::iterator
+index_heap<Key, Position, Compare>::begin()
+{
+    return m_data.begin() + 1;
+}
+
+template <class Key, class Position, class Compare>
+typename index_heap<Key, Position, Compare>::iterator
+index_heap<Key, Position, Compare>::end()
+{
+    return m_data.end();
+}
+
+template <class Key, class Position, class Compare>
+typename index_heap<Key, Position, Compare>::const_iterator
+index_heap<Key, Position, Compare>::begin() const
+{
+    return m_data.begin() + 1;
+}
+
+template <class Key, class Position, class Compare>
+typename index_heap<Key, Position, Compare>::const_iterator
+index_heap<Key, Position, Compare>::end() const
+{
+    return m_data.end();
+}
+
+template <class Key, class Position, class Compare>
+bool index_heap<Key, Position, Compare>::empty() const
+{
+    return m_data.size() == 1;
+}
+
+template <class Key, class Position, class Compare>
+typename index_heap<Key, Position, Compare>::size_type
+index_heap<Key, Position, Compare>::size() const
+{
+    return m_data.size() - 1;
+}
+
+template <class Key, class Position, class Compare>
+void index_heap<Key, Position, Compare>::reserve(size_type new_cap)
+{
+    m_data.reserve(new_cap + 1);
+}
+
+template <class Key, class Position, class Compare>
+void index_heap<Key, Position, Compare>::clear()
+{
+    for (size_type i = 1; i < m_data.size(); ++i) {
+        m_pos(m_data[i].index) = 0;
+    }
+    m_data.resize(1);
+}
+
+template <class Key, class Position, class Compare>
+void index_heap<Key, Position, Compare>::push(int e, const Key& key)
+{
+    m_pos(e) = (std::uint32_t)m_data.size();
+    m_data.push_back(element{ key, e });
+    percolate_up(m_data.size() - 1);
+}
+
+template <class Key, class Position, class Compare>
+void index_heap<Key, Position, Compare>::pop()
+{
+    assert(!empty());
+    m_pos(m_data[1].index) = 0;
+    m_data[1] = m_data.back();
+    m_data.pop_back();
+    percolate_down(1);
+}
+
+template <class Key, class Position, class Compare>
+bool index_heap<Key, Position, Compare>::contains(int e) const
+{
+    return m_pos(e) != 0;
+}
+
+template <class Key, class Position, class Compare>
+void index_heap<Key, Position, Compare>::update(int e, const Key& key)
+{
+    assert(contains(e));
+    erase(e);
+    push(e, key);
+}
+
+template <class Key, class Position, class Compare>
+void index_heap<Key, Position, Compare>::increase(int e, const Key& key)
+{
+    assert(contains(e));
+    size_type pos = m_pos(e);
+    m_data[pos].key = key;
+    percolate_down(pos);
+}
+
+template <class Key, class Position, class Compare>
+void index_heap<Key, Position, Compare>::decrease(int e, const Key& key)
+{
+    assert(contains(e));
+    size_type pos = m_pos(e);
+    m_data[pos].key = key;
+    percolate_up(pos);
+}
+
+template <class Key, class Position, class Compare>
+void index_heap<Key, Position, Compare>::erase(int e)
+{
+    assert(contains(e));
+    size_type pos = m_pos(e);
+    m_data[pos] = m_data.back();
+    m_pos(m_data[pos].index) = (std::uint32_t)pos;
+    m_pos(e) = 0;
+    m_data.pop_back();
+    if (pos >= m_data.size()) {
+        return;
+    }
+
+    // the last element may belong above or below the erased element's slot
+    if (pos > 1 && m_comp(m_data[pos].key, m_data[pos >> 1].key)) {
+        percolate_up(pos);
+    } else {
+        percolate_down(pos);
+    }
+}
+
+template <class Key, class Position, class Compare>
+void index_heap<Key, Position, Compare>::make()
+{
+    for (auto i = (m_data.size() - 1) >> 1; i >= 1; --i) {
+        percolate_down(i);
+    }
+}
+
+template <class Key, class Position, class Compare>
+inline
+void index_heap<Key, Position, Compare>::percolate_down(size_type pivot)
+{
+    if (pivot >= m_data.size()) {
+        return;
+    }
+
+    size_type left = pivot << 1;
+    size_type right = left + 1;
+
+    element tmp = m_data[pivot];
+    while (left < m_data.size()) {
+        size_type s = right;
+        if (right >= m_data.size() || m_comp(m_data[left].key, m_data[right].key)) {
+            s = left;
+        }
+
+        if (m_comp(m_data[s].key, tmp.key)) {
+            m_data[pivot] = m_data[s];
+            m_pos(m_data[pivot].index) = (std::uint32_t)pivot;
+            pivot = s;
+        } else {
+            break;
+        }
+
+        left = pivot << 1;
+        right = left + 1;
+    }
+    m_data[pivot] = tmp;
+    m_pos(tmp.index) = (std::uint32_t)pivot;
+}
+
+template <class Key, class Position, class Compare>
+inline
+void index_heap<Key, Position, Compare>::percolate_up(size_type pivot)
+{
+    element tmp = m_data[pivot];
+    while (pivot != 1) {
+        size_type p = pivot >> 1;
+        if (m_comp(m_data[p].key, tmp.key)) {
+            break;
+        }
+        m_data[pivot] = m_data[p];
+        m_pos(m_data[pivot].index) = (std::uint32_t)pivot;
+        pivot = p;
+    }
+    m_data[pivot] = tmp;
+    m_pos(tmp.index) = (std::uint32_t)pivot;
+}
+
+} // namespace smpl
+
+#endif
@@ -0,0 +1,117 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2018, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#ifndef SMPL_INDEX_HEAP_H
+#define SMPL_INDEX_HEAP_H
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace smpl {
+
+/// Provides a binary heap of integer indices into an array of elements owned
+/// elsewhere, for elements that are stored by value and may move when their
+/// array grows. Each index is stored in the heap together with its priority
+/// key, so that reordering the heap touches only the heap itself.
+///
+/// The heap position of each element is stored with the element and accessed
+/// through the \p Position function object, which maps an index to a
+/// reference to its std::uint32_t position; a position of 0 indicates that the
+/// element is not in the heap. Elements must start with a position of 0.
+///
+/// Apart from the explicit keys, the heap is identical to intrusive_heap, and
+/// orders elements with equal keys in the same way.
+template <class Key, class Position, class Compare = std::less<Key>>
+class index_heap
+{
+public:
+
+    struct element
+    {
+        Key key;
+        int index;
+    };
+
+    typedef Compare compare;
+    typedef Position position;
+
+    typedef std::vector<element> container_type;
+    typedef typename container_type::size_type size_type;
+
+    typedef typename container_type::iterator iterator;
+    typedef typename container_type::const_iterator const_iterator;
+
+    index_heap(const position& pos = position(), const compare& comp = compare());
+
+    index_heap(const index_heap&) = delete;
+    index_heap& operator=(const index_heap&) = delete;
+
+    int min() const;
+    const Key& min_key() const;
+
+    /// Iterators over the elements of the heap. Keys may be modified through
+    /// iterator, after which the heap must be reordered by make().
+    iterator begin();
+    iterator end();
+    const_iterator begin() const;
+    const_iterator end() const;
+
+    bool empty() const;
+    size_type size() const;
+    void reserve(size_type new_cap);
+
+    void clear();
+    void push(int e, const Key& key);
+    void pop();
+    bool contains(int e) const;
+    void update(int e, const Key& key);
+    void increase(int e, const Key& key);
+    void decrease(int e, const Key& key);
+    void erase(int e);
+
+    void make();
+
+private:
+
+    container_type m_data;
+    Position m_pos;
+    Compare m_comp;
+
+    void percolate_down(size_type pivot);
+    void percolate_up(size_type pivot);
+};
+
+} // namespace smpl
+
+#include "detail/index_heap.hpp"
+
+#endif
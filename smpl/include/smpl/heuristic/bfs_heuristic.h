@@ -40,10 +40,11 @@
 #include <smpl/bfs3d/bfs3d.h>
 #include <smpl/debug/marker.h>
 #include <smpl/heuristic/robot_heuristic.h>
+#include <smpl/memory_usage.h>
 
 namespace smpl {
 
-class BfsHeuristic : public RobotHeuristic
+class BfsHeuristic : public RobotHeuristic, public MemoryUsageExtension
 {
 public:
 
@@ -67,6 +68,11 @@ public:
     double getMetricGoalDistance(double x, double y, double z) override;
     ///@}
 
+    /// \name Required Public Functions from MemoryUsageExtension
+    ///@{
+    size_t memoryUsage() const override;
+    ///@}
+
     /// \name Required Public Functions from Extension
     ///@{
     Extension* getExtension(size_t class_code) override;
@@ -74,9 +80,18 @@ public:
 
     /// \name Reimplemented Public Functions from RobotPlanningSpaceObserver
     ///@{
+    void updateStart(const RobotState& state) override;
     void updateGoal(const GoalConstraint& goal) override;
     ///@}
 
+    /// \name Reimplemented Public Functions from RobotHeuristic
+    ///@{
+
+    /// Serial, since states are projected through the planning space's
+    /// shared forward kinematics; see concurrentGoalHeuristics().
+    void GetGoalHeuristics(const int* state_ids, size_t count, int* values) override;
+    ///@}
+
     /// \name Required Public Functions from Heuristic
     ///@{
     int GetGoalHeuristic(int state_id) override;
@@ -91,6 +106,11 @@ private:
     std::unique_ptr<BFS_3D> m_bfs;
     PointProjectionExtension* m_pp = nullptr;
 
+    // distances to the start cell, computed on the first request for a start
+    // heuristic after the start changes
+    std::unique_ptr<BFS_3D> m_start_bfs;
+    bool m_start_bfs_valid = false;
+
     double m_inflation_radius = 0.0;
     int m_cost_per_cell = 1;
 
@@ -102,7 +122,22 @@ private:
     };
     std::vector<CellCoord> m_goal_cells;
 
+    // scratch space for batched heuristic computations
+    std::vector<Vector3> m_batch_points;
+    std::vector<char> m_batch_projected;
+
+    // origin of the grid when the walls were last synced, to detect when the
+    // grid has been moved
+    Vector3 m_sync_origin = Vector3::Zero();
+
+    // last goal, to search from again after the grid moves
+    GoalConstraint m_goal;
+    bool m_has_goal = false;
+
     void syncGridAndBfs();
+    void setWalls(BFS_3D& bfs) const;
+    bool runStartBfs();
+    bool gridMoved() const;
     int getBfsCostToGoal(const BFS_3D& bfs, int x, int y, int z) const;
 };
 
@@ -38,17 +38,20 @@
 // project includes
 #include <smpl/debug/marker.h>
 #include <smpl/graph/experience_graph_extension.h>
+#include <smpl/graph/experience_graph_tables.h>
 #include <smpl/grid/grid.h>
 #include <smpl/heap/intrusive_heap.h>
 #include <smpl/heuristic/egraph_heuristic.h>
 #include <smpl/heuristic/robot_heuristic.h>
+#include <smpl/memory_usage.h>
 #include <smpl/occupancy_grid.h>
 
 namespace smpl {
 
 class DijkstraEgraphHeuristic3D :
     public RobotHeuristic,
-    public ExperienceGraphHeuristicExtension
+    public ExperienceGraphHeuristicExtension,
+    public MemoryUsageExtension
 {
 public:
 
@@ -62,6 +65,14 @@ public:
     double inflationRadius() const { return m_inflation_radius; }
     void setInflationRadius(double radius);
 
+    /// Set the number of threads used to compute distances when the goal
+    /// changes. With more than one thread, distances to every cell are
+    /// computed up front by a parallel delta-stepping search; with one thread,
+    /// distances are computed lazily as they are requested. The default is one
+    /// thread; 0 uses one thread per hardware thread.
+    int threadCount() const { return m_thread_count; }
+    void setThreadCount(int count);
+
     auto getWallsVisualization() -> visual::Marker;
     auto getValuesVisualization() -> visual::Marker;
 
@@ -82,6 +93,12 @@ public:
     double getMetricGoalDistance(double x, double y, double z) override;
     ///@}
 
+    /// \name Required Public Functions from MemoryUsageExtension
+    ///@{
+    size_t memoryUsage() const override;
+    void releaseCaches() override;
+    ///@}
+
     /// \name Required Public Functions from Extension
     ///@{
     Extension* getExtension(size_t class_code) override;
@@ -126,9 +143,14 @@ private:
 
     double m_eg_eps = 1.0;
     double m_inflation_radius = 0.0;
+    int m_thread_count = 1;
 
     intrusive_heap<Cell, CellCompare> m_open;
 
+    // last distance each cell's edges were relaxed with, during the parallel
+    // search
+    std::vector<int> m_relaxed_dist;
+
     PointProjectionExtension* m_pp = nullptr;
     ExperienceGraphExtension* m_eg = nullptr;
 
@@ -145,7 +167,7 @@ private:
     std::vector<Eigen::Vector3i> m_projected_nodes;
 
     // map from experience graph nodes to their component ids
-    std::vector<int> m_component_ids;
+    ExperienceGraphTables m_tables;
     std::vector<std::vector<ExperienceGraph::node_id>> m_shortcut_nodes;
 
     struct HeuristicNode
@@ -159,6 +181,7 @@ private:
 
     void projectExperienceGraph();
     int getGoalHeuristic(const Eigen::Vector3i& dp);
+    void computeDistancesParallel(const Eigen::Vector3i& dgp, size_t thread_count);
 
     void syncGridAndDijkstra();
 };
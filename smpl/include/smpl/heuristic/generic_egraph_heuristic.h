@@ -32,17 +32,23 @@
 #ifndef SMPL_GENERIC_EGRAPH_HEURISTIC_H
 #define SMPL_GENERIC_EGRAPH_HEURISTIC_H
 
+// standard includes
+#include <vector>
+
 // project includes
 #include <smpl/graph/experience_graph_extension.h>
+#include <smpl/graph/experience_graph_tables.h>
 #include <smpl/heap/intrusive_heap.h>
 #include <smpl/heuristic/robot_heuristic.h>
 #include <smpl/heuristic/egraph_heuristic.h>
+#include <smpl/memory_usage.h>
 
 namespace smpl {
 
 class GenericEgraphHeuristic :
     public RobotHeuristic,
-    public ExperienceGraphHeuristicExtension
+    public ExperienceGraphHeuristicExtension,
+    public MemoryUsageExtension
 {
 public:
 
@@ -63,6 +69,11 @@ public:
     double getMetricGoalDistance(double x, double y, double z) override;
     ///@}
 
+    /// \name MemoryUsageExtension Interface
+    ///@{
+    size_t memoryUsage() const override;
+    ///@}
+
     /// \name Extension Interface
     ///@{
     Extension* getExtension(size_t class_code) override;
@@ -92,9 +103,13 @@ private:
 
     double m_eg_eps = 1.0;
 
-    std::vector<int> m_component_ids;
+    ExperienceGraphTables m_tables;
     std::vector<std::vector<ExperienceGraph::node_id>> m_shortcut_nodes;
 
+    // goal heuristics of experience graph nodes
+    std::vector<int> m_node_state_ids;
+    std::vector<int> m_node_h;
+
     struct HeuristicNode : public heap_element
     {
         int dist;
@@ -113,6 +128,8 @@ private:
 
     std::vector<HeuristicNode> m_h_nodes;
     intrusive_heap<HeuristicNode, NodeCompare> m_open;
+
+    void computeNodeHeuristics();
 };
 
 } // namespace smpl
@@ -76,6 +76,7 @@ public:
 
     /// \name Reimplemented Public Functions from RobotPlanningSpaceObserver
     ///@{
+    void updateStart(const RobotState& state) override;
     void updateGoal(const GoalConstraint& goal) override;
     ///@}
 
@@ -104,7 +105,16 @@ private:
 
     int getGoalHeuristic(int state_id, bool use_ee) const;
 
+    // origin of the grid when the walls were last synced, to detect when the
+    // grid has been moved
+    Vector3 m_sync_origin = Vector3::Zero();
+
+    // last goal, to search from again after the grid moves
+    GoalConstraint m_goal;
+    bool m_has_goal = false;
+
     void syncGridAndBfs();
+    bool gridMoved() const;
     int getBfsCostToGoal(const BFS_3D& bfs, int x, int y, int z) const;
 
     inline
@@ -33,6 +33,7 @@
 #define SMPL_ROBOT_HEURISTIC_H
 
 // standard includes
+#include <stddef.h>
 #include <stdint.h>
 #include <limits>
 
@@ -75,6 +76,29 @@ public:
     virtual void updateStart(const RobotState& state) { }
     virtual void updateGoal(const GoalConstraint& goal) { }
 
+    /// \brief Compute the goal heuristic for a batch of states.
+    ///
+    /// Equivalent to calling GetGoalHeuristic() for each state. The default
+    /// implementation does exactly that; derived heuristics may override this
+    /// to hoist per-call work out of the loop.
+    virtual void GetGoalHeuristics(
+        const int* state_ids,
+        size_t count,
+        int* values);
+
+    /// \brief Return whether GetGoalHeuristics() may be called concurrently
+    ///     on disjoint batches.
+    ///
+    /// This holds only if computing a heuristic value modifies neither the
+    /// heuristic nor the planning space, including any shared kinematics.
+    ///
+    /// Of the heuristics in smpl, only ZeroHeuristic and JointDistHeuristic
+    /// allow it, and their per-state cost is trivial. Heuristics that project
+    /// states through forward kinematics, such as BfsHeuristic, are computed
+    /// serially, since the robot models do not support concurrent FK. No
+    /// costly heuristic is yet computed in parallel.
+    virtual bool concurrentGoalHeuristics() const { return false; }
+
     /// \name Restate Required Public Functions from Heuristic
     ///@{
     virtual int GetGoalHeuristic(int state_id) = 0;
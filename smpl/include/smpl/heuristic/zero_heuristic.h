@@ -49,6 +49,12 @@ public:
     double getMetricStartDistance(double x, double y, double z) override;
     ///@}
 
+    /// \name Reimplemented Functions from RobotHeuristic
+    ///@{
+    void GetGoalHeuristics(const int* state_ids, size_t count, int* values) override;
+    bool concurrentGoalHeuristics() const override { return true; }
+    ///@}
+
     /// \name Required Functions from Extension
     ///@{
     Extension* getExtension(size_t class_code) override;
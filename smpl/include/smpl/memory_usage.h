@@ -0,0 +1,79 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2018, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#ifndef SMPL_MEMORY_USAGE_H
+#define SMPL_MEMORY_USAGE_H
+
+// standard includes
+#include <cstddef>
+#include <vector>
+
+// project includes
+#include <smpl/extension.h>
+
+namespace smpl {
+
+/// Extension for planner components that can report how much memory they
+/// hold, and that may hold caches that can be rebuilt on demand.
+class MemoryUsageExtension : public virtual Extension
+{
+public:
+
+    virtual ~MemoryUsageExtension() { }
+
+    /// Return an estimate of the number of bytes held by the component.
+    virtual size_t memoryUsage() const = 0;
+
+    /// Release memory held by caches that the component rebuilds on demand.
+    /// Must not be called during a search.
+    virtual void releaseCaches() { }
+};
+
+/// Return the number of bytes allocated for the elements of a vector.
+template <class T, class Allocator>
+size_t VectorMemoryUsage(const std::vector<T, Allocator>& v)
+{
+    return v.capacity() * sizeof(T);
+}
+
+/// Return an estimate of the number of bytes held by a node-based hash map:
+/// one pointer per bucket, and per element the element itself and a pointer
+/// to the next node.
+template <class HashMap>
+size_t HashMapMemoryUsage(const HashMap& map)
+{
+    return map.bucket_count() * sizeof(void*) +
+            map.size() * (sizeof(typename HashMap::value_type) + sizeof(void*));
+}
+
+} // namespace smpl
+
+#endif
@@ -35,6 +35,8 @@
 
 // standard includes
 #include <algorithm>
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -45,6 +47,7 @@
 #include <smpl/forward.h>
 #include <smpl/debug/marker.h>
 #include <smpl/distance_map/distance_map_interface.h>
+#include <smpl/distance_map/distance_pyramid.h>
 #include <smpl/spatial.h>
 
 namespace smpl {
@@ -74,6 +77,9 @@ public:
     auto getDistanceField() const -> const std::shared_ptr<DistanceMapInterface>&
     { return m_grid; }
 
+    /// Return an estimate of the memory, in bytes, held by the distance map.
+    size_t memoryUsage() const { return m_grid->memoryUsage(); }
+
     /// \name Modifiers
     ///@{
     void addPointsToField(const std::vector<Vector3>& points);
@@ -84,6 +90,16 @@ public:
         const std::vector<Vector3>& new_points);
 
     void reset();
+
+    bool shiftOrigin(int dx, int dy, int dz);
+
+    void setDistancePyramidLevels(int levels);
+    int distancePyramidLevels() const;
+
+    /// Return a counter that is incremented whenever obstacles are modified
+    /// through the OccupancyGrid, so that results derived from its contents may
+    /// be detected as stale.
+    auto version() const -> std::uint64_t { return m_version; }
     ///@}
 
     /// \name Properties
@@ -130,6 +146,8 @@ public:
     double getDistanceFromPoint(double x, double y, double z) const;
     double getSquaredDist(double x, double y, double z) const;
 
+    bool isClear(double x, double y, double z, double dist) const;
+
     double getDistanceToBorder(int x, int y, int z) const;
 
     double getDistanceToBorder(double x, double y, double z) const;
@@ -166,8 +184,14 @@ private:
     int m_y_stride;
     std::vector<int> m_counts;
 
+    std::unique_ptr<DistancePyramid> m_pyramid;
+
+    std::uint64_t m_version = 0;
+
     void initRefCounts();
 
+    void updatePyramid(const std::vector<Vector3>& points);
+
     int coordToIndex(int x, int y, int z) const;
 
     int getCellCount() const;
@@ -230,6 +254,21 @@ double OccupancyGrid::getSquaredDist(double x, double y, double z) const
     return m_grid->getMetricSquaredDistance(x, y, z);
 }
 
+/// Return true if the distance pyramid proves that the distance from
+/// (x, y, z) to the nearest obstacle is at least \p dist. Return false if the
+/// pyramid is disabled or cannot prove it, in which case the distance must be
+/// looked up in the distance map.
+inline
+bool OccupancyGrid::isClear(double x, double y, double z, double dist) const
+{
+    if (!m_pyramid) {
+        return false;
+    }
+    int gx, gy, gz;
+    m_grid->worldToGrid(x, y, z, gx, gy, gz);
+    return m_pyramid->isClear(gx, gy, gz, dist);
+}
+
 /// Get the distance to the, in meters, to the border.
 inline
 double OccupancyGrid::getDistanceToBorder(int x, int y, int z) const
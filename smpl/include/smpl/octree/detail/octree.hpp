@@ -270,6 +270,19 @@ void OcTree<T, Allocator>::expand_node(node_type* n)
     construct_children(n, n->value);
 }
 
+/// Rebuild the tree from a copy of itself. The copy allocates the children of
+/// each level before those of the next, with a new allocator obtained via
+/// select_on_container_copy_construction. When used with a pooling allocator
+/// (see PoolAllocator), this lays out nodes contiguously in breadth-first order
+/// and releases storage retained from collapsed nodes. All pointers and
+/// references to non-root nodes are invalidated.
+template <class T, class Allocator>
+void OcTree<T, Allocator>::compact()
+{
+    OcTree tmp(*this);
+    *this = std::move(tmp);
+}
+
 /// Accept a function to be called on every node in the OcTree, in depth-first
 /// order.
 template <class T, class Allocator>
@@ -347,18 +360,32 @@ OcTree<T, Allocator>::mem_usage(const node_type* n) const
     }
 }
 
+// Clone the descendants of nin as descendants of nout. Children are cloned in
+// breadth-first order so that nodes that are close in the tree are likely to
+// be close in memory.
 template <class T, class Allocator>
 void
 OcTree<T, Allocator>::clone_children(node_type *nout, const node_type *nin)
 {
     assert(!nout->children);
-    if (nin->children) {
-        alloc_children(nout);
-        for (node_type *co = nout->children, *ci = nin->children;
-             co < nout->children + 8; ++co, ++ci)
+
+    std::deque<std::pair<node_type*, const node_type*>> q;
+    q.emplace_back(nout, nin);
+    while (!q.empty()) {
+        node_type* out = q.front().first;
+        const node_type* in = q.front().second;
+        q.pop_front();
+
+        if (!in->children) {
+            continue;
+        }
+
+        alloc_children(out);
+        for (node_type *co = out->children, *ci = in->children;
+             co < out->children + 8; ++co, ++ci)
         {
             construct_node(co, ci->value);
-            clone_children(co, ci);
+            q.emplace_back(co, ci);
         }
     }
 }
@@ -34,6 +34,7 @@
 
 // standard includes
 #include <cstdlib>
+#include <deque>
 #include <memory>
 #include <utility>
 #include <stack>
@@ -109,6 +110,8 @@ public:
 
     void expand_node(node_type* n);
 
+    void compact();
+
     /// \name Iteration
     ///@{
     std::pair<iterator, iterator> nodes()
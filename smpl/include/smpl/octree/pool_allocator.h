@@ -0,0 +1,289 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2018, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#ifndef SMPL_POOL_ALLOCATOR_H
+#define SMPL_POOL_ALLOCATOR_H
+
+// standard includes
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace smpl {
+namespace detail {
+
+/// A pool of fixed-size memory blocks. Blocks are carved from progressively
+/// larger slabs and returned to a free list on deallocation for reuse. Memory
+/// is only released to the system when the pool is destroyed.
+class BlockPool
+{
+public:
+
+    static constexpr std::size_t MinSlabBlocks = 64;
+    static constexpr std::size_t MaxSlabBlocks = 8192;
+
+    /// Return the size of the blocks of a pool created for allocations of
+    /// \p size bytes.
+    static std::size_t BlockSizeFor(std::size_t size)
+    {
+        return RoundUp(size < sizeof(FreeBlock) ? sizeof(FreeBlock) : size);
+    }
+
+    BlockPool(std::size_t block_size) :
+        m_block_size(BlockSizeFor(block_size)),
+        m_next_slab_blocks(MinSlabBlocks)
+    { }
+
+    BlockPool(const BlockPool&) = delete;
+    BlockPool& operator=(const BlockPool&) = delete;
+
+    ~BlockPool()
+    {
+        for (void* slab : m_slabs) {
+            ::operator delete(slab);
+        }
+    }
+
+    void* allocate()
+    {
+        if (m_free) {
+            FreeBlock* b = m_free;
+            m_free = b->next;
+            return b;
+        }
+
+        if (m_slab_pos == m_slab_end) {
+            allocate_slab();
+        }
+
+        void* p = m_slab_pos;
+        m_slab_pos += m_block_size;
+        return p;
+    }
+
+    void deallocate(void* p)
+    {
+        FreeBlock* b = static_cast<FreeBlock*>(p);
+        b->next = m_free;
+        m_free = b;
+    }
+
+    std::size_t block_size() const { return m_block_size; }
+
+    /// Return the number of bytes reserved from the system.
+    std::size_t capacity() const { return m_capacity; }
+
+private:
+
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+
+    std::size_t m_block_size;
+    std::size_t m_next_slab_blocks;
+    std::size_t m_capacity = 0;
+
+    std::vector<void*> m_slabs;
+    FreeBlock* m_free = nullptr;
+
+    // remaining never-allocated space in the most recent slab
+    char* m_slab_pos = nullptr;
+    char* m_slab_end = nullptr;
+
+    static std::size_t RoundUp(std::size_t size)
+    {
+        const std::size_t align = alignof(std::max_align_t);
+        return (size + align - 1) / align * align;
+    }
+
+    void allocate_slab()
+    {
+        std::size_t bytes = m_next_slab_blocks * m_block_size;
+        char* slab = static_cast<char*>(::operator new(bytes));
+        m_slabs.push_back(slab);
+        m_capacity += bytes;
+        m_slab_pos = slab;
+        m_slab_end = slab + bytes;
+        if (m_next_slab_blocks < MaxSlabBlocks) {
+            m_next_slab_blocks *= 2;
+        }
+    }
+};
+
+/// The pools shared by an allocator and all allocators rebound from it, one
+/// per block size.
+class BlockPoolGroup
+{
+public:
+
+    /// Return the pool serving allocations of \p size bytes, creating it if
+    /// it does not exist.
+    BlockPool* pool(std::size_t size)
+    {
+        std::size_t block_size = BlockPool::BlockSizeFor(size);
+        for (auto& pool : m_pools) {
+            if (pool->block_size() == block_size) {
+                return pool.get();
+            }
+        }
+        m_pools.emplace_back(new BlockPool(block_size));
+        return m_pools.back().get();
+    }
+
+    /// Return the number of bytes reserved by all pools.
+    std::size_t capacity() const
+    {
+        std::size_t bytes = 0;
+        for (auto& pool : m_pools) {
+            bytes += pool->capacity();
+        }
+        return bytes;
+    }
+
+private:
+
+    std::vector<std::unique_ptr<BlockPool>> m_pools;
+};
+
+} // namespace detail
+
+/// An allocator that serves allocations of exactly BlockSize elements from a
+/// pool of fixed-size blocks, and all other allocations from the global heap.
+/// Used with OcTree (and containers built on it, e.g. SparseGrid) to allocate
+/// the 8-element child arrays of expanded nodes, avoiding a call into the heap
+/// on every node expansion and reusing the storage of collapsed nodes.
+///
+/// Copies of an allocator, and allocators rebound from it, share its pools and
+/// compare equal, so memory may be returned through any of them. Containers
+/// that are copy-constructed obtain new pools, so distinct containers never
+/// share storage. The pools are not thread-safe.
+///
+/// Deallocated blocks are kept for reuse and are not returned to the system.
+/// The memory of the pools is only released when the last allocator sharing
+/// them is destroyed, e.g. when the container is destroyed or when
+/// OcTree::compact rebuilds the tree with new pools.
+template <class T, std::size_t BlockSize = 8>
+class PoolAllocator
+{
+public:
+
+    using value_type = T;
+
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    template <class U>
+    struct rebind
+    {
+        using other = PoolAllocator<U, BlockSize>;
+    };
+
+    PoolAllocator() :
+        m_pools(std::make_shared<detail::BlockPoolGroup>()),
+        m_pool_ptr(m_pools->pool(BlockSize * sizeof(T)))
+    { }
+
+    PoolAllocator(const PoolAllocator& o) :
+        m_pools(o.m_pools), m_pool_ptr(o.m_pool_ptr)
+    { }
+
+    // rebound allocators share the pools, and take the pool for their own
+    // block size
+    template <class U>
+    PoolAllocator(const PoolAllocator<U, BlockSize>& o) :
+        m_pools(o.m_pools),
+        m_pool_ptr(m_pools->pool(BlockSize * sizeof(T)))
+    { }
+
+    PoolAllocator& operator=(const PoolAllocator& o)
+    {
+        m_pools = o.m_pools;
+        m_pool_ptr = o.m_pool_ptr;
+        return *this;
+    }
+
+    T* allocate(std::size_t n)
+    {
+        if (n == BlockSize) {
+            return static_cast<T*>(m_pool_ptr->allocate());
+        }
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, std::size_t n)
+    {
+        if (n == BlockSize) {
+            m_pool_ptr->deallocate(p);
+        } else {
+            std::allocator<T>().deallocate(p, n);
+        }
+    }
+
+    PoolAllocator select_on_container_copy_construction() const
+    {
+        return PoolAllocator();
+    }
+
+    /// Return the number of bytes reserved by the pools.
+    std::size_t capacity() const { return m_pools->capacity(); }
+
+    template <class U>
+    bool operator==(const PoolAllocator<U, BlockSize>& o) const {
+        return m_pools == o.m_pools;
+    }
+
+    template <class U>
+    bool operator!=(const PoolAllocator<U, BlockSize>& o) const {
+        return m_pools != o.m_pools;
+    }
+
+private:
+
+    template <class U, std::size_t N>
+    friend class PoolAllocator;
+
+    static_assert(alignof(T) <= alignof(std::max_align_t), "over-aligned types are not supported");
+
+    std::shared_ptr<detail::BlockPoolGroup> m_pools;
+
+    // the pool for blocks of BlockSize elements, cached to avoid looking it up
+    // on every allocation
+    detail::BlockPool* m_pool_ptr;
+};
+
+} // namespace smpl
+
+#endif
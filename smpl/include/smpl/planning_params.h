@@ -100,6 +100,10 @@ public:
     /// \name Logging
     ///@{
     std::string plan_output_dir;
+
+    /// If non-empty, each request is captured to a binary file in this
+    /// directory, for offline replay.
+    std::string capture_output_dir;
     ///@}
 
     void addParam(const std::string& name, bool val);
@@ -122,6 +126,8 @@ public:
 
     bool hasParam(const std::string& name) const;
 
+    auto getParams() const -> const std::unordered_map<std::string, Parameter>&;
+
 private:
 
     std::unordered_map<std::string, Parameter> params;
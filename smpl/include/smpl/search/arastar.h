@@ -35,18 +35,24 @@
 // standard includes
 #include <assert.h>
 #include <algorithm>
+#include <cstdint>
 #include <functional>
+#include <vector>
 
 // system includes
 #include <sbpl/heuristics/heuristic.h>
 #include <sbpl/planners/planner.h>
 
 // project includes
-#include <smpl/heap/intrusive_heap.h>
+#include <smpl/heap/index_heap.h>
 #include <smpl/time.h>
 
 namespace smpl {
 
+class MemoryUsageExtension;
+class RobotHeuristic;
+class SearchTrace;
+
 /// An implementation of the ARA* (Anytime Repairing A*) search algorithm. This
 /// algorithm runs a series of weighted A* searches with decreasing bounds on
 /// suboptimality to return the best solution found within a given time bound.
@@ -77,6 +83,20 @@ namespace smpl {
 ///
 /// * The heuristics for any encountered states remain constant, unless the goal
 ///   state ID has changed.
+///
+/// By default, notifying the search of changes to edge costs, via
+/// costs_changed(), discards the search tree. If incremental repair is enabled,
+/// the search records the predecessors of each state it generates, and
+/// costs_changed() instead discards only the part of the search tree reached
+/// through changed edges, reopens the states that lead into it, and restarts
+/// the anytime search from the initial epsilon if the previous solution was
+/// lost. The previous solution, if it remains valid, bounds the cost of the
+/// repaired search.
+///
+/// Incremental repair is a feature of the search only. The caller is
+/// responsible for reporting which states have changed edges; none of the
+/// graphs in smpl, ManipLattice included, map changed cells of an
+/// OccupancyGrid to the ids of the states whose edges pass through them.
 class ARAStar : public SBPLPlanner
 {
 public:
@@ -104,6 +124,9 @@ public:
 
     bool allowPartialSolutions() const { return m_allow_partial_solutions; }
 
+    void allowIncrementalRepair(bool enabled);
+    bool allowIncrementalRepair() const { return m_allow_incremental_repair; }
+
     void setAllowedRepairTime(double allowed_time_secs) {
         m_time_params.max_allowed_time = to_duration(allowed_time_secs);
     }
@@ -134,6 +157,22 @@ public:
     void setBoundExpansions(bool bound) { m_time_params.bounded = bound; }
     bool boundExpansions() const { return m_time_params.bounded; }
 
+    /// Return an estimate of the number of bytes held by the search.
+    size_t memoryUsage() const;
+
+    /// Stop the search when the memory held by the search, together with the
+    /// memory reported by the graph if it provides MemoryUsageExtension,
+    /// exceeds this many bytes. The search then fails, or returns a partial
+    /// solution if those are allowed, as if it had run out of time. A limit of
+    /// 0 (the default) disables the check.
+    void setMemoryLimit(size_t bytes) { m_memory_limit = bytes; }
+    size_t memoryLimit() const { return m_memory_limit; }
+
+    /// Record each expansion into a trace, or stop recording if null. The
+    /// search does not take ownership of the trace.
+    void setTrace(SearchTrace* trace) { m_trace = trace; }
+    auto trace() const -> SearchTrace* { return m_trace; }
+
     int replan(
         const TimeParameters &params,
         std::vector<int>* solution,
@@ -168,29 +207,43 @@ public:
 
 private:
 
-    struct SearchState : public heap_element
+    // Search states are stored by value in an array indexed by graph state id,
+    // and refer to each other by id. The fields examined for every generated
+    // successor are packed at the front of the record, which fits two to a
+    // cache line.
+    struct SearchState
     {
-        int state_id;       // corresponding graph state
         unsigned int g;     // cost-to-come
-        unsigned int h;     // estimated cost-to-go
         unsigned int f;     // (g + eps * h) at time of insertion into OPEN
-        unsigned int eg;    // g-value at time of expansion
-        unsigned short iteration_closed;
+        unsigned int h;     // estimated cost-to-go
+        std::uint32_t heap_index;   // position in OPEN, or 0 if not in OPEN
         unsigned short call_number;
-        SearchState* bp;
+        unsigned short iteration_closed;
+
+        unsigned int eg;    // g-value at time of expansion
+        int bp;             // id of the best predecessor, or -1
         bool incons;
     };
 
-    struct SearchStateCompare
+    struct SearchStatePosition
     {
-        bool operator()(const SearchState& s1, const SearchState& s2) const {
-            return s1.f < s2.f;
+        std::vector<SearchState>* states;
+        std::uint32_t& operator()(int s) const {
+            return (*states)[s].heap_index;
         }
     };
 
     DiscreteSpaceInformation* m_space;
     Heuristic* m_heur;
 
+    // the graph, if it reports its memory usage
+    MemoryUsageExtension* m_space_memory;
+
+    // the heuristic, if it computes heuristic values in batches
+    RobotHeuristic* m_batch_heur;
+    std::vector<int> m_heur_ids;
+    std::vector<int> m_heur_values;
+
     TimeParameters m_time_params;
 
     double m_initial_eps;
@@ -198,22 +251,33 @@ private:
     double m_delta_eps;
 
     bool m_allow_partial_solutions;
+    bool m_allow_incremental_repair;
+
+    size_t m_memory_limit;
+
+    SearchTrace* m_trace;
+    clock::duration m_trace_heur_time; // heuristic time of the current expansion
 
-    std::vector<SearchState*> m_states;
+    std::vector<SearchState> m_states;
 
     int m_start_state_id;   // graph state id for the start state
     int m_goal_state_id;    // graph state id for the goal state
 
     // search state (not including the values of g, f, back pointers, and
     // closed list from m_stats)
-    intrusive_heap<SearchState, SearchStateCompare> m_open;
-    std::vector<SearchState*> m_incons;
+    index_heap<unsigned int, SearchStatePosition> m_open; // keyed by f
+    std::vector<int> m_incons;
     double m_curr_eps;
     int m_iteration;
 
     std::vector<int> m_succs;
     std::vector<int> m_costs;
 
+    // predecessors of each state generated during the search, recorded for
+    // incremental repair
+    std::vector<std::vector<int>> m_preds;
+    size_t m_pred_count;
+
     int m_call_number;          // for lazy reinitialization of search states
     int m_last_start_state_id;  // for lazy reinitialization of the search tree
     int m_last_goal_state_id;   // for updating the search tree when the goal changes
@@ -236,25 +300,27 @@ private:
     bool timedOut(
         int elapsed_expansions,
         const clock::duration& elapsed_time) const;
+    bool outOfMemory() const;
 
     int improvePath(
         const clock::time_point& start_time,
-        SearchState* goal_state,
         int& elapsed_expansions,
         clock::duration& elapsed_time);
 
-    void expand(SearchState* s);
+    void expand(int state_id);
+
+    void recordPredecessor(int state_id, int pred_id);
+    bool repairSearchTree(const StateChangeQuery& changes);
 
     void recomputeHeuristics();
     void reorderOpen();
-    int computeKey(SearchState* s) const;
+    int computeKey(const SearchState& s) const;
 
-    SearchState* getSearchState(int state_id);
-    SearchState* createState(int state_id);
-    void reinitSearchState(SearchState* state);
+    void growStates(int state_id);
+    void reinitSearchState(int state_id);
 
     void extractPath(
-        SearchState* to_state,
+        int to_state_id,
         std::vector<int>& solution,
         int& cost) const;
 };
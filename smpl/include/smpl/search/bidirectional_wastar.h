@@ -0,0 +1,189 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2018, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#ifndef SMPL_BIDIRECTIONAL_WASTAR_H
+#define SMPL_BIDIRECTIONAL_WASTAR_H
+
+// standard includes
+#include <vector>
+
+// system includes
+#include <sbpl/heuristics/heuristic.h>
+#include <sbpl/planners/planner.h>
+
+// project includes
+#include <smpl/heap/intrusive_heap.h>
+#include <smpl/time.h>
+
+namespace smpl {
+
+/// A bidirectional weighted A* search. A forward search from the start state,
+/// using successors and heuristic distances to the goal, and a backward search
+/// from the goal state, using predecessors and heuristic distances to the
+/// start, are run in alternation, each time expanding the search with the
+/// smaller open list. Whenever a state is reached by one search that has
+/// already been reached by the other, the path through that state becomes a
+/// candidate solution. The search ends when the cost of the best candidate is
+/// no greater than either of two lower bounds, each of which bounds the cost
+/// of the solution by epsilon times the optimal cost:
+///
+/// * the largest of the minimum keys of the two open lists
+/// * the sum of the smallest g-values in the two open lists, which relates
+///   the two frontiers to each other and does not depend on the heuristics
+///
+/// Heuristic estimates between states of the two frontiers are not used, since
+/// each step would have to evaluate every pair of frontier states and the
+/// heuristics only estimate distances to the start and the goal. The backward
+/// search uses the start heuristic, GetStartHeuristic(); with a heuristic that
+/// does not implement it, the sum of g-values still ends the search once the
+/// frontiers meet.
+///
+/// The backward search requires the graph to implement GetPreds(), with the
+/// same edge costs as GetSuccs(), for the goal state and the states behind it.
+/// If the backward search runs out of states, the search continues as a
+/// forward weighted A* search. Each call to replan() begins a new search.
+class BidirectionalWAStar : public SBPLPlanner
+{
+public:
+
+    BidirectionalWAStar(DiscreteSpaceInformation* space, Heuristic* heuristic);
+    ~BidirectionalWAStar();
+
+    /// \name Required Functions from SBPLPlanner
+    ///@{
+    int replan(double allowed_time_secs, std::vector<int>* solution) override;
+    int replan(double allowed_time_secs, std::vector<int>* solution, int* cost) override;
+    int set_goal(int state_id) override;
+    int set_start(int state_id) override;
+    int force_planning_from_scratch() override;
+    int set_search_mode(bool first_solution_unbounded) override;
+    void costs_changed(const StateChangeQuery& changes) override;
+    ///@}
+
+    /// \name Reimplemented Functions from SBPLPlanner
+    ///@{
+    int replan(std::vector<int>* solution, ReplanParams params) override;
+    int replan(std::vector<int>* solution, ReplanParams params, int* cost) override;
+    int force_planning_from_scratch_and_free_memory() override;
+    double get_solution_eps() const override { return m_eps; }
+    int get_n_expands() const override { return m_expand_count; }
+    double get_initial_eps() override { return m_eps; }
+    double get_initial_eps_planning_time() override;
+    double get_final_eps_planning_time() override;
+    int get_n_expands_init_solution() override { return m_expand_count; }
+    double get_final_epsilon() override { return m_eps; }
+    void get_search_stats(std::vector<PlannerStats>* s) override;
+    void set_initialsolution_eps(double eps) override { m_eps = eps; }
+    ///@}
+
+private:
+
+    enum Direction
+    {
+        Forward = 0,
+        Backward = 1,
+    };
+
+    struct SearchState;
+
+    // the entry of a search state in the open list ordered by g-value
+    struct GElement : public heap_element
+    {
+        SearchState* state;
+    };
+
+    struct SearchState : public heap_element
+    {
+        SearchState* bp;
+        int state_id;
+        int g;
+        int h;
+        int f;
+        int call_number;
+        bool closed;
+        GElement g_elem;
+    };
+
+    struct SearchStateCompare
+    {
+        bool operator()(const SearchState& s1, const SearchState& s2) const {
+            return s1.f < s2.f;
+        }
+    };
+
+    struct GElementCompare
+    {
+        bool operator()(const GElement& e1, const GElement& e2) const {
+            return e1.state->g < e2.state->g;
+        }
+    };
+
+    using OpenList = intrusive_heap<SearchState, SearchStateCompare>;
+    using GOpenList = intrusive_heap<GElement, GElementCompare>;
+
+    DiscreteSpaceInformation* m_space;
+    Heuristic* m_heur;
+
+    // search states and open lists for the forward and backward searches. The
+    // states of each open list are also kept ordered by g-value.
+    std::vector<SearchState*> m_states[2];
+    OpenList m_open[2];
+    GOpenList m_open_g[2];
+
+    double m_eps;
+
+    int m_start_state_id;
+    int m_goal_state_id;
+
+    int m_call_number;
+
+    // best path found so far, through the state where the searches met
+    int m_meet_state_id;
+    int m_best_cost;
+
+    int m_expand_count;
+    clock::duration m_search_time;
+
+    std::vector<int> m_succs;
+    std::vector<int> m_costs;
+
+    auto getSearchState(int dir, int state_id) -> SearchState*;
+    void reinitSearchState(int dir, SearchState* state);
+    int computeKey(SearchState* s) const;
+    void insertOrUpdate(int dir, SearchState* s);
+    void expand(int dir, SearchState* s);
+    void updateMeeting(int dir, SearchState* s);
+    void extractPath(std::vector<int>& solution) const;
+};
+
+} // namespace smpl
+
+#endif
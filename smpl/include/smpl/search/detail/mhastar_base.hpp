@@ -43,6 +43,7 @@
 // project includes
 #include <smpl/time.h>
 #include <smpl/console/console.h>
+#include <smpl/search/search_trace.h>
 
 namespace smpl {
 
@@ -64,6 +65,8 @@ MHAStarBase<Derived>::MHAStarBase(
     m_num_expansions(0),
     m_elapsed(0.0),
     m_call_number(0), // uninitialized
+    m_trace(nullptr),
+    m_trace_heur_time(clock::duration::zero()),
     m_start_state(nullptr),
     m_goal_state(nullptr),
     m_search_states(),
@@ -184,6 +187,11 @@ int MHAStarBase<Derived>::replan(
 
     auto start_time = smpl::clock::now();
 
+    if (m_trace) {
+        m_trace->beginSearch("mhastar", m_start_state->state_id, m_goal_state->state_id);
+        m_trace->beginIteration(m_eps);
+    }
+
     ++m_call_number;
     reinit_state(m_goal_state);
     reinit_state(m_start_state);
@@ -218,6 +226,9 @@ int MHAStarBase<Derived>::replan(
             if (static_cast<Derived*>(this)->terminated()) {
                 m_eps_satisfied = m_eps;
                 extract_path(solution, solcost);
+                if (m_trace) {
+                    m_trace->endSearch(true, *solcost, *solution);
+                }
                 return 1;
             }
 
@@ -234,6 +245,9 @@ int MHAStarBase<Derived>::replan(
             if (static_cast<Derived*>(this)->terminated()) {
                 m_eps_satisfied = m_eps;
                 extract_path(solution, solcost);
+                if (m_trace) {
+                    m_trace->endSearch(true, *solcost, *solution);
+                }
                 return 1;
             }
 
@@ -255,6 +269,9 @@ int MHAStarBase<Derived>::replan(
         SMPL_INFO("Time limit reached");
     }
 
+    if (m_trace) {
+        m_trace->endSearch(false, -1, std::vector<int>());
+    }
     return 0;
 }
 
@@ -570,11 +587,22 @@ void MHAStarBase<Derived>::expand(MHASearchState* state, int hidx)
         }
     }
 
+    clock::time_point succs_start;
+    clock::duration succs_time = clock::duration::zero();
+    if (m_trace) {
+        m_trace_heur_time = clock::duration::zero();
+        succs_start = clock::now();
+    }
+
     std::vector<int> succ_ids;
     std::vector<int> costs;
     environment_->GetSuccs(state->state_id, &succ_ids, &costs);
     assert(succ_ids.size() == costs.size());
 
+    if (m_trace) {
+        succs_time = clock::now() - succs_start;
+    }
+
     for (size_t sidx = 0; sidx < succ_ids.size(); ++sidx)  {
         const int cost = costs[sidx];
         MHASearchState* succ_state = get_state(succ_ids[sidx]);
@@ -601,6 +629,20 @@ void MHAStarBase<Derived>::expand(MHASearchState* state, int hidx)
             }
         }
     }
+
+    if (m_trace) {
+        ExpansionRecord record;
+        record.state_id = state->state_id;
+        record.queue = hidx;
+        record.g = state->g;
+        record.h = state->od[hidx].h;
+        record.f = state->od[hidx].f;
+        record.succ_count = (std::uint32_t)succ_ids.size();
+        record.succ_time_ns = ToTraceTime(succs_time);
+        record.heur_time_ns = ToTraceTime(m_trace_heur_time);
+        record.type = ExpansionRecord::Expansion;
+        m_trace->recordExpansion(record);
+    }
 }
 
 template <typename Derived>
@@ -613,11 +655,14 @@ MHASearchState* MHAStarBase<Derived>::state_from_open_state(
 template <typename Derived>
 int MHAStarBase<Derived>::compute_heuristic(int state_id, int hidx)
 {
-    if (hidx == 0) {
-        return m_hanchor->GetGoalHeuristic(state_id);
-    } else {
-        return m_heurs[hidx - 1]->GetGoalHeuristic(state_id);
+    Heuristic* h = hidx == 0 ? m_hanchor : m_heurs[hidx - 1];
+    if (m_trace) {
+        auto then = clock::now();
+        int value = h->GetGoalHeuristic(state_id);
+        m_trace_heur_time += clock::now() - then;
+        return value;
     }
+    return h->GetGoalHeuristic(state_id);
 }
 
 template <typename Derived>
@@ -34,12 +34,14 @@
 
 #include <smpl/heap/intrusive_heap.h>
 #include <smpl/heuristic/robot_heuristic.h>
+#include <smpl/time.h>
 
 #include <smpl/search/lazy_search_interface.h>
 
 namespace smpl {
 
 struct LazyARAStar;
+class SearchTrace;
 
 bool Init(
     LazyARAStar& search,
@@ -105,6 +107,10 @@ struct LazyARAStar
     std::vector<int> costs_;
     std::vector<bool> true_costs_;
 
+    // if non-null, each expansion and evaluation is recorded into the trace
+    SearchTrace*            trace_ = nullptr;
+    clock::duration         trace_heur_time_ = clock::duration::zero();
+
     LazyARAStar() : open_(StateCompare{this}) { }
 };
 
@@ -44,9 +44,12 @@
 
 // project includes
 #include <smpl/heap/intrusive_heap.h>
+#include <smpl/time.h>
 
 namespace smpl {
 
+class SearchTrace;
+
 struct MHASearchState
 {
     int call_number;
@@ -154,6 +157,11 @@ public:
 
     ///@}
 
+    /// Record each expansion into a trace, or stop recording if null. The
+    /// search does not take ownership of the trace.
+    void set_trace(SearchTrace* trace) { m_trace = trace; }
+    auto get_trace() const -> SearchTrace* { return m_trace; }
+
     friend Derived;
 
 private:
@@ -176,6 +184,9 @@ private:
 
     int m_call_number;
 
+    SearchTrace* m_trace;
+    clock::duration m_trace_heur_time; // heuristic time of the current expansion
+
     MHASearchState* m_start_state;
     MHASearchState* m_goal_state;
 
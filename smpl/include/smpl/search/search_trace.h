@@ -0,0 +1,170 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2018, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#ifndef SMPL_SEARCH_TRACE_H
+#define SMPL_SEARCH_TRACE_H
+
+// standard includes
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// project includes
+#include <smpl/time.h>
+
+namespace smpl {
+
+/// Statistics recorded for one state selected from the open list.
+struct ExpansionRecord
+{
+    enum Type : std::uint8_t
+    {
+        Expansion,  ///< the successors of the state were generated
+        Evaluation, ///< the edge to the state's best predecessor was evaluated
+    };
+
+    std::int32_t state_id;
+    std::int32_t queue;         ///< index of the open list the state came from
+    std::uint32_t g;
+    std::uint32_t h;            ///< heuristic value used by the queue
+    std::uint32_t f;            ///< priority in the queue
+    std::uint32_t succ_count;
+    std::uint32_t succ_time_ns; ///< time spent generating successors
+    std::uint32_t heur_time_ns; ///< time spent computing successor heuristics
+    std::uint32_t eval_time_ns; ///< time spent evaluating the edge
+    Type type;
+};
+
+/// Writes a binary trace of the states expanded by a search, for offline
+/// profiling. A search with a trace attached records a Begin event at the
+/// start of each call to replan, an Iteration event for each suboptimality
+/// bound it searches with, an Expansion event for each state it selects from
+/// an open list (or whose edge it evaluates), and an End event with the
+/// solution it returns. Searches do not take ownership of the trace, and
+/// several searches may write into the same trace, one after the other.
+class SearchTrace
+{
+public:
+
+    SearchTrace();
+    ~SearchTrace();
+
+    SearchTrace(const SearchTrace&) = delete;
+    SearchTrace& operator=(const SearchTrace&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return m_file != nullptr; }
+
+    void beginSearch(const char* search, int start_id, int goal_id);
+    void beginIteration(double eps);
+    void recordExpansion(const ExpansionRecord& record);
+    void endSearch(bool solved, int cost, const std::vector<int>& path);
+
+    /// Write all buffered events to the file.
+    void flush();
+
+private:
+
+    std::FILE* m_file;
+    std::vector<std::uint8_t> m_buffer;
+    clock::time_point m_search_start;
+
+    template <class T>
+    void write(const T& value);
+};
+
+/// An event read back from a search trace.
+struct SearchTraceEvent
+{
+    enum Type
+    {
+        Begin,
+        Iteration,
+        Expansion,
+        End,
+    } type;
+
+    // Begin
+    std::string search;
+    int start_id;
+    int goal_id;
+
+    // Iteration
+    double eps;
+
+    // Expansion
+    ExpansionRecord expansion;
+
+    // End
+    bool solved;
+    int cost;
+    std::uint64_t elapsed_ns;   ///< time between the Begin and End events
+    std::vector<int> path;
+};
+
+class SearchTraceReader
+{
+public:
+
+    SearchTraceReader();
+    ~SearchTraceReader();
+
+    SearchTraceReader(const SearchTraceReader&) = delete;
+    SearchTraceReader& operator=(const SearchTraceReader&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    /// Read the next event. Return false at the end of the trace or if the
+    /// trace is malformed.
+    bool next(SearchTraceEvent& event);
+
+private:
+
+    std::FILE* m_file;
+
+    template <class T>
+    bool read(T& value);
+};
+
+/// Convert a duration to the nanosecond counts stored in an ExpansionRecord,
+/// saturating at the largest representable value.
+inline auto ToTraceTime(const clock::duration& d) -> std::uint32_t
+{
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+    return ns > 0xFFFFFFFF ? 0xFFFFFFFF : (std::uint32_t)ns;
+}
+
+} // namespace smpl
+
+#endif
@@ -484,6 +484,13 @@ int BFS_3D::countDiscovered() const
     return count;
 }
 
+size_t BFS_3D::memoryUsage() const
+{
+    return 2 * (size_t)m_dim_xyz * sizeof(int) +
+            m_closed.capacity() / 8 +
+            m_distances.capacity() * sizeof(int);
+}
+
 #define EXPAND_NEIGHBOR(offset)                            \
     if (distance_grid[currentNode + offset] < 0) {         \
         queue[queue_tail++] = currentNode + offset;        \
@@ -21,6 +21,8 @@ bool g_initialized = false;
 static bool g_unbuffered = false;
 static bool g_colored = false;
 static bool g_show_locations = false;
+static bool g_async_enabled = false;
+static int g_async_buffer_size = 1 << 20;
 
 static std::mutex g_init_mutex;
 static std::mutex g_locations_mutex;
@@ -77,6 +79,8 @@ void initialize()
             ("format.unbuffered", po::value<bool>(&g_unbuffered)->default_value(false))
             ("format.colored", po::value<bool>(&g_colored)->default_value(false))
             ("format.show_locations", po::value<bool>(&g_show_locations)->default_value(false))
+            ("async.enabled", po::value<bool>(&g_async_enabled)->default_value(false))
+            ("async.buffer_size", po::value<int>(&g_async_buffer_size)->default_value(1 << 20))
             ;
 
     bool allow_unregistered = true;
@@ -110,6 +114,10 @@ void initialize()
         }
     }
 
+    if (g_async_enabled && g_async_buffer_size > 0) {
+        detail::StartAsync((size_t)g_async_buffer_size);
+    }
+
     g_initialized = true;
 }
 
@@ -130,11 +138,9 @@ void InitializeLogLocation(
     loc->initialized = true;
 }
 
-void print(Level level, const char* filename, int line, const char* fmt, ...)
+static
+auto BeginMessage(Level level) -> FILE*
 {
-    va_list args;
-    va_start(args, fmt);
-
     FILE* f;
     if (level >= LEVEL_ERROR) {
         f = stderr;
@@ -184,8 +190,12 @@ void print(Level level, const char* filename, int line, const char* fmt, ...)
         break;
     }
 
-    vfprintf(f, fmt, args);
+    return f;
+}
 
+static
+void EndMessage(FILE* f, const char* filename, int line)
+{
     // print file and line
     if (g_show_locations) {
         const char* base = strrchr(filename, '\\');
@@ -205,10 +215,31 @@ void print(Level level, const char* filename, int line, const char* fmt, ...)
     if (g_unbuffered) {
         fflush(f);
     }
+}
+
+void print(Level level, const char* filename, int line, const char* fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+
+    FILE* f = BeginMessage(level);
+    vfprintf(f, fmt, args);
+    EndMessage(f, filename, line);
 
     va_end(args);
 }
 
+namespace detail {
+
+void WriteMessage(int level, const char* filename, int line, const char* msg)
+{
+    FILE* f = BeginMessage((Level)level);
+    fputs(msg, f);
+    EndMessage(f, filename, line);
+}
+
+} // namespace detail
+
 void print(Level level, const char* filename, int line, const std::stringstream& ss)
 {
     auto& o = (level >= LEVEL_ERROR) ? std::cerr : std::cout;
@@ -0,0 +1,599 @@
+#include <smpl/console/detail/console_async.h>
+
+// standard includes
+#include <stdio.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace smpl {
+namespace console {
+namespace detail {
+
+std::atomic<bool> g_async(false);
+
+// Records are padded to this alignment within a buffer.
+static const size_t RecordAlignment = 8;
+
+// Marks the remainder of a buffer as unused, when a record does not fit
+// before the end of the buffer.
+static const int32_t PaddingLevel = -1;
+
+struct RecordHeader
+{
+    uint32_t size;
+    int32_t level;
+    int32_t line;
+    uint32_t fmt_len;
+    const char* filename;
+};
+
+// A single-producer, single-consumer ring of variable-sized records. The
+// producer is the thread that owns the buffer; the consumer is the writer
+// thread. Records never wrap around the end of the buffer.
+struct RecordBuffer
+{
+    std::vector<uint8_t> data;
+    size_t mask;
+
+    std::atomic<size_t> head;   // written by the producer
+    std::atomic<size_t> tail;   // written by the consumer
+
+    // end of the record currently being written by the producer
+    size_t pending_head;
+
+    std::atomic<uint64_t> written;
+    std::atomic<uint64_t> dropped;
+
+    // dropped count last reported by the consumer
+    uint64_t reported_dropped;
+
+    // set when the owning thread exits; the consumer frees the buffer once
+    // it has been drained
+    std::atomic<bool> orphaned;
+
+    RecordBuffer(size_t capacity) :
+        data(capacity),
+        mask(capacity - 1),
+        head(0),
+        tail(0),
+        pending_head(0),
+        written(0),
+        dropped(0),
+        reported_dropped(0),
+        orphaned(false)
+    { }
+};
+
+struct AsyncSink
+{
+    size_t buffer_size = 0;
+
+    std::mutex buffers_mutex;
+    std::vector<RecordBuffer*> buffers;
+
+    // counters of buffers that have already been freed
+    uint64_t retired_written = 0;
+    uint64_t retired_dropped = 0;
+
+    std::mutex wake_mutex;
+    std::condition_variable wake_cv;
+
+    // set by the writer, under wake_mutex, before it blocks waiting for
+    // messages; producers that publish a message while it is set wake it
+    std::atomic<bool> idle;
+    std::condition_variable flushed_cv;
+    uint64_t flush_requests = 0;
+    uint64_t flushes_done = 0;
+    bool stop = false;
+
+    std::thread writer;
+
+    AsyncSink() : idle(false) { }
+    ~AsyncSink();
+};
+
+static AsyncSink g_sink;
+
+struct BufferHandle
+{
+    RecordBuffer* buffer = nullptr;
+
+    ~BufferHandle()
+    {
+        if (buffer) {
+            buffer->orphaned.store(true, std::memory_order_release);
+        }
+    }
+};
+
+static thread_local BufferHandle t_buffer;
+
+static
+auto GetThreadBuffer() -> RecordBuffer*
+{
+    if (!t_buffer.buffer) {
+        auto* buffer = new RecordBuffer(g_sink.buffer_size);
+        std::unique_lock<std::mutex> lock(g_sink.buffers_mutex);
+        g_sink.buffers.push_back(buffer);
+        t_buffer.buffer = buffer;
+    }
+    return t_buffer.buffer;
+}
+
+static
+auto Align(size_t size) -> size_t
+{
+    return (size + RecordAlignment - 1) & ~(RecordAlignment - 1);
+}
+
+auto BeginAsyncRecord(
+    int level,
+    const char* filename,
+    int line,
+    const char* fmt,
+    size_t args_size)
+    -> uint8_t*
+{
+    auto* buffer = GetThreadBuffer();
+
+    auto fmt_len = strlen(fmt);
+    auto size = Align(sizeof(RecordHeader) + fmt_len + 1 + args_size);
+    auto capacity = buffer->data.size();
+
+    if (size > capacity / 2) {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    auto head = buffer->head.load(std::memory_order_relaxed);
+    auto tail = buffer->tail.load(std::memory_order_acquire);
+    auto used = head - tail;
+
+    auto offset = head & buffer->mask;
+    auto contiguous = capacity - offset;
+    if (contiguous < size) {
+        // pad out the end of the buffer and start at the beginning
+        if (capacity - used < contiguous + size) {
+            buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        int32_t padding_size = (int32_t)contiguous;
+        memcpy(&buffer->data[offset], &padding_size, sizeof(padding_size));
+        memcpy(&buffer->data[offset] + sizeof(uint32_t), &PaddingLevel, sizeof(PaddingLevel));
+        head += contiguous;
+        offset = 0;
+    } else if (capacity - used < size) {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    auto* record = &buffer->data[offset];
+
+    RecordHeader header;
+    header.size = (uint32_t)size;
+    header.level = level;
+    header.line = line;
+    header.fmt_len = (uint32_t)fmt_len;
+    header.filename = filename;
+    memcpy(record, &header, sizeof(header));
+    memcpy(record + sizeof(header), fmt, fmt_len + 1);
+
+    buffer->pending_head = head + size;
+    return record + sizeof(header) + fmt_len + 1;
+}
+
+void CommitAsyncRecord()
+{
+    auto* buffer = t_buffer.buffer;
+
+    // The store to head and the load of idle are sequentially consistent,
+    // paired with the writer's store to idle and its loads of head, so either
+    // the writer sees this record before it blocks or this thread sees that
+    // the writer is blocked.
+    buffer->head.store(buffer->pending_head, std::memory_order_seq_cst);
+    buffer->written.fetch_add(1, std::memory_order_relaxed);
+
+    if (g_sink.idle.load(std::memory_order_seq_cst)) {
+        std::unique_lock<std::mutex> lock(g_sink.wake_mutex);
+        g_sink.idle.store(false, std::memory_order_seq_cst);
+        g_sink.wake_cv.notify_all();
+    }
+}
+
+template <class T>
+static
+auto ReadValue(const uint8_t*& p) -> T
+{
+    T val;
+    memcpy(&val, p, sizeof(T));
+    p += sizeof(T);
+    return val;
+}
+
+template <class T>
+static
+void AppendFormatted(std::string& out, const std::string& spec, T val)
+{
+    char buf[256];
+    auto n = snprintf(buf, sizeof(buf), spec.c_str(), val);
+    if (n < 0) {
+        return;
+    }
+    if ((size_t)n < sizeof(buf)) {
+        out.append(buf, n);
+    } else {
+        std::vector<char> big(n + 1);
+        snprintf(big.data(), big.size(), spec.c_str(), val);
+        out.append(big.data(), n);
+    }
+}
+
+// Format a record's encoded arguments according to its format string. Each
+// conversion is formatted individually with snprintf, using the type the
+// argument was recorded with.
+static
+auto FormatRecord(const char* fmt, const uint8_t* args, const uint8_t* end)
+    -> std::string
+{
+    std::string out;
+    std::string spec;
+    std::string str_arg;
+
+    auto next_int = [&](int& val) -> bool {
+        if (args >= end) {
+            return false;
+        }
+        auto type = (ArgType)*args++;
+        switch (type) {
+        case ARG_I32: val = ReadValue<int32_t>(args); return true;
+        case ARG_U32: val = (int)ReadValue<uint32_t>(args); return true;
+        case ARG_I64: val = (int)ReadValue<int64_t>(args); return true;
+        case ARG_U64: val = (int)ReadValue<uint64_t>(args); return true;
+        default: args = end; return false;
+        }
+    };
+
+    const char* p = fmt;
+    while (*p) {
+        if (*p != '%') {
+            out.push_back(*p++);
+            continue;
+        }
+
+        if (p[1] == '%') {
+            out.push_back('%');
+            p += 2;
+            continue;
+        }
+
+        // gather the conversion specification, substituting '*' widths and
+        // precisions with their arguments
+        spec.assign(1, '%');
+        ++p;
+        while (*p && strchr("-+ #0123456789.*hlLjztq", *p)) {
+            if (*p == '*') {
+                int val;
+                if (!next_int(val)) {
+                    return out;
+                }
+                spec += std::to_string(val);
+            } else {
+                spec.push_back(*p);
+            }
+            ++p;
+        }
+        if (!*p) {
+            out += spec;
+            break;
+        }
+        spec.push_back(*p);
+        auto conversion = *p++;
+
+        if (conversion == 'n') {
+            continue;
+        }
+
+        if (args >= end) {
+            out += spec;
+            continue;
+        }
+
+        auto type = (ArgType)*args++;
+        switch (type) {
+        case ARG_I32:
+            AppendFormatted(out, spec, ReadValue<int32_t>(args));
+            break;
+        case ARG_U32:
+            AppendFormatted(out, spec, ReadValue<uint32_t>(args));
+            break;
+        case ARG_I64:
+            AppendFormatted(out, spec, (long long)ReadValue<int64_t>(args));
+            break;
+        case ARG_U64:
+            AppendFormatted(out, spec, (unsigned long long)ReadValue<uint64_t>(args));
+            break;
+        case ARG_F64:
+            AppendFormatted(out, spec, ReadValue<double>(args));
+            break;
+        case ARG_LF64:
+            AppendFormatted(out, spec, ReadValue<long double>(args));
+            break;
+        case ARG_STR: {
+            auto len = ReadValue<uint32_t>(args);
+            str_arg.assign((const char*)args, len);
+            args += len;
+            AppendFormatted(out, spec, str_arg.c_str());
+            break;
+        }
+        case ARG_PTR:
+            AppendFormatted(out, spec, ReadValue<const void*>(args));
+            break;
+        default:
+            // corrupt record; stop decoding arguments
+            args = end;
+            out += spec;
+            break;
+        }
+    }
+
+    return out;
+}
+
+// Write all records currently published in a buffer. Returns the number of
+// records written.
+static
+size_t DrainBuffer(RecordBuffer* buffer)
+{
+    auto tail = buffer->tail.load(std::memory_order_relaxed);
+    auto head = buffer->head.load(std::memory_order_acquire);
+
+    size_t count = 0;
+    while (tail != head) {
+        auto* record = &buffer->data[tail & buffer->mask];
+
+        uint32_t size;
+        int32_t level;
+        memcpy(&size, record, sizeof(size));
+        memcpy(&level, record + sizeof(uint32_t), sizeof(level));
+
+        if (level != PaddingLevel) {
+            RecordHeader header;
+            memcpy(&header, record, sizeof(header));
+            auto* fmt = (const char*)(record + sizeof(header));
+            auto* args = record + sizeof(header) + header.fmt_len + 1;
+            auto msg = FormatRecord(fmt, args, record + header.size);
+            WriteMessage(header.level, header.filename, header.line, msg.c_str());
+            ++count;
+        }
+
+        tail += size;
+        buffer->tail.store(tail, std::memory_order_release);
+    }
+
+    auto dropped = buffer->dropped.load(std::memory_order_relaxed);
+    if (dropped != buffer->reported_dropped) {
+        fprintf(stderr,
+                "[WARN]  smpl console dropped %llu messages (buffer full)\n",
+                (unsigned long long)(dropped - buffer->reported_dropped));
+        buffer->reported_dropped = dropped;
+    }
+
+    return count;
+}
+
+// Drain every buffer once, freeing buffers of exited threads that have been
+// fully drained.
+static
+size_t DrainAll()
+{
+    std::vector<RecordBuffer*> buffers;
+    {
+        std::unique_lock<std::mutex> lock(g_sink.buffers_mutex);
+        buffers = g_sink.buffers;
+    }
+
+    size_t count = 0;
+    std::vector<RecordBuffer*> retired;
+    for (auto* buffer : buffers) {
+        // check before draining, so that nothing published before the thread
+        // exited is missed
+        auto orphaned = buffer->orphaned.load(std::memory_order_acquire);
+        count += DrainBuffer(buffer);
+        if (orphaned) {
+            retired.push_back(buffer);
+        }
+    }
+
+    if (!retired.empty()) {
+        std::unique_lock<std::mutex> lock(g_sink.buffers_mutex);
+        for (auto* buffer : retired) {
+            g_sink.retired_written += buffer->written.load();
+            g_sink.retired_dropped += buffer->dropped.load();
+            g_sink.buffers.erase(
+                    std::find(begin(g_sink.buffers), end(g_sink.buffers), buffer));
+            delete buffer;
+        }
+    }
+
+    if (count != 0) {
+        fflush(stdout);
+        fflush(stderr);
+    }
+    return count;
+}
+
+// Return whether any buffer holds messages that have not been written.
+static
+bool AnyPending()
+{
+    std::unique_lock<std::mutex> lock(g_sink.buffers_mutex);
+    for (auto* buffer : g_sink.buffers) {
+        if (buffer->head.load(std::memory_order_seq_cst) !=
+            buffer->tail.load(std::memory_order_relaxed))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static
+void WriterMain()
+{
+    while (true) {
+        uint64_t flush_request;
+        bool stop;
+        {
+            std::unique_lock<std::mutex> lock(g_sink.wake_mutex);
+            flush_request = g_sink.flush_requests;
+            stop = g_sink.stop;
+        }
+
+        auto count = DrainAll();
+
+        {
+            std::unique_lock<std::mutex> lock(g_sink.wake_mutex);
+            g_sink.flushes_done = flush_request;
+            g_sink.flushed_cv.notify_all();
+
+            if (stop) {
+                break;
+            }
+
+            // block until a producer publishes a message, a flush is
+            // requested, or the sink is stopped
+            if (count == 0 && g_sink.flush_requests == flush_request) {
+                g_sink.idle.store(true, std::memory_order_seq_cst);
+                if (AnyPending()) {
+                    g_sink.idle.store(false, std::memory_order_relaxed);
+                    continue;
+                }
+                g_sink.wake_cv.wait(lock, [&]() {
+                    return !g_sink.idle.load(std::memory_order_relaxed) ||
+                            g_sink.flush_requests != flush_request ||
+                            g_sink.stop;
+                });
+                g_sink.idle.store(false, std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+AsyncSink::~AsyncSink()
+{
+    if (writer.joinable()) {
+        {
+            std::unique_lock<std::mutex> lock(wake_mutex);
+            stop = true;
+        }
+        wake_cv.notify_all();
+        writer.join();
+    }
+    g_async.store(false, std::memory_order_release);
+    for (auto* buffer : buffers) {
+        delete buffer;
+    }
+}
+
+bool StartAsync(size_t buffer_size)
+{
+    static std::mutex start_mutex;
+    std::unique_lock<std::mutex> lock(start_mutex);
+
+    if (g_async.load(std::memory_order_acquire)) {
+        return true;
+    }
+
+    // round up to a power of two
+    size_t capacity = 1024;
+    while (capacity < buffer_size) {
+        capacity <<= 1;
+    }
+
+    g_sink.buffer_size = capacity;
+    g_sink.writer = std::thread(WriterMain);
+    g_async.store(true, std::memory_order_release);
+    return true;
+}
+
+AsyncStream& AsyncStream::operator<<(const char* s)
+{
+    if (!s) {
+        s = "(null)";
+    }
+    if (m_stream) {
+        *m_stream << s;
+        return *this;
+    }
+    for (; *s; ++s) {
+        if (*s == '%') {
+            m_fmt.push_back('%');
+        }
+        m_fmt.push_back(*s);
+    }
+    return *this;
+}
+
+void AsyncStream::commit(int level, const char* filename, int line)
+{
+    if (m_stream) {
+        auto str = m_stream->str();
+        m_fmt += "%s";
+        ArgEncoder sizer;
+        sizer.put_str(str.c_str());
+        auto offset = m_args.size();
+        m_args.resize(offset + sizer.size);
+        ArgEncoder enc;
+        enc.data = m_args.data() + offset;
+        enc.put_str(str.c_str());
+    }
+
+    auto* data = BeginAsyncRecord(
+            level, filename, line, m_fmt.c_str(), m_args.size());
+    if (data) {
+        memcpy(data, m_args.data(), m_args.size());
+        CommitAsyncRecord();
+    }
+}
+
+} // namespace detail
+
+auto GetAsyncStats() -> AsyncStats
+{
+    using namespace detail;
+    std::unique_lock<std::mutex> lock(g_sink.buffers_mutex);
+    AsyncStats stats;
+    stats.written = g_sink.retired_written;
+    stats.dropped = g_sink.retired_dropped;
+    for (auto* buffer : g_sink.buffers) {
+        stats.written += buffer->written.load(std::memory_order_relaxed);
+        stats.dropped += buffer->dropped.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+void flush()
+{
+    using namespace detail;
+    if (!g_async.load(std::memory_order_acquire)) {
+        fflush(stdout);
+        fflush(stderr);
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(g_sink.wake_mutex);
+    auto request = ++g_sink.flush_requests;
+    g_sink.wake_cv.notify_all();
+    g_sink.flushed_cv.wait(lock, [&]() {
+        return g_sink.flushes_done >= request || g_sink.stop;
+    });
+}
+
+} // namespace console
+} // namespace smpl
@@ -0,0 +1,204 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2018, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#include <smpl/distance_map/distance_pyramid.h>
+
+// standard includes
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace smpl {
+
+void DistancePyramid::Level::resize(int sx, int sy, int sz, float value)
+{
+    size_x = sx;
+    size_y = sy;
+    size_z = sz;
+    values.assign((size_t)sx * sy * sz, value);
+}
+
+/// Construct an empty pyramid with the given number of levels, between 1 and
+/// MAX_LEVELS. rebuild() must be called before the pyramid is used.
+DistancePyramid::DistancePyramid(int levels) :
+    m_num_levels(std::max(1, std::min(levels, (int)MAX_LEVELS)))
+{
+}
+
+/// Recompute all levels of the pyramid from a distance map. Must be called
+/// when the extents of the distance map have changed.
+void DistancePyramid::rebuild(const DistanceMapInterface& dmap)
+{
+    m_cells_x = dmap.numCellsX();
+    m_cells_y = dmap.numCellsY();
+    m_cells_z = dmap.numCellsZ();
+    m_update_radius =
+            (int)std::ceil(dmap.getUninitializedDistance() / dmap.resolution()) + 1;
+    m_error = std::sqrt(3.0) * dmap.resolution();
+
+    auto coarse = [](int n, int shift) { return (n + (1 << shift) - 1) >> shift; };
+
+    m_levels.resize(m_num_levels);
+    for (int i = 0; i < m_num_levels; ++i) {
+        m_levels[i].resize(
+                coarse(m_cells_x, i + 1),
+                coarse(m_cells_y, i + 1),
+                coarse(m_cells_z, i + 1),
+                0.0f);
+    }
+    m_dirty.assign(m_levels.back().values.size(), 0);
+
+    update(dmap, 0, 0, 0, m_cells_x - 1, m_cells_y - 1, m_cells_z - 1);
+}
+
+/// Update the pyramid after obstacles at the given points have been added to,
+/// or removed from, the distance map.
+void DistancePyramid::update(
+    const DistanceMapInterface& dmap,
+    const std::vector<Vector3>& points)
+{
+    if (points.empty() || m_levels.empty()) {
+        return;
+    }
+
+    // gather the blocks of the coarsest level that are within the update
+    // radius of any point and update them one at a time
+    const int shift = m_num_levels;
+    Level& top = m_levels.back();
+    std::vector<int> blocks;
+    for (const Vector3& p : points) {
+        int gx, gy, gz;
+        dmap.worldToGrid(p.x(), p.y(), p.z(), gx, gy, gz);
+
+        const int bfx = std::max(gx - m_update_radius, 0) >> shift;
+        const int bfy = std::max(gy - m_update_radius, 0) >> shift;
+        const int bfz = std::max(gz - m_update_radius, 0) >> shift;
+        const int btx = std::min(gx + m_update_radius, m_cells_x - 1) >> shift;
+        const int bty = std::min(gy + m_update_radius, m_cells_y - 1) >> shift;
+        const int btz = std::min(gz + m_update_radius, m_cells_z - 1) >> shift;
+
+        for (int bx = bfx; bx <= btx; ++bx) {
+        for (int by = bfy; by <= bty; ++by) {
+        for (int bz = bfz; bz <= btz; ++bz) {
+            const int i = (bx * top.size_y + by) * top.size_z + bz;
+            if (!m_dirty[i]) {
+                m_dirty[i] = 1;
+                blocks.push_back(i);
+            }
+        }
+        }
+        }
+    }
+
+    const int block_dim = 1 << shift;
+    for (int i : blocks) {
+        m_dirty[i] = 0;
+        const int bz = i % top.size_z;
+        const int by = (i / top.size_z) % top.size_y;
+        const int bx = i / (top.size_z * top.size_y);
+        update(
+                dmap,
+                bx * block_dim,
+                by * block_dim,
+                bz * block_dim,
+                std::min((bx + 1) * block_dim, m_cells_x) - 1,
+                std::min((by + 1) * block_dim, m_cells_y) - 1,
+                std::min((bz + 1) * block_dim, m_cells_z) - 1);
+    }
+}
+
+/// Update the pyramid after the distances of cells within [f, t] have changed.
+void DistancePyramid::update(
+    const DistanceMapInterface& dmap,
+    int fx, int fy, int fz,
+    int tx, int ty, int tz)
+{
+    int bfx = fx, bfy = fy, bfz = fz;
+    int btx = tx, bty = ty, btz = tz;
+
+    // each level stores the minimum distance of the 2x2x2 blocks of the level
+    // below, starting with the cells of the distance map, less the difference
+    // allowed between a cell distance and a metric distance within the cell
+    for (int i = 0; i < m_num_levels; ++i) {
+        Level& dst = m_levels[i];
+        const int sx = i == 0 ? m_cells_x : m_levels[i - 1].size_x;
+        const int sy = i == 0 ? m_cells_y : m_levels[i - 1].size_y;
+        const int sz = i == 0 ? m_cells_z : m_levels[i - 1].size_z;
+        bfx >>= 1; bfy >>= 1; bfz >>= 1;
+        btx >>= 1; bty >>= 1; btz >>= 1;
+        for (int bx = bfx; bx <= btx; ++bx) {
+        for (int by = bfy; by <= bty; ++by) {
+        for (int bz = bfz; bz <= btz; ++bz) {
+            double d = std::numeric_limits<double>::infinity();
+            for (int x = 2 * bx; x < std::min(2 * bx + 2, sx); ++x) {
+            for (int y = 2 * by; y < std::min(2 * by + 2, sy); ++y) {
+            for (int z = 2 * bz; z < std::min(2 * bz + 2, sz); ++z) {
+                if (i == 0) {
+                    d = std::min(d, dmap.getCellDistance(x, y, z) - m_error);
+                } else {
+                    d = std::min(d, (double)m_levels[i - 1](x, y, z));
+                }
+            }
+            }
+            }
+            // round down so that the bound survives the conversion to float
+            float f = (float)d;
+            if ((double)f > d) {
+                f = std::nextafter(f, -std::numeric_limits<float>::infinity());
+            }
+            dst(bx, by, bz) = f;
+        }
+        }
+        }
+    }
+}
+
+/// Return true if the distance from any point within the cell (x, y, z) of
+/// the distance map to the nearest obstacle is known to be at least dist.
+/// Levels are consulted from coarsest to finest, so that cells far from
+/// obstacles are resolved by the smallest level. Return false if no level can
+/// prove it, or the cell is outside the distance map.
+bool DistancePyramid::isClear(int x, int y, int z, double dist) const
+{
+    if (x < 0 || x >= m_cells_x || y < 0 || y >= m_cells_y || z < 0 || z >= m_cells_z) {
+        return false;
+    }
+
+    for (int i = m_num_levels - 1; i >= 0; --i) {
+        const int shift = i + 1;
+        if (m_levels[i](x >> shift, y >> shift, z >> shift) >= dist) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace smpl
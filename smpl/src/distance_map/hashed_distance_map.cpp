@@ -0,0 +1,1018 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2018, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#include <smpl/distance_map/hashed_distance_map.h>
+
+// standard includes
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <set>
+
+namespace smpl {
+
+HashedDistanceMap::HashedDistanceMap(
+    double origin_x, double origin_y, double origin_z,
+    double size_x, double size_y, double size_z,
+    double resolution,
+    double max_dist)
+:
+    DistanceMapInterface(
+            origin_x, origin_y, origin_z,
+            size_x, size_y, size_z,
+            resolution),
+    m_blocks(),
+    m_spare_blocks(),
+    m_free_cell(),
+    m_last_key(~BlockKey(0)),
+    m_last_block(nullptr),
+    m_offset_x(0),
+    m_offset_y(0),
+    m_offset_z(0),
+    m_anchor_x(origin_x),
+    m_anchor_y(origin_y),
+    m_anchor_z(origin_z),
+    m_max_dist(max_dist),
+    m_inv_res(1.0 / resolution),
+    m_dmax_int((int)std::ceil(m_max_dist * m_inv_res)),
+    m_dmax_sqrd_int(m_dmax_int * m_dmax_int),
+    m_bucket(m_dmax_sqrd_int + 1),
+    m_neighbors(),
+    m_indices(),
+    m_neighbor_ranges(),
+    m_neighbor_dirs(),
+    m_open(),
+    m_rem_stack(),
+    m_rem_blocks(),
+    m_error(std::sqrt(3.0) * resolution)
+{
+    // init neighbors for forward propagation
+    CreateNeighborUpdateList(m_neighbors, m_indices, m_neighbor_ranges);
+
+    for (size_t i = 0; i < m_indices.size(); ++i) {
+        const Eigen::Vector3i& neighbor = m_neighbors[m_indices[i]];
+
+        if (i < NON_BORDER_NEIGHBOR_LIST_SIZE) {
+            m_neighbor_dirs[i] = dirnum(neighbor.x(), neighbor.y(), neighbor.z());
+        } else {
+            m_neighbor_dirs[i] = dirnum(neighbor.x(), neighbor.y(), neighbor.z(), 1);
+        }
+    }
+
+    m_cell_count_x = (int)(size_x * m_inv_res + 0.5);
+    m_cell_count_y = (int)(size_y * m_inv_res + 0.5);
+    m_cell_count_z = (int)(size_z * m_inv_res + 0.5);
+
+    m_open.resize(m_dmax_sqrd_int + 1);
+
+    m_sqrt_table.resize(m_dmax_sqrd_int + 1, 0.0);
+    for (int i = 0; i < m_dmax_sqrd_int + 1; ++i) {
+        m_sqrt_table[i] = m_res * std::sqrt((double)i);
+    }
+
+    reset();
+}
+
+/// Copy the cells of another distance map. Cells refer to their nearest
+/// obstacle cells by address, so these references are redirected to the
+/// copied obstacle cells.
+HashedDistanceMap::HashedDistanceMap(const HashedDistanceMap& o) :
+    DistanceMapInterface(o),
+    m_blocks(),
+    m_spare_blocks(),
+    m_free_cell(o.m_free_cell),
+    m_last_key(~BlockKey(0)),
+    m_last_block(nullptr),
+    m_cell_count_x(o.m_cell_count_x),
+    m_cell_count_y(o.m_cell_count_y),
+    m_cell_count_z(o.m_cell_count_z),
+    m_offset_x(o.m_offset_x),
+    m_offset_y(o.m_offset_y),
+    m_offset_z(o.m_offset_z),
+    m_anchor_x(o.m_anchor_x),
+    m_anchor_y(o.m_anchor_y),
+    m_anchor_z(o.m_anchor_z),
+    m_max_dist(o.m_max_dist),
+    m_inv_res(o.m_inv_res),
+    m_dmax_int(o.m_dmax_int),
+    m_dmax_sqrd_int(o.m_dmax_sqrd_int),
+    m_bucket(o.m_bucket),
+    m_neighbors(o.m_neighbors),
+    m_indices(o.m_indices),
+    m_neighbor_ranges(o.m_neighbor_ranges),
+    m_neighbor_dirs(o.m_neighbor_dirs),
+    m_sqrt_table(o.m_sqrt_table),
+    m_open(o.m_open.size()),
+    m_rem_stack(),
+    m_rem_blocks(),
+    m_error(o.m_error)
+{
+    m_blocks.reserve(o.m_blocks.size());
+    for (auto& entry : o.m_blocks) {
+        m_blocks.emplace(
+                entry.first,
+                std::unique_ptr<Block>(new Block(*entry.second)));
+    }
+    relinkObstacles();
+}
+
+HashedDistanceMap& HashedDistanceMap::operator=(const HashedDistanceMap& rhs)
+{
+    if (this != &rhs) {
+        HashedDistanceMap tmp(rhs);
+        *this = std::move(tmp);
+    }
+    return *this;
+}
+
+/// Return the distance value for an invalid cell.
+double HashedDistanceMap::maxDistance() const
+{
+    return m_max_dist;
+}
+
+/// Return the distance of a cell from its nearest obstacle. This function will
+/// also consider the distance to the nearest border cell. A value of 0.0 is
+/// returned for obstacle cells and cells outside of the bounding volume.
+double HashedDistanceMap::getDistance(double x, double y, double z) const
+{
+    int gx, gy, gz;
+    worldToGrid(x, y, z, gx, gy, gz);
+    return getDistance(gx, gy, gz);
+}
+
+/// Return the distance of a cell from its nearest obstacle cell. This function
+/// will also consider the distance to the nearest border cell. A value of 0.0
+/// is returned for obstacle cells and cells outside of the bounding volume.
+double HashedDistanceMap::getDistance(int x, int y, int z) const
+{
+    if (!isCellValid(x, y, z)) {
+        return 0.0;
+    }
+
+    BlockCursor cursor;
+    const Cell& c = getCell(x + m_offset_x, y + m_offset_y, z + m_offset_z, cursor);
+    return m_sqrt_table[c.dist];
+}
+
+DistanceMapInterface* HashedDistanceMap::clone() const
+{
+    return new HashedDistanceMap(*this);
+}
+
+/// Add a set of obstacle points to the distance map and update the distance
+/// values of affected cells. Points outside the map and cells that are already
+/// marked as obstacles will be ignored.
+void HashedDistanceMap::addPointsToMap(const std::vector<Vector3>& points)
+{
+    resetCursor();
+
+    for (const Vector3& p : points) {
+        int gx, gy, gz;
+        worldToGrid(p.x(), p.y(), p.z(), gx, gy, gz);
+        if (!isCellValid(gx, gy, gz)) {
+            continue;
+        }
+
+        gx += m_offset_x;
+        gy += m_offset_y;
+        gz += m_offset_z;
+
+        Cell& c = getCell(gx, gy, gz);
+        if (c.dist_new > 0) {
+            c.dir = NO_UPDATE_DIR;
+            c.dist_new = 0;
+            c.obs = &c;
+            c.ox = gx;
+            c.oy = gy;
+            c.oz = gz;
+            updateVertex(&c, gx, gy, gz);
+        }
+    }
+
+    propagate();
+}
+
+/// Remove a set of obstacle points from the distance map and update the
+/// distance values of affected cells. Points outside the map and cells that
+/// are not marked as obstacles will be ignored.
+void HashedDistanceMap::removePointsFromMap(const std::vector<Vector3>& points)
+{
+    resetCursor();
+
+    for (const Vector3& p : points) {
+        int gx, gy, gz;
+        worldToGrid(p.x(), p.y(), p.z(), gx, gy, gz);
+        if (!isCellValid(gx, gy, gz)) {
+            continue;
+        }
+
+        gx += m_offset_x;
+        gy += m_offset_y;
+        gz += m_offset_z;
+
+        BlockCursor cursor;
+        if (getCell(gx, gy, gz, cursor).obs == nullptr) {
+            continue; // don't allocate blocks to look at free cells
+        }
+
+        Cell& c = getCell(gx, gy, gz);
+        if (c.obs != &c) {
+            continue;
+        }
+
+        c.dist_new = m_dmax_sqrd_int;
+        c.obs = nullptr;
+        c.ox = c.oy = c.oz = -1;
+
+        c.dist = m_dmax_sqrd_int;
+        c.dir = NO_UPDATE_DIR;
+        m_rem_stack.emplace_back(gx, gy, gz);
+    }
+
+    propagateRemovals();
+}
+
+/// Add the set (new_points - old_points) of obstacle cells and remove the set
+/// (old_points - new_points) of obstacle cells and update the distance values
+/// of affected cells. Points outside the map will be ignored.
+void HashedDistanceMap::updatePointsInMap(
+    const std::vector<Vector3>& old_points,
+    const std::vector<Vector3>& new_points)
+{
+    resetCursor();
+
+    const Eigen::Vector3i offset(m_offset_x, m_offset_y, m_offset_z);
+
+    std::set<Eigen::Vector3i, Eigen_Vector3i_compare> old_point_set;
+    for (const Vector3& wp : old_points) {
+        Eigen::Vector3i gp;
+        worldToGrid(wp.x(), wp.y(), wp.z(), gp.x(), gp.y(), gp.z());
+        if (isCellValid(gp.x(), gp.y(), gp.z())) {
+            old_point_set.insert(gp + offset);
+        }
+    }
+
+    std::set<Eigen::Vector3i, Eigen_Vector3i_compare> new_point_set;
+    for (const Vector3& wp : new_points) {
+        Eigen::Vector3i gp;
+        worldToGrid(wp.x(), wp.y(), wp.z(), gp.x(), gp.y(), gp.z());
+        if (isCellValid(gp.x(), gp.y(), gp.z())) {
+            new_point_set.insert(gp + offset);
+        }
+    }
+
+    Eigen_Vector3i_compare comp;
+
+    std::vector<Eigen::Vector3i> old_not_new;
+    std::set_difference(
+            old_point_set.begin(), old_point_set.end(),
+            new_point_set.begin(), new_point_set.end(),
+            std::inserter(old_not_new, old_not_new.end()),
+            comp);
+
+    std::vector<Eigen::Vector3i> new_not_old;
+    std::set_difference(
+            new_point_set.begin(), new_point_set.end(),
+            old_point_set.begin(), old_point_set.end(),
+            std::inserter(new_not_old, new_not_old.end()),
+            comp);
+
+    // remove obstacle cells that were in the old cloud but not the new cloud
+    for (const Eigen::Vector3i& p : old_not_new) {
+        BlockCursor cursor;
+        if (getCell(p.x(), p.y(), p.z(), cursor).obs == nullptr) {
+            continue; // skip free cells without allocating their blocks
+        }
+        Cell& c = getCell(p.x(), p.y(), p.z());
+        if (c.obs != &c) {
+            continue; // skip already-free cells
+        }
+        c.dir = NO_UPDATE_DIR;
+        c.dist_new = m_dmax_sqrd_int;
+        c.dist = m_dmax_sqrd_int;
+        c.obs = nullptr;
+        c.ox = c.oy = c.oz = -1;
+        m_rem_stack.emplace_back(p.x(), p.y(), p.z());
+    }
+
+    propagateRemovals();
+
+    // add obstacle cells that are in the new cloud but not the old cloud
+    for (const Eigen::Vector3i& p : new_not_old) {
+        Cell& c = getCell(p.x(), p.y(), p.z());
+        if (c.dist_new == 0) {
+            continue; // skip already-obstacle cells
+        }
+        c.dir = NO_UPDATE_DIR;
+        c.dist_new = 0;
+        c.obs = &c;
+        c.ox = p.x();
+        c.oy = p.y();
+        c.oz = p.z();
+
+        updateVertex(&c, p.x(), p.y(), p.z());
+    }
+
+    propagate();
+}
+
+/// Reset all points in the distance map to their uninitialized (free) values.
+void HashedDistanceMap::reset()
+{
+    m_free_cell.dist = m_dmax_sqrd_int;
+    m_free_cell.dist_new = m_dmax_sqrd_int;
+#if SMPL_DMAP_RETURN_CHANGED_CELLS
+    m_free_cell.dist_old = m_dmax_sqrd_int;
+#endif
+    m_free_cell.obs = nullptr;
+    m_free_cell.ox = m_free_cell.oy = m_free_cell.oz = -1;
+
+    m_free_cell.bucket = -1;
+    m_free_cell.dir = NO_UPDATE_DIR;
+    m_free_cell.pos = 0;
+
+    m_blocks.clear();
+    m_spare_blocks.clear();
+    resetCursor();
+}
+
+/// Move the volume covered by the distance map by a whole number of cells
+/// along each axis. Obstacles in cells that leave the volume are removed, and
+/// the distances of cells entering the volume are propagated from the
+/// obstacles that remain within it. Cells remaining within the volume retain
+/// their storage and obstacles.
+bool HashedDistanceMap::shiftOrigin(int dx, int dy, int dz)
+{
+    if (dx == 0 && dy == 0 && dz == 0) {
+        return true;
+    }
+
+    resetCursor();
+
+    const Eigen::Vector3i size(m_cell_count_x, m_cell_count_y, m_cell_count_z);
+    const Eigen::Vector3i old_lo(m_offset_x, m_offset_y, m_offset_z);
+    const Eigen::Vector3i lo = old_lo + Eigen::Vector3i(dx, dy, dz);
+    const Eigen::Vector3i hi = lo + size;
+
+    auto in_new_volume = [&](int x, int y, int z) {
+        return x >= lo.x() && x < hi.x() &&
+            y >= lo.y() && y < hi.y() &&
+            z >= lo.z() && z < hi.z();
+    };
+
+    auto block_in_new_volume = [&](const Eigen::Vector3i& b) {
+        return b.x() >= lo.x() && b.x() + BLOCK_DIM <= hi.x() &&
+            b.y() >= lo.y() && b.y() + BLOCK_DIM <= hi.y() &&
+            b.z() >= lo.z() && b.z() + BLOCK_DIM <= hi.z();
+    };
+
+    // remove the obstacles that are leaving the volume, while the volume still
+    // covers the cells whose distances are affected by them
+    for (auto& entry : m_blocks) {
+        if (block_in_new_volume(blockOrigin(entry.first))) {
+            continue;
+        }
+        for (Cell& c : entry.second->cells) {
+            if (c.obs != &c || in_new_volume(c.ox, c.oy, c.oz)) {
+                continue;
+            }
+            m_rem_stack.emplace_back(c.ox, c.oy, c.oz);
+            c.dir = NO_UPDATE_DIR;
+            c.dist_new = m_dmax_sqrd_int;
+            c.dist = m_dmax_sqrd_int;
+            c.obs = nullptr;
+            c.ox = c.oy = c.oz = -1;
+        }
+    }
+
+    propagateRemovals();
+
+    m_offset_x = lo.x();
+    m_offset_y = lo.y();
+    m_offset_z = lo.z();
+    m_origin_x = m_anchor_x + m_res * m_offset_x;
+    m_origin_y = m_anchor_y + m_res * m_offset_y;
+    m_origin_z = m_anchor_z + m_res * m_offset_z;
+
+    // Cells outside the volume must be free, so that they are valid should
+    // they enter the volume again. No cell refers to them, since none of them
+    // are obstacles anymore.
+    auto known = [](const Cell& c) { return c.obs != nullptr; };
+    for (auto it = m_blocks.begin(); it != m_blocks.end(); ) {
+        const Eigen::Vector3i b = blockOrigin(it->first);
+        if (block_in_new_volume(b)) {
+            ++it;
+            continue;
+        }
+
+        auto& cells = it->second->cells;
+        for (int i = 0; i < BLOCK_CELLS; ++i) {
+            const int x = b.x() + (i & (BLOCK_DIM - 1));
+            const int y = b.y() + ((i >> BLOCK_BITS) & (BLOCK_DIM - 1));
+            const int z = b.z() + (i >> (2 * BLOCK_BITS));
+            if (!in_new_volume(x, y, z)) {
+                cells[i] = m_free_cell;
+            }
+        }
+
+        if (std::none_of(cells.begin(), cells.end(), known)) {
+            auto next = std::next(it);
+            releaseBlock(it);
+            it = next;
+        } else {
+            ++it;
+        }
+    }
+
+    // the part of the old volume still covered by the new volume
+    const Eigen::Vector3i rlo = lo.cwiseMax(old_lo);
+    const Eigen::Vector3i rhi = hi.cwiseMin(old_lo + size);
+    if ((rlo.array() < rhi.array()).all()) {
+        seedEnteringCells(rlo, rhi);
+    }
+
+    return true;
+}
+
+/// Return the number of cells along the x axis.
+int HashedDistanceMap::numCellsX() const
+{
+    return m_cell_count_x;
+}
+
+/// Return the number of cells along the y axis.
+int HashedDistanceMap::numCellsY() const
+{
+    return m_cell_count_y;
+}
+
+/// Return the number of cells along the z axis.
+int HashedDistanceMap::numCellsZ() const
+{
+    return m_cell_count_z;
+}
+
+double HashedDistanceMap::getUninitializedDistance() const
+{
+    return m_max_dist;
+}
+
+double HashedDistanceMap::getMetricDistance(double x, double y, double z) const
+{
+    return getDistance(x, y, z);
+}
+
+double HashedDistanceMap::getCellDistance(int x, int y, int z) const
+{
+    return getDistance(x, y, z);
+}
+
+double HashedDistanceMap::getMetricSquaredDistance(
+    double x, double y, double z) const
+{
+    return getTrueMetricSquaredDistance(x, y, z);
+}
+
+double HashedDistanceMap::getCellSquaredDistance(int x, int y, int z) const
+{
+    double wx, wy, wz;
+    gridToWorld(x, y, z, wx, wy, wz);
+    return getMetricSquaredDistance(wx, wy, wz);
+}
+
+/// Return the point in world coordinates marking the center of the cell at the
+/// given effective grid coordinates.
+void HashedDistanceMap::gridToWorld(
+    int x, int y, int z,
+    double& world_x, double& world_y, double& world_z) const
+{
+    world_x = (m_origin_x) + (x) * m_res;
+    world_y = (m_origin_y) + (y) * m_res;
+    world_z = (m_origin_z) + (z) * m_res;
+}
+
+/// Return the effective grid coordinates of the cell containing the given point
+/// specified in world coordinates.
+void HashedDistanceMap::worldToGrid(
+    double world_x, double world_y, double world_z,
+    int& x, int& y, int& z) const
+{
+    x = (int)(m_inv_res * (world_x - (m_origin_x - m_res)) + 0.5) - 1;
+    y = (int)(m_inv_res * (world_y - (m_origin_y - m_res)) + 0.5) - 1;
+    z = (int)(m_inv_res * (world_z - (m_origin_z - m_res)) + 0.5) - 1;
+}
+
+/// Test if a cell is outside the bounding volume.
+bool HashedDistanceMap::isCellValid(int x, int y, int z) const
+{
+    return x >= 0 && x < m_cell_count_x &&
+        y >= 0 && y < m_cell_count_y &&
+        z >= 0 && z < m_cell_count_z;
+}
+
+size_t HashedDistanceMap::memoryUsage() const
+{
+    size_t usage =
+            (m_blocks.size() + m_spare_blocks.size()) * sizeof(Block) +
+            m_blocks.bucket_count() * sizeof(void*) +
+            m_blocks.size() * (sizeof(BlockTable::value_type) + sizeof(void*)) +
+            m_spare_blocks.capacity() * sizeof(std::unique_ptr<Block>) +
+            m_sqrt_table.capacity() * sizeof(double) +
+            m_open.capacity() * sizeof(bucket_type) +
+            m_rem_stack.capacity() * sizeof(GridCoord);
+    for (auto& bucket : m_open) {
+        usage += bucket.capacity() * sizeof(bucket_element);
+    }
+    return usage;
+}
+
+// Look up a cell without allocating its block. Cells in unallocated blocks
+// read as free cells.
+auto HashedDistanceMap::getCell(int x, int y, int z, BlockCursor& cursor) const
+    -> const Cell&
+{
+    const BlockKey key = blockKey(x, y, z);
+    if (key != cursor.key) {
+        auto it = m_blocks.find(key);
+        cursor.key = key;
+        cursor.block = it != m_blocks.end() ? it->second.get() : nullptr;
+    }
+    if (cursor.block) {
+        return cursor.block->cells[cellIndex(x, y, z)];
+    }
+    return m_free_cell;
+}
+
+// Look up a cell, allocating its block if it does not exist yet. The address
+// of the cell remains valid until its block is released.
+auto HashedDistanceMap::getCell(int x, int y, int z) -> Cell&
+{
+    const BlockKey key = blockKey(x, y, z);
+    if (key != m_last_key) {
+        std::unique_ptr<Block>& block = m_blocks[key];
+        if (!block) {
+            if (m_spare_blocks.empty()) {
+                block.reset(new Block);
+            } else {
+                block = std::move(m_spare_blocks.back());
+                m_spare_blocks.pop_back();
+            }
+            block->cells.fill(m_free_cell);
+        }
+        m_last_key = key;
+        m_last_block = block.get();
+    }
+    return m_last_block->cells[cellIndex(x, y, z)];
+}
+
+// Remove a block from the map, keeping its storage for reuse.
+void HashedDistanceMap::releaseBlock(BlockTable::iterator it)
+{
+    m_spare_blocks.push_back(std::move(it->second));
+    m_blocks.erase(it);
+}
+
+void HashedDistanceMap::resetCursor()
+{
+    m_last_key = ~BlockKey(0);
+    m_last_block = nullptr;
+}
+
+void HashedDistanceMap::relinkObstacles()
+{
+    for (auto& entry : m_blocks) {
+        for (Cell& c : entry.second->cells) {
+            if (c.obs) {
+                c.obs = &getCell(c.ox, c.oy, c.oz);
+            }
+        }
+    }
+}
+
+// Release the blocks touched by the last removal in which no cell knows its
+// nearest obstacle anymore. These cells have all returned to the free state,
+// and no other cell may refer to them, since they are not obstacles.
+void HashedDistanceMap::releaseFreeBlocks()
+{
+    std::sort(m_rem_blocks.begin(), m_rem_blocks.end());
+    m_rem_blocks.erase(
+            std::unique(m_rem_blocks.begin(), m_rem_blocks.end()),
+            m_rem_blocks.end());
+
+    for (BlockKey key : m_rem_blocks) {
+        auto it = m_blocks.find(key);
+        if (it == m_blocks.end()) {
+            continue;
+        }
+        const auto& cells = it->second->cells;
+        auto known = [](const Cell& c) { return c.obs != nullptr; };
+        if (std::none_of(cells.begin(), cells.end(), known)) {
+            releaseBlock(it);
+        }
+    }
+    m_rem_blocks.clear();
+
+    resetCursor();
+}
+
+// Propagate distances from the cells in the region [lo, hi) of the volume to
+// the cells that surround it. The surrounding cells are treated as if their
+// nearest obstacles had just been removed, so that the cells of the region
+// bordering them propagate their nearest obstacles outward, as they do into
+// cells cleared by a removal.
+void HashedDistanceMap::seedEnteringCells(
+    const Eigen::Vector3i& lo,
+    const Eigen::Vector3i& hi)
+{
+    const int xmin = std::max(lo.x() - 1, m_offset_x);
+    const int xmax = std::min(hi.x() + 1, m_offset_x + m_cell_count_x);
+    const int ymin = std::max(lo.y() - 1, m_offset_y);
+    const int ymax = std::min(hi.y() + 1, m_offset_y + m_cell_count_y);
+    const int zmin = std::max(lo.z() - 1, m_offset_z);
+    const int zmax = std::min(hi.z() + 1, m_offset_z + m_cell_count_z);
+
+    for (int x = xmin; x < xmax; ++x) {
+    for (int y = ymin; y < ymax; ++y) {
+        const bool inner =
+                x >= lo.x() && x < hi.x() &&
+                y >= lo.y() && y < hi.y();
+        if (inner) {
+            // only the cells just above and below the region
+            if (lo.z() - 1 >= zmin) {
+                m_rem_stack.emplace_back(x, y, lo.z() - 1);
+            }
+            if (hi.z() < zmax) {
+                m_rem_stack.emplace_back(x, y, hi.z());
+            }
+        } else {
+            for (int z = zmin; z < zmax; ++z) {
+                m_rem_stack.emplace_back(x, y, z);
+            }
+        }
+    }
+    }
+
+    propagateRemovals();
+}
+
+void HashedDistanceMap::updateVertex(Cell* o, int cx, int cy, int cz)
+{
+    const int key = std::min(o->dist, o->dist_new);
+    assert(key < m_open.size());
+    if (o->bucket >= 0) { // update in heap
+        assert(o->bucket < m_open.size());
+
+        // swap places with last element and remove from end of current bucket
+        bucket_element& e = m_open[o->bucket][o->pos];
+        e = m_open[o->bucket].back();
+        e.c->pos = o->pos;
+        m_open[o->bucket].pop_back();
+
+        // place at the end of new bucket
+        o->pos = m_open[key].size();
+        m_open[key].emplace_back(o, cx, cy, cz);
+        o->bucket = key;
+    } else { // not in the heap yet
+        // place at the end of new bucket
+        o->pos = m_open[key].size();
+        m_open[key].emplace_back(o, cx, cy, cz);
+        o->bucket = key;
+    }
+    if (key < m_bucket) {
+        m_bucket = key;
+    }
+}
+
+int HashedDistanceMap::distance(int nx, int ny, int nz, const Cell& s)
+{
+    int dx = nx - s.ox;
+    int dy = ny - s.oy;
+    int dz = nz - s.oz;
+
+    return dx * dx + dy * dy + dz * dz;
+}
+
+void HashedDistanceMap::lower(Cell* s, int sx, int sy, int sz)
+{
+    BlockCursor cursor;
+    int nfirst, nlast;
+    std::tie(nfirst, nlast) = m_neighbor_ranges[s->dir];
+    for (int i = nfirst; i != nlast; ++i) {
+        const Eigen::Vector3i& neighbor = m_neighbors[m_indices[i]];
+        const Eigen::Vector3i& nx = Eigen::Vector3i(sx, sy, sz) + neighbor;
+        if (!inVolume(nx)) {
+            continue;
+        }
+
+        // test against a read-only lookup first to avoid allocating blocks
+        // at the fringe of the propagation
+        int dp = distance(nx.x(), nx.y(), nx.z(), *s);
+        if (dp < getCell(nx.x(), nx.y(), nx.z(), cursor).dist_new) {
+            Cell* n = &getCell(nx.x(), nx.y(), nx.z());
+            if (!cursor.block) {
+                cursor = BlockCursor(); // the block was just allocated
+            }
+            n->dist_new = dp;
+            n->obs = s->obs;
+            n->ox = s->ox;
+            n->oy = s->oy;
+            n->oz = s->oz;
+            n->dir = m_neighbor_dirs[i];
+            updateVertex(n, nx.x(), nx.y(), nx.z());
+        }
+    }
+}
+
+void HashedDistanceMap::raise(Cell* s, int sx, int sy, int sz)
+{
+    int nfirst, nlast;
+    std::tie(nfirst, nlast) = m_neighbor_ranges[NO_UPDATE_DIR];
+    for (int i = nfirst; i != nlast; ++i) {
+        const Eigen::Vector3i& neighbor = m_neighbors[m_indices[i]];
+        const Eigen::Vector3i& nx = Eigen::Vector3i(sx, sy, sz) + neighbor;
+        if (!inVolume(nx)) {
+            continue;
+        }
+        Cell* n = &getCell(nx.x(), nx.y(), nx.z());
+        waveout(n, nx.x(), nx.y(), nx.z());
+    }
+    waveout(s, sx, sy, sz);
+}
+
+void HashedDistanceMap::waveout(Cell* n, int nx, int ny, int nz)
+{
+    if (n == n->obs) {
+        return;
+    }
+
+    n->dist_new = m_dmax_sqrd_int;
+    Cell* obs_old = n->obs;
+    n->obs = nullptr;
+    n->ox = n->oy = n->oz = -1;
+
+    BlockCursor cursor;
+    int nfirst, nlast;
+    std::tie(nfirst, nlast) = m_neighbor_ranges[NO_UPDATE_DIR];
+    for (int i = nfirst; i != nlast; ++i) {
+        const Eigen::Vector3i& neighbor = m_neighbors[m_indices[i]];
+        const Eigen::Vector3i& ax = Eigen::Vector3i(nx, ny, nz) + neighbor;
+        if (!inVolume(ax)) {
+            continue;
+        }
+        const Cell* a = &getCell(ax.x(), ax.y(), ax.z(), cursor);
+        auto valid = [](const Cell* c) { return c && c->obs == c; };
+        if (valid(a->obs)) {
+            int dp = distance(nx, ny, nz, *a);
+            if (dp < n->dist_new) {
+                n->dist_new = dp;
+                n->obs = a->obs;
+                n->ox = a->ox;
+                n->oy = a->oy;
+                n->oz = a->oz;
+                n->dir = NO_UPDATE_DIR;
+            }
+        }
+    }
+
+    if (n->obs != obs_old) {
+        updateVertex(n, nx, ny, nz);
+    }
+}
+
+void HashedDistanceMap::propagate()
+{
+    while (m_bucket < (int)m_open.size()) {
+        while (!m_open[m_bucket].empty()) {
+            assert(m_bucket >= 0 && m_bucket < m_open.size());
+
+            bucket_element e = m_open[m_bucket].back();
+            m_open[m_bucket].pop_back();
+            Cell* s = e.c;
+            s->bucket = -1;
+
+            if (s->dist_new < s->dist) {
+                s->dist = s->dist_new;
+
+                // foreach n in adj(min)
+                lower(s, e.x, e.y, e.z);
+
+#if SMPL_DMAP_RETURN_CHANGED_CELLS
+                if (s->dist != s->dist_old) {
+                    // insert(C, s)
+                    s->dist_old = s->dist;
+                }
+#endif
+            } else {
+                s->dist = m_dmax_sqrd_int;
+                s->dir = NO_UPDATE_DIR;
+                raise(s, e.x, e.y, e.z);
+                if (s->dist != s->dist_new) {
+                    updateVertex(s, e.x, e.y, e.z);
+                }
+            }
+        }
+        ++m_bucket;
+    }
+}
+
+void HashedDistanceMap::propagateRemovals()
+{
+    while (!m_rem_stack.empty()) {
+        GridCoord e = m_rem_stack.back();
+        m_rem_stack.pop_back();
+        m_rem_blocks.push_back(blockKey(e.x, e.y, e.z));
+
+        BlockCursor cursor;
+        int nfirst, nlast;
+        std::tie(nfirst, nlast) = m_neighbor_ranges[NO_UPDATE_DIR];
+        for (int i = nfirst; i != nlast; ++i) {
+            const Eigen::Vector3i& neighbor = m_neighbors[m_indices[i]];
+            const Eigen::Vector3i& nx = Eigen::Vector3i(e.x, e.y, e.z) + neighbor;
+            if (!inVolume(nx)) {
+                continue;
+            }
+            // cells in unallocated blocks are free and need no update
+            if (&getCell(nx.x(), nx.y(), nx.z(), cursor) == &m_free_cell) {
+                continue;
+            }
+            Cell* n = &getCell(nx.x(), nx.y(), nx.z());
+            auto valid = [](Cell* c) { return c && c->obs == c; };
+            if (!valid(n->obs)) {
+                if (n->dist_new != m_dmax_sqrd_int) {
+                    n->dist_new = m_dmax_sqrd_int;
+                    n->dist = m_dmax_sqrd_int;
+                    n->obs = nullptr;
+                    n->ox = n->oy = n->oz = -1;
+                    n->dir = NO_UPDATE_DIR;
+                    m_rem_stack.emplace_back(nx.x(), nx.y(), nx.z());
+                }
+            } else {
+                updateVertex(n, nx.x(), nx.y(), nx.z());
+            }
+        }
+    }
+
+    propagateBorder();
+
+    releaseFreeBlocks();
+}
+
+void HashedDistanceMap::propagateBorder()
+{
+    while (m_bucket < (int)m_open.size()) {
+        while (!m_open[m_bucket].empty()) {
+            assert(m_bucket >= 0 && m_bucket < m_open.size());
+            bucket_element e = m_open[m_bucket].back();
+            m_open[m_bucket].pop_back();
+            Cell* s = e.c;
+            s->bucket = -1;
+
+            assert(s->dist_new <= s->dist);
+            s->dist = s->dist_new;
+
+            // foreach n in adj(min)
+            lower(s, e.x, e.y, e.z);
+
+#if SMPL_DMAP_RETURN_CHANGED_CELLS
+            if (s->dist != s->dist_old) {
+                // insert(C, s)
+                s->dist_old = s->dist;
+            }
+#endif
+        }
+        ++m_bucket;
+    }
+}
+
+/// Return the distance from a world point to nearest point on (or within)
+/// the nearest occupied voxel. This function proceeds by computing the
+/// distances between the world point and the nearest point on (or within) the
+/// nearest obstacle cells for all of its 27-nearest cell neighbors and taking
+/// the minimum distance.
+double HashedDistanceMap::getTrueMetricSquaredDistance(
+    double x, double y, double z) const
+{
+    int gpx, gpy, gpz;
+    worldToGrid(x, y, z, gpx, gpy, gpz);
+
+    if (!HashedDistanceMap::isCellValid(gpx, gpy, gpz)) {
+        return 0.0;
+    }
+
+    // continue with coordinates relative to the original origin, in which the
+    // nearest obstacle cells are stored
+    gpx += m_offset_x;
+    gpy += m_offset_y;
+    gpz += m_offset_z;
+
+    const double ox = m_anchor_x;
+    const double oy = m_anchor_y;
+    const double oz = m_anchor_z;
+    const double res = resolution();
+    const double half_res = 0.5 * res;
+
+    // Compute the squared distance from (x, y, z) to the nearest point on
+    //  the obstacle cell positioned at \p npos
+    auto nearestEdgeDist = [&](int nx, int ny, int nz) {
+        // nearest obstacle cell -> nearest obstacle center
+        double nnx = ox + res * nx;
+        double nny = oy + res * ny;
+        double nnz = oz + res * nz;
+
+        // nearest obstacle center -> nearest obstacle corner/edge/face
+        if (gpx > nx) {
+            nnx += half_res;
+        } else if (gpx < nx) {
+            nnx -= half_res;
+        } else {
+            nnx = x;
+        }
+
+        if (gpy > ny) {
+            nny += half_res;
+        } else if (gpy < ny) {
+            nny -= half_res;
+        } else {
+            nny = y;
+        }
+
+        if (gpz > nz) {
+            nnz += half_res;
+        } else if (gpz < nz) {
+            nnz -= half_res;
+        } else {
+            nnz = z;
+        }
+
+        const double dx = x - nnx;
+        const double dy = y - nny;
+        const double dz = z - nnz;
+
+        return dx * dx + dy * dy + dz * dz;
+    };
+
+    double min_d2 = res * res * m_dmax_sqrd_int;
+    bool conservative = false;
+
+    // check the 27 nearest cells and take the minimum of the distances from
+    // (x, y, z) to their nearest obstacles
+    BlockCursor cursor;
+    for (int gppx = gpx - 1; gppx != gpx + 2; ++gppx) {
+    for (int gppy = gpy - 1; gppy != gpy + 2; ++gppy) {
+    for (int gppz = gpz - 1; gppz != gpz + 2; ++gppz) {
+        if (!inVolume(gppx, gppy, gppz)) {
+            continue;
+        }
+
+        const Cell& c = getCell(gppx, gppy, gppz, cursor);
+        if (c.obs) { // known nearest obstacle -> nearest distance to it
+            const double d2 = nearestEdgeDist(c.ox, c.oy, c.oz);
+            if (d2 < min_d2) {
+                min_d2 = d2;
+            }
+        } else { // unknown nearest obstacle -> conservative nearest distance
+            conservative = true;
+        }
+    } } }
+
+    if (conservative) {
+        const double d = m_sqrt_table[m_dmax_sqrd_int] - m_error;
+        const double d2 = d * d;
+        if (d2 < min_d2) {
+            min_d2 = d2;
+        }
+    }
+
+    return min_d2;
+}
+
+} // namespace smpl
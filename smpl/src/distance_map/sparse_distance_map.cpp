@@ -125,9 +125,39 @@ bool SparseDistanceMap::isCellValid(const Eigen::Vector3i& gp) const
         gp.z() >= 0 & gp.z() < m_cell_count_z;
 }
 
+/// Rebuild the underlying cell storage contiguously in breadth-first order.
+/// Intended to be called once the map has been built, to improve the locality
+/// of subsequent lookups and updates, and to release storage retained from
+/// cells that have since been pruned.
+void SparseDistanceMap::compact()
+{
+    m_cells.compact();
+    relinkObstacles();
+}
+
 DistanceMapInterface* SparseDistanceMap::clone() const
 {
-    return new SparseDistanceMap(*this);
+    auto* dmap = new SparseDistanceMap(*this);
+    dmap->relinkObstacles();
+    return dmap;
+}
+
+// Point each cell's nearest obstacle pointer back into this map's cells, after
+// they have been copied or moved. Obstacle cells are never pruned, so they
+// already exist as unique leaves and can be looked up without expanding any
+// nodes during the traversal.
+void SparseDistanceMap::relinkObstacles()
+{
+    using size_type = CellGrid::size_type;
+    m_cells.accept_coords([&](
+        Cell& c,
+        size_type, size_type, size_type,
+        size_type, size_type, size_type)
+    {
+        if (c.obs) {
+            c.obs = const_cast<Cell*>(&m_cells.get(c.ox, c.oy, c.oz));
+        }
+    });
 }
 
 /// Add a set of obstacle points to the distance map and update the distance
@@ -360,6 +390,18 @@ bool SparseDistanceMap::isCellValid(int x, int y, int z) const
         z >= 0 & z < m_cell_count_z;
 }
 
+size_t SparseDistanceMap::memoryUsage() const
+{
+    size_t usage = m_cells.mem_usage() +
+            m_sqrt_table.capacity() * sizeof(double) +
+            m_open.capacity() * sizeof(bucket_type) +
+            m_rem_stack.capacity() * sizeof(GridCoord);
+    for (auto& bucket : m_open) {
+        usage += bucket.capacity() * sizeof(bucket_element);
+    }
+    return usage;
+}
+
 void SparseDistanceMap::updateVertex(Cell* o, int cx, int cy, int cz)
 {
     const int key = std::min(o->dist, o->dist_new);
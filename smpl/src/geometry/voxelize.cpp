@@ -33,6 +33,7 @@
 #include <cmath>
 #include <cstdlib>
 #include <algorithm>
+#include <thread>
 #include <utility>
 
 // project includes
@@ -44,6 +45,10 @@
 namespace smpl {
 namespace geometry {
 
+// Meshes with fewer triangles than this per available hardware thread are
+// voxelized on the calling thread.
+static const size_t MinTrianglesPerThread = 1024;
+
 //////////////////////////////////
 // Static Function Declarations //
 //////////////////////////////////
@@ -127,11 +132,63 @@ void VoxelizeMeshAwesome(
     const std::vector<std::uint32_t>& indices,
     VoxelGrid<Discretizer>& vg)
 {
-    for (size_t i = 0; i < indices.size(); i += 3) {
-        auto& a = vertices[indices[i + 0]];
-        auto& b = vertices[indices[i + 1]];
-        auto& c = vertices[indices[i + 2]];
-        VoxelizeTriangle(a, b, c, vg);
+    const size_t triangle_count = indices.size() / 3;
+
+    size_t thread_count = std::thread::hardware_concurrency();
+    thread_count = std::min(thread_count, triangle_count / MinTrianglesPerThread);
+    thread_count = std::min(thread_count, (size_t)vg.sizeX());
+
+    if (thread_count <= 1) {
+        for (size_t i = 0; i < indices.size(); i += 3) {
+            auto& a = vertices[indices[i + 0]];
+            auto& b = vertices[indices[i + 1]];
+            auto& c = vertices[indices[i + 2]];
+            VoxelizeTriangle(a, b, c, vg);
+        }
+        return;
+    }
+
+    // Partition the grid into slabs along x. Each thread voxelizes the part of
+    // every triangle that overlaps its own slab, so no two threads ever touch
+    // the same voxel.
+    const GridCoord min = vg.memoryToGrid(MemoryCoord(0, 0, 0));
+    const GridCoord max = vg.memoryToGrid(
+            MemoryCoord(vg.sizeX() - 1, vg.sizeY() - 1, vg.sizeZ() - 1));
+
+    auto voxelize_slab = [&](int slab_min_x, int slab_max_x)
+    {
+        const GridCoord slab_min(slab_min_x, min.y, min.z);
+        const GridCoord slab_max(slab_max_x, max.y, max.z);
+        for (size_t i = 0; i < indices.size(); i += 3) {
+            auto& a = vertices[indices[i + 0]];
+            auto& b = vertices[indices[i + 1]];
+            auto& c = vertices[indices[i + 2]];
+
+            // skip triangles that lie entirely outside of this slab before
+            // paying for the triangle setup
+            auto tri_min_x = std::min(a.x(), std::min(b.x(), c.x()));
+            auto tri_max_x = std::max(a.x(), std::max(b.x(), c.x()));
+            if (vg.worldToGrid(WorldCoord(tri_max_x, 0.0, 0.0)).x < slab_min_x ||
+                vg.worldToGrid(WorldCoord(tri_min_x, 0.0, 0.0)).x > slab_max_x)
+            {
+                continue;
+            }
+
+            VoxelizeTriangle(a, b, c, slab_min, slab_max, vg);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(thread_count);
+    const int width = max.x - min.x + 1;
+    for (size_t i = 0; i < thread_count; ++i) {
+        int slab_min_x = min.x + (int)(i * width / thread_count);
+        int slab_max_x = min.x + (int)((i + 1) * width / thread_count) - 1;
+        threads.emplace_back(voxelize_slab, slab_min_x, slab_max_x);
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
     }
 }
 
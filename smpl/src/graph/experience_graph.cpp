@@ -2,6 +2,7 @@
 
 #include <assert.h>
 #include <algorithm>
+#include <atomic>
 #include <stdexcept>
 
 namespace smpl {
@@ -310,9 +311,16 @@ bool ExperienceGraph::edge(node_id uid, node_id vid) const
     return false;
 }
 
+auto ExperienceGraph::next_version() -> std::uint64_t
+{
+    static std::atomic<std::uint64_t> version(0);
+    return ++version;
+}
+
 /// Insert a node.
 auto ExperienceGraph::insert_node(const RobotState& state) -> node_id
 {
+    m_version = next_version();
     m_nodes.emplace_back(state);
     return m_nodes.size() - 1;
 }
@@ -326,6 +334,8 @@ void ExperienceGraph::erase_node(node_id id)
         throw std::out_of_range("ExperienceGraph::erase_node called with invalid node id");
     }
 
+    m_version = next_version();
+
     auto& rem_node = m_nodes[id];
 
     // the number of edges to be removed and the smallest id, for updating
@@ -407,6 +417,7 @@ auto ExperienceGraph::insert_edge(node_id uid, node_id vid) -> edge_id
         throw std::out_of_range("ExperienceGraph::insert_edge called with invalid node ids");
     }
 
+    m_version = next_version();
     m_edges.emplace_back(uid, vid);
     ExperienceGraph::edge_id eid = m_edges.size() - 1;
     insert_incident_edge(this, eid, uid, vid);
@@ -425,6 +436,7 @@ auto ExperienceGraph::insert_edge(
         throw std::out_of_range("ExperienceGraph::insert_edge called with invalid node ids");
     }
 
+    m_version = next_version();
     m_edges.emplace_back(path, uid, vid);
     ExperienceGraph::edge_id eid = m_edges.size() - 1;
     insert_incident_edge(this, eid, uid, vid);
@@ -477,6 +489,8 @@ void ExperienceGraph::erase_edge(edge_id id)
         throw std::out_of_range("ExperienceGraph::erase_edge called with invalid edge id");
     }
 
+    m_version = next_version();
+
     auto& e = m_edges[id];
 
     // remove incident edge from source node and update edge ids
@@ -516,6 +530,7 @@ void ExperienceGraph::erase_edge(edge_id id)
 
 void ExperienceGraph::clear()
 {
+    m_version = next_version();
     m_nodes.clear();
     m_edges.clear();
     m_shift.clear();
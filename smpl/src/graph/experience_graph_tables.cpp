@@ -0,0 +1,161 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2018, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#include <smpl/graph/experience_graph_tables.h>
+
+// standard includes
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+namespace smpl {
+
+// Edges are unioned on the calling thread unless there are at least this many
+// edges per available hardware thread.
+static const size_t MinEdgesPerThread = 4096;
+
+// Concurrent union-find. The root of every set is its lowest node id, so the
+// final forest is the same regardless of the order edges are unioned in.
+static auto FindRoot(std::atomic<size_t>* parents, size_t n) -> size_t
+{
+    while (true) {
+        size_t p = parents[n].load(std::memory_order_relaxed);
+        if (p == n) {
+            return n;
+        }
+        size_t gp = parents[p].load(std::memory_order_relaxed);
+        if (gp != p) {
+            // path halving; losing the race leaves a valid, longer path
+            parents[n].compare_exchange_weak(p, gp, std::memory_order_relaxed);
+        }
+        n = gp;
+    }
+}
+
+static void Union(std::atomic<size_t>* parents, size_t u, size_t v)
+{
+    while (true) {
+        u = FindRoot(parents, u);
+        v = FindRoot(parents, v);
+        if (u == v) {
+            return;
+        }
+        if (u < v) {
+            std::swap(u, v);
+        }
+        // link the higher root under the lower root, unless another thread
+        // has linked it elsewhere first
+        size_t expected = u;
+        if (parents[u].compare_exchange_strong(
+                expected, v, std::memory_order_relaxed))
+        {
+            return;
+        }
+    }
+}
+
+int ComputeConnectedComponents(
+    const ExperienceGraph& eg,
+    std::vector<int>& component_ids)
+{
+    const size_t node_count = eg.num_nodes();
+    const size_t edge_count = eg.num_edges();
+
+    std::unique_ptr<std::atomic<size_t>[]> parents(
+            new std::atomic<size_t>[node_count]);
+    for (size_t n = 0; n < node_count; ++n) {
+        parents[n].store(n, std::memory_order_relaxed);
+    }
+
+    auto union_edges = [&](size_t begin, size_t end)
+    {
+        for (size_t e = begin; e < end; ++e) {
+            Union(parents.get(), eg.source(e), eg.target(e));
+        }
+    };
+
+    size_t thread_count = std::thread::hardware_concurrency();
+    thread_count = std::min(thread_count, edge_count / MinEdgesPerThread);
+    if (thread_count <= 1) {
+        union_edges(0, edge_count);
+    } else {
+        std::vector<std::thread> threads;
+        threads.reserve(thread_count);
+        for (size_t i = 0; i < thread_count; ++i) {
+            size_t begin = i * edge_count / thread_count;
+            size_t end = (i + 1) * edge_count / thread_count;
+            threads.emplace_back(union_edges, begin, end);
+        }
+
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    // every root is the lowest node in its component, so it is labeled
+    // before any other node in its component
+    int comp_count = 0;
+    component_ids.resize(node_count);
+    for (size_t n = 0; n < node_count; ++n) {
+        size_t root = FindRoot(parents.get(), n);
+        if (root == n) {
+            component_ids[n] = comp_count++;
+        } else {
+            component_ids[n] = component_ids[root];
+        }
+    }
+
+    return comp_count;
+}
+
+void BuildExperienceGraphTables(
+    const ExperienceGraph& eg,
+    ExperienceGraphTables& tables)
+{
+    tables.graph_version = eg.version();
+    tables.component_count = ComputeConnectedComponents(eg, tables.component_ids);
+}
+
+void UpdateExperienceGraphTables(
+    const ExperienceGraph& eg,
+    ExperienceGraphTables& tables)
+{
+    if (tables.graph_version == eg.version() &&
+        tables.component_ids.size() == eg.num_nodes())
+    {
+        return;
+    }
+
+    BuildExperienceGraphTables(eg, tables);
+}
+
+} // namespace smpl
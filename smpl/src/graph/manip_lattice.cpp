@@ -33,6 +33,7 @@
 #include <smpl/graph/manip_lattice.h>
 
 // standard includes
+#include <algorithm>
 #include <iomanip>
 #include <sstream>
 
@@ -92,6 +93,7 @@ bool ManipLattice::init(
     }
 
     m_fk_iface = _robot->getExtension<ForwardKinematicsInterface>();
+    m_batch_checker = checker->getExtension<BatchCollisionCheckExtension>();
 
     m_min_limits.resize(_robot->jointVariableCount());
     m_max_limits.resize(_robot->jointVariableCount());
@@ -136,6 +138,37 @@ bool ManipLattice::init(
     m_coord_vals = std::move(discretization);
     m_coord_deltas = std::move(deltas);
 
+    // coordinates of bounded and continuous variables have a fixed range, so
+    // they may be packed into a single key if their widths total 64 bits or
+    // less
+    m_var_disc.resize(_robot->jointVariableCount());
+    m_pack_coords = true;
+    int total_bits = 0;
+    for (size_t vidx = 0; vidx < _robot->jointVariableCount(); ++vidx) {
+        auto& vd = m_var_disc[vidx];
+        vd.offset = m_continuous[vidx] || !m_bounded[vidx] ? 0.0 : m_min_limits[vidx];
+        vd.delta = m_coord_deltas[vidx];
+        vd.round_neg = m_continuous[vidx] || m_bounded[vidx] ? 0.5 : -0.5;
+        vd.wrap = m_continuous[vidx] ? m_coord_vals[vidx] : 0;
+
+        vd.bits = 0;
+        if (m_continuous[vidx] || m_bounded[vidx]) {
+            // bounded variables include both limits
+            auto count = (std::uint64_t)m_coord_vals[vidx] + (m_continuous[vidx] ? 0 : 1);
+            while (((std::uint64_t)1 << vd.bits) < count) {
+                ++vd.bits;
+            }
+            total_bits += vd.bits;
+        } else {
+            m_pack_coords = false;
+        }
+    }
+    if (total_bits > 64) {
+        m_pack_coords = false;
+    }
+
+    SMPL_DEBUG_NAMED(G_LOG, "  pack coords: %s (%d bits)", m_pack_coords ? "true" : "false", total_bits);
+
     m_actions = actions;
 
     return true;
@@ -233,6 +266,9 @@ void ManipLattice::GetSuccs(
     SMPL_DEBUG_NAMED(G_EXPANSIONS_LOG, "  actions: %zu", actions.size());
 
     // check actions for validity
+    std::vector<bool> valid;
+    checkActions(parent_entry->state, actions, valid);
+
     RobotCoord succ_coord(robot()->jointVariableCount(), 0);
     for (size_t i = 0; i < actions.size(); ++i) {
         auto& action = actions[i];
@@ -240,7 +276,7 @@ void ManipLattice::GetSuccs(
         SMPL_DEBUG_NAMED(G_EXPANSIONS_LOG, "    action %zu:", i);
         SMPL_DEBUG_NAMED(G_EXPANSIONS_LOG, "      waypoints: %zu", action.size());
 
-        if (!checkAction(parent_entry->state, action)) {
+        if (!valid[i]) {
             continue;
         }
 
@@ -281,6 +317,13 @@ void ManipLattice::GetSuccs(
     }
 }
 
+static
+auto LazyEdgeKey(int parent_id, int child_id) -> std::uint64_t
+{
+    return ((std::uint64_t)(std::uint32_t)parent_id << 32) |
+            (std::uint64_t)(std::uint32_t)child_id;
+}
+
 Stopwatch GetLazySuccsStopwatch("GetLazySuccs", 10);
 
 void ManipLattice::GetLazySuccs(
@@ -322,6 +365,9 @@ void ManipLattice::GetLazySuccs(
 
     SMPL_DEBUG_NAMED(G_EXPANSIONS_LOG, "  actions: %zu", actions.size());
 
+    // identifies the edges recorded by this expansion
+    const auto generation = ++m_lazy_action_generation;
+
     int goal_succ_count = 0;
     RobotCoord succ_coord(robot()->jointVariableCount());
     for (size_t i = 0; i < actions.size(); ++i) {
@@ -340,11 +386,22 @@ void ManipLattice::GetLazySuccs(
         int succ_state_id = getOrCreateState(succ_coord, action.back());
         ManipLatticeState* succ_entry = getHashEntry(succ_state_id);
 
-        if (succ_is_goal_state) {
-            succs->push_back(m_goal_state_id);
-        } else {
-            succs->push_back(succ_state_id);
+        const int child_id = succ_is_goal_state ? m_goal_state_id : succ_state_id;
+
+        // remember the action for GetTrueCost, replacing actions recorded
+        // by a previous expansion of this state
+        if (m_lazy_action_capacity != 0) {
+            auto key = LazyEdgeKey(state_id, child_id);
+            auto& edge = m_lazy_actions[key];
+            if (edge.generation != generation) {
+                edge.generation = generation;
+                edge.actions.clear();
+                m_lazy_action_order.emplace_back(key, generation);
+            }
+            edge.actions.push_back(LazyAction{ succ_state_id, std::move(action) });
         }
+
+        succs->push_back(child_id);
         costs->push_back(cost(state_entry, succ_entry, succ_is_goal_state));
         true_costs->push_back(false);
 
@@ -356,6 +413,8 @@ void ManipLattice::GetLazySuccs(
         SMPL_DEBUG_NAMED(G_EXPANSIONS_LOG, "        cost: %5d", cost(state_entry, succ_entry, succ_is_goal_state));
     }
 
+    evictLazyActions();
+
     if (goal_succ_count > 0) {
         SMPL_DEBUG_NAMED(G_EXPANSIONS_LOG, "Got %d goal successors!", goal_succ_count);
     }
@@ -382,14 +441,50 @@ int ManipLattice::GetTrueCost(int parentID, int childID)
     auto* vis_name = "expansion";
     SV_SHOW_DEBUG_NAMED(vis_name, getStateVisualization(parent_angles, vis_name));
 
+    auto goal_edge = (childID == m_goal_state_id);
+
+    // check the actions recorded for this edge by GetLazySuccs and find the
+    // valid action with the least cost
+    auto lit = m_lazy_actions.find(LazyEdgeKey(parentID, childID));
+    if (lit != m_lazy_actions.end()) {
+        auto lazy_actions = std::move(lit->second.actions);
+        m_lazy_actions.erase(lit);
+
+        int best_cost = std::numeric_limits<int>::max();
+        for (size_t aidx = 0; aidx < lazy_actions.size(); ++aidx) {
+            auto& lazy_action = lazy_actions[aidx];
+
+            SMPL_DEBUG_NAMED(G_EXPANSIONS_LOG, "    action %zu:", aidx);
+            SMPL_DEBUG_NAMED(G_EXPANSIONS_LOG, "      waypoints %zu:", lazy_action.action.size());
+
+            if (!checkAction(parent_angles, lazy_action.action)) {
+                continue;
+            }
+
+            ManipLatticeState* succ_entry = getHashEntry(lazy_action.succ_id);
+            assert(succ_entry);
+
+            auto edge_cost = cost(parent_entry, succ_entry, goal_edge);
+            if (edge_cost < best_cost) {
+                best_cost = edge_cost;
+            }
+        }
+
+        if (best_cost != std::numeric_limits<int>::max()) {
+            return best_cost;
+        } else {
+            return -1;
+        }
+    }
+
+    // otherwise, regenerate the actions from the parent and check those that
+    // reach the child
     std::vector<Action> actions;
     if (!m_actions->apply(parent_angles, actions)) {
         SMPL_WARN("Failed to get actions");
         return -1;
     }
 
-    auto goal_edge = (childID == m_goal_state_id);
-
     size_t num_actions = 0;
 
     // check actions for validity and find the valid action with the least cost
@@ -454,12 +549,96 @@ bool ManipLattice::projectToPose(int state_id, Affine3& pose)
     return true;
 }
 
+/// Get the predecessors of a state. Motion primitives are added along with
+/// their converses, so the candidate predecessors are the states reached by
+/// applying the actions from the state itself. A candidate is kept only if one
+/// of its own valid actions leads back to the state, which excludes the
+/// candidates generated by actions without a converse. Predecessors of the goal
+/// state are only available for joint state goals, where they are the states
+/// with a valid action into the goal region, found from the goal configuration.
 void ManipLattice::GetPreds(
     int state_id,
     std::vector<int>* preds,
     std::vector<int>* costs)
 {
-    SMPL_WARN("GetPreds unimplemented");
+    assert(state_id >= 0 && state_id < (int)m_states.size() && "state id out of bounds");
+    assert(preds && costs && "predecessor buffer is null");
+    assert(m_actions && "action space is uninitialized");
+
+    SMPL_DEBUG_NAMED(G_EXPANSIONS_LOG, "expanding predecessors of state %d", state_id);
+
+    ManipLatticeState* state_entry = m_states[state_id];
+    const bool goal_state = (state_id == m_goal_state_id);
+
+    RobotCoord coord;
+    RobotState state;
+    if (goal_state) {
+        if (goal().type != GoalType::JOINT_STATE_GOAL) {
+            SMPL_WARN_ONCE("GetPreds of the goal state is only implemented for joint state goals");
+            return;
+        }
+        state = goal().angles;
+        coord.resize(robot()->jointVariableCount());
+        stateToCoord(state, coord);
+    } else {
+        assert(state_entry);
+        state = state_entry->state;
+        coord = state_entry->coord;
+    }
+
+    std::vector<Action> actions;
+    if (!m_actions->apply(state, actions)) {
+        SMPL_WARN("Failed to get actions");
+        return;
+    }
+
+    const size_t first_pred = preds->size();
+
+    std::vector<Action> pred_actions;
+    RobotCoord pred_coord(robot()->jointVariableCount());
+    RobotCoord succ_coord(robot()->jointVariableCount());
+    for (auto& action : actions) {
+        stateToCoord(action.back(), pred_coord);
+        if (pred_coord == coord) {
+            continue;
+        }
+
+        int pred_id = getOrCreateState(pred_coord, action.back());
+        if (std::find(preds->begin() + first_pred, preds->end(), pred_id) != preds->end()) {
+            continue;
+        }
+
+        ManipLatticeState* pred_entry = getHashEntry(pred_id);
+
+        pred_actions.clear();
+        if (!m_actions->apply(pred_entry->state, pred_actions)) {
+            continue;
+        }
+
+        for (auto& pred_action : pred_actions) {
+            if (goal_state) {
+                if (!isGoal(pred_action.back())) {
+                    continue;
+                }
+            } else {
+                stateToCoord(pred_action.back(), succ_coord);
+                if (succ_coord != coord) {
+                    continue;
+                }
+            }
+
+            if (!checkAction(pred_entry->state, pred_action)) {
+                continue;
+            }
+
+            preds->push_back(pred_id);
+            costs->push_back(cost(pred_entry, state_entry, goal_state));
+
+            SMPL_DEBUG_NAMED(G_EXPANSIONS_LOG, "      pred: %d", pred_id);
+            SMPL_DEBUG_STREAM_NAMED(G_EXPANSIONS_LOG, "        coord: " << pred_coord);
+            break;
+        }
+    }
 }
 
 // angles are counterclockwise from 0 to 360 in radians, 0 is the center of bin
@@ -471,14 +650,9 @@ void ManipLattice::coordToState(
     assert((int)state.size() == robot()->jointVariableCount() &&
             (int)coord.size() == robot()->jointVariableCount());
 
+    const VariableDiscretization* vd = m_var_disc.data();
     for (size_t i = 0; i < coord.size(); ++i) {
-        if (m_continuous[i]) {
-            state[i] = coord[i] * m_coord_deltas[i];
-        } else if (!m_bounded[i]) {
-            state[i] = (double)coord[i] * m_coord_deltas[i];
-        } else {
-            state[i] = m_min_limits[i] + coord[i] * m_coord_deltas[i];
-        }
+        state[i] = vd[i].offset + coord[i] * vd[i].delta;
     }
 }
 
@@ -489,24 +663,78 @@ void ManipLattice::stateToCoord(
     assert((int)state.size() == robot()->jointVariableCount() &&
             (int)coord.size() == robot()->jointVariableCount());
 
+    const VariableDiscretization* vd = m_var_disc.data();
     for (size_t i = 0; i < state.size(); ++i) {
-        if (m_continuous[i]) {
+        if (vd[i].wrap) {
             auto pos_angle = normalize_angle_positive(state[i]);
+            int c = (int)((pos_angle + vd[i].delta * 0.5) / vd[i].delta);
+            coord[i] = c == vd[i].wrap ? 0 : c;
+        } else {
+            // positions of bounded variables are rounded up from the lower
+            // limit; positions of unbounded variables are rounded away from 0
+            auto pos = (state[i] - vd[i].offset) / vd[i].delta;
+            coord[i] = (int)(pos + (pos >= 0.0 ? 0.5 : vd[i].round_neg));
+        }
+    }
+}
 
-            coord[i] = (int)((pos_angle + m_coord_deltas[i] * 0.5) / m_coord_deltas[i]);
+/// Pack a coordinate into a single integer key. Return false if the
+/// coordinates cannot be packed or this coordinate lies outside the limits.
+bool ManipLattice::packCoord(const RobotCoord& coord, std::uint64_t& key) const
+{
+    if (!m_pack_coords) {
+        return false;
+    }
 
-            if (coord[i] == m_coord_vals[i]) {
-                coord[i] = 0;
-            }
-        } else if (!m_bounded[i]) {
-            if (state[i] >= 0.0) {
-                coord[i] = (int)(state[i] / m_coord_deltas[i] + 0.5);
-            } else {
-                coord[i] = (int)(state[i] / m_coord_deltas[i] - 0.5);
-            }
-        } else {
-            coord[i] = (int)(((state[i] - m_min_limits[i]) / m_coord_deltas[i]) + 0.5);
+    const VariableDiscretization* vd = m_var_disc.data();
+    std::uint64_t k = 0;
+    for (size_t i = 0; i < coord.size(); ++i) {
+        auto c = (std::uint64_t)(std::uint32_t)coord[i];
+        if (c >> vd[i].bits) {
+            return false;
+        }
+        k = (k << vd[i].bits) | c;
+    }
+    key = k;
+    return true;
+}
+
+void ManipLattice::clearLazyActions()
+{
+    m_lazy_actions.clear();
+    m_lazy_action_order.clear();
+}
+
+// Evict the edges recorded longest ago until at most m_lazy_action_capacity
+// edges remain, and drop the order entries of edges that have since been
+// consumed or recorded again.
+void ManipLattice::evictLazyActions()
+{
+    auto live = [&](const std::pair<std::uint64_t, std::uint64_t>& entry) {
+        auto it = m_lazy_actions.find(entry.first);
+        return it != m_lazy_actions.end() && it->second.generation == entry.second;
+    };
+
+    while (!m_lazy_action_order.empty() &&
+        (m_lazy_actions.size() > m_lazy_action_capacity ||
+        !live(m_lazy_action_order.front())))
+    {
+        auto& entry = m_lazy_action_order.front();
+        if (live(entry)) {
+            m_lazy_actions.erase(entry.first);
         }
+        m_lazy_action_order.pop_front();
+    }
+
+    // stale entries behind the front accumulate as edges are consumed out of
+    // order; compact the order once they outnumber the live entries
+    if (m_lazy_action_order.size() > 2 * m_lazy_actions.size()) {
+        auto end = std::remove_if(
+                m_lazy_action_order.begin(), m_lazy_action_order.end(),
+                [&](const std::pair<std::uint64_t, std::uint64_t>& entry) {
+                    return !live(entry);
+                });
+        m_lazy_action_order.erase(end, m_lazy_action_order.end());
     }
 }
 
@@ -523,6 +751,15 @@ ManipLatticeState* ManipLattice::getHashEntry(int state_id) const
 /// state has not yet been allocated.
 int ManipLattice::getHashEntry(const RobotCoord& coord)
 {
+    std::uint64_t key;
+    if (packCoord(coord, key)) {
+        auto kit = m_packed_state_to_id.find(key);
+        if (kit == m_packed_state_to_id.end()) {
+            return -1;
+        }
+        return kit->second;
+    }
+
     ManipLatticeState state;
     state.coord = coord;
     auto sit = m_state_to_id.find(&state);
@@ -543,7 +780,12 @@ int ManipLattice::createHashEntry(
     entry->state = state;
 
     // map state -> state id
-    m_state_to_id[entry] = state_id;
+    std::uint64_t key;
+    if (packCoord(coord, key)) {
+        m_packed_state_to_id[key] = state_id;
+    } else {
+        m_state_to_id[entry] = state_id;
+    }
 
     return state_id;
 }
@@ -595,6 +837,51 @@ int ManipLattice::cost(
     return DefaultCostMultiplier;
 }
 
+bool ManipLattice::checkActionJointLimits(const Action& action)
+{
+    for (auto& istate : action) {
+        if (!robot()->checkJointLimits(istate)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Check a set of actions from the same state for validity. If the collision
+/// checker supports batch checks, every action within joint limits is handed
+/// to it in a single call; otherwise, each action is checked with checkAction.
+void ManipLattice::checkActions(
+    const RobotState& state,
+    const std::vector<Action>& actions,
+    std::vector<bool>& valid)
+{
+    valid.assign(actions.size(), false);
+
+    if (!m_batch_checker) {
+        for (size_t i = 0; i < actions.size(); ++i) {
+            valid[i] = checkAction(state, actions[i]);
+        }
+        return;
+    }
+
+    std::vector<const Action*> motions;
+    std::vector<size_t> motion_indices;
+    motions.reserve(actions.size());
+    motion_indices.reserve(actions.size());
+    for (size_t i = 0; i < actions.size(); ++i) {
+        if (checkActionJointLimits(actions[i])) {
+            motions.push_back(&actions[i]);
+            motion_indices.push_back(i);
+        }
+    }
+
+    std::vector<bool> motion_valid;
+    m_batch_checker->isMotionBatchValid(state, motions, motion_valid);
+    for (size_t i = 0; i < motions.size(); ++i) {
+        valid[motion_indices[i]] = motion_valid[i];
+    }
+}
+
 bool ManipLattice::checkAction(const RobotState& state, const Action& action)
 {
     std::uint32_t violation_mask = 0x00000000;
@@ -811,6 +1098,9 @@ bool ManipLattice::setStart(const RobotState& state)
 
     m_actions->updateStart(state);
 
+    // actions may depend on the start state
+    clearLazyActions();
+
     // notify observers of updated start state
     return RobotPlanningSpace::setStart(state);
 }
@@ -839,6 +1129,9 @@ bool ManipLattice::setGoal(const GoalConstraint& goal)
 
     if (success) {
         m_actions->updateGoal(goal);
+
+        // actions, and whether they reach the goal, may depend on the goal
+        clearLazyActions();
     }
 
     return success;
@@ -863,6 +1156,16 @@ auto ManipLattice::getDiscreteCenter(const RobotState& state) const -> RobotStat
     return center;
 }
 
+/// Set the maximum number of lazy edges whose actions are remembered between
+/// GetLazySuccs and GetTrueCost. Edges are evicted oldest first; GetTrueCost
+/// regenerates the actions of evicted edges. A capacity of 0 disables the
+/// cache.
+void ManipLattice::setLazyActionCacheCapacity(size_t capacity)
+{
+    m_lazy_action_capacity = capacity;
+    evictLazyActions();
+}
+
 void ManipLattice::clearStates()
 {
     for (auto& state : m_states) {
@@ -870,7 +1173,9 @@ void ManipLattice::clearStates()
     }
     m_states.clear();
     m_state_to_id.clear();
+    m_packed_state_to_id.clear();
     m_states.shrink_to_fit();
+    clearLazyActions();
 
     m_goal_state_id = reserveHashEntry();
 }
@@ -1003,10 +1308,36 @@ bool ManipLattice::extractPath(
     return true;
 }
 
+/// Return an estimate of the memory held by the state table and the lazy
+/// action cache. States are assumed to hold one coordinate and one position
+/// per joint variable.
+size_t ManipLattice::memoryUsage() const
+{
+    size_t state_size =
+            sizeof(ManipLatticeState) +
+            robot()->jointVariableCount() * (sizeof(int) + sizeof(double));
+    return VectorMemoryUsage(m_states) +
+            m_states.size() * state_size +
+            HashMapMemoryUsage(m_state_to_id) +
+            HashMapMemoryUsage(m_packed_state_to_id) +
+            HashMapMemoryUsage(m_lazy_actions) +
+            m_lazy_action_order.size() * sizeof(decltype(m_lazy_action_order)::value_type);
+}
+
+/// Release the actions recorded by GetLazySuccs. GetTrueCost regenerates the
+/// actions for edges missing from the cache.
+void ManipLattice::releaseCaches()
+{
+    clearLazyActions();
+    m_lazy_actions.rehash(0);
+    m_lazy_action_order.shrink_to_fit();
+}
+
 Extension* ManipLattice::getExtension(size_t class_code)
 {
     if (class_code == GetClassCode<RobotPlanningSpace>() ||
-        class_code == GetClassCode<ExtractRobotStateExtension>())
+        class_code == GetClassCode<ExtractRobotStateExtension>() ||
+        class_code == GetClassCode<MemoryUsageExtension>())
     {
         return this;
     }
@@ -71,6 +71,11 @@ bool all_equal(InputIt first, InputIt last, typename std::iterator_traits<InputI
             [&val](reference a) { return Equal()(a, val); });
 }
 
+double WorkspaceLatticeIKStats::memoHitRate() const
+{
+    return queries != 0 ? (double)memo_hits / (double)queries : 0.0;
+}
+
 WorkspaceLattice::~WorkspaceLattice()
 {
     for (size_t i = 0; i < m_states.size(); i++) {
@@ -92,6 +97,28 @@ const std::string& WorkspaceLattice::visualizationFrameId() const
     return m_viz_frame_id;
 }
 
+void WorkspaceLattice::setIKMemoEnabled(bool enabled)
+{
+    m_ik_memo_enabled = enabled;
+    if (!enabled) {
+        m_ik_memo.clear();
+    }
+}
+
+void WorkspaceLattice::clearIKMemo()
+{
+    if (m_ik_stats.queries != 0) {
+        SMPL_DEBUG_NAMED(G_LOG, "IK queries: %llu, memo hits: %llu (%0.1f%%), solves: %llu, warm starts: %llu",
+                (unsigned long long)m_ik_stats.queries,
+                (unsigned long long)m_ik_stats.memo_hits,
+                100.0 * m_ik_stats.memoHitRate(),
+                (unsigned long long)m_ik_stats.solves,
+                (unsigned long long)m_ik_stats.warm_starts);
+    }
+    m_ik_memo.clear();
+    m_ik_stats = WorkspaceLatticeIKStats();
+}
+
 bool WorkspaceLattice::init(
     RobotModel* _robot,
     CollisionChecker* checker,
@@ -172,6 +199,8 @@ bool WorkspaceLattice::setStart(const RobotState& state)
     m_start_entry = getState(m_start_state_id);
     m_start_entry->state = state;
 
+    clearIKMemo();
+
     return RobotPlanningSpace::setStart(state);
 }
 
@@ -361,6 +390,8 @@ void WorkspaceLattice::GetSuccs(
 
     SMPL_DEBUG_NAMED(G_EXPANSIONS_LOG, "  actions: %zu", actions.size());
 
+    RobotState final_rstate;
+
     // iterate through successors of source state
     for (size_t i = 0; i < actions.size(); ++i) {
         auto& action = actions[i];
@@ -368,7 +399,6 @@ void WorkspaceLattice::GetSuccs(
         SMPL_DEBUG_NAMED(G_EXPANSIONS_LOG, "    action %zu", i);
         SMPL_DEBUG_NAMED(G_EXPANSIONS_LOG, "      waypoints: %zu", action.size());
 
-        RobotState final_rstate;
         if (!checkAction(parent_entry->state, action, &final_rstate)) {
             continue;
         }
@@ -735,8 +765,11 @@ bool WorkspaceLattice::checkAction(
     const WorkspaceAction& action,
     RobotState* final_robot_state)
 {
-    std::vector<RobotState> wptraj;
-    wptraj.reserve(action.size());
+    // reuse the waypoint trajectory and seed storage across calls
+    auto& wptraj = m_wptraj;
+    wptraj.resize(action.size());
+
+    auto& seed = m_ik_seed;
 
     // check waypoints for ik solutions and joint limits
     for (size_t widx = 0; widx < action.size(); ++widx) {
@@ -744,14 +777,22 @@ bool WorkspaceLattice::checkAction(
 
         SMPL_DEBUG_STREAM_NAMED(G_SUCCESSORS_LOG, "        " << widx << ": " << waypoint);
 
-        RobotState seed = state;
+        // optionally seed each waypoint with the solution to the previous
+        // waypoint, which is closer than the source state
+        const bool warm_start = m_ik_warm_start_enabled && widx != 0;
+        if (warm_start) {
+            seed = wptraj[widx - 1];
+        } else {
+            seed = state;
+        }
+
         // copy over seed angles from the intermediate state
         for (int i = 0; i < this->freeAngleCount(); ++i) {
             seed[this->m_fangle_indices[i]] = waypoint[6 + i];
         }
 
-        RobotState irstate;
-        if (!stateWorkspaceToRobot(waypoint, seed, irstate)) {
+        auto& irstate = wptraj[widx];
+        if (!computeWaypointIK(waypoint, seed, warm_start, irstate)) {
             SMPL_DEBUG_NAMED(G_SUCCESSORS_LOG, "         -> failed to find ik solution");
             return false;
         }
@@ -760,8 +801,6 @@ bool WorkspaceLattice::checkAction(
             SMPL_DEBUG_NAMED(G_SUCCESSORS_LOG, "        -> violates joint limits");
             return false;
         }
-
-        wptraj.push_back(std::move(irstate));
     }
 
     // check for collisions between the waypoints
@@ -788,6 +827,70 @@ bool WorkspaceLattice::checkAction(
     return true;
 }
 
+/// Compute the IK solution for an action waypoint, answering from the IK memo
+/// when the same waypoint has been solved before during this search.
+/// \p warm_start indicates that the seed is the solution to the previous
+/// waypoint of the action.
+bool WorkspaceLattice::computeWaypointIK(
+    const WorkspaceState& waypoint,
+    const RobotState& seed,
+    bool warm_start,
+    RobotState& solution)
+{
+    ++m_ik_stats.queries;
+
+    auto solve = [&]() {
+        ++m_ik_stats.solves;
+        if (warm_start) {
+            ++m_ik_stats.warm_starts;
+        }
+        return stateWorkspaceToRobot(waypoint, seed, solution);
+    };
+
+    if (!m_ik_memo_enabled) {
+        return solve();
+    }
+
+    // waypoints reached by different actions differ by rounding error, so
+    // compare them with a small tolerance, and compare the orientation angles
+    // modulo 2 pi
+    auto same_waypoint = [](const WorkspaceState& a, const WorkspaceState& b) {
+        const double tol = 1e-6;
+        for (size_t i = 0; i < a.size(); ++i) {
+            auto diff = (i >= 3 && i < 6) ?
+                    angles::shortest_angle_dist(a[i], b[i]) :
+                    std::fabs(a[i] - b[i]);
+            if (diff > tol) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    stateWorkspaceToCoord(waypoint, m_ik_coord);
+    auto it = m_ik_memo.find(m_ik_coord);
+    if (it != end(m_ik_memo) && same_waypoint(it->second.waypoint, waypoint)) {
+        ++m_ik_stats.memo_hits;
+        solution = it->second.solution;
+        return true;
+    }
+
+    if (!solve()) {
+        return false;
+    }
+
+    // keep the first solution for a cell; later waypoints in the same cell
+    // with a different pose are solved directly
+    if (it == end(m_ik_memo)) {
+        IKMemoEntry entry;
+        entry.waypoint = waypoint;
+        entry.solution = solution;
+        m_ik_memo.emplace(m_ik_coord, std::move(entry));
+    }
+
+    return true;
+}
+
 int WorkspaceLattice::computeCost(
     const WorkspaceLatticeState& src,
     const WorkspaceLatticeState& dst)
@@ -31,6 +31,9 @@
 
 #include <smpl/heuristic/bfs_heuristic.h>
 
+// standard includes
+#include <algorithm>
+
 // project includes
 #include <smpl/bfs3d/bfs3d.h>
 #include <smpl/console/console.h>
@@ -79,8 +82,30 @@ void BfsHeuristic::setCostPerCell(int cost_per_cell)
     m_cost_per_cell = cost_per_cell;
 }
 
+// If the grid has moved since the walls were synced, sync them again and
+// search from the last goal again, so that a grid moved between requests is
+// picked up when only the start changes.
+void BfsHeuristic::updateStart(const RobotState& state)
+{
+    m_start_bfs_valid = false;
+
+    if (m_has_goal && gridMoved()) {
+        auto goal = m_goal;
+        updateGoal(goal);
+    }
+}
+
 void BfsHeuristic::updateGoal(const GoalConstraint& goal)
 {
+    if (gridMoved()) {
+        SMPL_DEBUG_NAMED(LOG, "Grid moved, resyncing the BFS walls");
+        syncGridAndBfs();
+    }
+
+    m_goal = goal;
+    m_has_goal = true;
+    m_goal_cells.clear();
+
     switch (goal.type) {
     case GoalType::XYZ_GOAL:
     case GoalType::XYZ_RPY_GOAL:
@@ -180,9 +205,25 @@ double BfsHeuristic::getMetricGoalDistance(double x, double y, double z)
     }
 }
 
+size_t BfsHeuristic::memoryUsage() const
+{
+    size_t usage = VectorMemoryUsage(m_goal_cells) +
+            VectorMemoryUsage(m_batch_points) +
+            VectorMemoryUsage(m_batch_projected);
+    if (m_bfs) {
+        usage += m_bfs->memoryUsage();
+    }
+    if (m_start_bfs) {
+        usage += m_start_bfs->memoryUsage();
+    }
+    return usage;
+}
+
 Extension* BfsHeuristic::getExtension(size_t class_code)
 {
-    if (class_code == GetClassCode<RobotHeuristic>()) {
+    if (class_code == GetClassCode<RobotHeuristic>() ||
+        class_code == GetClassCode<MemoryUsageExtension>())
+    {
         return this;
     }
     return nullptr;
@@ -205,10 +246,60 @@ int BfsHeuristic::GetGoalHeuristic(int state_id)
     return getBfsCostToGoal(*m_bfs, dp.x(), dp.y(), dp.z());
 }
 
+// Project all states to points first, so that the grid lookups run as one
+// tight loop without interleaved kinematics.
+void BfsHeuristic::GetGoalHeuristics(
+    const int* state_ids,
+    size_t count,
+    int* values)
+{
+    if (m_pp == NULL) {
+        std::fill(values, values + count, 0);
+        return;
+    }
+
+    m_batch_points.resize(count);
+    m_batch_projected.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        m_batch_projected[i] = m_pp->projectToPoint(state_ids[i], m_batch_points[i]);
+    }
+
+    const OccupancyGrid* g = grid();
+    const BFS_3D& bfs = *m_bfs;
+    for (size_t i = 0; i < count; ++i) {
+        if (!m_batch_projected[i]) {
+            values[i] = 0;
+            continue;
+        }
+        const Vector3& p = m_batch_points[i];
+        int gx, gy, gz;
+        g->worldToGrid(p.x(), p.y(), p.z(), gx, gy, gz);
+        values[i] = getBfsCostToGoal(bfs, gx, gy, gz);
+    }
+}
+
+/// Return the cost of the BFS path from the start cell to the cell of a state.
+/// The BFS from the start cell is run on the first call after the start
+/// changes, so searches that only use goal heuristics do not pay for it.
 int BfsHeuristic::GetStartHeuristic(int state_id)
 {
-    SMPL_WARN_ONCE("BfsHeuristic::GetStartHeuristic unimplemented");
-    return 0;
+    if (m_pp == NULL) {
+        return 0;
+    }
+
+    if (!m_start_bfs_valid && !runStartBfs()) {
+        return 0;
+    }
+
+    Vector3 p;
+    if (!m_pp->projectToPoint(state_id, p)) {
+        return 0;
+    }
+
+    Eigen::Vector3i dp;
+    grid()->worldToGrid(p.x(), p.y(), p.z(), dp.x(), dp.y(), dp.z());
+
+    return getBfsCostToGoal(*m_start_bfs, dp.x(), dp.y(), dp.z());
 }
 
 int BfsHeuristic::GetFromToHeuristic(int from_id, int to_id)
@@ -386,11 +477,24 @@ auto BfsHeuristic::getValuesVisualization() -> visual::Marker
 
 void BfsHeuristic::syncGridAndBfs()
 {
+    m_sync_origin = Vector3(grid()->originX(), grid()->originY(), grid()->originZ());
+
     const int xc = grid()->numCellsX();
     const int yc = grid()->numCellsY();
     const int zc = grid()->numCellsZ();
 //    SMPL_DEBUG_NAMED(LOG, "Initializing BFS of size %d x %d x %d = %d", xc, yc, zc, xc * yc * zc);
     m_bfs.reset(new BFS_3D(xc, yc, zc));
+    setWalls(*m_bfs);
+
+    m_start_bfs.reset();
+    m_start_bfs_valid = false;
+}
+
+void BfsHeuristic::setWalls(BFS_3D& bfs) const
+{
+    const int xc = grid()->numCellsX();
+    const int yc = grid()->numCellsY();
+    const int zc = grid()->numCellsZ();
     const int cell_count = xc * yc * zc;
     int wall_count = 0;
     for (int x = 0; x < xc; ++x) {
@@ -398,7 +502,7 @@ void BfsHeuristic::syncGridAndBfs()
     for (int z = 0; z < zc; ++z) {
         const double radius = m_inflation_radius;
         if (grid()->getDistance(x, y, z) <= radius) {
-            m_bfs->setWall(x, y, z);
+            bfs.setWall(x, y, z);
             ++wall_count;
         }
     }
@@ -408,6 +512,42 @@ void BfsHeuristic::syncGridAndBfs()
     SMPL_DEBUG_NAMED(LOG, "%d/%d (%0.3f%%) walls in the bfs heuristic", wall_count, cell_count, 100.0 * (double)wall_count / cell_count);
 }
 
+// Run the BFS from the cell of the start state, through the same walls as
+// the BFS from the goal.
+bool BfsHeuristic::runStartBfs()
+{
+    Vector3 p;
+    if (!m_pp->projectToPoint(planningSpace()->getStartStateID(), p)) {
+        SMPL_WARN_ONCE("Failed to project the start state for the BFS start heuristic");
+        return false;
+    }
+
+    int sx, sy, sz;
+    grid()->worldToGrid(p.x(), p.y(), p.z(), sx, sy, sz);
+
+    if (!m_bfs->inBounds(sx, sy, sz)) {
+        SMPL_ERROR_NAMED(LOG, "Heuristic start is out of BFS bounds");
+        return false;
+    }
+
+    if (!m_start_bfs) {
+        m_start_bfs.reset(new BFS_3D(
+                grid()->numCellsX(), grid()->numCellsY(), grid()->numCellsZ()));
+        setWalls(*m_start_bfs);
+    }
+
+    SMPL_DEBUG_NAMED(LOG, "Setting the BFS heuristic start (%d, %d, %d)", sx, sy, sz);
+    m_start_bfs->run(sx, sy, sz);
+    m_start_bfs_valid = true;
+    return true;
+}
+
+bool BfsHeuristic::gridMoved() const
+{
+    return m_sync_origin !=
+            Vector3(grid()->originX(), grid()->originY(), grid()->originZ());
+}
+
 int BfsHeuristic::getBfsCostToGoal(const BFS_3D& bfs, int x, int y, int z) const
 {
     if (!bfs.inBounds(x, y, z)) {
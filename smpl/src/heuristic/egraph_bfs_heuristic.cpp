@@ -31,6 +31,11 @@
 
 #include <smpl/heuristic/egraph_bfs_heuristic.h>
 
+#include <condition_variable>
+#include <limits>
+#include <mutex>
+#include <thread>
+
 #include <boost/functional/hash.hpp>
 
 #include <smpl/console/console.h>
@@ -126,6 +131,11 @@ void DijkstraEgraphHeuristic3D::setInflationRadius(double radius)
     m_inflation_radius = radius;
 }
 
+void DijkstraEgraphHeuristic3D::setThreadCount(int count)
+{
+    m_thread_count = std::max(count, 0);
+}
+
 void DijkstraEgraphHeuristic3D::getEquivalentStates(
     int state_id,
     std::vector<int>& ids)
@@ -164,7 +174,7 @@ void DijkstraEgraphHeuristic3D::getShortcutSuccs(
     SMPL_INFO_STREAM_NAMED(SLOG, "  e-graph nodes: " << egraph_nodes);
 
     for (auto node : egraph_nodes) {
-        auto comp_id = m_component_ids[node];
+        auto comp_id = m_tables.component_ids[node];
         for (auto shortcut_node : m_shortcut_nodes[comp_id]) {
             auto id = m_eg->getStateID(shortcut_node);
             if (id != state_id) {
@@ -307,9 +317,36 @@ double DijkstraEgraphHeuristic3D::getMetricGoalDistance(double x, double y, doub
     return grid()->resolution() * (abs(d.x()) + abs(d.y() + abs(d.z())));
 }
 
+/// Return an estimate of the memory held by the distance grid, the projected
+/// experience graph, and the experience graph tables.
+size_t DijkstraEgraphHeuristic3D::memoryUsage() const
+{
+    size_t usage = m_dist_grid.size() * sizeof(Cell) +
+            m_open.size() * sizeof(Cell*) +
+            VectorMemoryUsage(m_relaxed_dist) +
+            VectorMemoryUsage(m_projected_nodes) +
+            VectorMemoryUsage(m_tables.component_ids) +
+            VectorMemoryUsage(m_shortcut_nodes) +
+            HashMapMemoryUsage(m_heur_nodes);
+    for (auto& entry : m_heur_nodes) {
+        usage += VectorMemoryUsage(entry.second.up_nodes);
+        usage += VectorMemoryUsage(entry.second.edges);
+    }
+    return usage;
+}
+
+/// Release the scratch space of the parallel search.
+void DijkstraEgraphHeuristic3D::releaseCaches()
+{
+    m_relaxed_dist.clear();
+    m_relaxed_dist.shrink_to_fit();
+}
+
 Extension* DijkstraEgraphHeuristic3D::getExtension(size_t class_code)
 {
-    if (class_code == GetClassCode<ExperienceGraphHeuristicExtension>()) {
+    if (class_code == GetClassCode<ExperienceGraphHeuristicExtension>() ||
+        class_code == GetClassCode<MemoryUsageExtension>())
+    {
         return this;
     }
     return nullptr;
@@ -337,11 +374,11 @@ void DijkstraEgraphHeuristic3D::updateGoal(const GoalConstraint& goal)
     grid()->worldToGrid(gp.x(), gp.y(), gp.z(), dgp.x(), dgp.y(), dgp.z());
 
     // precompute shortcuts
-    assert(m_component_ids.size() == m_eg->getExperienceGraph()->num_nodes());
+    assert(m_tables.component_ids.size() == m_eg->getExperienceGraph()->num_nodes());
     auto* eg = m_eg->getExperienceGraph();
     auto nodes = eg->nodes();
     for (auto nit = nodes.first; nit != nodes.second; ++nit) {
-        auto comp_id = m_component_ids[*nit];
+        auto comp_id = m_tables.component_ids[*nit];
         if (m_shortcut_nodes[comp_id].empty()) {
             m_shortcut_nodes[comp_id].push_back(*nit);
             continue;
@@ -374,9 +411,19 @@ void DijkstraEgraphHeuristic3D::updateGoal(const GoalConstraint& goal)
     dgp += Eigen::Vector3i::Ones();
 
     m_open.clear();
-    auto* c = &m_dist_grid(dgp.x(), dgp.y(), dgp.z());
-    c->dist = 0;
-    m_open.push(c);
+
+    size_t thread_count = m_thread_count;
+    if (thread_count == 0) {
+        thread_count = std::thread::hardware_concurrency();
+    }
+
+    if (thread_count > 1) {
+        computeDistancesParallel(dgp, thread_count);
+    } else {
+        auto* c = &m_dist_grid(dgp.x(), dgp.y(), dgp.z());
+        c->dist = 0;
+        m_open.push(c);
+    }
 
     SMPL_INFO_NAMED(LOG, "Updated EGraphBfsHeuristic goal");
 }
@@ -504,35 +551,11 @@ void DijkstraEgraphHeuristic3D::projectExperienceGraph()
 
     SMPL_INFO("Projected experience graph contains %d nodes and %d edges", proj_node_count, proj_edge_count);
 
-    auto comp_count = 0;
-    m_component_ids.assign(eg->num_nodes(), -1);
-    for (auto nit = nodes.first; nit != nodes.second; ++nit) {
-        if (m_component_ids[*nit] != -1) {
-            continue;
-        }
-
-        std::vector<ExperienceGraph::node_id> frontier;
-        frontier.push_back(*nit);
-        while (!frontier.empty()) {
-            auto n = frontier.back();
-            frontier.pop_back();
-
-            m_component_ids[n] = comp_count;
-
-            auto adj = eg->adjacent_nodes(n);
-            for (auto ait = adj.first; ait != adj.second; ++ait) {
-                if (m_component_ids[*ait] == -1) {
-                    frontier.push_back(*ait);
-                }
-            }
-        }
-
-        ++comp_count;
-    }
+    UpdateExperienceGraphTables(*eg, m_tables);
 
     // pre-allocate shortcuts array here, fill in updateGoal()
-    m_shortcut_nodes.assign(comp_count, std::vector<ExperienceGraph::node_id>());
-    SMPL_INFO("Experience graph contains %d components", comp_count);
+    m_shortcut_nodes.assign(m_tables.component_count, std::vector<ExperienceGraph::node_id>());
+    SMPL_INFO("Experience graph contains %d components", m_tables.component_count);
 
     visual::Color color;
     color.r = (float)0xFF / (float)0xFF;
@@ -649,6 +672,235 @@ int DijkstraEgraphHeuristic3D::getGoalHeuristic(const Eigen::Vector3i& dp)
     return cell->dist;
 }
 
+namespace {
+
+class Barrier
+{
+public:
+
+    explicit Barrier(size_t count) : m_count(count) { }
+
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        auto generation = m_generation;
+        if (++m_waiting == m_count) {
+            m_waiting = 0;
+            ++m_generation;
+            m_cv.notify_all();
+        } else {
+            m_cv.wait(lock, [&]() { return generation != m_generation; });
+        }
+    }
+
+private:
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    size_t m_count;
+    size_t m_waiting = 0;
+    size_t m_generation = 0;
+};
+
+} // namespace
+
+// Compute the distance to every cell with a delta-stepping search. The grid is
+// split into slabs along x, one per thread. Each thread keeps the cells in its
+// slab in its own array of buckets, each bucket holding the cells with
+// distances in a range of width delta, and is the only thread to write the
+// distances of those cells. Relaxations of edges into another thread's slab
+// are sent to that thread as requests. All threads process the lowest
+// non-empty bucket together, in rounds, until it stays empty. Delta is the
+// cost of the longest grid edge, so most edges lead to a later bucket.
+void DijkstraEgraphHeuristic3D::computeDistancesParallel(
+    const Eigen::Vector3i& dgp,
+    size_t thread_count)
+{
+    const size_t xsize = m_dist_grid.xsize();
+    const size_t ysize = m_dist_grid.ysize();
+    const size_t zsize = m_dist_grid.zsize();
+    const size_t slab_size = ysize * zsize;
+
+    thread_count = std::min(thread_count, xsize);
+
+    struct GridEdge
+    {
+        std::ptrdiff_t offset;
+        int cost;
+    };
+
+    std::vector<GridEdge> grid_edges;
+    int delta = 1;
+    for (int dx = -1; dx <= 1; ++dx) {
+    for (int dy = -1; dy <= 1; ++dy) {
+    for (int dz = -1; dz <= 1; ++dz) {
+        if (dx == 0 && dy == 0 && dz == 0) {
+            continue;
+        }
+        GridEdge edge;
+        edge.offset = (dx * (std::ptrdiff_t)ysize + dy) * (std::ptrdiff_t)zsize + dz;
+        edge.cost = (int)(m_eg_eps * 1000.0 * std::sqrt((double)(dx * dx + dy * dy + dz * dz)));
+        delta = std::max(delta, edge.cost);
+        grid_edges.push_back(edge);
+    }
+    }
+    }
+
+    struct Worker
+    {
+        std::vector<std::vector<size_t>> buckets;
+        std::vector<size_t> frontier;
+
+        // outgoing relaxation requests, indexed by destination thread
+        std::vector<std::vector<std::pair<size_t, int>>> requests;
+
+        size_t next_bucket;
+        bool bucket_empty;
+    };
+
+    std::vector<Worker> workers(thread_count);
+    for (auto& worker : workers) {
+        worker.requests.resize(thread_count);
+    }
+
+    Cell* cells = m_dist_grid.data();
+    m_relaxed_dist.assign(m_dist_grid.size(), -1);
+
+    auto owner = [&](size_t index) {
+        return index / slab_size * thread_count / xsize;
+    };
+
+    auto relax = [&](Worker& worker, size_t index, int dist) {
+        auto& cell = cells[index];
+        if (cell.dist == Wall || dist >= cell.dist) {
+            return;
+        }
+        cell.dist = dist;
+        size_t b = dist / delta;
+        if (b >= worker.buckets.size()) {
+            worker.buckets.resize(b + 1);
+        }
+        worker.buckets[b].push_back(index);
+    };
+
+    // Experience graph edges may lead into walls, and cells reached this way
+    // are no longer walls. The serial search allows this too, but the outcome
+    // there depends on the order cells are reached in; here, those cells are
+    // opened up front so that distances don't depend on the thread count.
+    for (auto& entry : m_heur_nodes) {
+        for (auto& adj : entry.second.edges) {
+            auto& cell = m_dist_grid(adj.x(), adj.y(), adj.z());
+            if (cell.dist == Wall) {
+                cell.dist = Unknown;
+            }
+        }
+    }
+
+    auto goal_index = m_dist_grid.coord_to_index(dgp.x(), dgp.y(), dgp.z());
+    cells[goal_index].dist = 0;
+    workers[owner(goal_index)].buckets.resize(1);
+    workers[owner(goal_index)].buckets[0].push_back(goal_index);
+
+    Barrier barrier(thread_count);
+
+    auto search = [&](size_t tid)
+    {
+        auto& worker = workers[tid];
+
+        size_t b = 0;
+        while (true) {
+            // find the lowest non-empty bucket over all threads
+            while (b < worker.buckets.size() && worker.buckets[b].empty()) {
+                ++b;
+            }
+            worker.next_bucket = b < worker.buckets.size() ?
+                    b : std::numeric_limits<size_t>::max();
+            barrier.wait();
+
+            b = std::numeric_limits<size_t>::max();
+            for (auto& w : workers) {
+                b = std::min(b, w.next_bucket);
+            }
+            if (b == std::numeric_limits<size_t>::max()) {
+                break;
+            }
+
+            while (true) {
+                // relax the edges of the cells in the current bucket; edges
+                // into this thread's slab are relaxed immediately
+                if (b < worker.buckets.size()) {
+                    worker.frontier.swap(worker.buckets[b]);
+                }
+                for (size_t index : worker.frontier) {
+                    int dist = cells[index].dist;
+                    if (dist / delta != b || m_relaxed_dist[index] == dist) {
+                        continue; // stale or already relaxed
+                    }
+                    m_relaxed_dist[index] = dist;
+
+                    auto send = [&](size_t nindex, int ndist) {
+                        auto ntid = owner(nindex);
+                        if (ntid == tid) {
+                            relax(worker, nindex, ndist);
+                        } else {
+                            worker.requests[ntid].emplace_back(nindex, ndist);
+                        }
+                    };
+
+                    for (auto& edge : grid_edges) {
+                        send(index + edge.offset, dist + edge.cost);
+                    }
+
+                    size_t cx, cy, cz;
+                    m_dist_grid.index_to_coord(index, cx, cy, cz);
+                    auto it = m_heur_nodes.find(Eigen::Vector3i(cx, cy, cz));
+                    if (it != end(m_heur_nodes)) {
+                        for (auto& adj : it->second.edges) {
+                            auto dx = adj.x() - (int)cx;
+                            auto dy = adj.y() - (int)cy;
+                            auto dz = adj.z() - (int)cz;
+                            auto cost = (int)(1000.0 * std::sqrt((double)(dx * dx + dy * dy + dz * dz)));
+                            send(m_dist_grid.coord_to_index(adj.x(), adj.y(), adj.z()), dist + cost);
+                        }
+                    }
+                }
+                worker.frontier.clear();
+                barrier.wait();
+
+                // apply requests from the other threads
+                for (auto& w : workers) {
+                    for (auto& request : w.requests[tid]) {
+                        relax(worker, request.first, request.second);
+                    }
+                    w.requests[tid].clear();
+                }
+                worker.bucket_empty =
+                        b >= worker.buckets.size() || worker.buckets[b].empty();
+                barrier.wait();
+
+                bool done = true;
+                for (auto& w : workers) {
+                    done &= w.bucket_empty;
+                }
+                if (done) {
+                    break;
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(thread_count - 1);
+    for (size_t i = 1; i < thread_count; ++i) {
+        threads.emplace_back(search, i);
+    }
+    search(0);
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
 void DijkstraEgraphHeuristic3D::syncGridAndDijkstra()
 {
     auto xc = grid()->numCellsX();
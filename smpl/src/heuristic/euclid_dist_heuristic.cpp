@@ -162,7 +162,7 @@ int EuclidDistHeuristic::GetGoalHeuristic(int state_id)
 
 int EuclidDistHeuristic::GetStartHeuristic(int state_id)
 {
-    return 0;
+    return GetFromToHeuristic(planningSpace()->getStartStateID(), state_id);
 }
 
 int EuclidDistHeuristic::GetFromToHeuristic(int from_id, int to_id)
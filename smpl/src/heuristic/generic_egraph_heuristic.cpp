@@ -29,6 +29,10 @@
 
 /// \author Andrew Dornbush
 
+// standard includes
+#include <algorithm>
+#include <thread>
+
 // project includes
 #include <smpl/console/console.h>
 #include <smpl/heuristic/generic_egraph_heuristic.h>
@@ -37,6 +41,10 @@ namespace smpl {
 
 static const char* LOG = "heuristic.generic_egraph";
 
+// Experience graph node heuristics are computed on the calling thread unless
+// there are at least this many nodes per available hardware thread.
+static const size_t MinHeuristicsPerThread = 4096;
+
 bool GenericEgraphHeuristic::init(RobotPlanningSpace* space, RobotHeuristic* h)
 {
     if (!h) {
@@ -87,7 +95,7 @@ void GenericEgraphHeuristic::getShortcutSuccs(
     m_eg->getExperienceGraphNodes(state_id, egraph_nodes);
 
     for (ExperienceGraph::node_id n : egraph_nodes) {
-        const int comp_id = m_component_ids[n];
+        const int comp_id = m_tables.component_ids[n];
         for (ExperienceGraph::node_id nn : m_shortcut_nodes[comp_id]) {
             int egraph_state_id = m_eg->getStateID(nn);
             if (state_id != egraph_state_id) {
@@ -109,9 +117,25 @@ double GenericEgraphHeuristic::getMetricGoalDistance(
     return m_orig_h->getMetricGoalDistance(x, y, z);
 }
 
+size_t GenericEgraphHeuristic::memoryUsage() const
+{
+    size_t usage = VectorMemoryUsage(m_tables.component_ids) +
+            VectorMemoryUsage(m_shortcut_nodes) +
+            VectorMemoryUsage(m_node_state_ids) +
+            VectorMemoryUsage(m_node_h) +
+            VectorMemoryUsage(m_h_nodes) +
+            m_open.size() * sizeof(HeuristicNode*);
+    for (auto& nodes : m_shortcut_nodes) {
+        usage += VectorMemoryUsage(nodes);
+    }
+    return usage;
+}
+
 Extension* GenericEgraphHeuristic::getExtension(size_t class_code)
 {
-    if (class_code == GetClassCode<ExperienceGraphHeuristicExtension>()) {
+    if (class_code == GetClassCode<ExperienceGraphHeuristicExtension>() ||
+        class_code == GetClassCode<MemoryUsageExtension>())
+    {
         return this;
     }
     return nullptr;
@@ -131,51 +155,24 @@ void GenericEgraphHeuristic::updateGoal(const GoalConstraint& goal)
         return;
     }
 
-    //////////////////////////////////////////////////////////
-    // Compute Connected Components of the Experience Graph //
-    //////////////////////////////////////////////////////////
+    UpdateExperienceGraphTables(*eg, m_tables);
 
-    int comp_count = 0;
-    m_component_ids.assign(eg->num_nodes(), -1);
-    auto nodes = eg->nodes();
-    for (auto nit = nodes.first; nit != nodes.second; ++nit) {
-        if (m_component_ids[*nit] != -1) {
-            continue;
-        }
-
-        std::vector<ExperienceGraph::node_id> frontier;
-        frontier.push_back(*nit);
-        while (!frontier.empty()) {
-            ExperienceGraph::node_id n = frontier.back();
-            frontier.pop_back();
-
-            m_component_ids[n] = comp_count;
-
-            auto adj = eg->adjacent_nodes(n);
-            for (auto ait = adj.first; ait != adj.second; ++ait) {
-                if (m_component_ids[*ait] == -1) {
-                    frontier.push_back(*ait);
-                }
-            }
-        }
-
-        ++comp_count;
-    }
+    SMPL_INFO_NAMED(LOG, "Experience graph contains %d connected components", m_tables.component_count);
 
-    SMPL_INFO_NAMED(LOG, "Experience graph contains %d connected components", comp_count);
+    computeNodeHeuristics();
 
     ////////////////////////////
     // Compute Shortcut Nodes //
     ////////////////////////////
 
-    m_shortcut_nodes.assign(comp_count, std::vector<ExperienceGraph::node_id>());
-    std::vector<int> shortcut_heuristics(comp_count);
+    auto nodes = eg->nodes();
+    m_shortcut_nodes.assign(m_tables.component_count, std::vector<ExperienceGraph::node_id>());
+    std::vector<int> shortcut_heuristics(m_tables.component_count);
     for (auto nit = nodes.first; nit != nodes.second; ++nit) {
         const ExperienceGraph::node_id n = *nit;
-        const int comp_id = m_component_ids[n];
-        const int state_id = m_eg->getStateID(n);
+        const int comp_id = m_tables.component_ids[n];
 
-        int h = m_orig_h->GetGoalHeuristic(state_id);
+        int h = m_node_h[n];
 
         if (m_shortcut_nodes[comp_id].empty()) {
             m_shortcut_nodes[comp_id].push_back(n);
@@ -211,9 +208,7 @@ void GenericEgraphHeuristic::updateGoal(const GoalConstraint& goal)
             for (auto nit = nodes.first; nit != nodes.second; ++nit) {
                 const ExperienceGraph::node_id nid = *nit;
                 HeuristicNode* n = &m_h_nodes[nid + 1];
-                const int state_id = m_eg->getStateID(nid);
-                const int h = m_orig_h->GetGoalHeuristic(state_id);
-                n->dist = (int)(m_eg_eps * h);
+                n->dist = (int)(m_eg_eps * m_node_h[nid]);
                 m_open.push(n);
             }
         } else {
@@ -254,6 +249,53 @@ void GenericEgraphHeuristic::updateGoal(const GoalConstraint& goal)
     }
 }
 
+// Compute the goal heuristic of every experience graph node in batches,
+// spread across the available hardware threads if the original heuristic
+// permits.
+void GenericEgraphHeuristic::computeNodeHeuristics()
+{
+    ExperienceGraph* eg = m_eg->getExperienceGraph();
+    const size_t count = eg->num_nodes();
+
+    m_node_state_ids.resize(count);
+    for (size_t n = 0; n < count; ++n) {
+        m_node_state_ids[n] = m_eg->getStateID(n);
+    }
+    m_node_h.resize(count);
+
+    size_t thread_count = 1;
+    if (m_orig_h->concurrentGoalHeuristics()) {
+        thread_count = std::thread::hardware_concurrency();
+        thread_count = std::min(thread_count, count / MinHeuristicsPerThread);
+    }
+
+    if (thread_count <= 1) {
+        m_orig_h->GetGoalHeuristics(
+                m_node_state_ids.data(), count, m_node_h.data());
+        return;
+    }
+
+    auto compute_batch = [&](size_t begin, size_t end)
+    {
+        m_orig_h->GetGoalHeuristics(
+                m_node_state_ids.data() + begin,
+                end - begin,
+                m_node_h.data() + begin);
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(thread_count);
+    for (size_t i = 0; i < thread_count; ++i) {
+        size_t begin = i * count / thread_count;
+        size_t end = (i + 1) * count / thread_count;
+        threads.emplace_back(compute_batch, begin, end);
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
 int GenericEgraphHeuristic::GetGoalHeuristic(int state_id)
 {
     if (!m_eg) {
@@ -66,6 +66,31 @@ Extension* JointDistHeuristic::getExtension(size_t class_code)
     return nullptr;
 }
 
+void JointDistHeuristic::GetGoalHeuristics(
+    const int* state_ids,
+    size_t count,
+    int* values)
+{
+    if (!m_ers || planningSpace()->goal().type != GoalType::JOINT_STATE_GOAL) {
+        for (size_t i = 0; i < count; ++i) {
+            values[i] = GetGoalHeuristic(state_ids[i]);
+        }
+        return;
+    }
+
+    const int goal_id = planningSpace()->getGoalStateID();
+    const RobotState& goal_state = planningSpace()->goal().angles;
+    for (size_t i = 0; i < count; ++i) {
+        if (state_ids[i] == goal_id) {
+            values[i] = 0;
+            continue;
+        }
+        const RobotState& state = m_ers->extractState(state_ids[i]);
+        assert(goal_state.size() == state.size());
+        values[i] = (int)(FIXED_POINT_RATIO * computeJointDistance(state, goal_state));
+    }
+}
+
 int JointDistHeuristic::GetGoalHeuristic(int state_id)
 {
     if (state_id == planningSpace()->getGoalStateID()) {
@@ -104,8 +104,26 @@ Extension* MultiFrameBfsHeuristic::getExtension(size_t class_code)
     return nullptr;
 }
 
+// If the grid has moved since the walls were synced, sync them again and
+// search from the last goal again.
+void MultiFrameBfsHeuristic::updateStart(const RobotState& state)
+{
+    if (m_has_goal && gridMoved()) {
+        auto goal = m_goal;
+        updateGoal(goal);
+    }
+}
+
 void MultiFrameBfsHeuristic::updateGoal(const GoalConstraint& goal)
 {
+    if (gridMoved()) {
+        SMPL_DEBUG_NAMED(LOG, "Grid moved, resyncing the BFS walls");
+        syncGridAndBfs();
+    }
+
+    m_goal = goal;
+    m_has_goal = true;
+
     SMPL_DEBUG_NAMED(LOG, "Update goal");
 
     Affine3 offset_pose =
@@ -335,6 +353,8 @@ int MultiFrameBfsHeuristic::getGoalHeuristic(int state_id, bool use_ee) const
 
 void MultiFrameBfsHeuristic::syncGridAndBfs()
 {
+    m_sync_origin = Vector3(grid()->originX(), grid()->originY(), grid()->originZ());
+
     const int xc = grid()->numCellsX();
     const int yc = grid()->numCellsY();
     const int zc = grid()->numCellsZ();
@@ -358,6 +378,12 @@ void MultiFrameBfsHeuristic::syncGridAndBfs()
     SMPL_DEBUG_NAMED(LOG, "%d/%d (%0.3f%%) walls in the bfs heuristic", wall_count, cell_count, 100.0 * (double)wall_count / cell_count);
 }
 
+bool MultiFrameBfsHeuristic::gridMoved() const
+{
+    return m_sync_origin !=
+            Vector3(grid()->originX(), grid()->originY(), grid()->originZ());
+}
+
 int MultiFrameBfsHeuristic::getBfsCostToGoal(
     const BFS_3D& bfs, int x, int y, int z) const
 {
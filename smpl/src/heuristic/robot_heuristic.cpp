@@ -50,4 +50,14 @@ RobotHeuristic::~RobotHeuristic()
 {
 }
 
+void RobotHeuristic::GetGoalHeuristics(
+    const int* state_ids,
+    size_t count,
+    int* values)
+{
+    for (size_t i = 0; i < count; ++i) {
+        values[i] = GetGoalHeuristic(state_ids[i]);
+    }
+}
+
 } // namespace smpl
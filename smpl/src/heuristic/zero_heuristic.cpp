@@ -31,6 +31,9 @@
 
 #include <smpl/heuristic/zero_heuristic.h>
 
+// standard includes
+#include <algorithm>
+
 namespace smpl {
 
 bool ZeroHeuristic::init(RobotPlanningSpace* space)
@@ -56,6 +59,14 @@ Extension* ZeroHeuristic::getExtension(size_t class_code)
     return nullptr;
 }
 
+void ZeroHeuristic::GetGoalHeuristics(
+    const int* state_ids,
+    size_t count,
+    int* values)
+{
+    std::fill(values, values + count, 0);
+}
+
 int ZeroHeuristic::GetGoalHeuristic(int state_id)
 {
     return 0;
@@ -64,6 +64,13 @@ namespace smpl {
 /// distance map. This may corrupt the invariant that the obstacle exists in
 /// the distance map if its reference count is non-zero.
 ///
+/// The third additional feature is an optional DistancePyramid, enabled with
+/// setDistancePyramidLevels(), which allows isClear() to answer clearance
+/// queries far from obstacles from a small, coarse grid. The pyramid is kept
+/// in sync with modifications made through the OccupancyGrid, so, as with
+/// reference counting, the caller must not directly modify the distance map
+/// while the pyramid is enabled.
+///
 /// An arbitrary distance map implementation may be used with this class. If
 /// none is specified, by calling the verbose constructor, an instance of
 /// smpl::EuclidDistanceMap is constructed.
@@ -139,7 +146,9 @@ OccupancyGrid::OccupancyGrid(const OccupancyGrid& o) :
     m_ref_counted(o.m_ref_counted),
     m_x_stride(o.m_x_stride),
     m_y_stride(o.m_y_stride),
-    m_counts(o.m_counts)
+    m_counts(o.m_counts),
+    m_pyramid(o.m_pyramid ? new DistancePyramid(*o.m_pyramid) : nullptr),
+    m_version(o.m_version)
 {
 }
 
@@ -152,6 +161,9 @@ OccupancyGrid& OccupancyGrid::operator=(const OccupancyGrid& rhs)
         m_x_stride = rhs.m_x_stride;
         m_y_stride = rhs.m_y_stride;
         m_counts = rhs.m_counts;
+        m_pyramid.reset(
+                rhs.m_pyramid ? new DistancePyramid(*rhs.m_pyramid) : nullptr);
+        ++m_version;
     }
     return *this;
 }
@@ -161,9 +173,69 @@ OccupancyGrid& OccupancyGrid::operator=(const OccupancyGrid& rhs)
 void OccupancyGrid::reset()
 {
     m_grid->reset();
+    ++m_version;
     if (m_ref_counted) {
         m_counts.assign(getCellCount(), 0);
     }
+    if (m_pyramid) {
+        m_pyramid->rebuild(*m_grid);
+    }
+}
+
+/// Move the volume covered by the grid by a whole number of cells along each
+/// axis, e.g. to keep it centered on a moving robot. Obstacles that remain
+/// within the volume are kept, and obstacles that leave it are forgotten;
+/// obstacles entering the volume must be added by the caller. BFS heuristics
+/// computed over the grid recompute their walls on their next start or goal
+/// update. Return false, leaving the grid unchanged, if the underlying distance
+/// map does not support moving.
+bool OccupancyGrid::shiftOrigin(int dx, int dy, int dz)
+{
+    if (!m_grid->shiftOrigin(dx, dy, dz)) {
+        return false;
+    }
+    ++m_version;
+
+    if (m_ref_counted) {
+        const int xc = m_grid->numCellsX();
+        const int yc = m_grid->numCellsY();
+        const int zc = m_grid->numCellsZ();
+        std::vector<int> counts(getCellCount(), 0);
+        for (int x = std::max(0, -dx); x < std::min(xc, xc - dx); ++x) {
+        for (int y = std::max(0, -dy); y < std::min(yc, yc - dy); ++y) {
+        for (int z = std::max(0, -dz); z < std::min(zc, zc - dz); ++z) {
+            counts[coordToIndex(x, y, z)] =
+                    m_counts[coordToIndex(x + dx, y + dy, z + dz)];
+        }
+        }
+        }
+        m_counts = std::move(counts);
+    }
+
+    if (m_pyramid) {
+        m_pyramid->rebuild(*m_grid);
+    }
+
+    return true;
+}
+
+/// Enable a distance pyramid with the given number of levels, at most
+/// DistancePyramid::MAX_LEVELS, to accelerate isClear(). A value of 0 disables
+/// the pyramid.
+void OccupancyGrid::setDistancePyramidLevels(int levels)
+{
+    if (levels <= 0) {
+        m_pyramid.reset();
+        return;
+    }
+
+    m_pyramid.reset(new DistancePyramid(levels));
+    m_pyramid->rebuild(*m_grid);
+}
+
+int OccupancyGrid::distancePyramidLevels() const
+{
+    return m_pyramid ? m_pyramid->levels() : 0;
 }
 
 /// Count the number of obstacles in the occupancy grid.
@@ -361,6 +433,7 @@ auto OccupancyGrid::getOccupiedVoxelsVisualization() const -> visual::Marker
 void OccupancyGrid::addPointsToField(
     const std::vector<Vector3>& points)
 {
+    ++m_version;
     if (m_ref_counted) {
         std::vector<Vector3> pts;
         pts.reserve(points.size());
@@ -379,9 +452,11 @@ void OccupancyGrid::addPointsToField(
             }
         }
         m_grid->addPointsToMap(pts);
+        updatePyramid(pts);
     }
     else {
         m_grid->addPointsToMap(points);
+        updatePyramid(points);
     }
 }
 
@@ -389,6 +464,7 @@ void OccupancyGrid::addPointsToField(
 void OccupancyGrid::removePointsFromField(
     const std::vector<Vector3>& points)
 {
+    ++m_version;
     if (m_ref_counted) {
         std::vector<Vector3> pts;
         pts.reserve(points.size());
@@ -408,9 +484,11 @@ void OccupancyGrid::removePointsFromField(
             }
         }
         m_grid->removePointsFromMap(pts);
+        updatePyramid(pts);
     }
     else {
         m_grid->removePointsFromMap(points);
+        updatePyramid(points);
     }
 }
 
@@ -423,6 +501,16 @@ void OccupancyGrid::updatePointsInField(
 {
     // TODO: ref counting
     m_grid->updatePointsInMap(old_points, new_points);
+    ++m_version;
+    updatePyramid(old_points);
+    updatePyramid(new_points);
+}
+
+void OccupancyGrid::updatePyramid(const std::vector<Vector3>& points)
+{
+    if (m_pyramid) {
+        m_pyramid->update(*m_grid, points);
+    }
 }
 
 void OccupancyGrid::initRefCounts()
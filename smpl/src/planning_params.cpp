@@ -204,6 +204,12 @@ bool PlanningParams::hasParam(const std::string& name) const
     return it != params.end();
 }
 
+auto PlanningParams::getParams() const
+    -> const std::unordered_map<std::string, Parameter>&
+{
+    return params;
+}
+
 void PlanningParams::convertToBool(const Parameter& p, bool& val) const
 {
     struct bool_converter : public boost::static_visitor<bool> {
@@ -32,6 +32,7 @@
 #include <smpl/search/arastar.h>
 
 #include <algorithm>
+#include <thread>
 
 // system includes
 #include <sbpl/utils/key.h>
@@ -39,12 +40,22 @@
 // project includes
 #include <smpl/time.h>
 #include <smpl/console/console.h>
+#include <smpl/heuristic/robot_heuristic.h>
+#include <smpl/memory_usage.h>
+#include <smpl/search/search_trace.h>
 
 namespace smpl {
 
 static const char* SLOG = "search";
 static const char* SELOG = "search.expansions";
 
+// Memory usage is checked against the limit once every this many expansions.
+static const int MemoryCheckInterval = 256;
+
+// Heuristics are recomputed on the calling thread unless there are at least
+// this many states per available hardware thread.
+static const size_t MinHeuristicsPerThread = 4096;
+
 ARAStar::ARAStar(
     DiscreteSpaceInformation* space,
     Heuristic* heur)
@@ -52,18 +63,25 @@ ARAStar::ARAStar(
     SBPLPlanner(),
     m_space(space),
     m_heur(heur),
+    m_space_memory(dynamic_cast<MemoryUsageExtension*>(space)),
+    m_batch_heur(dynamic_cast<RobotHeuristic*>(heur)),
     m_time_params(),
     m_initial_eps(1.0),
     m_final_eps(1.0),
     m_delta_eps(1.0),
     m_allow_partial_solutions(false),
+    m_allow_incremental_repair(false),
+    m_memory_limit(0),
+    m_trace(nullptr),
+    m_trace_heur_time(clock::duration::zero()),
     m_states(),
     m_start_state_id(-1),
     m_goal_state_id(-1),
-    m_open(),
+    m_open(SearchStatePosition{ &m_states }),
     m_incons(),
     m_curr_eps(1.0),
     m_iteration(1),
+    m_pred_count(0),
     m_call_number(0),
     m_last_start_state_id(-1),
     m_last_goal_state_id(-1),
@@ -87,11 +105,6 @@ ARAStar::ARAStar(
 
 ARAStar::~ARAStar()
 {
-    for (SearchState* s : m_states) {
-        if (s != NULL) {
-            delete s;
-        }
-    }
 }
 
 enum ReplanResultCode
@@ -101,7 +114,8 @@ enum ReplanResultCode
     START_NOT_SET,
     GOAL_NOT_SET,
     TIMED_OUT,
-    EXHAUSTED_OPEN_LIST
+    EXHAUSTED_OPEN_LIST,
+    OUT_OF_MEMORY
 };
 
 int ARAStar::replan(
@@ -122,21 +136,24 @@ int ARAStar::replan(
 
     m_time_params = params;
 
-    SearchState* start_state = getSearchState(m_start_state_id);
-    SearchState* goal_state = getSearchState(m_goal_state_id);
+    growStates(std::max(m_start_state_id, m_goal_state_id));
 
-    if (m_start_state_id != m_last_start_state_id) {
+    bool reinit = m_start_state_id != m_last_start_state_id;
+    if (reinit) {
         SMPL_DEBUG_NAMED(SLOG, "Reinitialize search");
         m_open.clear();
         m_incons.clear();
+        m_preds.clear();
+        m_pred_count = 0;
         ++m_call_number; // trigger state reinitializations
 
-        reinitSearchState(start_state);
-        reinitSearchState(goal_state);
+        reinitSearchState(m_start_state_id);
+        reinitSearchState(m_goal_state_id);
 
-        start_state->g = 0;
-        start_state->f = computeKey(start_state);
-        m_open.push(start_state);
+        SearchState& start_state = m_states[m_start_state_id];
+        start_state.g = 0;
+        start_state.f = computeKey(start_state);
+        m_open.push(m_start_state_id, start_state.f);
 
         m_iteration = 1; // 0 reserved for "not closed on any iteration"
 
@@ -155,8 +172,25 @@ int ARAStar::replan(
 
     if (m_goal_state_id != m_last_goal_state_id) {
         SMPL_DEBUG_NAMED(SLOG, "Refresh heuristics, keys, and reorder open list");
+        if (!reinit) {
+            // search toward the new goal in a new iteration. g-values remain
+            // valid since the start has not changed.
+            reinitSearchState(m_goal_state_id);
+            ++m_iteration;
+            m_curr_eps = m_initial_eps;
+            m_satisfied_eps = std::numeric_limits<double>::infinity();
+            for (int s : m_incons) {
+                m_states[s].incons = false;
+                m_open.push(s, m_states[s].f);
+            }
+            m_incons.clear();
+        }
         recomputeHeuristics();
         reorderOpen();
+        if (!reinit && !m_open.contains(m_goal_state_id)) {
+            SearchState& goal_state = m_states[m_goal_state_id];
+            goal_state.f = computeKey(goal_state);
+        }
 
         m_last_goal_state_id = m_goal_state_id;
     }
@@ -165,7 +199,11 @@ int ARAStar::replan(
     int num_expansions = 0;
     clock::duration elapsed_time = clock::duration::zero();
 
-    int err;
+    if (m_trace) {
+        m_trace->beginSearch("arastar", m_start_state_id, m_goal_state_id);
+    }
+
+    int err = SUCCESS;
     while (m_satisfied_eps > m_final_eps) {
         if (m_curr_eps == m_satisfied_eps) {
             if (!m_time_params.improve) {
@@ -175,15 +213,18 @@ int ARAStar::replan(
             ++m_iteration;
             m_curr_eps -= m_delta_eps;
             m_curr_eps = std::max(m_curr_eps, m_final_eps);
-            for (SearchState* s : m_incons) {
-                s->incons = false;
-                m_open.push(s);
+            for (int s : m_incons) {
+                m_states[s].incons = false;
+                m_open.push(s, m_states[s].f);
             }
             reorderOpen();
             m_incons.clear();
             SMPL_DEBUG_NAMED(SLOG, "Begin new search iteration %d with epsilon = %0.3f", m_iteration, m_curr_eps);
         }
-        err = improvePath(start_time, goal_state, num_expansions, elapsed_time);
+        if (m_trace) {
+            m_trace->beginIteration(m_curr_eps);
+        }
+        err = improvePath(start_time, num_expansions, elapsed_time);
         if (m_curr_eps == m_initial_eps) {
             m_expand_count_init += num_expansions;
             m_search_time_init += elapsed_time;
@@ -198,17 +239,36 @@ int ARAStar::replan(
     m_search_time += elapsed_time;
     m_expand_count += num_expansions;
 
+    int result;
     if (m_satisfied_eps == std::numeric_limits<double>::infinity()) {
         if (m_allow_partial_solutions && !m_open.empty()) {
-            SearchState* next_state = m_open.min();
-            extractPath(next_state, *solution, *cost);
-            return !SUCCESS;
+            extractPath(m_open.min(), *solution, *cost);
+            if (m_trace) {
+                m_trace->endSearch(false, *cost, *solution);
+            }
+            result = !SUCCESS;
+        } else {
+            if (m_trace) {
+                m_trace->endSearch(false, -1, std::vector<int>());
+            }
+            result = !err;
+        }
+    } else {
+        extractPath(m_goal_state_id, *solution, *cost);
+        if (m_trace) {
+            m_trace->endSearch(true, *cost, *solution);
         }
-        return !err;
+        result = !SUCCESS;
+    }
+
+    // release the search tree that exceeded the memory limit, so that the
+    // next call to replan() begins from scratch instead of growing it further
+    if (err == OUT_OF_MEMORY) {
+        SMPL_DEBUG_NAMED(SLOG, "Free search memory");
+        force_planning_from_scratch_and_free_memory();
     }
 
-    extractPath(goal_state, *solution, *cost);
-    return !SUCCESS;
+    return result;
 }
 
 int ARAStar::replan(
@@ -289,13 +349,12 @@ int ARAStar::force_planning_from_scratch_and_free_memory()
 {
     force_planning_from_scratch();
     m_open.clear();
-    for (SearchState* s : m_states) {
-        if (s != NULL) {
-            delete s;
-        }
-    }
+    m_incons.clear();
     m_states.clear();
     m_states.shrink_to_fit();
+    m_preds.clear();
+    m_preds.shrink_to_fit();
+    m_pred_count = 0;
     return 0;
 }
 
@@ -358,6 +417,19 @@ void ARAStar::set_initialsolution_eps(double eps)
     m_initial_eps = eps;
 }
 
+size_t ARAStar::memoryUsage() const
+{
+    return VectorMemoryUsage(m_states) +
+            m_open.size() * sizeof(decltype(m_open)::element) +
+            VectorMemoryUsage(m_incons) +
+            VectorMemoryUsage(m_preds) +
+            m_pred_count * sizeof(int) +
+            VectorMemoryUsage(m_succs) +
+            VectorMemoryUsage(m_costs) +
+            VectorMemoryUsage(m_heur_ids) +
+            VectorMemoryUsage(m_heur_values);
+}
+
 /// Set the goal state.
 int ARAStar::set_goal(int goal_state_id)
 {
@@ -388,20 +460,255 @@ int ARAStar::set_search_mode(bool first_solution_unbounded)
     return 0;
 }
 
+/// Enable or disable incremental repair of the search tree when edge costs
+/// change. Changing the setting forces the next search to begin from scratch.
+void ARAStar::allowIncrementalRepair(bool enabled)
+{
+    if (enabled != m_allow_incremental_repair) {
+        m_allow_incremental_repair = enabled;
+        force_planning_from_scratch();
+    }
+}
+
 /// Notify the search of changes to edge costs in the graph.
+///
+/// The predecessors in \p changes are the states whose outgoing edges have
+/// changed, and the successors are the states whose incoming edges have
+/// changed. If incremental repair is enabled, the search tree is repaired
+/// around the changed edges; otherwise, the next search begins from scratch.
 void ARAStar::costs_changed(const StateChangeQuery& changes)
 {
-    force_planning_from_scratch();
+    if (!m_allow_incremental_repair || !repairSearchTree(changes)) {
+        force_planning_from_scratch();
+    }
+}
+
+// Remember that a state was generated as a successor of another state.
+void ARAStar::recordPredecessor(int state_id, int pred_id)
+{
+    if ((int)m_preds.size() <= state_id) {
+        m_preds.resize(state_id + 1);
+    }
+    auto& preds = m_preds[state_id];
+    if (std::find(preds.begin(), preds.end(), pred_id) == preds.end()) {
+        preds.push_back(pred_id);
+        ++m_pred_count;
+    }
 }
 
-// Recompute heuristics for all states.
+// Repair the search tree after edge costs have changed. Every state whose
+// path from the start passes through a changed edge is returned to its
+// initial, unvisited state. The states with changed outgoing edges, and the
+// states with edges into the discarded part of the tree, are returned to OPEN
+// to be expanded again, after which the search resumes as in a new ARA*
+// iteration. Return false if there is no search tree to repair.
+bool ARAStar::repairSearchTree(const StateChangeQuery& changes)
+{
+    if (m_last_start_state_id < 0 || m_last_start_state_id != m_start_state_id) {
+        return false;
+    }
+
+    enum : char { CHANGED = 1, VISITED = 2, AFFECTED = 4 };
+    std::vector<char> marks(m_states.size(), 0);
+
+    auto valid_state = [&](int state_id)
+    {
+        return state_id >= 0 && state_id < (int)m_states.size() &&
+                m_states[state_id].call_number == m_call_number;
+    };
+
+    std::vector<int> changed;
+    auto add_changed = [&](int state_id)
+    {
+        if (valid_state(state_id) && !(marks[state_id] & CHANGED)) {
+            marks[state_id] |= CHANGED;
+            changed.push_back(state_id);
+        }
+    };
+
+    if (auto* preds = changes.getPredecessors()) {
+        for (int state_id : *preds) {
+            add_changed(state_id);
+        }
+    }
+    if (auto* succs = changes.getSuccessors()) {
+        for (int state_id : *succs) {
+            if (state_id >= 0 && state_id < (int)m_preds.size()) {
+                for (int pred_id : m_preds[state_id]) {
+                    add_changed(pred_id);
+                }
+            }
+        }
+    }
+
+    SMPL_DEBUG_NAMED(SLOG, "Repair search tree around %zu changed states", changed.size());
+
+    if (changed.empty()) {
+        return true;
+    }
+
+    // find the states whose back pointers lead through a changed edge,
+    // resolving the chain of back pointers up to the first state whose status
+    // is already known
+    std::vector<int> affected;
+    std::vector<int> chain;
+    for (int state_id = 0; state_id < (int)m_states.size(); ++state_id) {
+        if (m_states[state_id].call_number != m_call_number) {
+            continue;
+        }
+
+        chain.clear();
+        int t = state_id;
+        while (t >= 0 && !(marks[t] & VISITED)) {
+            chain.push_back(t);
+            t = m_states[t].bp;
+        }
+
+        bool parent_affected = t >= 0 && (marks[t] & AFFECTED);
+        for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+            int c = *it;
+            int bp = m_states[c].bp;
+            bool a = bp >= 0 && (parent_affected || (marks[bp] & CHANGED));
+            marks[c] |= VISITED;
+            if (a) {
+                marks[c] |= AFFECTED;
+                affected.push_back(c);
+            }
+            parent_affected = a;
+        }
+    }
+
+    SMPL_DEBUG_NAMED(SLOG, "  Discard %zu states", affected.size());
+
+    for (int state_id : affected) {
+        if (m_open.contains(state_id)) {
+            m_open.erase(state_id);
+        }
+        SearchState& s = m_states[state_id];
+        s.g = INFINITECOST;
+        s.f = INFINITECOST;
+        s.eg = INFINITECOST;
+        s.iteration_closed = 0;
+        s.bp = -1;
+        s.incons = false;
+    }
+
+    // reopen expanded states that may offer new paths
+    int reopened = 0;
+    auto reopen = [&](int state_id)
+    {
+        if (!valid_state(state_id) || (marks[state_id] & AFFECTED)) {
+            return;
+        }
+        SearchState& s = m_states[state_id];
+        if (s.eg == INFINITECOST || m_open.contains(state_id)) {
+            return;
+        }
+        s.iteration_closed = 0;
+        s.incons = false;
+        s.f = computeKey(s);
+        m_open.push(state_id, s.f);
+        ++reopened;
+    };
+
+    for (int state_id : changed) {
+        reopen(state_id);
+    }
+    for (int state_id : affected) {
+        if (state_id < (int)m_preds.size()) {
+            for (int pred_id : m_preds[state_id]) {
+                reopen(pred_id);
+            }
+        }
+    }
+
+    SMPL_DEBUG_NAMED(SLOG, "  Reopen %d states", reopened);
+
+    // begin a new search iteration, restarting from the initial epsilon if
+    // the previous solution was lost
+    if (!valid_state(m_goal_state_id) ||
+        m_states[m_goal_state_id].g == INFINITECOST)
+    {
+        m_curr_eps = m_initial_eps;
+    }
+    m_satisfied_eps = std::numeric_limits<double>::infinity();
+
+    ++m_iteration;
+    for (int state_id : m_incons) {
+        SearchState& s = m_states[state_id];
+        if (s.incons) {
+            s.incons = false;
+            m_open.push(state_id, s.f);
+        }
+    }
+    m_incons.clear();
+
+    // heuristics may depend on the changed environment
+    recomputeHeuristics();
+    reorderOpen();
+    return true;
+}
+
+// Recompute heuristics for all states initialized for the current search;
+// the rest are recomputed when they are reinitialized. A RobotHeuristic
+// computes them in batches, split across threads if it allows concurrent
+// batches.
 void ARAStar::recomputeHeuristics()
 {
-    for (SearchState* s : m_states) {
-        if (s != NULL) {
-            s->h = m_heur->GetGoalHeuristic(s->state_id);
+    if (m_batch_heur == NULL) {
+        for (int state_id = 0; state_id < (int)m_states.size(); ++state_id) {
+            SearchState& s = m_states[state_id];
+            if (s.call_number == m_call_number) {
+                s.h = m_heur->GetGoalHeuristic(state_id);
+            }
+        }
+        return;
+    }
+
+    m_heur_ids.clear();
+    for (int state_id = 0; state_id < (int)m_states.size(); ++state_id) {
+        if (m_states[state_id].call_number == m_call_number) {
+            m_heur_ids.push_back(state_id);
+        }
+    }
+
+    const size_t count = m_heur_ids.size();
+    m_heur_values.resize(count);
+
+    size_t thread_count = 1;
+    if (m_batch_heur->concurrentGoalHeuristics()) {
+        thread_count = std::thread::hardware_concurrency();
+        thread_count = std::min(thread_count, count / MinHeuristicsPerThread);
+    }
+
+    if (thread_count <= 1) {
+        m_batch_heur->GetGoalHeuristics(
+                m_heur_ids.data(), count, m_heur_values.data());
+    } else {
+        auto compute_batch = [&](size_t begin, size_t end)
+        {
+            m_batch_heur->GetGoalHeuristics(
+                    m_heur_ids.data() + begin,
+                    end - begin,
+                    m_heur_values.data() + begin);
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(thread_count);
+        for (size_t i = 0; i < thread_count; ++i) {
+            size_t begin = i * count / thread_count;
+            size_t end = (i + 1) * count / thread_count;
+            threads.emplace_back(compute_batch, begin, end);
+        }
+
+        for (auto& thread : threads) {
+            thread.join();
         }
     }
+
+    for (size_t i = 0; i < count; ++i) {
+        m_states[m_heur_ids[i]].h = m_heur_values[i];
+    }
 }
 
 // Convert TimeParameters to ReplanParams. Uses the current epsilon values
@@ -478,22 +785,38 @@ bool ARAStar::timedOut(
     return true;
 }
 
+// Test whether the search, and the graph, hold more memory than allowed.
+bool ARAStar::outOfMemory() const
+{
+    if (m_memory_limit == 0) {
+        return false;
+    }
+
+    size_t usage = memoryUsage();
+    if (m_space_memory) {
+        usage += m_space_memory->memoryUsage();
+    }
+    return usage > m_memory_limit;
+}
+
 // Expand states to improve the current solution until a solution within the
 // current suboptimality bound is found, time runs out, or no solution exists.
 int ARAStar::improvePath(
     const clock::time_point& start_time,
-    SearchState* goal_state,
     int& elapsed_expansions,
     clock::duration& elapsed_time)
 {
     while (!m_open.empty()) {
-        SearchState* min_state = m_open.min();
+        int min_state_id = m_open.min();
+        SearchState& min_state = m_states[min_state_id];
 
         auto now = clock::now();
         elapsed_time = now - start_time;
 
         // path to goal found
-        if (min_state->f >= goal_state->f || min_state == goal_state) {
+        if (min_state.f >= m_states[m_goal_state_id].f ||
+            min_state_id == m_goal_state_id)
+        {
             SMPL_DEBUG_NAMED(SLOG, "Found path to goal");
             return SUCCESS;
         }
@@ -503,17 +826,22 @@ int ARAStar::improvePath(
             return TIMED_OUT;
         }
 
-        SMPL_DEBUG_NAMED(SELOG, "Expand state %d", min_state->state_id);
+        if (elapsed_expansions % MemoryCheckInterval == 0 && outOfMemory()) {
+            SMPL_WARN_NAMED(SLOG, "Search exceeded memory limit of %zu bytes", m_memory_limit);
+            return OUT_OF_MEMORY;
+        }
+
+        SMPL_DEBUG_NAMED(SELOG, "Expand state %d", min_state_id);
 
         m_open.pop();
 
-        assert(min_state->iteration_closed != m_iteration);
-        assert(min_state->g != INFINITECOST);
+        assert(min_state.iteration_closed != m_iteration);
+        assert(min_state.g != INFINITECOST);
 
-        min_state->iteration_closed = m_iteration;
-        min_state->eg = min_state->g;
+        min_state.iteration_closed = m_iteration;
+        min_state.eg = min_state.g;
 
-        expand(min_state);
+        expand(min_state_id);
 
         ++elapsed_expansions;
     }
@@ -523,109 +851,140 @@ int ARAStar::improvePath(
 
 // Expand a state, updating its successors and placing them into OPEN, CLOSED,
 // and INCONS list appropriately.
-void ARAStar::expand(SearchState* s)
+void ARAStar::expand(int state_id)
 {
+    clock::time_point succs_start;
+    clock::duration succs_time = clock::duration::zero();
+    if (m_trace) {
+        m_trace_heur_time = clock::duration::zero();
+        succs_start = clock::now();
+    }
+
     m_succs.clear();
     m_costs.clear();
-    m_space->GetSuccs(s->state_id, &m_succs, &m_costs);
+    m_space->GetSuccs(state_id, &m_succs, &m_costs);
+
+    if (m_trace) {
+        succs_time = clock::now() - succs_start;
+    }
 
     SMPL_DEBUG_NAMED(SELOG, "  %zu successors", m_succs.size());
 
+    // grow the state table once, before taking references into it
+    if (!m_succs.empty()) {
+        growStates(*std::max_element(m_succs.begin(), m_succs.end()));
+    }
+
+    const unsigned int eg = m_states[state_id].eg;
+
     for (size_t sidx = 0; sidx < m_succs.size(); ++sidx) {
         int succ_state_id = m_succs[sidx];
         int cost = m_costs[sidx];
 
-        SearchState* succ_state = getSearchState(succ_state_id);
-        reinitSearchState(succ_state);
-
-        int new_cost = s->eg + cost;
-        SMPL_DEBUG_NAMED(SELOG, "Compare new cost %d vs old cost %d", new_cost, succ_state->g);
-        if (new_cost < succ_state->g) {
-            succ_state->g = new_cost;
-            succ_state->bp = s;
-            if (succ_state->iteration_closed != m_iteration) {
-                succ_state->f = computeKey(succ_state);
-                if (m_open.contains(succ_state)) {
-                    m_open.decrease(succ_state);
+        reinitSearchState(succ_state_id);
+        SearchState& succ_state = m_states[succ_state_id];
+
+        if (m_allow_incremental_repair) {
+            recordPredecessor(succ_state_id, state_id);
+        }
+
+        int new_cost = eg + cost;
+        SMPL_DEBUG_NAMED(SELOG, "Compare new cost %d vs old cost %d", new_cost, succ_state.g);
+        if (new_cost < succ_state.g) {
+            succ_state.g = new_cost;
+            succ_state.bp = state_id;
+            if (succ_state.iteration_closed != m_iteration) {
+                succ_state.f = computeKey(succ_state);
+                if (m_open.contains(succ_state_id)) {
+                    m_open.decrease(succ_state_id, succ_state.f);
                 } else {
-                    m_open.push(succ_state);
+                    m_open.push(succ_state_id, succ_state.f);
                 }
-            } else if (!succ_state->incons) {
-                m_incons.push_back(succ_state);
+            } else if (!succ_state.incons) {
+                succ_state.incons = true;
+                m_incons.push_back(succ_state_id);
             }
         }
     }
+
+    if (m_trace) {
+        const SearchState& s = m_states[state_id];
+        ExpansionRecord record;
+        record.state_id = state_id;
+        record.queue = 0;
+        record.g = s.eg;
+        record.h = s.h;
+        record.f = s.f;
+        record.succ_count = (std::uint32_t)m_succs.size();
+        record.succ_time_ns = ToTraceTime(succs_time);
+        record.heur_time_ns = ToTraceTime(m_trace_heur_time);
+        record.eval_time_ns = 0;
+        record.type = ExpansionRecord::Expansion;
+        m_trace->recordExpansion(record);
+    }
 }
 
 // Recompute the f-values of all states in OPEN and reorder OPEN.
 void ARAStar::reorderOpen()
 {
     for (auto it = m_open.begin(); it != m_open.end(); ++it) {
-        (*it)->f = computeKey(*it);
+        SearchState& s = m_states[it->index];
+        s.f = computeKey(s);
+        it->key = s.f;
     }
     m_open.make();
 }
 
-int ARAStar::computeKey(SearchState* s) const
+int ARAStar::computeKey(const SearchState& s) const
 {
-    return s->g + (unsigned int)(m_curr_eps * s->h);
+    return s.g + (unsigned int)(m_curr_eps * s.h);
 }
 
-// Get the search state corresponding to a graph state, creating a new state if
-// one has not been created yet.
-ARAStar::SearchState* ARAStar::getSearchState(int state_id)
+// Grow the state table to include a graph state. New states are zeroed, which
+// marks them as not yet initialized for any search. The table grows
+// geometrically, since graphs typically number states in the order they are
+// discovered.
+void ARAStar::growStates(int state_id)
 {
-    if (m_states.size() <= state_id) {
-        m_states.resize(state_id + 1, nullptr);
+    if (state_id >= (int)m_states.size()) {
+        m_states.resize(std::max((size_t)state_id + 1, 2 * m_states.size()));
     }
-
-    auto& state = m_states[state_id];
-    if (state == NULL) {
-        state = createState(state_id);
-    }
-
-    return state;
-}
-
-// Create a new search state for a graph state.
-ARAStar::SearchState* ARAStar::createState(int state_id)
-{
-    assert(state_id < m_states.size());
-
-    SearchState* ss = new SearchState;
-    ss->state_id = state_id;
-    ss->call_number = 0;
-
-    return ss;
 }
 
 // Lazily (re)initialize a search state.
-void ARAStar::reinitSearchState(SearchState* state)
-{
-    if (state->call_number != m_call_number) {
-        SMPL_DEBUG_NAMED(SELOG, "Reinitialize state %d", state->state_id);
-        state->g = INFINITECOST;
-        state->h = m_heur->GetGoalHeuristic(state->state_id);
-        state->f = INFINITECOST;
-        state->eg = INFINITECOST;
-        state->iteration_closed = 0;
-        state->call_number = m_call_number;
-        state->bp = nullptr;
-        state->incons = false;
+void ARAStar::reinitSearchState(int state_id)
+{
+    SearchState& state = m_states[state_id];
+    if (state.call_number != m_call_number) {
+        SMPL_DEBUG_NAMED(SELOG, "Reinitialize state %d", state_id);
+        state.g = INFINITECOST;
+        if (m_trace) {
+            auto then = clock::now();
+            state.h = m_heur->GetGoalHeuristic(state_id);
+            m_trace_heur_time += clock::now() - then;
+        } else {
+            state.h = m_heur->GetGoalHeuristic(state_id);
+        }
+        state.f = INFINITECOST;
+        state.eg = INFINITECOST;
+        state.iteration_closed = 0;
+        state.call_number = m_call_number;
+        state.bp = -1;
+        state.incons = false;
     }
 }
 
 // Extract the path from the start state up to a new state.
 void ARAStar::extractPath(
-    SearchState* to_state,
+    int to_state_id,
     std::vector<int>& solution,
     int& cost) const
 {
-    for (SearchState* s = to_state; s; s = s->bp) {
-        solution.push_back(s->state_id);
+    for (int s = to_state_id; s >= 0; s = m_states[s].bp) {
+        solution.push_back(s);
     }
     std::reverse(solution.begin(), solution.end());
-    cost = to_state->g;
+    cost = m_states[to_state_id].g;
 }
 
 } // namespace smpl
@@ -0,0 +1,416 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2018, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#include <smpl/search/bidirectional_wastar.h>
+
+// standard includes
+#include <algorithm>
+
+// project includes
+#include <smpl/console/console.h>
+
+namespace smpl {
+
+static const char* SLOG = "search";
+static const char* SELOG = "search.expansions";
+
+enum ReplanResultCode
+{
+    SUCCESS             =  0,
+    START_NOT_SET       = -2,
+    GOAL_NOT_SET        = -3,
+    TIMED_OUT           = -4,
+    EXHAUSTED_OPEN_LIST = -5,
+};
+
+BidirectionalWAStar::BidirectionalWAStar(
+    DiscreteSpaceInformation* space,
+    Heuristic* heuristic)
+:
+    SBPLPlanner(),
+    m_space(space),
+    m_heur(heuristic),
+    m_eps(1.0),
+    m_start_state_id(-1),
+    m_goal_state_id(-1),
+    m_call_number(0),
+    m_meet_state_id(-1),
+    m_best_cost(INFINITECOST),
+    m_expand_count(0),
+    m_search_time(clock::duration::zero())
+{
+    environment_ = space;
+}
+
+BidirectionalWAStar::~BidirectionalWAStar()
+{
+    force_planning_from_scratch_and_free_memory();
+}
+
+int BidirectionalWAStar::replan(
+    double allowed_time_secs,
+    std::vector<int>* solution)
+{
+    int cost;
+    return replan(allowed_time_secs, solution, &cost);
+}
+
+int BidirectionalWAStar::replan(
+    double allowed_time_secs,
+    std::vector<int>* solution,
+    int* cost)
+{
+    SMPL_DEBUG_NAMED(SLOG, "Find path to goal");
+
+    if (m_start_state_id < 0) {
+        SMPL_ERROR_NAMED(SLOG, "Start state not set");
+        return false;
+    }
+    if (m_goal_state_id < 0) {
+        SMPL_ERROR_NAMED(SLOG, "Goal state not set");
+        return false;
+    }
+
+    // begin a new search
+    ++m_call_number;
+    for (int dir = Forward; dir <= Backward; ++dir) {
+        m_open[dir].clear();
+        m_open_g[dir].clear();
+    }
+    m_meet_state_id = -1;
+    m_best_cost = INFINITECOST;
+    m_expand_count = 0;
+
+    SearchState* start_state = getSearchState(Forward, m_start_state_id);
+    reinitSearchState(Forward, start_state);
+    start_state->g = 0;
+    start_state->f = computeKey(start_state);
+    insertOrUpdate(Forward, start_state);
+
+    SearchState* goal_state = getSearchState(Backward, m_goal_state_id);
+    reinitSearchState(Backward, goal_state);
+    goal_state->g = 0;
+    goal_state->f = computeKey(goal_state);
+    insertOrUpdate(Backward, goal_state);
+
+    if (m_start_state_id == m_goal_state_id) {
+        m_meet_state_id = m_start_state_id;
+        m_best_cost = 0;
+    }
+
+    auto allowed_time = to_duration(allowed_time_secs);
+    auto start_time = clock::now();
+
+    int err = SUCCESS;
+    while (true) {
+        // the largest minimum key over the open lists bounds the cost of the
+        // solution through any state not yet expanded
+        int min_key = -1;
+        for (int dir = Forward; dir <= Backward; ++dir) {
+            if (!m_open[dir].empty()) {
+                min_key = std::max(min_key, m_open[dir].min()->f);
+            }
+        }
+
+        if (min_key < 0) {
+            SMPL_DEBUG_NAMED(SLOG, "Exhausted open lists");
+            if (m_best_cost == INFINITECOST) {
+                err = EXHAUSTED_OPEN_LIST;
+            }
+            break;
+        }
+
+        // a path not yet found must also pass through a state in each open
+        // list, so the smallest g-values of the two frontiers bound its cost
+        int bound = min_key;
+        if (!m_open_g[Forward].empty() && !m_open_g[Backward].empty()) {
+            int min_g_sum =
+                    m_open_g[Forward].min()->state->g +
+                    m_open_g[Backward].min()->state->g;
+            bound = std::max(bound, min_g_sum);
+        }
+
+        if (m_best_cost <= bound) {
+            SMPL_DEBUG_NAMED(SLOG, "Found path to goal through state %d", m_meet_state_id);
+            break;
+        }
+
+        if (clock::now() - start_time > allowed_time) {
+            SMPL_DEBUG_NAMED(SLOG, "Ran out of time");
+            err = TIMED_OUT;
+            break;
+        }
+
+        // expand from the search with the smaller frontier
+        int dir;
+        if (m_open[Backward].empty()) {
+            dir = Forward;
+        } else if (m_open[Forward].empty()) {
+            dir = Backward;
+        } else {
+            dir = m_open[Forward].size() <= m_open[Backward].size() ? Forward : Backward;
+        }
+
+        SearchState* s = m_open[dir].min();
+        m_open[dir].pop();
+        m_open_g[dir].erase(&s->g_elem);
+        s->closed = true;
+        ++m_expand_count;
+        expand(dir, s);
+    }
+
+    m_search_time = clock::now() - start_time;
+
+    SMPL_DEBUG_NAMED(SLOG, "Expanded %d states in %0.3fs", m_expand_count, to_seconds(m_search_time));
+
+    if (err != SUCCESS) {
+        return !err;
+    }
+
+    solution->clear();
+    extractPath(*solution);
+    *cost = m_best_cost;
+    return !SUCCESS;
+}
+
+int BidirectionalWAStar::replan(std::vector<int>* solution, ReplanParams params)
+{
+    int cost;
+    return replan(solution, params, &cost);
+}
+
+int BidirectionalWAStar::replan(
+    std::vector<int>* solution,
+    ReplanParams params,
+    int* cost)
+{
+    m_eps = params.initial_eps;
+    return replan(params.max_time, solution, cost);
+}
+
+/// Set the goal state.
+int BidirectionalWAStar::set_goal(int goal_state_id)
+{
+    m_goal_state_id = goal_state_id;
+    return 1;
+}
+
+/// Set the start state.
+int BidirectionalWAStar::set_start(int start_state_id)
+{
+    m_start_state_id = start_state_id;
+    return 1;
+}
+
+/// Force the search to forget previous search efforts and start from scratch.
+/// Every call to replan() already begins a new search.
+int BidirectionalWAStar::force_planning_from_scratch()
+{
+    return 0;
+}
+
+/// Force the planner to forget previous search efforts, begin from scratch,
+/// and free all memory allocated by the planner during previous searches.
+int BidirectionalWAStar::force_planning_from_scratch_and_free_memory()
+{
+    for (int dir = Forward; dir <= Backward; ++dir) {
+        m_open[dir].clear();
+        m_open_g[dir].clear();
+        for (SearchState* s : m_states[dir]) {
+            delete s;
+        }
+        m_states[dir].clear();
+        m_states[dir].shrink_to_fit();
+    }
+    return 0;
+}
+
+/// The search always runs until it finds a solution or runs out of time.
+int BidirectionalWAStar::set_search_mode(bool first_solution_unbounded)
+{
+    return 0;
+}
+
+/// Notify the search of changes to edge costs in the graph.
+void BidirectionalWAStar::costs_changed(const StateChangeQuery& changes)
+{
+    force_planning_from_scratch();
+}
+
+/// Return the time consumed by the search in progress to the initial solution.
+double BidirectionalWAStar::get_initial_eps_planning_time()
+{
+    return to_seconds(m_search_time);
+}
+
+/// Return the time consumed by the search in progress to the final solution.
+double BidirectionalWAStar::get_final_eps_planning_time()
+{
+    return to_seconds(m_search_time);
+}
+
+/// Return statistics for each completed search iteration.
+void BidirectionalWAStar::get_search_stats(std::vector<PlannerStats>* s)
+{
+    PlannerStats stats;
+    stats.eps = m_eps;
+    stats.cost = m_best_cost;
+    stats.expands = m_expand_count;
+    stats.time = to_seconds(m_search_time);
+    s->push_back(stats);
+}
+
+// Get the search state of a graph state in one direction, creating a new
+// state if one has not been created yet.
+auto BidirectionalWAStar::getSearchState(int dir, int state_id) -> SearchState*
+{
+    auto& states = m_states[dir];
+    if ((int)states.size() <= state_id) {
+        states.resize(state_id + 1, nullptr);
+    }
+
+    auto& state = states[state_id];
+    if (state == NULL) {
+        state = new SearchState;
+        state->state_id = state_id;
+        state->call_number = 0;
+        state->g_elem.state = state;
+    }
+
+    return state;
+}
+
+// Lazily (re)initialize a search state.
+void BidirectionalWAStar::reinitSearchState(int dir, SearchState* state)
+{
+    if (state->call_number != m_call_number) {
+        SMPL_DEBUG_NAMED(SELOG, "Reinitialize state %d", state->state_id);
+        state->bp = nullptr;
+        state->g = INFINITECOST;
+        if (dir == Forward) {
+            state->h = m_heur->GetGoalHeuristic(state->state_id);
+        } else {
+            state->h = m_heur->GetStartHeuristic(state->state_id);
+        }
+        state->f = INFINITECOST;
+        state->call_number = m_call_number;
+        state->closed = false;
+    }
+}
+
+int BidirectionalWAStar::computeKey(SearchState* s) const
+{
+    return s->g + (unsigned int)(m_eps * s->h);
+}
+
+// Insert a state into the open lists of one search, or update its position
+// after its g-value and key have decreased.
+void BidirectionalWAStar::insertOrUpdate(int dir, SearchState* s)
+{
+    if (m_open[dir].contains(s)) {
+        m_open[dir].decrease(s);
+        m_open_g[dir].decrease(&s->g_elem);
+    } else {
+        m_open[dir].push(s);
+        m_open_g[dir].push(&s->g_elem);
+    }
+}
+
+// Expand a state in the forward or backward search. Closed states are not
+// reopened.
+void BidirectionalWAStar::expand(int dir, SearchState* s)
+{
+    SMPL_DEBUG_NAMED(SELOG, "Expand state %d %s", s->state_id, dir == Forward ? "forward" : "backward");
+
+    m_succs.clear();
+    m_costs.clear();
+    if (dir == Forward) {
+        m_space->GetSuccs(s->state_id, &m_succs, &m_costs);
+    } else {
+        m_space->GetPreds(s->state_id, &m_succs, &m_costs);
+    }
+
+    for (size_t sidx = 0; sidx < m_succs.size(); ++sidx) {
+        SearchState* succ_state = getSearchState(dir, m_succs[sidx]);
+        reinitSearchState(dir, succ_state);
+        if (succ_state->closed) {
+            continue;
+        }
+
+        int new_g = s->g + m_costs[sidx];
+        if (new_g < succ_state->g) {
+            succ_state->g = new_g;
+            succ_state->bp = s;
+            succ_state->f = computeKey(succ_state);
+            insertOrUpdate(dir, succ_state);
+            updateMeeting(dir, succ_state);
+        }
+    }
+}
+
+// Record the path through a state if the state has been reached by the other
+// search and the path improves on the best path so far.
+void BidirectionalWAStar::updateMeeting(int dir, SearchState* s)
+{
+    auto& other_states = m_states[1 - dir];
+    if (s->state_id >= (int)other_states.size()) {
+        return;
+    }
+
+    SearchState* o = other_states[s->state_id];
+    if (o == NULL || o->call_number != m_call_number || o->g == INFINITECOST) {
+        return;
+    }
+
+    int cost = s->g + o->g;
+    if (cost < m_best_cost) {
+        SMPL_DEBUG_NAMED(SLOG, "Searches met at state %d with cost %d", s->state_id, cost);
+        m_best_cost = cost;
+        m_meet_state_id = s->state_id;
+    }
+}
+
+// Extract the path from the start to the goal through the state where the
+// searches met.
+void BidirectionalWAStar::extractPath(std::vector<int>& solution) const
+{
+    for (SearchState* s = m_states[Forward][m_meet_state_id]; s; s = s->bp) {
+        solution.push_back(s->state_id);
+    }
+    std::reverse(solution.begin(), solution.end());
+
+    SearchState* s = m_states[Backward][m_meet_state_id]->bp;
+    for (; s; s = s->bp) {
+        solution.push_back(s->state_id);
+    }
+}
+
+} // namespace smpl
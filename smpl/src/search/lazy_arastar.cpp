@@ -1,6 +1,7 @@
 #include <smpl/search/lazy_arastar.h>
 
 #include <smpl/console/console.h>
+#include <smpl/search/search_trace.h>
 
 namespace smpl {
 
@@ -45,7 +46,13 @@ static void ReinitState(LazyARAStar& search, State* state) {
             state->h = 0;
         } else {
             int32_t goal = search.goal_state_->graph_state;
-            state->h = search.heuristic_->GetGoalHeuristic(state->graph_state);
+            if (search.trace_) {
+                auto then = clock::now();
+                state->h = search.heuristic_->GetGoalHeuristic(state->graph_state);
+                search.trace_heur_time_ += clock::now() - then;
+            } else {
+                state->h = search.heuristic_->GetGoalHeuristic(state->graph_state);
+            }
         }
 
         state->g = g_infinite;
@@ -67,6 +74,29 @@ static bool IsPredDominated(const CandidatePred& cand, State* state) {
     return false;
 }
 
+static int ComputeFVal(const LazyARAStar& search, const State& s);
+
+static void TraceState(
+    LazyARAStar& search,
+    const State* state,
+    ExpansionRecord::Type type,
+    const clock::duration& time)
+{
+    auto expansion = type == ExpansionRecord::Expansion;
+    ExpansionRecord record;
+    record.state_id = state->graph_state;
+    record.queue = 0;
+    record.g = state->g;
+    record.h = state->h;
+    record.f = ComputeFVal(search, *state);
+    record.succ_count = expansion ? (std::uint32_t)search.succs_.size() : 0;
+    record.succ_time_ns = expansion ? ToTraceTime(time) : 0;
+    record.heur_time_ns = ToTraceTime(search.trace_heur_time_);
+    record.eval_time_ns = expansion ? 0 : ToTraceTime(time);
+    record.type = type;
+    search.trace_->recordExpansion(record);
+}
+
 static void ExpandState(LazyARAStar& search, State* state) {
     SMPL_DEBUG_NAMED(LOG, "Expand state %d", state->graph_state);
 
@@ -75,6 +105,13 @@ static void ExpandState(LazyARAStar& search, State* state) {
     state->ebp = state->bp;
     state->eg = state->g;
 
+    clock::time_point succs_start;
+    clock::duration succs_time = clock::duration::zero();
+    if (search.trace_) {
+        search.trace_heur_time_ = clock::duration::zero();
+        succs_start = clock::now();
+    }
+
     search.succs_.clear();
     search.costs_.clear();
     search.true_costs_.clear();
@@ -84,6 +121,10 @@ static void ExpandState(LazyARAStar& search, State* state) {
             search.costs_,
             search.true_costs_);
 
+    if (search.trace_) {
+        succs_time = clock::now() - succs_start;
+    }
+
     assert(search.succs_.size() == search.costs_.size());
     assert(search.succs_.size() == search.true_costs_.size());
 
@@ -130,6 +171,10 @@ static void ExpandState(LazyARAStar& search, State* state) {
             search.open_.update(succ_state);
         }
     }
+
+    if (search.trace_) {
+        TraceState(search, state, ExpansionRecord::Expansion, succs_time);
+    }
 }
 
 static void EvaluateState(LazyARAStar& search, State* s) {
@@ -149,9 +194,19 @@ static void EvaluateState(LazyARAStar& search, State* s) {
 
     SMPL_DEBUG_NAMED(LOG, "Evaluate transitions %d -> %d", s->bp->graph_state, s->graph_state);
 
+    clock::time_point eval_start;
+    if (search.trace_) {
+        eval_start = clock::now();
+    }
+
     int32_t cost = search.succ_fun_->GetSuccTrueCost(
             s->bp->graph_state, s->graph_state);
 
+    if (search.trace_) {
+        search.trace_heur_time_ = clock::duration::zero();
+        TraceState(search, s, ExpansionRecord::Evaluation, clock::now() - eval_start);
+    }
+
     // remove invalid or now-dominated candidate preds
     if (cost < 0) {
         cands.erase(best_it);
@@ -246,6 +301,11 @@ int Replan(
     search.start_state_->true_cost = true;
     search.open_.push(search.start_state_);
 
+    if (search.trace_) {
+        search.trace_->beginSearch("lazy_arastar", start_id, goal_id);
+        search.trace_->beginIteration(search.eps_);
+    }
+
     while (!search.open_.empty()) {
         State* min_state = search.open_.min();
         search.open_.pop();
@@ -258,6 +318,9 @@ int Replan(
             search.goal_state_->eg = search.goal_state_->g;
 
             ReconstructPath(search, solution, cost);
+            if (search.trace_) {
+                search.trace_->endSearch(true, cost, solution);
+            }
             return 0;
         }
 
@@ -273,6 +336,9 @@ int Replan(
         }
     }
 
+    if (search.trace_) {
+        search.trace_->endSearch(false, -1, std::vector<int>());
+    }
     return 1;
 }
 
@@ -0,0 +1,310 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2018, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#include <smpl/search/search_trace.h>
+
+// standard includes
+#include <cstring>
+
+// project includes
+#include <smpl/console/console.h>
+
+namespace smpl {
+
+static const char* LOG = "search.trace";
+
+// Traces begin with this signature, followed by a 32-bit format version. Each
+// event is then written as a one-byte tag followed by its fields, in host byte
+// order.
+static const char TraceMagic[8] = { 'S', 'M', 'P', 'L', 'T', 'R', 'C', '\0' };
+static const std::uint32_t TraceVersion = 2;
+
+enum TraceTag : std::uint8_t
+{
+    TAG_BEGIN = 1,
+    TAG_ITERATION,
+    TAG_EXPANSION,
+    TAG_END,
+};
+
+// Buffered events are written to the file once the buffer grows past this
+// many bytes.
+static const size_t TraceBufferSize = 1 << 16;
+
+SearchTrace::SearchTrace() : m_file(nullptr)
+{
+}
+
+SearchTrace::~SearchTrace()
+{
+    close();
+}
+
+bool SearchTrace::open(const std::string& path)
+{
+    close();
+
+    m_file = std::fopen(path.c_str(), "wb");
+    if (!m_file) {
+        SMPL_WARN_NAMED(LOG, "Failed to open search trace '%s'", path.c_str());
+        return false;
+    }
+
+    m_buffer.reserve(TraceBufferSize + 256);
+    m_buffer.insert(m_buffer.end(), TraceMagic, TraceMagic + sizeof(TraceMagic));
+    write(TraceVersion);
+    return true;
+}
+
+void SearchTrace::close()
+{
+    if (m_file) {
+        flush();
+        std::fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+template <class T>
+void SearchTrace::write(const T& value)
+{
+    auto* bytes = reinterpret_cast<const std::uint8_t*>(&value);
+    m_buffer.insert(m_buffer.end(), bytes, bytes + sizeof(T));
+}
+
+void SearchTrace::beginSearch(const char* search, int start_id, int goal_id)
+{
+    if (!m_file) {
+        return;
+    }
+
+    auto len = (std::uint32_t)std::strlen(search);
+    write(TAG_BEGIN);
+    write((std::int32_t)start_id);
+    write((std::int32_t)goal_id);
+    write(len);
+    m_buffer.insert(m_buffer.end(), search, search + len);
+    m_search_start = clock::now();
+}
+
+void SearchTrace::beginIteration(double eps)
+{
+    if (!m_file) {
+        return;
+    }
+
+    write(TAG_ITERATION);
+    write(eps);
+}
+
+void SearchTrace::recordExpansion(const ExpansionRecord& record)
+{
+    if (!m_file) {
+        return;
+    }
+
+    write(TAG_EXPANSION);
+    write(record.state_id);
+    write(record.queue);
+    write(record.g);
+    write(record.h);
+    write(record.f);
+    write(record.succ_count);
+    write(record.succ_time_ns);
+    write(record.heur_time_ns);
+    write(record.eval_time_ns);
+    write(record.type);
+
+    if (m_buffer.size() >= TraceBufferSize) {
+        flush();
+    }
+}
+
+void SearchTrace::endSearch(bool solved, int cost, const std::vector<int>& path)
+{
+    if (!m_file) {
+        return;
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            clock::now() - m_search_start).count();
+
+    write(TAG_END);
+    write((std::uint8_t)solved);
+    write((std::int32_t)cost);
+    write((std::uint64_t)elapsed);
+    write((std::uint32_t)path.size());
+    for (int id : path) {
+        write((std::int32_t)id);
+    }
+    flush();
+}
+
+void SearchTrace::flush()
+{
+    if (!m_file || m_buffer.empty()) {
+        return;
+    }
+
+    if (std::fwrite(m_buffer.data(), 1, m_buffer.size(), m_file) != m_buffer.size()) {
+        SMPL_WARN_NAMED(LOG, "Failed to write search trace");
+    }
+    m_buffer.clear();
+}
+
+SearchTraceReader::SearchTraceReader() : m_file(nullptr)
+{
+}
+
+SearchTraceReader::~SearchTraceReader()
+{
+    close();
+}
+
+bool SearchTraceReader::open(const std::string& path)
+{
+    close();
+
+    m_file = std::fopen(path.c_str(), "rb");
+    if (!m_file) {
+        SMPL_WARN_NAMED(LOG, "Failed to open search trace '%s'", path.c_str());
+        return false;
+    }
+
+    char magic[sizeof(TraceMagic)];
+    std::uint32_t version;
+    if (std::fread(magic, 1, sizeof(magic), m_file) != sizeof(magic) ||
+        std::memcmp(magic, TraceMagic, sizeof(magic)) != 0 ||
+        !read(version))
+    {
+        SMPL_WARN_NAMED(LOG, "'%s' is not a search trace", path.c_str());
+        close();
+        return false;
+    }
+
+    if (version != TraceVersion) {
+        SMPL_WARN_NAMED(LOG, "Search trace '%s' has unsupported version %u", path.c_str(), version);
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void SearchTraceReader::close()
+{
+    if (m_file) {
+        std::fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+template <class T>
+bool SearchTraceReader::read(T& value)
+{
+    return std::fread(&value, sizeof(T), 1, m_file) == 1;
+}
+
+bool SearchTraceReader::next(SearchTraceEvent& event)
+{
+    if (!m_file) {
+        return false;
+    }
+
+    std::uint8_t tag;
+    if (!read(tag)) {
+        return false;
+    }
+
+    switch (tag) {
+    case TAG_BEGIN: {
+        event.type = SearchTraceEvent::Begin;
+        std::int32_t start_id, goal_id;
+        std::uint32_t len;
+        if (!read(start_id) || !read(goal_id) || !read(len)) {
+            return false;
+        }
+        event.start_id = start_id;
+        event.goal_id = goal_id;
+        event.search.resize(len);
+        if (len != 0 && std::fread(&event.search[0], 1, len, m_file) != len) {
+            return false;
+        }
+        return true;
+    }
+    case TAG_ITERATION:
+        event.type = SearchTraceEvent::Iteration;
+        return read(event.eps);
+    case TAG_EXPANSION: {
+        event.type = SearchTraceEvent::Expansion;
+        auto& r = event.expansion;
+        return read(r.state_id) &&
+                read(r.queue) &&
+                read(r.g) &&
+                read(r.h) &&
+                read(r.f) &&
+                read(r.succ_count) &&
+                read(r.succ_time_ns) &&
+                read(r.heur_time_ns) &&
+                read(r.eval_time_ns) &&
+                read(r.type);
+    }
+    case TAG_END: {
+        event.type = SearchTraceEvent::End;
+        std::uint8_t solved;
+        std::int32_t cost;
+        std::uint32_t path_len;
+        if (!read(solved) ||
+            !read(cost) ||
+            !read(event.elapsed_ns) ||
+            !read(path_len))
+        {
+            return false;
+        }
+        event.solved = solved != 0;
+        event.cost = cost;
+        event.path.resize(path_len);
+        for (auto& id : event.path) {
+            std::int32_t v;
+            if (!read(v)) {
+                return false;
+            }
+            id = v;
+        }
+        return true;
+    }
+    default:
+        SMPL_WARN_NAMED(LOG, "Unrecognized search trace event %u", (unsigned)tag);
+        return false;
+    }
+}
+
+} // namespace smpl
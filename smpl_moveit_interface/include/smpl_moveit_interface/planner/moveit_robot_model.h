@@ -34,6 +34,12 @@
 #ifndef sbpl_interface_MoveItRobotModel_h
 #define sbpl_interface_MoveItRobotModel_h
 
+// standard includes
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 // system includes
 #include <kdl/frames.hpp>
 #include <moveit/robot_model/robot_model.h>
@@ -185,6 +191,34 @@ private:
     bool m_planning_frame_is_model_frame = false;
     planning_scene::PlanningSceneConstPtr m_planning_scene;
 
+    // The joints between a link and the first joint above it that is moved by
+    // a planning variable, used to compute the pose of the link without
+    // updating the transforms of the entire robot state. Joints above the
+    // chain contribute a constant transform, and the values of any variables
+    // in the chain that are not planning variables are taken from the
+    // reference state. The pose of each link along the chain is cached, so
+    // that only the joints below the first changed variable are recomputed.
+    struct FKChain
+    {
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+        bool supported = false;
+        Eigen::Affine3d T_model_root;
+        std::vector<const moveit::core::JointModel*> joints;
+        std::vector<int> var_offsets;   // offset of each joint's values
+        std::vector<double> values;     // variable values of the chain joints
+        std::vector<int> value_vars;    // planning variable for each value, or -1
+        std::vector<int> value_joints;  // joint index of each value
+        // T_model_link along the chain
+        std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d>> transforms;
+        size_t valid_count = 0;
+    };
+
+    // kinematic chains by link name, invalidated by changes to the reference
+    // state. Chains are allocated individually to keep their transforms
+    // aligned.
+    std::unordered_map<std::string, std::unique_ptr<FKChain>> m_fk_chains;
+
 #ifdef PR2_WRIST_IK
     std::unique_ptr<smpl::RPYSolver> m_rpy_solver;
     std::string m_forearm_roll_link;
@@ -204,6 +238,11 @@ private:
         const smpl::RobotState& start,
         smpl::RobotState& solution);
 
+    auto getFKChain(const std::string& name) -> FKChain&;
+    void initFKChain(const moveit::core::LinkModel* link, FKChain& chain);
+    auto computeChainFK(FKChain& chain, const smpl::RobotState& state)
+        -> const Eigen::Affine3d&;
+
     bool transformToPlanningFrame(Eigen::Affine3d& T_model_link) const;
     bool transformToModelFrame(Eigen::Affine3d& T_planning_link) const;
 };
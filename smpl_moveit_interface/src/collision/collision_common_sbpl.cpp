@@ -257,6 +257,18 @@ void LoadCollisionGridConfig(
     config.origin_z = cm_config["origin_z"];
     config.res_m = cm_config["res_m"];
     config.max_distance_m = cm_config["max_distance_m"];
+
+    if (cm_config.hasMember("pyramid_levels")) {
+        config.pyramid_levels = cm_config["pyramid_levels"];
+    } else {
+        config.pyramid_levels = 0;
+    }
+
+    if (cm_config.hasMember("hashed")) {
+        config.hashed = cm_config["hashed"];
+    } else {
+        config.hashed = false;
+    }
 }
 
 /// \brief Load the Joint <-> Collision Group Map from the param server
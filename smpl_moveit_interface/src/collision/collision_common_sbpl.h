@@ -34,6 +34,7 @@
 
 // standard includes
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -70,6 +71,10 @@ struct CollisionGridConfig
     double origin_z;
     double res_m;
     double max_distance_m;
+    int pyramid_levels;
+
+    // build the grid on a HashedDistanceMap, which supports moving its origin
+    bool hashed;
 };
 
 void LoadCollisionGridConfig(
@@ -167,6 +172,93 @@ private:
 using CollisionStateUpdaterPtr = std::shared_ptr<CollisionStateUpdater>;
 using CollisionStateUpdaterConstPtr = std::shared_ptr<const CollisionStateUpdater>;
 
+// Pool of scratch contexts for collision queries. A context is checked out for
+// the duration of a single query and returned to the pool when the handle goes
+// out of scope, so concurrent queries never share mutable state and no more
+// contexts are created than there are concurrent queries.
+template <class Context>
+class CollisionContextPool
+{
+public:
+
+    class Handle
+    {
+    public:
+
+        Handle() = default;
+        Handle(CollisionContextPool* pool, std::unique_ptr<Context> context) :
+            m_pool(pool), m_context(std::move(context))
+        { }
+
+        Handle(Handle&& o) = default;
+        Handle& operator=(Handle&& o) = default;
+
+        ~Handle()
+        {
+            if (m_pool && m_context) {
+                m_pool->release(std::move(m_context));
+            }
+        }
+
+        explicit operator bool() const { return (bool)m_context; }
+
+        auto operator*() const -> Context& { return *m_context; }
+        auto operator->() const -> Context* { return m_context.get(); }
+
+    private:
+
+        CollisionContextPool* m_pool = nullptr;
+        std::unique_ptr<Context> m_context;
+    };
+
+    CollisionContextPool() = default;
+
+    // contexts are never shared between pools
+    CollisionContextPool(const CollisionContextPool&) : CollisionContextPool()
+    { }
+
+    CollisionContextPool& operator=(const CollisionContextPool&)
+    {
+        return *this;
+    }
+
+    // Check out an idle context, or construct a new one with create() if none
+    // is available. create() returns a std::unique_ptr<Context>, which may be
+    // null to signal failure, in which case the returned handle is empty.
+    template <class Factory>
+    auto acquire(Factory create) -> Handle
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_idle.empty()) {
+                auto context = std::move(m_idle.back());
+                m_idle.pop_back();
+                return Handle(this, std::move(context));
+            }
+        }
+        return Handle(this, create());
+    }
+
+    void release(std::unique_ptr<Context> context)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_idle.push_back(std::move(context));
+    }
+
+    // Destroy all idle contexts. Contexts checked out at the time of the call
+    // are returned to the pool as usual.
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_idle.clear();
+    }
+
+private:
+
+    std::mutex m_mutex;
+    std::vector<std::unique_ptr<Context>> m_idle;
+};
+
 // proxy class to interface with CollisionSpace
 class AllowedCollisionMatrixInterface :
     public smpl::collision::AllowedCollisionsInterface
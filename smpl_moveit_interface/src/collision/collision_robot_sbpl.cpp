@@ -148,15 +148,19 @@ CollisionRobotSBPL::CollisionRobotSBPL(
 
     LoadJointCollisionGroupMap(ph, m_jcgm_map);
 
-    if (!m_updater.init(*model, rcm)) {
+    // ok! store the robot collision model
+    m_rcm = rcm;
+    m_rmcm = std::make_shared<smpl::collision::RobotMotionCollisionModel>(m_rcm.get());
+
+    // create the first collision context up front to validate the collision
+    // state updater against the robot model
+    auto context = createSelfCollisionContext();
+    if (!context) {
         auto msg = "Failed to initialize Collision State Updater";
         ROS_ERROR_NAMED(CRP_LOGGER, "%s", msg);
         throw std::runtime_error(msg);
     }
-
-    // ok! store the robot collision model
-    m_rcm = rcm;
-    m_rmcm = std::make_shared<smpl::collision::RobotMotionCollisionModel>(m_rcm.get());
+    m_contexts.release(std::move(context));
 
     ros::NodeHandle nh;
 }
@@ -169,7 +173,6 @@ CollisionRobotSBPL::CollisionRobotSBPL(const CollisionRobotSBPL& other) :
     m_jcgm_map = other.m_jcgm_map;
     m_rcm = other.m_rcm;
     m_rmcm = other.m_rmcm;
-    m_updater = other.m_updater;
 }
 
 CollisionRobotSBPL::~CollisionRobotSBPL()
@@ -254,8 +257,7 @@ void CollisionRobotSBPL::checkSelfCollision(
     const robot_state::RobotState& state,
     const AllowedCollisionMatrix& acm) const
 {
-    const_cast<CollisionRobotSBPL*>(this)->checkSelfCollisionMutable(
-            req, res, state, acm);
+    checkSelfCollisionImpl(req, res, state, acm);
 }
 
 void CollisionRobotSBPL::checkSelfCollision(
@@ -275,9 +277,7 @@ void CollisionRobotSBPL::checkSelfCollision(
     const robot_state::RobotState& state2,
     const AllowedCollisionMatrix& acm) const
 {
-    // TODO: implement
-    const_cast<CollisionRobotSBPL*>(this)->checkSelfCollisionMutable(
-            req, res, state1, state2, acm);
+    checkSelfCollisionImpl(req, res, state1, state2, acm);
 }
 
 #if COLLISION_DETECTION_SBPL_ROS_VERSION == COLLISION_DETECTION_SBPL_ROS_KINETIC
@@ -353,11 +353,28 @@ void CollisionRobotSBPL::setVacuousCollision(CollisionResult& res) const
     res.distance = 0.0;
 }
 
-void CollisionRobotSBPL::checkSelfCollisionMutable(
+auto CollisionRobotSBPL::createSelfCollisionContext() const
+    -> std::unique_ptr<SelfCollisionContext>
+{
+    ROS_DEBUG_NAMED(CRP_LOGGER, "Create self collision context");
+
+    auto context = std::unique_ptr<SelfCollisionContext>(
+            new SelfCollisionContext);
+    if (!context->updater.init(*getRobotModel(), m_rcm)) {
+        return nullptr;
+    }
+
+    // the self collision model is initialized lazily on the first query so
+    // that robots which are never checked for self collisions don't pay for
+    // the grid
+    return context;
+}
+
+void CollisionRobotSBPL::checkSelfCollisionImpl(
     const CollisionRequest& req,
     CollisionResult& res,
     const robot_state::RobotState& state,
-    const AllowedCollisionMatrix& acm)
+    const AllowedCollisionMatrix& acm) const
 {
     using smpl::collision::AttachedBodiesCollisionModel;
     using smpl::collision::AttachedBodiesCollisionState;
@@ -381,19 +398,31 @@ void CollisionRobotSBPL::checkSelfCollisionMutable(
         return;
     }
 
-    if (!m_grid) {
+    auto context = m_contexts.acquire([&]() {
+        return createSelfCollisionContext();
+    });
+    if (!context) {
+        ROS_ERROR_NAMED(CRP_LOGGER, "Failed to create self collision context");
+        setVacuousCollision(res);
+        return;
+    }
+
+    auto& updater = context->updater;
+    if (!context->scm) {
         ROS_DEBUG_NAMED(CRP_LOGGER, "Initialize self collision model");
 
         // lazily initialize self collision model
-        m_grid = createGridFor(m_scm_config);
-        m_grid->setReferenceFrame(m_rcm->modelFrame());
+        context->grid = createGridFor(m_scm_config);
+        context->grid->setReferenceFrame(m_rcm->modelFrame());
 
-        auto bbm = m_grid->getOccupiedVoxelsVisualization();
+        auto bbm = context->grid->getOccupiedVoxelsVisualization();
         bbm.ns = "self_collision_model_bounds";
         SV_SHOW_INFO_NAMED("collision_robot_bounds", bbm);
 
-        m_scm = std::make_shared<SelfCollisionModel>(
-                m_grid.get(), m_rcm.get(), m_updater.attachedBodiesCollisionModel());
+        context->scm = std::make_shared<SelfCollisionModel>(
+                context->grid.get(),
+                m_rcm.get(),
+                updater.attachedBodiesCollisionModel());
     }
 
     auto gidx = m_rcm->groupIndex(collision_group_name);
@@ -402,14 +431,14 @@ void CollisionRobotSBPL::checkSelfCollisionMutable(
     state_copy.setJointPositions(
             state_copy.getRobotModel()->getRootJoint(),
             Eigen::Affine3d::Identity());
-    m_updater.update(state_copy);
+    updater.update(state_copy);
 
     double dist;
-    auto valid = m_scm->checkCollision(
-            *m_updater.collisionState(),
-            *m_updater.attachedBodiesCollisionState(),
+    auto valid = context->scm->checkCollision(
+            *updater.collisionState(),
+            *updater.attachedBodiesCollisionState(),
             AllowedCollisionMatrixAndTouchLinksInterface(
-                    acm, m_updater.touchLinkSet()),
+                    acm, updater.touchLinkSet()),
             gidx,
             dist);
 
@@ -420,8 +449,8 @@ void CollisionRobotSBPL::checkSelfCollisionMutable(
             "self_collision",
             MakeCollisionRobotValidityVisualization(
                     this,
-                    m_updater.collisionState(),
-                    m_updater.attachedBodiesCollisionState(),
+                    updater.collisionState(),
+                    updater.attachedBodiesCollisionState(),
                     gidx,
                     valid));
 
@@ -437,12 +466,12 @@ void CollisionRobotSBPL::checkSelfCollisionMutable(
     }
 }
 
-void CollisionRobotSBPL::checkSelfCollisionMutable(
+void CollisionRobotSBPL::checkSelfCollisionImpl(
     const CollisionRequest& req,
     CollisionResult& res,
     const moveit::core::RobotState& state1,
     const moveit::core::RobotState& state2,
-    const AllowedCollisionMatrix& acm)
+    const AllowedCollisionMatrix& acm) const
 {
     using smpl::collision::AttachedBodiesCollisionModel;
     using smpl::collision::AttachedBodiesCollisionState;
@@ -463,19 +492,31 @@ void CollisionRobotSBPL::checkSelfCollisionMutable(
         return;
     }
 
-    if (!m_grid) {
+    auto context = m_contexts.acquire([&]() {
+        return createSelfCollisionContext();
+    });
+    if (!context) {
+        ROS_ERROR_NAMED(CRP_LOGGER, "Failed to create self collision context");
+        setVacuousCollision(res);
+        return;
+    }
+
+    auto& updater = context->updater;
+    if (!context->scm) {
         ROS_DEBUG_NAMED(CRP_LOGGER, "Initialize self collision model");
 
         // lazily initialize self collision model
-        m_grid = createGridFor(m_scm_config);
-        m_grid->setReferenceFrame(m_rcm->modelFrame());
+        context->grid = createGridFor(m_scm_config);
+        context->grid->setReferenceFrame(m_rcm->modelFrame());
 
-        auto bbma = m_grid->getOccupiedVoxelsVisualization();
+        auto bbma = context->grid->getOccupiedVoxelsVisualization();
         bbma.ns = "self_collision_model_bounds";
         SV_SHOW_INFO_NAMED("collision_robot_bounds", bbma);
 
-        m_scm = std::make_shared<SelfCollisionModel>(
-                m_grid.get(), m_rcm.get(), m_updater.attachedBodiesCollisionModel());
+        context->scm = std::make_shared<SelfCollisionModel>(
+                context->grid.get(),
+                m_rcm.get(),
+                updater.attachedBodiesCollisionModel());
     }
 
     auto gidx = m_rcm->groupIndex(collision_group_name);
@@ -488,16 +529,16 @@ void CollisionRobotSBPL::checkSelfCollisionMutable(
     state2_copy.setJointPositions(
             state1_copy.getRobotModel()->getRootJoint(),
             Eigen::Affine3d::Identity());
-//    m_updater.update(state_copy);
+//    updater.update(state_copy);
 
-    auto startvars = m_updater.getVariablesFor(state1_copy);
-    auto goalvars = m_updater.getVariablesFor(state2_copy);
+    auto startvars = updater.getVariablesFor(state1_copy);
+    auto goalvars = updater.getVariablesFor(state2_copy);
 
     double dist;
-    auto valid = m_scm->checkMotionCollision(
-            *m_updater.collisionState(),
-            *m_updater.attachedBodiesCollisionState(),
-            AllowedCollisionMatrixAndTouchLinksInterface(acm, m_updater.touchLinkSet()),
+    auto valid = context->scm->checkMotionCollision(
+            *updater.collisionState(),
+            *updater.attachedBodiesCollisionState(),
+            AllowedCollisionMatrixAndTouchLinksInterface(acm, updater.touchLinkSet()),
             *m_rmcm,
             startvars,
             goalvars,
@@ -511,8 +552,8 @@ void CollisionRobotSBPL::checkSelfCollisionMutable(
             "self_collision",
             MakeCollisionRobotValidityVisualization(
                     this,
-                    m_updater.collisionState(),
-                    m_updater.attachedBodiesCollisionState(),
+                    updater.collisionState(),
+                    updater.attachedBodiesCollisionState(),
                     gidx,
                     valid));
 
@@ -563,12 +604,13 @@ auto CollisionRobotSBPL::createGridFor(const CollisionGridConfig& config) const
     ROS_DEBUG_NAMED(CRP_LOGGER, "    origin: (%0.3f, %0.3f, %0.3f)", config.origin_x, config.origin_y, config.origin_z);
     ROS_DEBUG_NAMED(CRP_LOGGER, "    resolution: %0.3f", config.res_m);
     ROS_DEBUG_NAMED(CRP_LOGGER, "    max_distance: %0.3f", config.max_distance_m);
+    ROS_DEBUG_NAMED(CRP_LOGGER, "    pyramid_levels: %d", config.pyramid_levels);
 
     // TODO: this can be substantially smaller since it only has to encompass
     // the range of motion of the robot
     auto ref_counted = true;
     auto max_distance = getSelfCollisionPropagationDistance();
-    return std::make_shared<smpl::OccupancyGrid>(
+    auto grid = std::make_shared<smpl::OccupancyGrid>(
             config.size_x,
             config.size_y,
             config.size_z,
@@ -578,6 +620,8 @@ auto CollisionRobotSBPL::createGridFor(const CollisionGridConfig& config) const
             config.origin_z,
             max_distance,
             ref_counted);
+    grid->setDistancePyramidLevels(config.pyramid_levels);
+    return grid;
 }
 
 } // namespace collision_detection
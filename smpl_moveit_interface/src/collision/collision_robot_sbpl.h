@@ -32,6 +32,9 @@
 #ifndef SMPL_MOVEIT_INTERFACE_COLLISION_ROBOT_SBPL_H
 #define SMPL_MOVEIT_INTERFACE_COLLISION_ROBOT_SBPL_H
 
+// standard includes
+#include <memory>
+
 // system includes
 #include <moveit/collision_detection/collision_robot.h>
 #include <smpl/occupancy_grid.h>
@@ -185,26 +188,35 @@ public:
     smpl::collision::RobotCollisionModelConstPtr m_rcm;
     smpl::collision::RobotMotionCollisionModelConstPtr m_rmcm;
 
-    CollisionStateUpdater m_updater;
+    // scratch state for a single self collision query. the self collision
+    // model mutates its grid and sphere states while checking, so each
+    // concurrent query gets its own copy.
+    struct SelfCollisionContext
+    {
+        CollisionStateUpdater updater;
+        smpl::OccupancyGridPtr grid;
+        smpl::collision::SelfCollisionModelPtr scm;
+    };
 
-    // self colllision models
-    smpl::OccupancyGridPtr m_grid;
-    smpl::collision::SelfCollisionModelPtr m_scm;
+    mutable CollisionContextPool<SelfCollisionContext> m_contexts;
 
     void setVacuousCollision(CollisionResult& res) const;
 
-    void checkSelfCollisionMutable(
+    auto createSelfCollisionContext() const
+        -> std::unique_ptr<SelfCollisionContext>;
+
+    void checkSelfCollisionImpl(
         const CollisionRequest& req,
         CollisionResult& res,
         const robot_state::RobotState& state,
-        const AllowedCollisionMatrix& acm);
+        const AllowedCollisionMatrix& acm) const;
 
-    void checkSelfCollisionMutable(
+    void checkSelfCollisionImpl(
         const CollisionRequest& req,
         CollisionResult& res,
         const moveit::core::RobotState& state1,
         const moveit::core::RobotState& state2,
-        const AllowedCollisionMatrix& acm);
+        const AllowedCollisionMatrix& acm) const;
 
     bool updateAttachedBodies(const moveit::core::RobotState& state);
 
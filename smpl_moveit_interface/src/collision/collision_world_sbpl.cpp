@@ -38,6 +38,7 @@
 #include <ros/ros.h>
 #include <geometric_shapes/shape_operations.h>
 #include <smpl/debug/visualize.h>
+#include <smpl/distance_map/hashed_distance_map.h>
 
 // module includes
 #include "collision_common_sbpl.h"
@@ -115,20 +116,37 @@ auto MakeGrid(const CollisionGridConfig& config) -> smpl::OccupancyGridPtr
     ROS_DEBUG_NAMED(LOG, "    origin: (%0.3f, %0.3f, %0.3f)", config.origin_x, config.origin_y, config.origin_z);
     ROS_DEBUG_NAMED(LOG, "    resolution: %0.3f", config.res_m);
     ROS_DEBUG_NAMED(LOG, "    max_distance: %0.3f", config.max_distance_m);
+    ROS_DEBUG_NAMED(LOG, "    pyramid_levels: %d", config.pyramid_levels);
+    ROS_DEBUG_NAMED(LOG, "    hashed: %s", config.hashed ? "true" : "false");
 
     auto ref_counted = true;
 
-    auto dmap = std::make_shared<smpl::OccupancyGrid>(
-            config.size_x,
-            config.size_y,
-            config.size_z,
-            config.res_m,
-            config.origin_x,
-            config.origin_y,
-            config.origin_z,
-            config.max_distance_m,
-            ref_counted);
+    smpl::OccupancyGridPtr dmap;
+    if (config.hashed) {
+        auto df = std::make_shared<smpl::HashedDistanceMap>(
+                config.origin_x,
+                config.origin_y,
+                config.origin_z,
+                config.size_x,
+                config.size_y,
+                config.size_z,
+                config.res_m,
+                config.max_distance_m);
+        dmap = std::make_shared<smpl::OccupancyGrid>(df, ref_counted);
+    } else {
+        dmap = std::make_shared<smpl::OccupancyGrid>(
+                config.size_x,
+                config.size_y,
+                config.size_z,
+                config.res_m,
+                config.origin_x,
+                config.origin_y,
+                config.origin_z,
+                config.max_distance_m,
+                ref_counted);
+    }
     dmap->setReferenceFrame(config.frame_id);
+    dmap->setDistancePyramidLevels(config.pyramid_levels);
     return dmap;
 }
 
@@ -174,7 +192,7 @@ auto MakeCollisionRobotVisualization(
 
 static
 auto MakeCollisionRobotValidityVisualization(
-    CollisionWorldSBPL* cworld,
+    const CollisionWorldSBPL* cworld,
     smpl::collision::RobotCollisionState* rcs,
     smpl::collision::AttachedBodiesCollisionState* abcs,
     int gidx,
@@ -222,7 +240,6 @@ CollisionWorldSBPL::CollisionWorldSBPL(
     m_parent_grid = other.m_grid ? other.m_grid : other.m_parent_grid;
     m_parent_wcm = other.m_wcm ? other.m_wcm : other.m_parent_wcm;
 
-    m_updaters = other.m_updaters;
     // NOTE: no need to copy observer handle
     registerWorldCallback();
     // NOTE: no need to copy node handle
@@ -259,8 +276,7 @@ void CollisionWorldSBPL::checkRobotCollision(
 {
     ROS_INFO_NAMED(LOG, "checkRobotCollision(req, res, robot, state)");
 
-    const_cast<CollisionWorldSBPL*>(this)->checkRobotCollisionMutable(
-            req, res, robot, state);
+    checkRobotCollisionImpl(req, res, robot, state);
 }
 
 void CollisionWorldSBPL::checkRobotCollision(
@@ -270,8 +286,7 @@ void CollisionWorldSBPL::checkRobotCollision(
     const robot_state::RobotState& state,
     const AllowedCollisionMatrix& acm) const
 {
-    const_cast<CollisionWorldSBPL*>(this)->checkRobotCollisionMutable(
-            req, res, robot, state, acm);
+    checkRobotCollisionImpl(req, res, robot, state, acm);
 }
 
 void CollisionWorldSBPL::checkRobotCollision(
@@ -283,8 +298,7 @@ void CollisionWorldSBPL::checkRobotCollision(
 {
     ROS_INFO_NAMED(LOG, "checkRobotCollision(req, res, robot, state1, state2)");
 
-    const_cast<CollisionWorldSBPL*>(this)->checkRobotCollisionMutable(
-            req, res, robot, state1, state2);
+    checkRobotCollisionImpl(req, res, robot, state1, state2);
 }
 
 void CollisionWorldSBPL::checkRobotCollision(
@@ -295,8 +309,7 @@ void CollisionWorldSBPL::checkRobotCollision(
     const robot_state::RobotState& state2,
     const AllowedCollisionMatrix& acm) const
 {
-    const_cast<CollisionWorldSBPL*>(this)->checkRobotCollisionMutable(
-            req, res, robot, state1, state2, acm);
+    checkRobotCollisionImpl(req, res, robot, state1, state2, acm);
 }
 
 void CollisionWorldSBPL::checkWorldCollision(
@@ -449,13 +462,14 @@ auto CollisionWorldSBPL::FindObjectRepPair(
 }
 
 auto CollisionWorldSBPL::getCollisionStateUpdater(
+    WorldCollisionContext& context,
     const CollisionRobotSBPL& collision_robot,
-    const moveit::core::RobotModel& robot_model)
+    const moveit::core::RobotModel& robot_model) const
     -> CollisionStateUpdaterPtr
 {
     // return an existing updater if available
-    auto it = m_updaters.find(robot_model.getName());
-    if (it != m_updaters.end()) {
+    auto it = context.updaters.find(robot_model.getName());
+    if (it != context.updaters.end()) {
         return it->second;
     }
 
@@ -467,7 +481,7 @@ auto CollisionWorldSBPL::getCollisionStateUpdater(
     }
 
     // store the successfully initialized group model
-    m_updaters[robot_model.getName()] = gm;
+    context.updaters[robot_model.getName()] = gm;
     return gm;
 }
 
@@ -521,11 +535,11 @@ void CollisionWorldSBPL::setVacuousCollision(CollisionResult& res) const
     res.distance = 0.0;
 }
 
-void CollisionWorldSBPL::checkRobotCollisionMutable(
+void CollisionWorldSBPL::checkRobotCollisionImpl(
     const CollisionRequest& req,
     CollisionResult& res,
     const CollisionRobot& robot,
-    const robot_state::RobotState& state)
+    const robot_state::RobotState& state) const
 {
     // TODO: implement
     ROS_ERROR_NAMED(LOG, "checkRobotCollision(req, res, robot, state)");
@@ -535,12 +549,12 @@ void CollisionWorldSBPL::checkRobotCollisionMutable(
 /// Note: The output CollisionResult is shared between multiple collision
 /// checking calls (i.e. both for world and self collisions). The policy is to
 /// only set fields when a collision occurs and not to clear fields.
-void CollisionWorldSBPL::checkRobotCollisionMutable(
+void CollisionWorldSBPL::checkRobotCollisionImpl(
     const CollisionRequest& req,
     CollisionResult& res,
     const CollisionRobot& robot,
     const robot_state::RobotState& state,
-    const AllowedCollisionMatrix& acm)
+    const AllowedCollisionMatrix& acm) const
 {
     auto& crobot = (const CollisionRobotSBPL&)robot;
     auto& rcm = crobot.robotCollisionModel();
@@ -550,7 +564,13 @@ void CollisionWorldSBPL::checkRobotCollisionMutable(
         return;
     }
 
-    auto gm = getCollisionStateUpdater(crobot, *state.getRobotModel());
+    auto context = m_contexts.acquire([]() {
+        return std::unique_ptr<WorldCollisionContext>(
+                new WorldCollisionContext);
+    });
+
+    auto gm = getCollisionStateUpdater(
+            *context, crobot, *state.getRobotModel());
     if (!gm) {
         ROS_ERROR_NAMED(LOG, "Failed to get Group Model for robot '%s', group '%s'", state.getRobotModel()->getName().c_str(), req.group_name.c_str());
         setVacuousCollision(res);
@@ -611,25 +631,25 @@ void CollisionWorldSBPL::checkRobotCollisionMutable(
     }
 }
 
-void CollisionWorldSBPL::checkRobotCollisionMutable(
+void CollisionWorldSBPL::checkRobotCollisionImpl(
     const CollisionRequest& req,
     CollisionResult& res,
     const CollisionRobot& robot,
     const robot_state::RobotState& state1,
-    const robot_state::RobotState& state2)
+    const robot_state::RobotState& state2) const
 {
     // TODO: implement
     ROS_ERROR_NAMED(LOG, "checkRobotCollision(req, res, robot, state1, state2)");
     setVacuousCollision(res);
 }
 
-void CollisionWorldSBPL::checkRobotCollisionMutable(
+void CollisionWorldSBPL::checkRobotCollisionImpl(
     const CollisionRequest& req,
     CollisionResult& res,
     const CollisionRobot& robot,
     const robot_state::RobotState& state1,
     const robot_state::RobotState& state2,
-    const AllowedCollisionMatrix& acm)
+    const AllowedCollisionMatrix& acm) const
 {
     auto& crobot = (const CollisionRobotSBPL&)robot;
     auto& rcm = crobot.robotCollisionModel();
@@ -638,7 +658,13 @@ void CollisionWorldSBPL::checkRobotCollisionMutable(
     assert(state1.getRobotModel()->getName() == rcm->name());
     assert(state2.getRobotModel()->getName() == rcm->name());
 
-    auto gm = getCollisionStateUpdater(crobot, *state1.getRobotModel());
+    auto context = m_contexts.acquire([]() {
+        return std::unique_ptr<WorldCollisionContext>(
+                new WorldCollisionContext);
+    });
+
+    auto gm = getCollisionStateUpdater(
+            *context, crobot, *state1.getRobotModel());
     if (!gm) {
         ROS_ERROR_NAMED(LOG, "Failed to get Group Model for robot '%s', group '%s'", state1.getRobotModel()->getName().c_str(), req.group_name.c_str());
         setVacuousCollision(res);
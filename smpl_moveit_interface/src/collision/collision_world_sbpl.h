@@ -164,7 +164,15 @@ public:
     smpl::OccupancyGridPtr m_grid;
     smpl::collision::WorldCollisionModelPtr m_wcm;
 
-    std::unordered_map<std::string, CollisionStateUpdaterPtr> m_updaters;
+    // scratch state for a single world collision query. each concurrent query
+    // gets its own robot collision states to update.
+    struct WorldCollisionContext
+    {
+        // collision state updaters, keyed by robot model name
+        std::unordered_map<std::string, CollisionStateUpdaterPtr> updaters;
+    };
+
+    mutable CollisionContextPool<WorldCollisionContext> m_contexts;
 
     World::ObserverHandle m_observer_handle;
 
@@ -192,8 +200,9 @@ public:
         -> std::vector<ObjectRepPair>::iterator;
 
     auto getCollisionStateUpdater(
+        WorldCollisionContext& context,
         const CollisionRobotSBPL& collision_robot,
-        const moveit::core::RobotModel& robot_model)
+        const moveit::core::RobotModel& robot_model) const
         -> CollisionStateUpdaterPtr;
 
     void registerWorldCallback();
@@ -202,33 +211,33 @@ public:
     void setVacuousCollision(CollisionResult& res) const;
     void clearAllCollisions(CollisionResult& res) const;
 
-    void checkRobotCollisionMutable(
+    void checkRobotCollisionImpl(
         const CollisionRequest& req,
         CollisionResult& res,
         const CollisionRobot& robot,
-        const robot_state::RobotState& state);
+        const robot_state::RobotState& state) const;
 
-    void checkRobotCollisionMutable(
+    void checkRobotCollisionImpl(
         const CollisionRequest& req,
         CollisionResult& res,
         const CollisionRobot& robot,
         const robot_state::RobotState& state,
-        const AllowedCollisionMatrix& acm);
+        const AllowedCollisionMatrix& acm) const;
 
-    void checkRobotCollisionMutable(
+    void checkRobotCollisionImpl(
         const CollisionRequest& req,
         CollisionResult& res,
         const CollisionRobot& robot,
         const robot_state::RobotState& state1,
-        const robot_state::RobotState& state2);
+        const robot_state::RobotState& state2) const;
 
-    void checkRobotCollisionMutable(
+    void checkRobotCollisionImpl(
         const CollisionRequest& req,
         CollisionResult& res,
         const CollisionRobot& robot,
         const robot_state::RobotState& state1,
         const robot_state::RobotState& state2,
-        const AllowedCollisionMatrix& acm);
+        const AllowedCollisionMatrix& acm) const;
 
     void processWorldUpdateUninitialized(const World::ObjectConstPtr& object);
     void processWorldUpdateCreate(const World::ObjectConstPtr& object);
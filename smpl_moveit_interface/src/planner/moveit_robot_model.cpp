@@ -35,6 +35,7 @@
 
 // standard includes
 #include <math.h>
+#include <algorithm>
 
 // system includes
 #include <eigen_conversions/eigen_kdl.h>
@@ -366,6 +367,7 @@ bool MoveItRobotModel::init(
 
     m_robot_model = robot_model;
     m_robot_state = std::move(robot_state);
+    m_fk_chains.clear();
     m_group_name = group_name;
     m_ik_group_name = std::move(real_ik_group_name);
 
@@ -520,6 +522,7 @@ bool MoveItRobotModel::updateReferenceState(const moveit::core::RobotState& stat
 
     *m_robot_state = state;
     m_robot_state->updateLinkTransforms();
+    m_fk_chains.clear();
     return true;
 }
 
@@ -566,6 +569,15 @@ auto MoveItRobotModel::computeFK(
     assert(initialized() && "MoveItRobotModel is uninitialized");
     assert(state.size() == m_active_var_count && "Incorrect number of joint variables");
 
+    auto& chain = getFKChain(name);
+    if (chain.supported) {
+        auto T_model_link = computeChainFK(chain, state);
+        if (!transformToPlanningFrame(T_model_link)) {
+            return Eigen::Affine3d::Identity(); // errors printed within
+        }
+        return T_model_link;
+    }
+
     // update all the variables in the robot state
     for (size_t vind = 0; vind < state.size(); ++vind) {
         m_robot_state->setVariablePosition(
@@ -600,6 +612,131 @@ auto MoveItRobotModel::computeFK(const smpl::RobotState& state)
     return computeFK(state, m_tip_link->getName());
 }
 
+auto MoveItRobotModel::getFKChain(const std::string& name) -> FKChain&
+{
+    auto it = m_fk_chains.find(name);
+    if (it != end(m_fk_chains)) {
+        return *it->second;
+    }
+
+    auto& chain = *(m_fk_chains[name] = std::unique_ptr<FKChain>(new FKChain));
+    auto* link = m_robot_model->getLinkModel(name);
+    if (link != NULL) {
+        initFKChain(link, chain);
+    }
+    return chain;
+}
+
+void MoveItRobotModel::initFKChain(
+    const moveit::core::LinkModel* link,
+    FKChain& chain)
+{
+    // map robot state variables to planning variables
+    std::vector<int> planning_vars(m_robot_model->getVariableCount(), -1);
+    for (size_t vidx = 0; vidx < m_active_var_indices.size(); ++vidx) {
+        planning_vars[m_active_var_indices[vidx]] = (int)vidx;
+    }
+
+    auto moved_by_planning_vars = [&](const moveit::core::JointModel* joint)
+    {
+        auto first = joint->getFirstVariableIndex();
+        for (size_t i = 0; i < joint->getVariableCount(); ++i) {
+            if (planning_vars[first + i] >= 0) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    // collect the joints from the link up to the root, and remember the
+    // topmost joint moved by a planning variable
+    std::vector<const moveit::core::JointModel*> joints;
+    size_t chain_length = 0;
+    for (auto* l = link; l != NULL; l = l->getParentJointModel()->getParentLinkModel()) {
+        auto* joint = l->getParentJointModel();
+        joints.push_back(joint);
+
+        // the mimicked joint may not lie along the chain
+        if (joint->getMimic() != NULL && moved_by_planning_vars(joint->getMimic())) {
+            ROS_DEBUG_NAMED(LOG, "Chain to link '%s' contains mimic joint '%s'", link->getName().c_str(), joint->getName().c_str());
+            chain.supported = false;
+            return;
+        }
+        if (moved_by_planning_vars(joint)) {
+            chain_length = joints.size();
+        }
+    }
+    joints.resize(chain_length);
+    std::reverse(begin(joints), end(joints));
+
+    if (joints.empty()) {
+        chain.T_model_root = m_robot_state->getGlobalLinkTransform(link);
+    } else if (joints.front()->getParentLinkModel() == NULL) {
+        chain.T_model_root = Eigen::Affine3d::Identity();
+    } else {
+        chain.T_model_root = m_robot_state->getGlobalLinkTransform(
+                joints.front()->getParentLinkModel());
+    }
+
+    chain.joints = std::move(joints);
+    chain.var_offsets.clear();
+    chain.values.clear();
+    chain.value_vars.clear();
+    chain.value_joints.clear();
+    for (size_t j = 0; j < chain.joints.size(); ++j) {
+        auto* joint = chain.joints[j];
+        chain.var_offsets.push_back((int)chain.values.size());
+        auto* positions = m_robot_state->getJointPositions(joint);
+        auto first = joint->getFirstVariableIndex();
+        for (size_t i = 0; i < joint->getVariableCount(); ++i) {
+            chain.values.push_back(positions[i]);
+            chain.value_vars.push_back(planning_vars[first + i]);
+            chain.value_joints.push_back((int)j);
+        }
+    }
+    chain.transforms.resize(chain.joints.size());
+    chain.valid_count = 0;
+    chain.supported = true;
+
+    ROS_DEBUG_NAMED(LOG, "Initialized kinematic chain of %zu joints to link '%s'", chain.joints.size(), link->getName().c_str());
+}
+
+// Compute the pose of the last link in the chain, in the model frame, updating
+// only the joints at or below the first joint whose variables have changed
+// since the last call.
+auto MoveItRobotModel::computeChainFK(
+    FKChain& chain,
+    const smpl::RobotState& state)
+    -> const Eigen::Affine3d&
+{
+    if (chain.joints.empty()) {
+        return chain.T_model_root;
+    }
+
+    size_t first = chain.valid_count;
+    for (size_t i = 0; i < chain.values.size(); ++i) {
+        int vidx = chain.value_vars[i];
+        if (vidx >= 0 && chain.values[i] != state[vidx]) {
+            chain.values[i] = state[vidx];
+            first = std::min(first, (size_t)chain.value_joints[i]);
+        }
+    }
+
+    for (size_t j = first; j < chain.joints.size(); ++j) {
+        auto* joint = chain.joints[j];
+        auto* link = joint->getChildLinkModel();
+        Eigen::Affine3d T_parent_link =
+                (j == 0) ? chain.T_model_root : chain.transforms[j - 1];
+        Eigen::Affine3d T_joint;
+        joint->computeTransform(&chain.values[chain.var_offsets[j]], T_joint);
+        chain.transforms[j] =
+                T_parent_link * link->getJointOriginTransform() * T_joint;
+    }
+    chain.valid_count = chain.joints.size();
+
+    return chain.transforms.back();
+}
+
 bool MoveItRobotModel::computeIK(
     const Eigen::Affine3d& pose,
     const smpl::RobotState& start,
@@ -2,6 +2,8 @@
 
 // standard includes
 #include <chrono>
+#include <list>
+#include <mutex>
 
 // system includes
 #include <moveit/collision_detection/world.h>
@@ -10,6 +12,7 @@
 #include <moveit/robot_state/conversions.h>
 #include <moveit_msgs/GetMotionPlan.h>
 #include <moveit_msgs/PlanningScene.h>
+#include <ros/ros.h>
 #include <smpl/console/nonstd.h>
 #include <smpl/ros/propagation_distance_field.h>
 #include <smpl/stl/memory.h>
@@ -92,6 +95,68 @@ auto to_cstring(moveit_msgs::MoveItErrorCodes code) -> const char*
 
 namespace sbpl_interface {
 
+using HeuristicGridObjectMap =
+        std::map<std::string, collision_detection::World::ObjectConstPtr>;
+
+// Identifies the region and discretization of a heuristic grid
+struct HeuristicGridKey
+{
+    std::string frame_id;
+    double origin_x, origin_y, origin_z;
+    double size_x, size_y, size_z;
+    double res_x, res_y, res_z;
+    double max_distance;
+};
+
+static
+bool operator==(const HeuristicGridKey& a, const HeuristicGridKey& b)
+{
+    return a.frame_id == b.frame_id &&
+            a.origin_x == b.origin_x &&
+            a.origin_y == b.origin_y &&
+            a.origin_z == b.origin_z &&
+            a.size_x == b.size_x &&
+            a.size_y == b.size_y &&
+            a.size_z == b.size_z &&
+            a.res_x == b.res_x &&
+            a.res_y == b.res_y &&
+            a.res_z == b.res_z &&
+            a.max_distance == b.max_distance;
+}
+
+// A heuristic grid and the world objects it contains. MoveIt copies a world
+// object on write whenever the object is shared, so holding references to the
+// objects guarantees that they are never modified in place, and the grid is
+// up to date for any world holding exactly the same objects. Only grids built
+// by voxelizing the objects may be updated incrementally; the obstacle counts
+// of a grid copied from another distance field do not correspond to the
+// objects.
+struct HeuristicGridEntry
+{
+    HeuristicGridKey key;
+    HeuristicGridObjectMap objects;
+    std::shared_ptr<const smpl::OccupancyGrid> grid;
+    bool voxelized;
+};
+
+// Heuristic grids shared by all planning contexts in the process, most
+// recently used first. Cached grids are never modified, so contexts may plan
+// with them concurrently.
+struct HeuristicGridCache
+{
+    std::mutex mutex;
+    std::list<HeuristicGridEntry> entries;
+};
+
+static const size_t HeuristicGridCacheCapacity = 4;
+
+static
+auto GetHeuristicGridCache() -> HeuristicGridCache&
+{
+    static HeuristicGridCache cache;
+    return cache;
+}
+
 static
 bool InitPlanningParams(
     const std::map<std::string, std::string>& config,
@@ -114,12 +179,13 @@ bool TranslateRequest(
 static
 auto CreateHeuristicGrid(
     const planning_scene::PlanningScene& scene,
-    const moveit_msgs::WorkspaceParameters& workspace,
+    const moveit_msgs::OrientedBoundingBox& workspace_aabb,
     const std::string& group_name,
     double res_y,
     double res_x,
     double res_z,
-    double max_distance)
+    double max_distance,
+    bool* voxelized)
     -> std::unique_ptr<smpl::OccupancyGrid>;
 
 static
@@ -134,102 +200,17 @@ void CopyDistanceField(
     smpl::DistanceMapInterface& dfout);
 
 static
-auto UpdateOrCreateGrid(
+void UpdateHeuristicGrid(
+    const HeuristicGridObjectMap& prev_objects,
+    const HeuristicGridObjectMap& objects,
+    smpl::OccupancyGrid& grid);
+
+static
+auto GetHeuristicGrid(
     SBPLPlanningContext* context,
-    std::unique_ptr<smpl::OccupancyGrid> grid,
-    const planning_scene::PlanningSceneConstPtr& scene,
+    const planning_scene::PlanningScene& scene,
     const moveit_msgs::WorkspaceParameters& workspace)
-    -> std::unique_ptr<smpl::OccupancyGrid>
-{
-    // TODO: transforms may have changed that reposition the workspace within
-    // the planning frame
-    bool workspace_diff =
-            workspace.header.frame_id != context->m_prev_workspace.header.frame_id ||
-            workspace.min_corner.x != context->m_prev_workspace.min_corner.x ||
-            workspace.min_corner.y != context->m_prev_workspace.min_corner.y ||
-            workspace.min_corner.z != context->m_prev_workspace.min_corner.z ||
-            workspace.max_corner.x != context->m_prev_workspace.max_corner.x ||
-            workspace.max_corner.y != context->m_prev_workspace.max_corner.y ||
-            workspace.max_corner.z != context->m_prev_workspace.max_corner.z;
-
-    if (scene != context->m_prev_scene || workspace_diff) {
-        ROS_DEBUG_NAMED(PP_LOGGER, "   -> Scene or workspace changed (scene: %p -> %p)", context->m_prev_scene.get(), scene.get());
-        {
-            auto g = std::move(grid); // for lack of a swap or destroy
-        }
-        return CreateHeuristicGrid(
-                *scene,
-                workspace,
-                context->m_robot_model->planningGroupName(),
-                context->m_grid_res_x,
-                context->m_grid_res_y,
-                context->m_grid_res_z,
-                context->m_grid_inflation_radius);
-    } else {
-        ROS_DEBUG_NAMED(PP_LOGGER, "   -> Update persistent grid");
-        auto voxelize = [&](const collision_detection::World::Object& object)
-        {
-            std::vector<std::vector<Eigen::Vector3d>> voxelses; // , my precious
-            Eigen::Vector3d grid_origin;
-            grid_origin.x() = grid->originX();
-            grid_origin.y() = grid->originY();
-            grid_origin.z() = grid->originZ();
-            smpl::collision::VoxelizeObject(
-                    object,
-                    grid->resolution(),
-                    grid_origin,
-                    voxelses);
-            return voxelses;
-        };
-
-        auto remove_object = [&](const collision_detection::World::Object& object)
-        {
-            auto voxelses = voxelize(object);
-            for (auto& voxels : voxelses) {
-                grid->removePointsFromField(voxels);
-            }
-        };
-
-        auto insert_object = [&](const collision_detection::World::Object& object)
-        {
-            auto voxelses = voxelize(object);
-            for (auto& voxels : voxelses) {
-                grid->addPointsToField(voxels);
-            }
-        };
-
-        auto wnew_begin = scene->getWorld()->begin();
-        auto wnew_end = scene->getWorld()->end();
-
-        auto wold_begin = context->m_prev_scene->getWorld()->begin();
-        auto wold_end = context->m_prev_scene->getWorld()->end();
-
-        // Remove objects that are in prev_scene but not in scene
-        for (auto it = wold_begin; it != wold_end; ++it) {
-            if (!scene->getWorld()->hasObject(it->first)) {
-                remove_object(*it->second);
-            }
-        }
-
-        // Update objects that are in both scenes but whose properties have changed
-        for (auto it = wold_begin; it != wold_end; ++it) {
-            if (scene->getWorld()->hasObject(it->first)) {
-                remove_object(*it->second);
-                insert_object(*scene->getWorld()->getObject(it->first));
-            }
-        }
-
-        // Add objects that are in scene but not in prev_scene
-        for (auto it = wnew_begin; it != wnew_end; ++it) {
-            if (!context->m_prev_scene->getWorld()->hasObject(it->first)) {
-                insert_object(*it->second);
-            }
-        }
-
-//        return std::move(grid);
-        return grid;
-    }
-}
+    -> std::shared_ptr<const smpl::OccupancyGrid>;
 
 bool InitPlanningParams(
     const std::map<std::string, std::string>& config,
@@ -288,6 +269,15 @@ bool InitPlanningParams(
         }
     }
 
+    {
+        auto it = config.find("capture_output_dir");
+        if (it != end(config)) {
+            pp->capture_output_dir = it->second;
+        } else {
+            pp->capture_output_dir.clear();
+        }
+    }
+
     //////////////////////////////////////////////
     // initialize structures against parameters //
     //////////////////////////////////////////////
@@ -435,12 +425,13 @@ bool GetPlanningFrameWorkspaceAABB(
 
 auto CreateHeuristicGrid(
     const planning_scene::PlanningScene& scene,
-    const moveit_msgs::WorkspaceParameters& workspace,
+    const moveit_msgs::OrientedBoundingBox& workspace_aabb,
     const std::string& group_name,
     double res_y,
     double res_x,
     double res_z,
-    double max_distance)
+    double max_distance,
+    bool* voxelized)
     -> std::unique_ptr<smpl::OccupancyGrid>
 {
     // create a distance field in the planning frame that represents the
@@ -450,12 +441,6 @@ auto CreateHeuristicGrid(
     // Determine Distance Field Parameters //
     /////////////////////////////////////////
 
-    moveit_msgs::OrientedBoundingBox workspace_aabb;
-    if (!GetPlanningFrameWorkspaceAABB(workspace, scene, workspace_aabb)) {
-        ROS_ERROR_NAMED(PP_LOGGER, "Failed to get workspace boundaries in the planning frame");
-        return NULL;
-    }
-
     ROS_DEBUG_NAMED(PP_LOGGER, "AABB of workspace in planning frame:");
     ROS_DEBUG_NAMED(PP_LOGGER, "  pose:");
     ROS_DEBUG_NAMED(PP_LOGGER, "    position: (%0.3f, %0.3f, %0.3f)", workspace_aabb.pose.position.x, workspace_aabb.pose.position.y, workspace_aabb.pose.position.z);
@@ -515,8 +500,9 @@ auto CreateHeuristicGrid(
             CopyDistanceField(*df, *hdf);
 
             ROS_INFO_NAMED(PP_LOGGER, "Successfully initialized heuristic grid from sbpl collision checker");
-            auto grid = smpl::make_unique<smpl::OccupancyGrid>(hdf);
+            auto grid = smpl::make_unique<smpl::OccupancyGrid>(hdf, true);
             grid->setReferenceFrame(scene.getPlanningFrame());
+            *voxelized = false;
             return grid;
         } else {
             ROS_WARN_NAMED(PP_LOGGER, "Just kidding! Collision World SBPL's distance field is uninitialized");
@@ -531,7 +517,7 @@ auto CreateHeuristicGrid(
     // instantiating a full cspace here and using available voxels state
     // information for a more accurate heuristic
 
-    auto grid = smpl::make_unique<smpl::OccupancyGrid>(hdf);
+    auto grid = smpl::make_unique<smpl::OccupancyGrid>(hdf, true);
     grid->setReferenceFrame(scene.getPlanningFrame());
 
     // temporary storage for collision shapes/objects
@@ -563,6 +549,7 @@ auto CreateHeuristicGrid(
     // note: collision world and going out of scope here will
     // not destroy the prepared distance field and occupancy grid
 
+    *voxelized = true;
     return grid;
 }
 
@@ -591,6 +578,168 @@ void CopyDistanceField(
     dfout.addPointsToMap(points);
 }
 
+// Update a grid containing one set of world objects to contain another. Only
+// objects that were added, removed, or replaced are voxelized.
+void UpdateHeuristicGrid(
+    const HeuristicGridObjectMap& prev_objects,
+    const HeuristicGridObjectMap& objects,
+    smpl::OccupancyGrid& grid)
+{
+    auto voxelize = [&](const collision_detection::World::Object& object)
+    {
+        std::vector<std::vector<Eigen::Vector3d>> voxelses; // , my precious
+        Eigen::Vector3d grid_origin;
+        grid_origin.x() = grid.originX();
+        grid_origin.y() = grid.originY();
+        grid_origin.z() = grid.originZ();
+        smpl::collision::VoxelizeObject(
+                object,
+                grid.resolution(),
+                grid_origin,
+                voxelses);
+        return voxelses;
+    };
+
+    int remove_count = 0;
+    for (auto& entry : prev_objects) {
+        auto it = objects.find(entry.first);
+        if (it == end(objects) || it->second != entry.second) {
+            for (auto& voxels : voxelize(*entry.second)) {
+                grid.removePointsFromField(voxels);
+            }
+            ++remove_count;
+        }
+    }
+
+    int insert_count = 0;
+    for (auto& entry : objects) {
+        auto it = prev_objects.find(entry.first);
+        if (it == end(prev_objects) || it->second != entry.second) {
+            for (auto& voxels : voxelize(*entry.second)) {
+                grid.addPointsToField(voxels);
+            }
+            ++insert_count;
+        }
+    }
+
+    ROS_DEBUG_NAMED(PP_LOGGER, "Removed %d and inserted %d objects into the heuristic grid", remove_count, insert_count);
+}
+
+// Return a heuristic grid for the world of a planning scene, from the shared
+// cache if possible. On a miss, a cached grid over the same workspace is
+// copied and updated with the objects that differ, and a new grid is created
+// only if there is no such grid.
+auto GetHeuristicGrid(
+    SBPLPlanningContext* context,
+    const planning_scene::PlanningScene& scene,
+    const moveit_msgs::WorkspaceParameters& workspace)
+    -> std::shared_ptr<const smpl::OccupancyGrid>
+{
+    moveit_msgs::OrientedBoundingBox workspace_aabb;
+    if (!GetPlanningFrameWorkspaceAABB(workspace, scene, workspace_aabb)) {
+        ROS_ERROR_NAMED(PP_LOGGER, "Failed to get workspace boundaries in the planning frame");
+        return NULL;
+    }
+
+    HeuristicGridKey key;
+    key.frame_id = scene.getPlanningFrame();
+    key.origin_x = workspace_aabb.pose.position.x - 0.5 * workspace_aabb.extents.x;
+    key.origin_y = workspace_aabb.pose.position.y - 0.5 * workspace_aabb.extents.y;
+    key.origin_z = workspace_aabb.pose.position.z - 0.5 * workspace_aabb.extents.z;
+    key.size_x = workspace_aabb.extents.x;
+    key.size_y = workspace_aabb.extents.y;
+    key.size_z = workspace_aabb.extents.z;
+    key.res_x = context->m_grid_res_x;
+    key.res_y = context->m_grid_res_y;
+    key.res_z = context->m_grid_res_z;
+    key.max_distance = context->m_grid_inflation_radius;
+
+    HeuristicGridObjectMap objects;
+    auto world = scene.getWorld();
+    if (world) {
+        for (auto it = world->begin(); it != world->end(); ++it) {
+            objects.insert(std::make_pair(it->first, it->second));
+        }
+    }
+
+    auto& cache = GetHeuristicGridCache();
+
+    // look for a grid of this world, or else the most recently used grid over
+    // the same workspace that may be updated
+    auto find_grid = [&]() -> std::list<HeuristicGridEntry>::iterator
+    {
+        for (auto it = begin(cache.entries); it != end(cache.entries); ++it) {
+            if (it->key == key && it->objects == objects) {
+                cache.entries.splice(begin(cache.entries), cache.entries, it);
+                return begin(cache.entries);
+            }
+        }
+        return end(cache.entries);
+    };
+
+    std::shared_ptr<const smpl::OccupancyGrid> base_grid;
+    HeuristicGridObjectMap base_objects;
+    {
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        auto it = find_grid();
+        if (it != end(cache.entries)) {
+            ROS_DEBUG_NAMED(PP_LOGGER, "   -> Use cached heuristic grid");
+            return it->grid;
+        }
+        for (auto& entry : cache.entries) {
+            if (entry.key == key && entry.voxelized) {
+                base_grid = entry.grid;
+                base_objects = entry.objects;
+                break;
+            }
+        }
+    }
+
+    // build the grid without holding the lock, so contexts with cached grids
+    // are not kept waiting
+    std::shared_ptr<smpl::OccupancyGrid> grid;
+    bool voxelized;
+    if (base_grid) {
+        ROS_DEBUG_NAMED(PP_LOGGER, "   -> Update copy of cached heuristic grid");
+        grid = std::make_shared<smpl::OccupancyGrid>(*base_grid);
+        UpdateHeuristicGrid(base_objects, objects, *grid);
+        voxelized = true;
+    } else {
+        ROS_DEBUG_NAMED(PP_LOGGER, "   -> Create heuristic grid");
+        grid = CreateHeuristicGrid(
+                scene,
+                workspace_aabb,
+                context->m_robot_model->planningGroupName(),
+                context->m_grid_res_x,
+                context->m_grid_res_y,
+                context->m_grid_res_z,
+                context->m_grid_inflation_radius,
+                &voxelized);
+        if (!grid) {
+            return NULL;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(cache.mutex);
+
+    // another context may have made the same grid in the meantime
+    auto it = find_grid();
+    if (it != end(cache.entries)) {
+        return it->grid;
+    }
+
+    HeuristicGridEntry entry;
+    entry.key = std::move(key);
+    entry.objects = std::move(objects);
+    entry.grid = std::move(grid);
+    entry.voxelized = voxelized;
+    cache.entries.push_front(std::move(entry));
+    while (cache.entries.size() > HeuristicGridCacheCapacity) {
+        cache.entries.pop_back();
+    }
+    return cache.entries.front().grid;
+}
+
 /// \brief Initialize SBPL constructs
 /// \param[out] Reason for failure if initialization is unsuccessful
 /// \return true if successful; false otherwise
@@ -616,10 +765,8 @@ bool UpdatePlanner(
     // Create an occupancy grid (distance map) if required by the planner
     // TODO: this should be optional if a grid is not required by the planner
     if (true || context->m_use_grid) {
-        ROS_DEBUG_NAMED(PP_LOGGER, " -> Update or create grid");
-        // TODO: difficult to make this function transactional, since it is
-        // preferred to modify the grid in place when possible
-        context->m_grid = UpdateOrCreateGrid(context, std::move(context->m_grid), scene, workspace);
+        ROS_DEBUG_NAMED(PP_LOGGER, " -> Get heuristic grid");
+        context->m_grid = GetHeuristicGrid(context, *scene, workspace);
         if (!context->m_grid) {
             ROS_WARN_NAMED(PP_LOGGER, "Failed to update or create grid");
             return false;
@@ -634,8 +781,23 @@ bool UpdatePlanner(
         return false;
     }
 
-    context->m_prev_scene = scene;
-    context->m_prev_workspace = workspace;
+    // the collision checker checks against the planning scene, not the
+    // heuristic grid, so captures of requests here can not be replayed
+    // against the captured grid. The configuration of the sbpl collision
+    // plugin, if it is in use, is still recorded with them. Attached objects
+    // are recorded from the planning scene and the start state
+    context->m_planner->setCaptureGridIsCollisionWorld(false);
+    if (!context->m_pp.capture_output_dir.empty()) {
+        ros::NodeHandle ph("~");
+        std::string rcm_key;
+        XmlRpc::XmlRpcValue rcm_config;
+        if (ph.searchParam("robot_collision_model", rcm_key) &&
+            ph.getParam(rcm_key, rcm_config))
+        {
+            context->m_planner->setCaptureCollisionModelConfig(rcm_config.toXml());
+        }
+    }
+
     return true;
 }
 
@@ -63,7 +63,8 @@ public:
     MoveItRobotModel* m_robot_model;
     std::unique_ptr<MoveItCollisionChecker> m_collision_checker;
 
-    std::unique_ptr<smpl::OccupancyGrid> m_grid;
+    // heuristic grid, shared with other contexts planning in the same world
+    std::shared_ptr<const smpl::OccupancyGrid> m_grid;
 
     std::unique_ptr<smpl::PlannerInterface> m_planner;
 
@@ -78,9 +79,6 @@ public:
     double m_grid_res_y;
     double m_grid_res_z;
     double m_grid_inflation_radius;
-
-    moveit_msgs::WorkspaceParameters m_prev_workspace;
-    planning_scene::PlanningSceneConstPtr m_prev_scene;
 };
 
 MOVEIT_CLASS_FORWARD(SBPLPlanningContext);
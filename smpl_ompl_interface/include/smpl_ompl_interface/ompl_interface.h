@@ -2,6 +2,7 @@
 #define SMPL_OMPL_INTERFACE_OMPL_INTERFACE_H
 
 // standard includes
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -11,6 +12,7 @@
 
 namespace smpl {
 
+class CollisionChecker;
 class OccupancyGrid;
 
 namespace visual {
@@ -52,6 +54,23 @@ struct OMPLPlanner : public ompl::base::Planner
 
     void setOccupancyGrid(OccupancyGrid* grid);
 
+    using StateValidityCheckerAllocator =
+            std::function<ompl::base::StateValidityCheckerPtr(
+                    const ompl::base::SpaceInformationPtr&)>;
+
+    /// Set the allocator used to create a StateValidityChecker for each
+    /// collision checking thread when the "num_threads" parameter is greater
+    /// than 1. If no allocator is set, all threads share the
+    /// SpaceInformation's StateValidityChecker, which must then be safe to
+    /// call concurrently.
+    void setStateValidityCheckerAllocator(
+        const StateValidityCheckerAllocator& alloc);
+
+    /// Return the collision checker through which the planner checks states
+    /// and motions against the SpaceInformation. The collision checking
+    /// threads used for batch checks are (re)created by setup() and solve().
+    auto getCollisionChecker() -> CollisionChecker*;
+
     void setProblemDefinition(const ompl::base::ProblemDefinitionPtr& pdef) override;
 
     auto solve(const ompl::base::PlannerTerminationCondition& ptc)
@@ -1,6 +1,13 @@
 #include <smpl_ompl_interface/ompl_interface.h>
 
+// standard includes
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 // system includes
+#include <ompl/base/DiscreteMotionValidator.h>
 #include <ompl/base/Planner.h>
 #include <ompl/base/goals/GoalLazySamples.h>
 #include <ompl/base/goals/GoalRegion.h>
@@ -158,17 +165,245 @@ auto RobotModel::getExtension(size_t class_code) -> smpl::Extension*
     return NULL;
 }
 
+////////////////////////////////////////
+// Parallel Motion Validity Checking //
+////////////////////////////////////////
+
+// A set of threads that check batches of motions for validity, each using its
+// own StateValidityChecker. The calling thread participates in each batch as
+// worker 0. Motions are checked the same way as DiscreteMotionValidator.
+struct MotionCheckWorkers
+{
+    struct Worker
+    {
+        ompl::base::StateValidityCheckerPtr checker;
+        ompl::base::State* prev = NULL;
+        ompl::base::State* curr = NULL;
+        ompl::base::State* interm = NULL;
+    };
+
+    ompl::base::SpaceInformation* si = NULL;
+    std::vector<Worker> workers;
+    std::vector<std::thread> threads;
+
+    std::mutex mutex;
+    std::condition_variable work_cv;
+    std::condition_variable done_cv;
+    unsigned int generation = 0;
+    int busy = 0;
+    bool stop = false;
+
+    // the batch currently being checked
+    const smpl::RobotState* start = NULL;
+    const std::vector<const Action*>* motions = NULL;
+    std::vector<char> results;
+    std::atomic<size_t> next_motion;
+
+    MotionCheckWorkers() : next_motion(0) { }
+    ~MotionCheckWorkers() { shutdown(); }
+
+    bool init(
+        ompl::base::SpaceInformation* si,
+        int num_workers,
+        const OMPLPlanner::StateValidityCheckerAllocator& alloc);
+
+    void shutdown();
+
+    auto size() const -> int { return (int)workers.size(); }
+
+    void checkBatch(
+        const smpl::RobotState& start,
+        const std::vector<const Action*>& motions,
+        std::vector<bool>& valid);
+
+    void run(int widx, unsigned int generation);
+    void checkMotions(Worker& worker);
+    bool checkMotion(Worker& worker, const Action& motion);
+};
+
+bool MotionCheckWorkers::init(
+    ompl::base::SpaceInformation* si,
+    int num_workers,
+    const OMPLPlanner::StateValidityCheckerAllocator& alloc)
+{
+    shutdown();
+
+    this->si = si;
+
+    auto* space = si->getStateSpace().get();
+    this->workers.resize(num_workers);
+    for (auto& worker : this->workers) {
+        if (alloc) {
+            // OMPL only hands out SpaceInformationPtrs by way of its
+            // StateSpace; pass a non-owning pointer to the allocator
+            auto si_ptr = ompl::base::SpaceInformationPtr(
+                    si, [](ompl::base::SpaceInformation*) { });
+            worker.checker = alloc(si_ptr);
+        } else {
+            worker.checker = si->getStateValidityChecker();
+        }
+        if (!worker.checker) {
+            SMPL_ERROR("Failed to allocate State Validity Checker");
+            shutdown();
+            return false;
+        }
+        worker.prev = space->allocState();
+        worker.curr = space->allocState();
+        worker.interm = space->allocState();
+    }
+
+    this->stop = false;
+    for (int i = 1; i < num_workers; ++i) {
+        this->threads.emplace_back(
+                &MotionCheckWorkers::run, this, i, this->generation);
+    }
+
+    return true;
+}
+
+void MotionCheckWorkers::shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->stop = true;
+    }
+    this->work_cv.notify_all();
+    for (auto& thread : this->threads) {
+        thread.join();
+    }
+    this->threads.clear();
+
+    // if init() failed part-way, the remaining workers have no states
+    for (auto& worker : this->workers) {
+        auto* space = this->si->getStateSpace().get();
+        if (worker.prev != NULL) {
+            space->freeState(worker.prev);
+        }
+        if (worker.curr != NULL) {
+            space->freeState(worker.curr);
+        }
+        if (worker.interm != NULL) {
+            space->freeState(worker.interm);
+        }
+    }
+    this->workers.clear();
+}
+
+void MotionCheckWorkers::checkBatch(
+    const smpl::RobotState& start,
+    const std::vector<const Action*>& motions,
+    std::vector<bool>& valid)
+{
+    this->start = &start;
+    this->motions = &motions;
+    this->results.assign(motions.size(), 0);
+    this->next_motion = 0;
+
+    // wake up the worker threads only if there is more than one motion to go
+    // around
+    auto wake = !this->threads.empty() && motions.size() > 1;
+    if (wake) {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->busy = (int)this->threads.size();
+        ++this->generation;
+    }
+    if (wake) {
+        this->work_cv.notify_all();
+    }
+
+    checkMotions(this->workers[0]);
+
+    if (wake) {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        this->done_cv.wait(lock, [&]() { return this->busy == 0; });
+    }
+
+    valid.resize(motions.size());
+    for (size_t i = 0; i < motions.size(); ++i) {
+        valid[i] = this->results[i] != 0;
+    }
+}
+
+void MotionCheckWorkers::run(int widx, unsigned int generation)
+{
+    auto& worker = this->workers[widx];
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->work_cv.wait(lock, [&]() {
+                return this->stop || this->generation != generation;
+            });
+            if (this->stop) {
+                return;
+            }
+            generation = this->generation;
+        }
+
+        checkMotions(worker);
+
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            if (--this->busy == 0) {
+                this->done_cv.notify_one();
+            }
+        }
+    }
+}
+
+void MotionCheckWorkers::checkMotions(Worker& worker)
+{
+    auto& motions = *this->motions;
+    while (true) {
+        auto i = this->next_motion++;
+        if (i >= motions.size()) {
+            break;
+        }
+        this->results[i] = checkMotion(worker, *motions[i]);
+    }
+}
+
+bool MotionCheckWorkers::checkMotion(Worker& worker, const Action& motion)
+{
+    auto* space = this->si->getStateSpace().get();
+    space->copyFromReals(worker.prev, *this->start);
+    for (auto& waypoint : motion) {
+        space->copyFromReals(worker.curr, waypoint);
+
+        // same checks as DiscreteMotionValidator::checkMotion
+        if (!worker.checker->isValid(worker.curr)) {
+            return false;
+        }
+
+        auto nd = space->validSegmentCount(worker.prev, worker.curr);
+        for (auto j = 1u; j < nd; ++j) {
+            space->interpolate(
+                    worker.prev, worker.curr, (double)j / (double)nd, worker.interm);
+            if (!worker.checker->isValid(worker.interm)) {
+                return false;
+            }
+        }
+
+        std::swap(worker.prev, worker.curr);
+    }
+    return true;
+}
+
 /////////////////////////////////////
 // CollisionChecker Implementation //
 /////////////////////////////////////
 
-struct CollisionChecker : public smpl::CollisionChecker
+struct CollisionChecker :
+    public smpl::CollisionChecker,
+    public smpl::BatchCollisionCheckExtension
 {
     ompl::base::StateSpace* space;
     ompl::base::StateValidityChecker* checker;
     ompl::base::MotionValidator* validator;
     OMPLPlanner::VisualizerFun visualizer;
 
+    // used for batch checks if there is more than one worker
+    MotionCheckWorkers workers;
+
     /// \name smpl::CollisionChecker Interface
     ///@{
     bool isStateValid(
@@ -189,6 +424,14 @@ struct CollisionChecker : public smpl::CollisionChecker
         -> std::vector<smpl::visual::Marker> override;
     ///@}
 
+    /// \name smpl::BatchCollisionCheckExtension Interface
+    ///@{
+    void isMotionBatchValid(
+        const smpl::RobotState& start,
+        const std::vector<const Action*>& motions,
+        std::vector<bool>& valid) override;
+    ///@}
+
     /// \name Extension Interface
     ///@{
     auto getExtension(size_t class_code) -> smpl::Extension* override;
@@ -234,10 +477,32 @@ auto CollisionChecker::getCollisionModelVisualization(const RobotState& state)
     return this->visualizer(state);
 }
 
+void CollisionChecker::isMotionBatchValid(
+    const smpl::RobotState& start,
+    const std::vector<const Action*>& motions,
+    std::vector<bool>& valid)
+{
+    if (this->workers.size() > 1) {
+        this->workers.checkBatch(start, motions, valid);
+        return;
+    }
+
+    valid.resize(motions.size());
+    for (size_t i = 0; i < motions.size(); ++i) {
+        auto& motion = *motions[i];
+        valid[i] = isStateToStateValid(start, motion[0]);
+        for (size_t j = 1; valid[i] && j < motion.size(); ++j) {
+            valid[i] = isStateToStateValid(motion[j - 1], motion[j]);
+        }
+    }
+}
+
 auto CollisionChecker::getExtension(size_t class_code)
     -> smpl::Extension*
 {
-    if (class_code == smpl::GetClassCode<smpl::CollisionChecker>()) {
+    if (class_code == smpl::GetClassCode<smpl::CollisionChecker>() ||
+        class_code == smpl::GetClassCode<smpl::BatchCollisionCheckExtension>())
+    {
         return this;
     }
     return NULL;
@@ -268,6 +533,11 @@ struct PlannerImpl
 
     OccupancyGrid* grid = NULL;
 
+    // number of threads used to check successors for validity
+    int num_threads = 1;
+    OMPLPlanner::StateValidityCheckerAllocator svc_allocator;
+    bool workers_dirty = true;
+
     bool initialized = false;
 
     PlannerImpl(
@@ -288,6 +558,8 @@ struct PlannerImpl
     void setup(OMPLPlanner* planner);
 
     void getPlannerData(const OMPLPlanner* planner, ompl::base::PlannerData& data) const;
+
+    void updateWorkers(ompl::base::SpaceInformation* si);
 };
 
 static
@@ -541,6 +813,16 @@ PlannerImpl::PlannerImpl(
 
     this->search = make_unique<ARAStar>(&this->space, this->heuristic.get());
 
+    {
+        auto set = [this, planner](int val) {
+            this->num_threads = std::max(1, val);
+            this->workers_dirty = true;
+            planner->specs_.multithreaded = this->num_threads > 1;
+        };
+        auto get = [this]() { return this->num_threads; };
+        planner->params().declareParam<int>("num_threads", set, get);
+    }
+
     ////////////////////////
     // Declare Parameters //
     ////////////////////////
@@ -842,6 +1124,8 @@ auto PlannerImpl::solve(
     // Do the thing //
     //////////////////
 
+    updateWorkers(si);
+
     // TODO: hmmm, is this needed? this should probably be part of clear()
     // and allow the state of the search to persist between calls
     this->search->force_planning_from_scratch();
@@ -918,6 +1202,30 @@ void PlannerImpl::setProblemDefinition(
     planner->ompl::base::Planner::setProblemDefinition(pdef);
 }
 
+// (re)create the collision checking threads. successors are only checked in
+// parallel if motions are checked by discretization, since that is how the
+// workers check them
+void PlannerImpl::updateWorkers(ompl::base::SpaceInformation* si)
+{
+    if (!this->workers_dirty) {
+        return;
+    }
+
+    if (this->num_threads > 1 &&
+        dynamic_cast<ompl::base::DiscreteMotionValidator*>(this->checker.validator) != NULL)
+    {
+        if (!this->checker.workers.init(si, this->num_threads, this->svc_allocator)) {
+            SMPL_WARN("Failed to initialize collision checking threads");
+        }
+    } else {
+        if (this->num_threads > 1) {
+            SMPL_WARN("Parallel collision checking requires a DiscreteMotionValidator");
+        }
+        this->checker.workers.shutdown();
+    }
+    this->workers_dirty = false;
+}
+
 void PlannerImpl::clear(OMPLPlanner* planner)
 {
     SMPL_DEBUG("TODO: Planner::clear");
@@ -931,6 +1239,7 @@ void PlannerImpl::setup(OMPLPlanner* planner)
 {
     SMPL_DEBUG("Planner::setup");
     planner->ompl::base::Planner::setup();
+    updateWorkers(planner->getSpaceInformation().get());
 }
 
 void PlannerImpl::checkValidity(OMPLPlanner* planner)
@@ -957,6 +1266,14 @@ void SetOccupancyGrid(PlannerImpl* planner, OccupancyGrid* grid)
     planner->grid = grid;
 }
 
+void SetStateValidityCheckerAllocator(
+    PlannerImpl* planner,
+    const OMPLPlanner::StateValidityCheckerAllocator& alloc)
+{
+    planner->svc_allocator = alloc;
+    planner->workers_dirty = true;
+}
+
 } // namespace detail
 
 ////////////////////////////////
@@ -1004,6 +1321,17 @@ void OMPLPlanner::setOccupancyGrid(OccupancyGrid* grid)
     SetOccupancyGrid(this->m_impl.get(), grid);
 }
 
+void OMPLPlanner::setStateValidityCheckerAllocator(
+    const StateValidityCheckerAllocator& alloc)
+{
+    SetStateValidityCheckerAllocator(this->m_impl.get(), alloc);
+}
+
+auto OMPLPlanner::getCollisionChecker() -> CollisionChecker*
+{
+    return &this->m_impl->checker;
+}
+
 void OMPLPlanner::setProblemDefinition(const ompl::base::ProblemDefinitionPtr& pdef)
 {
     return m_impl->setProblemDefinition(this, pdef);
@@ -113,6 +113,12 @@ auto MakeAWAStar(
     const PlanningParams& params)
     -> std::unique_ptr<SBPLPlanner>;
 
+auto MakeBiWAStar(
+    RobotPlanningSpace* space,
+    RobotHeuristic* heuristic,
+    const PlanningParams& params)
+    -> std::unique_ptr<SBPLPlanner>;
+
 auto MakeMHAStar(
     RobotPlanningSpace* space,
     RobotHeuristic* heuristic,
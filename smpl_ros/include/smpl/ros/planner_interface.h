@@ -41,6 +41,7 @@
 
 // system includes
 #include <Eigen/Dense>
+#include <moveit_msgs/AttachedCollisionObject.h>
 #include <moveit_msgs/MotionPlanRequest.h>
 #include <moveit_msgs/MotionPlanResponse.h>
 #include <moveit_msgs/PlanningScene.h>
@@ -64,6 +65,8 @@ class SBPLPlanner;
 
 namespace smpl {
 
+class SearchTrace;
+
 using PlanningSpaceFactory = std::function<
         std::unique_ptr<RobotPlanningSpace>(
                 RobotModel*, CollisionChecker*, const PlanningParams&)>;
@@ -85,7 +88,7 @@ public:
     PlannerInterface(
         RobotModel* robot,
         CollisionChecker* checker,
-        OccupancyGrid* grid);
+        const OccupancyGrid* grid);
 
     ~PlannerInterface();
 
@@ -126,10 +129,41 @@ public:
     ///     "solution epsilon"
     ///     "expansions"
     ///     "solution cost"
+    ///     "time limited" (1 if the search was stopped by the allowed
+    ///         planning time rather than finishing on its own, 0 otherwise)
     ///
     /// @return The statistics
     auto getPlannerStats() -> std::map<std::string, double>;
 
+    /// @brief Return an estimate of the memory, in bytes, held by each of the
+    /// planner components.
+    ///
+    /// Keys are "space", "search", "grid", and "heuristic/<name>" for each
+    /// heuristic. Components that do not report their memory usage are
+    /// omitted.
+    auto getMemoryUsage() const -> std::map<std::string, size_t>;
+
+    /// \name Planning Capture
+    ///@{
+
+    /// Set the collision model configuration, encoded as XML-RPC, that the
+    /// collision checker was initialized with. It is recorded with each
+    /// capture so that replays rebuild the same collision model.
+    void setCaptureCollisionModelConfig(const std::string& config);
+
+    /// Set the objects attached to the robot in the collision checker. They
+    /// are recorded with each capture, along with the objects attached by the
+    /// planning scene and the start state of the request.
+    void setCaptureAttachedObjects(
+        const std::vector<moveit_msgs::AttachedCollisionObject>& objects);
+
+    /// Set whether the collision checker checks against the world in the
+    /// grid given to the PlannerInterface (the default). If it does not, the
+    /// captured grid is only the heuristic grid, and replays refuse the
+    /// capture.
+    void setCaptureGridIsCollisionWorld(bool value);
+    ///@}
+
     /// \name Visualization
     ///@{
 
@@ -144,7 +178,7 @@ protected:
 
     RobotModel* m_robot;
     CollisionChecker* m_checker;
-    OccupancyGrid* m_grid;
+    const OccupancyGrid* m_grid;
 
     ForwardKinematicsInterface* m_fk_iface;
 
@@ -163,10 +197,26 @@ protected:
     std::map<std::string, std::unique_ptr<RobotHeuristic>> m_heuristics;
     std::unique_ptr<SBPLPlanner> m_planner;
 
+    // trace of search expansions, if "search_trace_path" is set
+    std::unique_ptr<SearchTrace> m_trace;
+
     int m_sol_cost;
 
+    // whether the last search was stopped by the allowed planning time
+    bool m_time_limited;
+
     std::string m_planner_id;
 
+    // collision checker state recorded with captures
+    std::string m_capture_cc_config;
+    std::vector<moveit_msgs::AttachedCollisionObject> m_capture_attached_objects;
+    bool m_capture_grid_is_collision_world;
+
+    bool solveRequest(
+        const moveit_msgs::PlanningScene& planning_scene,
+        const moveit_msgs::MotionPlanRequest& req,
+        moveit_msgs::MotionPlanResponse& res);
+
     // Set start configuration
     bool setGoal(const GoalConstraints& v_goal_constraints);
     bool setStart(const moveit_msgs::RobotState& state);
@@ -182,6 +232,8 @@ protected:
 
     bool reinitPlanner(const std::string& planner_id);
 
+    bool enforceMemoryBudget();
+
     void postProcessPath(std::vector<RobotState>& path) const;
 };
 
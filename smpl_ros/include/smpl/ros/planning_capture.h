@@ -0,0 +1,106 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2018, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#ifndef SMPL_PLANNING_CAPTURE_H
+#define SMPL_PLANNING_CAPTURE_H
+
+// standard includes
+#include <string>
+#include <vector>
+
+// system includes
+#include <moveit_msgs/AttachedCollisionObject.h>
+#include <moveit_msgs/MotionPlanRequest.h>
+#include <moveit_msgs/PlanningScene.h>
+
+// project includes
+#include <smpl/planning_params.h>
+#include <smpl/spatial.h>
+
+namespace smpl {
+
+/// A self-contained snapshot of a single call to PlannerInterface::solve,
+/// sufficient to re-run the request offline and compare against the
+/// recorded outcome.
+struct PlanningCapture
+{
+    /// \name Request
+    ///@{
+    moveit_msgs::PlanningScene scene;
+    moveit_msgs::MotionPlanRequest req;
+    PlanningParams params;
+    ///@}
+
+    /// \name Occupancy Grid Snapshot
+    ///@{
+    double grid_origin[3] = { 0.0, 0.0, 0.0 };
+    double grid_size[3] = { 0.0, 0.0, 0.0 };
+    double grid_resolution = 0.0;
+    double grid_max_distance = 0.0;
+    std::vector<Vector3> occupied_voxels;
+    ///@}
+
+    /// \name Collision Model
+    ///@{
+
+    /// The collision model configuration, encoded as XML-RPC. Empty if it
+    /// was not given to the PlannerInterface.
+    std::string collision_model_config;
+
+    /// Objects attached to the robot when the request was made
+    std::vector<moveit_msgs::AttachedCollisionObject> attached_objects;
+
+    /// Whether the collision checker checked against the world in the grid
+    /// snapshot. When it checked against a world of its own, such as the
+    /// planning scene in MoveIt, the snapshot only holds the heuristic grid
+    /// and the capture can not be replayed against it.
+    bool grid_is_collision_world = true;
+    ///@}
+
+    /// \name Recorded Result
+    ///@{
+    int error_code = 0;
+    double planning_time = 0.0;
+    int expansions = 0;
+    int solution_cost = 0;
+
+    /// Whether the search was stopped by the allowed planning time. The
+    /// expansions and cost of such a search depend on how fast it ran.
+    bool time_limited = false;
+    ///@}
+};
+
+bool WritePlanningCapture(const std::string& path, const PlanningCapture& capture);
+bool ReadPlanningCapture(const std::string& path, PlanningCapture& capture);
+
+} // namespace smpl
+
+#endif
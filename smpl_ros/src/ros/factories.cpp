@@ -22,6 +22,7 @@
 #include <smpl/search/adaptive_planner.h>
 #include <smpl/search/arastar.h>
 #include <smpl/search/awastar.h>
+#include <smpl/search/bidirectional_wastar.h>
 #include <smpl/search/experience_graph_planner.h>
 #include <smpl/stl/memory.h>
 
@@ -399,6 +400,16 @@ auto MakeWorkspaceLattice(
 
     space->setVisualizationFrameId(grid->getReferenceFrame());
 
+    bool ik_memo;
+    if (params.getParam("ik_memo", ik_memo)) {
+        space->setIKMemoEnabled(ik_memo);
+    }
+
+    bool ik_warm_start;
+    if (params.getParam("ik_warm_start", ik_warm_start)) {
+        space->setIKWarmStartEnabled(ik_warm_start);
+    }
+
     return std::move(space);
 }
 
@@ -439,6 +450,16 @@ auto MakeWorkspaceLatticeEGraph(
 
     space->setVisualizationFrameId(grid->getReferenceFrame());
 
+    bool ik_memo;
+    if (params.getParam("ik_memo", ik_memo)) {
+        space->setIKMemoEnabled(ik_memo);
+    }
+
+    bool ik_warm_start;
+    if (params.getParam("ik_warm_start", ik_warm_start)) {
+        space->setIKWarmStartEnabled(ik_warm_start);
+    }
+
     std::string egraph_path;
     if (params.getParam("egraph_path", egraph_path)) {
         // warning printed within, allow to fail silently
@@ -579,6 +600,10 @@ auto MakeDijkstraEgraphHeuristic3D(
     params.param("egraph_epsilon", egw, 1.0);
     h->setWeightEGraph(egw);
 
+    int thread_count;
+    params.param("egraph_heuristic_threads", thread_count, 1);
+    h->setThreadCount(thread_count);
+
     return std::move(h);
 };
 
@@ -648,6 +673,16 @@ auto MakeARAStar(
         search->setAllowedRepairTime(repair_time);
     }
 
+    bool incremental_repair;
+    if (params.getParam("incremental_repair", incremental_repair)) {
+        search->allowIncrementalRepair(incremental_repair);
+    }
+
+    double memory_limit_mb;
+    if (params.getParam("search_memory_limit_mb", memory_limit_mb)) {
+        search->setMemoryLimit((size_t)(memory_limit_mb * 1024.0 * 1024.0));
+    }
+
     return std::move(search);
 }
 
@@ -664,6 +699,24 @@ auto MakeAWAStar(
     return std::move(search);
 }
 
+// Note that the backward search expands predecessors with
+// ManipLattice::GetPreds, which applies the full action set, including any IK
+// actions, to every candidate predecessor to find the actions leading back to
+// the expanded state. Each backward expansion therefore costs roughly one
+// forward expansion per candidate predecessor.
+auto MakeBiWAStar(
+    RobotPlanningSpace* space,
+    RobotHeuristic* heuristic,
+    const PlanningParams& params)
+    -> std::unique_ptr<SBPLPlanner>
+{
+    auto search = make_unique<BidirectionalWAStar>(space, heuristic);
+    double epsilon;
+    params.param("epsilon", epsilon, 1.0);
+    search->set_initialsolution_eps(epsilon);
+    return std::move(search);
+}
+
 auto MakeMHAStar(
     RobotPlanningSpace* space,
     RobotHeuristic* heuristic,
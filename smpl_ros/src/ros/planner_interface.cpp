@@ -47,13 +47,17 @@
 #include <leatherman/utils.h>
 #include <sbpl/planners/mhaplanner.h>
 #include <smpl/angles.h>
+#include <smpl/collision_checker.h>
 #include <smpl/console/console.h>
 #include <smpl/console/nonstd.h>
 #include <smpl/debug/visualize.h>
+#include <smpl/memory_usage.h>
 #include <smpl/heuristic/bfs_heuristic.h>
 #include <smpl/heuristic/egraph_bfs_heuristic.h>
 #include <smpl/heuristic/multi_frame_bfs_heuristic.h>
 #include <smpl/post_processing.h>
+#include <smpl/search/arastar.h>
+#include <smpl/search/search_trace.h>
 #include <smpl/stl/memory.h>
 #include <smpl/time.h>
 #include <smpl/types.h>
@@ -61,6 +65,7 @@
 
 // project includes
 #include <smpl/ros/factories.h>
+#include <smpl/ros/planning_capture.h>
 
 namespace smpl {
 
@@ -192,7 +197,11 @@ PlannerInterface::PlannerInterface(
     m_heuristics(),
     m_planner(),
     m_sol_cost(INFINITECOST),
-    m_planner_id()
+    m_time_limited(false),
+    m_planner_id(),
+    m_capture_cc_config(),
+    m_capture_attached_objects(),
+    m_capture_grid_is_collision_world(true)
 {
     if (m_robot) {
         m_fk_iface = m_robot->getExtension<ForwardKinematicsInterface>();
@@ -279,6 +288,7 @@ PlannerInterface::PlannerInterface(
 
     m_planner_factories["arastar"] = MakeARAStar;
     m_planner_factories["awastar"] = MakeAWAStar;
+    m_planner_factories["biwastar"] = MakeBiWAStar;
     m_planner_factories["mhastar"] = MakeMHAStar;
     m_planner_factories["larastar"] = MakeLARAStar;
     m_planner_factories["egwastar"] = MakeEGWAStar;
@@ -318,6 +328,16 @@ bool PlannerInterface::init(const PlanningParams& params)
 
     m_params = params;
 
+    int cache_capacity;
+    if (m_params.getParam("validity_cache_capacity", cache_capacity)) {
+        auto* cache = m_checker->getExtension<ValidityCacheExtension>();
+        if (cache) {
+            cache->setValidityCacheCapacity(std::max(cache_capacity, 0));
+        } else {
+            SMPL_WARN_NAMED(PI_LOGGER, "Collision checker does not support a validity cache");
+        }
+    }
+
     m_initialized = true;
 
     SMPL_INFO_NAMED(PI_LOGGER, "Initialized planner interface");
@@ -689,13 +709,135 @@ bool WritePath(
     return true;
 }
 
+static
+bool WriteCapture(
+    const moveit_msgs::PlanningScene& planning_scene,
+    const moveit_msgs::MotionPlanRequest& req,
+    const moveit_msgs::MotionPlanResponse& res,
+    const PlanningParams& params,
+    const OccupancyGrid& grid,
+    const std::string& cc_config,
+    const std::vector<moveit_msgs::AttachedCollisionObject>& attached_objects,
+    bool grid_is_collision_world,
+    int expansions,
+    int solution_cost,
+    bool time_limited,
+    const std::string& path)
+{
+    boost::filesystem::path p(path);
+
+    try {
+        if (!boost::filesystem::exists(p)) {
+            SMPL_INFO("Create capture output directory %s", p.native().c_str());
+            boost::filesystem::create_directory(p);
+        }
+
+        if (!boost::filesystem::is_directory(p)) {
+            SMPL_ERROR("Failed to capture request. %s is not a directory", path.c_str());
+            return false;
+        }
+    } catch (const boost::filesystem::filesystem_error& ex) {
+        SMPL_ERROR("Failed to create capture output directory %s", p.native().c_str());
+        return false;
+    }
+
+    std::stringstream ss_filename;
+    auto now = clock::now();
+    ss_filename << "capture_" << now.time_since_epoch().count() << ".bin";
+    p /= ss_filename.str();
+
+    PlanningCapture capture;
+    capture.scene = planning_scene;
+    capture.req = req;
+    capture.params = params;
+
+    // the capture is replayed offline; don't have it log paths or captures of
+    // its own
+    capture.params.plan_output_dir.clear();
+    capture.params.capture_output_dir.clear();
+
+    capture.grid_origin[0] = grid.originX();
+    capture.grid_origin[1] = grid.originY();
+    capture.grid_origin[2] = grid.originZ();
+    capture.grid_size[0] = grid.sizeX();
+    capture.grid_size[1] = grid.sizeY();
+    capture.grid_size[2] = grid.sizeZ();
+    capture.grid_resolution = grid.resolution();
+    capture.grid_max_distance = grid.getDistanceField()->getUninitializedDistance();
+    grid.getOccupiedVoxels(capture.occupied_voxels);
+
+    capture.collision_model_config = cc_config;
+    capture.grid_is_collision_world = grid_is_collision_world;
+
+    // objects attached in the collision checker, followed by those attached
+    // by the scene and the request that were not already recorded
+    capture.attached_objects = attached_objects;
+    auto record_attached = [&](
+        const std::vector<moveit_msgs::AttachedCollisionObject>& objects)
+    {
+        for (auto& ao : objects) {
+            if (ao.object.operation != moveit_msgs::CollisionObject::ADD) {
+                continue;
+            }
+            auto it = std::find_if(
+                    begin(capture.attached_objects),
+                    end(capture.attached_objects),
+                    [&](const moveit_msgs::AttachedCollisionObject& recorded) {
+                        return recorded.object.id == ao.object.id;
+                    });
+            if (it == end(capture.attached_objects)) {
+                capture.attached_objects.push_back(ao);
+            }
+        }
+    };
+    record_attached(planning_scene.robot_state.attached_collision_objects);
+    record_attached(req.start_state.attached_collision_objects);
+
+    capture.error_code = res.error_code.val;
+    capture.planning_time = res.planning_time;
+    capture.expansions = expansions;
+    capture.solution_cost = solution_cost;
+    capture.time_limited = time_limited;
+
+    SMPL_INFO("Capture request to %s", p.native().c_str());
+    return WritePlanningCapture(p.native(), capture);
+}
+
 bool PlannerInterface::solve(
     // TODO: this planning scene is probably not being used in any meaningful way
     const moveit_msgs::PlanningScene& planning_scene,
     const moveit_msgs::MotionPlanRequest& req,
     moveit_msgs::MotionPlanResponse& res)
+{
+    auto success = solveRequest(planning_scene, req, res);
+
+    if (m_initialized && !m_params.capture_output_dir.empty()) {
+        auto expansions = m_planner ? m_planner->get_n_expands() : 0;
+        WriteCapture(
+                planning_scene,
+                req,
+                res,
+                m_params,
+                *m_grid,
+                m_capture_cc_config,
+                m_capture_attached_objects,
+                m_capture_grid_is_collision_world,
+                expansions,
+                success ? m_sol_cost : INFINITECOST,
+                m_time_limited,
+                m_params.capture_output_dir);
+    }
+
+    return success;
+}
+
+bool PlannerInterface::solveRequest(
+    const moveit_msgs::PlanningScene& planning_scene,
+    const moveit_msgs::MotionPlanRequest& req,
+    moveit_msgs::MotionPlanResponse& res)
 {
     ClearMotionPlanResponse(req, res);
+    m_time_limited = false;
 
     if (!m_initialized) {
         res.error_code.val = moveit_msgs::MoveItErrorCodes::FAILURE;
@@ -718,6 +860,11 @@ bool PlannerInterface::solve(
         return false;
     }
 
+    if (!enforceMemoryBudget()) {
+        res.error_code.val = moveit_msgs::MoveItErrorCodes::FAILURE;
+        return false;
+    }
+
     res.trajectory_start = planning_scene.robot_state;
     SMPL_INFO_NAMED(PI_LOGGER, "Allowed Time (s): %0.3f", req.allowed_planning_time);
 
@@ -1172,8 +1319,13 @@ bool PlannerInterface::plan(double allowed_time, std::vector<RobotState>& path)
     m_planner->force_planning_from_scratch();
 
     // plan
+    auto then = clock::now();
     b_ret = m_planner->replan(allowed_time, &solution_state_ids, &m_sol_cost);
 
+    // the search checks its time limit between expansions, so a search that
+    // ran out of time has run for at least the allowed time
+    m_time_limited = to_seconds(clock::now() - then) >= allowed_time;
+
     // check if an empty plan was received.
     if (b_ret && solution_state_ids.size() <= 0) {
         SMPL_WARN_NAMED(PI_LOGGER, "Path returned by the planner is empty?");
@@ -1255,6 +1407,9 @@ bool PlannerInterface::canServiceRequest(
 auto PlannerInterface::getPlannerStats() -> std::map<std::string, double>
 {
     std::map<std::string, double> stats;
+    if (!m_planner) {
+        return stats;
+    }
     stats["initial solution planning time"] = m_planner->get_initial_eps_planning_time();
     stats["initial epsilon"] = m_planner->get_initial_eps();
     stats["initial solution expansions"] = m_planner->get_n_expands_init_solution();
@@ -1263,9 +1418,51 @@ auto PlannerInterface::getPlannerStats() -> std::map<std::string, double>
     stats["solution epsilon"] = m_planner->get_solution_eps();
     stats["expansions"] = m_planner->get_n_expands();
     stats["solution cost"] = m_sol_cost;
+    stats["time limited"] = m_time_limited ? 1.0 : 0.0;
     return stats;
 }
 
+void PlannerInterface::setCaptureCollisionModelConfig(const std::string& config)
+{
+    m_capture_cc_config = config;
+}
+
+void PlannerInterface::setCaptureAttachedObjects(
+    const std::vector<moveit_msgs::AttachedCollisionObject>& objects)
+{
+    m_capture_attached_objects = objects;
+}
+
+void PlannerInterface::setCaptureGridIsCollisionWorld(bool value)
+{
+    m_capture_grid_is_collision_world = value;
+}
+
+auto PlannerInterface::getMemoryUsage() const -> std::map<std::string, size_t>
+{
+    std::map<std::string, size_t> usage;
+    if (m_pspace) {
+        auto* mem = m_pspace->getExtension<MemoryUsageExtension>();
+        if (mem) {
+            usage["space"] = mem->memoryUsage();
+        }
+    }
+    for (auto& entry : m_heuristics) {
+        auto* mem = entry.second->getExtension<MemoryUsageExtension>();
+        if (mem) {
+            usage["heuristic/" + entry.first] = mem->memoryUsage();
+        }
+    }
+    auto* search = dynamic_cast<const ARAStar*>(m_planner.get());
+    if (search) {
+        usage["search"] = search->memoryUsage();
+    }
+    if (m_grid) {
+        usage["grid"] = m_grid->memoryUsage();
+    }
+    return usage;
+}
+
 auto PlannerInterface::makePathVisualization(
     const std::vector<RobotState>& path) const
     -> std::vector<visual::Marker>
@@ -1445,10 +1642,75 @@ bool PlannerInterface::reinitPlanner(const std::string& planner_id)
         SMPL_ERROR("Failed to build planner '%s'", search_name.c_str());
         return false;
     }
+
+    std::string trace_path;
+    if (m_params.getParam("search_trace_path", trace_path)) {
+        if (!m_trace) {
+            m_trace = make_unique<SearchTrace>();
+            m_trace->open(trace_path);
+        }
+        auto* search = dynamic_cast<ARAStar*>(m_planner.get());
+        if (search && m_trace->isOpen()) {
+            search->setTrace(m_trace.get());
+        }
+    }
+
     m_planner_id = planner_id;
     return true;
 }
 
+// Keep the memory retained by the planning space, heuristics, and search
+// below the "memory_budget_mb" parameter. Caches are released first; if that
+// is not enough, the planner components are rebuilt from scratch. The
+// occupancy grid is not owned here and does not count toward the budget.
+bool PlannerInterface::enforceMemoryBudget()
+{
+    double budget_mb;
+    if (!m_params.getParam("memory_budget_mb", budget_mb) || budget_mb <= 0.0) {
+        return true;
+    }
+    auto budget = (size_t)(budget_mb * 1024.0 * 1024.0);
+
+    auto planner_usage = [&]() {
+        auto usage = getMemoryUsage();
+        usage.erase("grid");
+        size_t total = 0;
+        for (auto& entry : usage) {
+            total += entry.second;
+        }
+        return total;
+    };
+
+    auto total = planner_usage();
+    if (total <= budget) {
+        return true;
+    }
+
+    SMPL_INFO_NAMED(PI_LOGGER, "Planner memory usage (%zu bytes) exceeds budget (%zu bytes). Release caches", total, budget);
+
+    auto release = [](Extension* ext) {
+        auto* mem = ext->getExtension<MemoryUsageExtension>();
+        if (mem) {
+            mem->releaseCaches();
+        }
+    };
+    release(m_pspace.get());
+    for (auto& entry : m_heuristics) {
+        release(entry.second.get());
+    }
+
+    total = planner_usage();
+    if (total <= budget) {
+        return true;
+    }
+
+    SMPL_WARN_NAMED(PI_LOGGER, "Planner memory usage (%zu bytes) still exceeds budget (%zu bytes). Rebuild planner", total, budget);
+
+    auto planner_id = m_planner_id;
+    m_planner_id.clear();
+    return reinitPlanner(planner_id);
+}
+
 void PlannerInterface::postProcessPath(std::vector<RobotState>& path) const
 {
     // shortcut path
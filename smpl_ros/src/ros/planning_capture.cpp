@@ -0,0 +1,302 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2018, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#include <smpl/ros/planning_capture.h>
+
+// standard includes
+#include <stdint.h>
+#include <fstream>
+#include <iterator>
+
+// system includes
+#include <ros/serialization.h>
+#include <smpl/console/console.h>
+
+namespace smpl {
+
+namespace ser = ros::serialization;
+
+static const uint32_t CaptureMagic = 0x50414353; // "SCAP"
+static const uint32_t CaptureVersion = 3;
+
+enum ParameterType : uint8_t
+{
+    BoolParam = 0,
+    IntParam,
+    DoubleParam,
+    StringParam,
+};
+
+// Accumulates the serialized length of a capture without writing it. Mirrors
+// the interface of ros::serialization::OStream so that the same Serialize
+// routine may be used for both passes.
+struct LengthStream
+{
+    uint32_t length = 0;
+
+    template <class T>
+    void next(const T& t) { length += ser::serializationLength(t); }
+};
+
+template <class Stream>
+struct ParamWriter : public boost::static_visitor<void>
+{
+    Stream* stream;
+
+    ParamWriter(Stream* stream) : stream(stream) { }
+
+    void operator()(bool val) const {
+        stream->next((uint8_t)BoolParam);
+        stream->next((uint8_t)val);
+    }
+
+    void operator()(int val) const {
+        stream->next((uint8_t)IntParam);
+        stream->next((int32_t)val);
+    }
+
+    void operator()(double val) const {
+        stream->next((uint8_t)DoubleParam);
+        stream->next(val);
+    }
+
+    void operator()(const std::string& val) const {
+        stream->next((uint8_t)StringParam);
+        stream->next(val);
+    }
+};
+
+template <class Stream>
+static
+void Serialize(Stream& stream, const PlanningCapture& capture)
+{
+    stream.next(CaptureMagic);
+    stream.next(CaptureVersion);
+
+    stream.next(capture.scene);
+    stream.next(capture.req);
+
+    auto& params = capture.params;
+    stream.next((int32_t)params.cost_per_cell);
+    stream.next((uint8_t)params.shortcut_path);
+    stream.next((uint8_t)params.interpolate_path);
+    stream.next((int32_t)params.shortcut_type);
+    stream.next((uint32_t)params.getParams().size());
+    ParamWriter<Stream> vis(&stream);
+    for (auto& entry : params.getParams()) {
+        stream.next(entry.first);
+        boost::apply_visitor(vis, entry.second);
+    }
+
+    for (int i = 0; i < 3; ++i) {
+        stream.next(capture.grid_origin[i]);
+    }
+    for (int i = 0; i < 3; ++i) {
+        stream.next(capture.grid_size[i]);
+    }
+    stream.next(capture.grid_resolution);
+    stream.next(capture.grid_max_distance);
+    stream.next((uint32_t)capture.occupied_voxels.size());
+    for (auto& v : capture.occupied_voxels) {
+        stream.next(v.x());
+        stream.next(v.y());
+        stream.next(v.z());
+    }
+
+    stream.next(capture.collision_model_config);
+    stream.next(capture.attached_objects);
+    stream.next((uint8_t)capture.grid_is_collision_world);
+
+    stream.next((int32_t)capture.error_code);
+    stream.next(capture.planning_time);
+    stream.next((int32_t)capture.expansions);
+    stream.next((int32_t)capture.solution_cost);
+    stream.next((uint8_t)capture.time_limited);
+}
+
+static
+void Deserialize(ser::IStream& stream, PlanningCapture& capture)
+{
+    stream.next(capture.scene);
+    stream.next(capture.req);
+
+    auto& params = capture.params;
+    int32_t cost_per_cell;
+    uint8_t shortcut_path;
+    uint8_t interpolate_path;
+    int32_t shortcut_type;
+    stream.next(cost_per_cell);
+    stream.next(shortcut_path);
+    stream.next(interpolate_path);
+    stream.next(shortcut_type);
+    params.cost_per_cell = cost_per_cell;
+    params.shortcut_path = shortcut_path != 0;
+    params.interpolate_path = interpolate_path != 0;
+    params.shortcut_type = (ShortcutType)shortcut_type;
+
+    uint32_t param_count;
+    stream.next(param_count);
+    for (uint32_t i = 0; i < param_count; ++i) {
+        std::string name;
+        uint8_t type;
+        stream.next(name);
+        stream.next(type);
+        switch (type) {
+        case BoolParam: {
+            uint8_t val;
+            stream.next(val);
+            params.addParam(name, val != 0);
+            break;
+        }
+        case IntParam: {
+            int32_t val;
+            stream.next(val);
+            params.addParam(name, (int)val);
+            break;
+        }
+        case DoubleParam: {
+            double val;
+            stream.next(val);
+            params.addParam(name, val);
+            break;
+        }
+        case StringParam: {
+            std::string val;
+            stream.next(val);
+            params.addParam(name, val);
+            break;
+        }
+        default:
+            throw ser::StreamOverrunException("Unrecognized parameter type");
+        }
+    }
+
+    for (int i = 0; i < 3; ++i) {
+        stream.next(capture.grid_origin[i]);
+    }
+    for (int i = 0; i < 3; ++i) {
+        stream.next(capture.grid_size[i]);
+    }
+    stream.next(capture.grid_resolution);
+    stream.next(capture.grid_max_distance);
+
+    uint32_t voxel_count;
+    stream.next(voxel_count);
+    capture.occupied_voxels.resize(voxel_count);
+    for (auto& v : capture.occupied_voxels) {
+        stream.next(v.x());
+        stream.next(v.y());
+        stream.next(v.z());
+    }
+
+    stream.next(capture.collision_model_config);
+    stream.next(capture.attached_objects);
+    uint8_t grid_is_collision_world;
+    stream.next(grid_is_collision_world);
+    capture.grid_is_collision_world = grid_is_collision_world != 0;
+
+    int32_t error_code;
+    int32_t expansions;
+    int32_t solution_cost;
+    uint8_t time_limited;
+    stream.next(error_code);
+    stream.next(capture.planning_time);
+    stream.next(expansions);
+    stream.next(solution_cost);
+    stream.next(time_limited);
+    capture.error_code = error_code;
+    capture.expansions = expansions;
+    capture.solution_cost = solution_cost;
+    capture.time_limited = time_limited != 0;
+}
+
+bool WritePlanningCapture(const std::string& path, const PlanningCapture& capture)
+{
+    LengthStream ls;
+    Serialize(ls, capture);
+
+    std::vector<uint8_t> buffer(ls.length);
+    ser::OStream os(buffer.data(), (uint32_t)buffer.size());
+    Serialize(os, capture);
+
+    std::ofstream ofs(path, std::ios::binary);
+    if (!ofs.is_open()) {
+        SMPL_ERROR("Failed to open capture file '%s' for writing", path.c_str());
+        return false;
+    }
+
+    ofs.write((const char*)buffer.data(), buffer.size());
+    if (!ofs.good()) {
+        SMPL_ERROR("Failed to write capture file '%s'", path.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool ReadPlanningCapture(const std::string& path, PlanningCapture& capture)
+{
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs.is_open()) {
+        SMPL_ERROR("Failed to open capture file '%s' for reading", path.c_str());
+        return false;
+    }
+
+    std::vector<uint8_t> buffer(
+            (std::istreambuf_iterator<char>(ifs)),
+            std::istreambuf_iterator<char>());
+
+    try {
+        ser::IStream is(buffer.data(), (uint32_t)buffer.size());
+
+        uint32_t magic;
+        uint32_t version;
+        is.next(magic);
+        is.next(version);
+        if (magic != CaptureMagic) {
+            SMPL_ERROR("'%s' is not a planning capture", path.c_str());
+            return false;
+        }
+        if (version != CaptureVersion) {
+            SMPL_ERROR("Unsupported planning capture version %u (expected %u)", version, CaptureVersion);
+            return false;
+        }
+
+        Deserialize(is, capture);
+    } catch (const ser::StreamOverrunException& ex) {
+        SMPL_ERROR("Failed to read capture file '%s': %s", path.c_str(), ex.what());
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace smpl
@@ -620,6 +620,15 @@ int main(int argc, char* argv[])
         return 1;
     }
 
+    // record the collision model with captures of planning requests
+    std::string rcm_key;
+    XmlRpc::XmlRpcValue rcm_config;
+    if (ph.searchParam("robot_collision_model", rcm_key) &&
+        ph.getParam(rcm_key, rcm_config))
+    {
+        planner.setCaptureCollisionModelConfig(rcm_config.toXml());
+    }
+
     //////////////
     // Planning //
     //////////////
@@ -0,0 +1,162 @@
+#include <stdio.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define BOOST_TEST_MODULE ConsoleAsyncTest
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+// use the standalone console regardless of whether smpl was built against
+// rosconsole; the asynchronous sink is only used by the standalone console
+#include <smpl/console/detail/console_std.h>
+
+namespace console = smpl::console;
+
+static const size_t BufferSize = 1 << 20;
+
+// Redirect stdout to a temporary file for the lifetime of the capture.
+struct StdoutCapture
+{
+    std::string path;
+    int saved_fd;
+
+    StdoutCapture()
+    {
+        char tmpl[] = "/tmp/console_async_testXXXXXX";
+        int fd = mkstemp(tmpl);
+        BOOST_REQUIRE(fd >= 0);
+        path = tmpl;
+        fflush(stdout);
+        saved_fd = dup(STDOUT_FILENO);
+        dup2(fd, STDOUT_FILENO);
+        close(fd);
+    }
+
+    ~StdoutCapture()
+    {
+        fflush(stdout);
+        dup2(saved_fd, STDOUT_FILENO);
+        close(saved_fd);
+        unlink(path.c_str());
+    }
+
+    auto lines() const -> std::vector<std::string>
+    {
+        fflush(stdout);
+        std::vector<std::string> lines;
+        std::ifstream ifs(path);
+        std::string line;
+        while (std::getline(ifs, line)) {
+            lines.push_back(line);
+        }
+        return lines;
+    }
+};
+
+// Messages still queued when the process exits must be written. The sink is
+// started in a child process, since fork() does not carry over the writer
+// thread; this case must run before the sink is started in this process.
+BOOST_AUTO_TEST_CASE(FlushOnShutdownTest)
+{
+    const int count = 1000;
+
+    StdoutCapture capture;
+    pid_t pid = fork();
+    BOOST_REQUIRE(pid >= 0);
+    if (pid == 0) {
+        console::detail::StartAsync(BufferSize);
+        for (int i = 0; i < count; ++i) {
+            SMPL_INFO("shutdown %d", i);
+        }
+        exit(0);
+    }
+
+    int status;
+    BOOST_REQUIRE(waitpid(pid, &status, 0) == pid);
+    BOOST_REQUIRE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    auto lines = capture.lines();
+    BOOST_REQUIRE_EQUAL(lines.size(), (size_t)count);
+    for (int i = 0; i < count; ++i) {
+        BOOST_CHECK_EQUAL(lines[i], "[INFO]  shutdown " + std::to_string(i));
+    }
+}
+
+// Messages are queued for the background writer and written, formatted as
+// they would be on the calling thread, by flush().
+BOOST_AUTO_TEST_CASE(QueueTest)
+{
+    BOOST_REQUIRE(console::detail::StartAsync(BufferSize));
+    BOOST_REQUIRE(console::detail::g_async.load());
+
+    StdoutCapture capture;
+
+    auto before = console::GetAsyncStats();
+    SMPL_INFO("int %d, double %.3f, string %s, %%", -7, 2.5, "str");
+    SMPL_INFO_STREAM("stream " << 42 << ' ' << 2.5 << " 100% " << std::string("str") << ' ' << true);
+    SMPL_INFO_STREAM("manip " << 1.0 / 3.0 << ' ' << std::setprecision(3) << 1.0 / 3.0 << ' ' << 7);
+    auto after = console::GetAsyncStats();
+    BOOST_CHECK_EQUAL(after.written - before.written, 3u);
+    BOOST_CHECK_EQUAL(after.dropped, before.dropped);
+
+    console::flush();
+
+    std::stringstream manip;
+    manip << "manip " << 1.0 / 3.0 << ' ' << std::setprecision(3) << 1.0 / 3.0 << ' ' << 7;
+
+    auto lines = capture.lines();
+    BOOST_REQUIRE_EQUAL(lines.size(), 3u);
+    BOOST_CHECK_EQUAL(lines[0], "[INFO]  int -7, double 2.500, string str, %");
+    BOOST_CHECK_EQUAL(lines[1], "[INFO]  stream 42 2.5 100% str 1");
+    BOOST_CHECK_EQUAL(lines[2], "[INFO]  " + manip.str());
+}
+
+// Messages logged by one thread are written in the order they were logged,
+// and no message is lost when several threads log at once.
+BOOST_AUTO_TEST_CASE(ConcurrentWritersTest)
+{
+    BOOST_REQUIRE(console::detail::StartAsync(BufferSize));
+
+    const int thread_count = 4;
+    const int count = 2000;
+
+    StdoutCapture capture;
+
+    auto before = console::GetAsyncStats();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < thread_count; ++t) {
+        threads.emplace_back([t, count]() {
+            for (int i = 0; i < count; ++i) {
+                if (i % 2) {
+                    SMPL_INFO("thread %d message %d", t, i);
+                } else {
+                    SMPL_INFO_STREAM("thread " << t << " message " << i);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    console::flush();
+    auto after = console::GetAsyncStats();
+    BOOST_REQUIRE_EQUAL(after.dropped, before.dropped);
+
+    std::vector<int> next(thread_count, 0);
+    for (auto& line : capture.lines()) {
+        int t, i;
+        BOOST_REQUIRE(sscanf(line.c_str(), "[INFO]  thread %d message %d", &t, &i) == 2);
+        BOOST_REQUIRE(t >= 0 && t < thread_count);
+        BOOST_REQUIRE_EQUAL(i, next[t]);
+        ++next[t];
+    }
+    for (int t = 0; t < thread_count; ++t) {
+        BOOST_CHECK_EQUAL(next[t], count);
+    }
+}
@@ -1,9 +1,12 @@
 #include <iomanip>
 #include <iostream>
 #include <ostream>
+#include <random>
 #include <utility>
 
+#include <smpl/distance_map/distance_pyramid.h>
 #include <smpl/distance_map/euclid_distance_map.h>
+#include <smpl/distance_map/hashed_distance_map.h>
 #include <smpl/distance_map/sparse_distance_map.h>
 
 /*
@@ -153,9 +156,215 @@ void TestSpecialMemberFunctions()
     }
 }
 
+// Apply the same sequence of insertions, removals, and updates to a distance
+// map and to a SparseDistanceMap and compare the distances after each step.
+template <class DistanceMap>
+void TestMatchesSparseDistanceMap()
+{
+    const double size_x = 3.0;
+    const double size_y = 3.0;
+    const double size_z = 1.5;
+    const double res = 0.05;
+    const double max_dist = 0.4;
+
+    DistanceMap d(0.0, 0.0, 0.0, size_x, size_y, size_z, res, max_dist);
+    smpl::SparseDistanceMap expected(
+            0.0, 0.0, 0.0, size_x, size_y, size_z, res, max_dist);
+
+    std::vector<Eigen::Vector3d> points;
+    std::default_random_engine rng;
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+    for (int i = 0; i < 200; ++i) {
+        points.emplace_back(
+                size_x * dist(rng), size_y * dist(rng), size_z * dist(rng));
+    }
+
+    auto compare = [&](const char* step) {
+        if (d != expected) {
+            printf("Distance map differs from SparseDistanceMap after %s\n", step);
+            return false;
+        }
+        return true;
+    };
+
+    d.addPointsToMap(points);
+    expected.addPointsToMap(points);
+    if (!compare("insertion")) return;
+
+    std::vector<Eigen::Vector3d> removed(points.begin(), points.begin() + 80);
+    d.removePointsFromMap(removed);
+    expected.removePointsFromMap(removed);
+    if (!compare("removal")) return;
+
+    // move the remaining obstacles
+    std::vector<Eigen::Vector3d> old_points(points.begin() + 80, points.end());
+    std::vector<Eigen::Vector3d> new_points;
+    for (size_t i = 0; i < old_points.size(); ++i) {
+        new_points.emplace_back(
+                size_x * dist(rng), size_y * dist(rng), size_z * dist(rng));
+    }
+    d.updatePointsInMap(old_points, new_points);
+    expected.updatePointsInMap(old_points, new_points);
+    if (!compare("update")) return;
+
+    d.reset();
+    expected.reset();
+    compare("reset");
+}
+
+// Shift a distance map and compare it to a distance map constructed at the
+// shifted origin with the same obstacles.
+template <class DistanceMap>
+void TestShiftOrigin()
+{
+    const double size_x = 4.0;
+    const double size_y = 4.0;
+    const double size_z = 2.0;
+    const double res = 0.1;
+    const double max_dist = 0.5;
+
+    std::vector<Eigen::Vector3d> points;
+    std::default_random_engine rng;
+    std::uniform_real_distribution<double> dist(-2.0, 6.0);
+    for (int i = 0; i < 500; ++i) {
+        points.emplace_back(dist(rng), dist(rng), 0.25 * dist(rng) + 0.5);
+    }
+
+    auto within = [&](const DistanceMap& d, const Eigen::Vector3d& p) {
+        int x, y, z;
+        d.worldToGrid(p.x(), p.y(), p.z(), x, y, z);
+        return p.x() > d.originX() - 0.5 * res &&
+                p.y() > d.originY() - 0.5 * res &&
+                p.z() > d.originZ() - 0.5 * res &&
+                d.isCellValid(x, y, z);
+    };
+
+    auto points_within = [&](const DistanceMap& d) {
+        std::vector<Eigen::Vector3d> inside;
+        for (auto& p : points) {
+            if (within(d, p)) {
+                inside.push_back(p);
+            }
+        }
+        return inside;
+    };
+
+    DistanceMap d1(0.0, 0.0, 0.0, size_x, size_y, size_z, res, max_dist);
+    d1.addPointsToMap(points_within(d1));
+
+    const int shifts[][3] = { { 3, 0, 0 }, { -5, 7, 1 }, { 0, -2, -1 }, { 50, 0, 0 } };
+    for (auto& shift : shifts) {
+        std::vector<bool> was_within(points.size());
+        for (size_t i = 0; i < points.size(); ++i) {
+            was_within[i] = within(d1, points[i]);
+        }
+
+        if (!d1.shiftOrigin(shift[0], shift[1], shift[2])) {
+            printf("Failed to shift distance map\n");
+            return;
+        }
+
+        // add only the obstacles entering the volume; the distances around
+        // the retained obstacles must survive the shift
+        std::vector<Eigen::Vector3d> entering;
+        for (size_t i = 0; i < points.size(); ++i) {
+            if (!was_within[i] && within(d1, points[i])) {
+                entering.push_back(points[i]);
+            }
+        }
+        d1.addPointsToMap(entering);
+
+        DistanceMap d2(
+                d1.originX(), d1.originY(), d1.originZ(),
+                size_x, size_y, size_z,
+                res, max_dist);
+        d2.addPointsToMap(points_within(d2));
+
+        if (d1 != d2) {
+            printf("Shifted distance map differs from constructed distance map\n");
+        }
+    }
+}
+
+template <class DistanceMap>
+void TestDistancePyramid()
+{
+    DistanceMap d(0.0, 0.0, 0.0, 2.0, 2.0, 1.0, 0.05, 0.4);
+
+    std::vector<Eigen::Vector3d> points;
+    std::default_random_engine rng;
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+    for (int i = 0; i < 100; ++i) {
+        points.emplace_back(2.0 * dist(rng), 2.0 * dist(rng), dist(rng));
+    }
+
+    smpl::DistancePyramid pyramid;
+    pyramid.rebuild(d);
+
+    // add and remove obstacles in batches, comparing the incrementally updated
+    // pyramid against one built from scratch. Every third batch removes the
+    // obstacles added by the batch before it.
+    for (int i = 0; i < 10; ++i) {
+        std::vector<Eigen::Vector3d> batch;
+        if (i % 3 == 2) {
+            batch.assign(points.begin() + 10 * (i - 1), points.begin() + 10 * i);
+            d.removePointsFromMap(batch);
+        } else {
+            batch.assign(points.begin() + 10 * i, points.begin() + 10 * (i + 1));
+            d.addPointsToMap(batch);
+        }
+        pyramid.update(d, batch);
+
+        smpl::DistancePyramid expected;
+        expected.rebuild(d);
+
+        const double res = d.resolution();
+        for (int x = 0; x < d.numCellsX(); ++x) {
+        for (int y = 0; y < d.numCellsY(); ++y) {
+        for (int z = 0; z < d.numCellsZ(); ++z) {
+            // largest tested radius the pyramid considers clear
+            double clear_r = -1.0;
+            for (double r = 0.0; r <= 0.4; r += 0.05) {
+                if (pyramid.isClear(x, y, z, r) != expected.isClear(x, y, z, r)) {
+                    printf("Updated distance pyramid differs from rebuilt distance pyramid\n");
+                    return;
+                }
+                if (pyramid.isClear(x, y, z, r)) {
+                    clear_r = r;
+                }
+            }
+            if (clear_r < 0.0) {
+                continue;
+            }
+
+            // the bound must hold for the metric distance of any point within
+            // the cell, not only the distance of the cell center
+            double wx, wy, wz;
+            d.gridToWorld(x, y, z, wx, wy, wz);
+            for (int corner = 0; corner < 9; ++corner) {
+                const double off = corner == 8 ? 0.0 : 0.45 * res;
+                const double px = wx + ((corner & 1) ? off : -off);
+                const double py = wy + ((corner & 2) ? off : -off);
+                const double pz = wz + ((corner & 4) ? off : -off);
+                if (d.getMetricSquaredDistance(px, py, pz) < clear_r * clear_r) {
+                    printf("Distance pyramid overestimates distance at (%d, %d, %d)\n", x, y, z);
+                    return;
+                }
+            }
+        }
+        }
+        }
+    }
+}
+
 int main(int argc, char* argv[])
 {
     TestSpecialMemberFunctions<smpl::SparseDistanceMap>();
+    TestSpecialMemberFunctions<smpl::HashedDistanceMap>();
+    TestMatchesSparseDistanceMap<smpl::HashedDistanceMap>();
+    TestShiftOrigin<smpl::HashedDistanceMap>();
+    TestDistancePyramid<smpl::SparseDistanceMap>();
+    TestDistancePyramid<smpl::HashedDistanceMap>();
 //    TestSpecialMemberFunctions<smpl::EuclidDistanceMap>();
     return 0;
 }
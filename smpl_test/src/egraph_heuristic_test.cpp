@@ -0,0 +1,336 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2018, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#define BOOST_TEST_MODULE ExperienceGraphHeuristicTest
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <smpl/collision_checker.h>
+#include <smpl/occupancy_grid.h>
+#include <smpl/robot_model.h>
+#include <smpl/graph/experience_graph.h>
+#include <smpl/graph/experience_graph_extension.h>
+#include <smpl/graph/experience_graph_tables.h>
+#include <smpl/graph/robot_planning_space.h>
+#include <smpl/heuristic/egraph_bfs_heuristic.h>
+
+struct PointRobotModel : public smpl::RobotModel
+{
+    double minPosLimit(int jidx) const override { return 0.0; }
+    double maxPosLimit(int jidx) const override { return 0.0; }
+    bool hasPosLimit(int jidx) const override { return false; }
+    bool isContinuous(int jidx) const override { return false; }
+    double velLimit(int jidx) const override { return 0.0; }
+    double accLimit(int jidx) const override { return 0.0; }
+    bool checkJointLimits(const smpl::RobotState&, bool) override { return true; }
+    Extension* getExtension(size_t class_code) override { return nullptr; }
+};
+
+struct NullCollisionChecker : public smpl::CollisionChecker
+{
+    bool isStateValid(const smpl::RobotState&, bool) override { return true; }
+
+    bool isStateToStateValid(
+        const smpl::RobotState&,
+        const smpl::RobotState&,
+        bool) override
+    {
+        return true;
+    }
+
+    bool interpolatePath(
+        const smpl::RobotState&,
+        const smpl::RobotState&,
+        std::vector<smpl::RobotState>&) override
+    {
+        return false;
+    }
+
+    Extension* getExtension(size_t class_code) override { return nullptr; }
+};
+
+// A planning space whose states are the cells of a grid, each projecting to
+// the center of its cell, with an experience graph over some of the cells.
+class CellSpace :
+    public smpl::RobotPlanningSpace,
+    public smpl::PointProjectionExtension,
+    public smpl::ExperienceGraphExtension
+{
+public:
+
+    explicit CellSpace(const smpl::OccupancyGrid* grid) : m_grid(grid) { }
+
+    int cellID(int x, int y, int z) const
+    {
+        return (x * m_grid->numCellsY() + y) * m_grid->numCellsZ() + z;
+    }
+
+    int cellCount() const
+    {
+        return m_grid->numCellsX() * m_grid->numCellsY() * m_grid->numCellsZ();
+    }
+
+    // experience graph nodes are stored as the ids of their cells
+    smpl::ExperienceGraph& egraph() { return m_egraph; }
+
+    bool projectToPoint(int state_id, smpl::Vector3& pos) override
+    {
+        int z = state_id % m_grid->numCellsZ();
+        int y = state_id / m_grid->numCellsZ() % m_grid->numCellsY();
+        int x = state_id / m_grid->numCellsZ() / m_grid->numCellsY();
+        m_grid->gridToWorld(x, y, z, pos.x(), pos.y(), pos.z());
+        return true;
+    }
+
+    bool loadExperienceGraph(const std::string& path) override { return false; }
+
+    void getExperienceGraphNodes(
+        int state_id,
+        std::vector<smpl::ExperienceGraph::node_id>& nodes) override
+    { }
+
+    bool shortcut(int first_id, int second_id, int& cost) override { return false; }
+    bool snap(int first_id, int second_id, int& cost) override { return false; }
+
+    auto getExperienceGraph() const -> const smpl::ExperienceGraph* override { return &m_egraph; }
+    auto getExperienceGraph() -> smpl::ExperienceGraph* override { return &m_egraph; }
+
+    int getStateID(smpl::ExperienceGraph::node_id n) const override
+    {
+        return (int)m_egraph.state(n)[0];
+    }
+
+    int getStartStateID() const override { return 0; }
+    int getGoalStateID() const override { return -1; }
+
+    bool extractPath(const std::vector<int>&, std::vector<smpl::RobotState>&) override
+    {
+        return false;
+    }
+
+    void GetSuccs(int, std::vector<int>*, std::vector<int>*) override { }
+    void GetPreds(int, std::vector<int>*, std::vector<int>*) override { }
+    void PrintState(int, bool, FILE*) override { }
+
+    Extension* getExtension(size_t class_code) override
+    {
+        if (class_code == smpl::GetClassCode<smpl::RobotPlanningSpace>() ||
+            class_code == smpl::GetClassCode<smpl::PointProjectionExtension>() ||
+            class_code == smpl::GetClassCode<smpl::ExperienceGraphExtension>())
+        {
+            return this;
+        }
+        return nullptr;
+    }
+
+private:
+
+    const smpl::OccupancyGrid* m_grid;
+    smpl::ExperienceGraph m_egraph;
+};
+
+// The distances computed up front by the parallel search must match the
+// distances computed lazily by the serial search, for every cell.
+BOOST_AUTO_TEST_CASE(ParallelDistancesMatchSerialTest)
+{
+    const double res = 0.1;
+    smpl::OccupancyGrid grid(2.0, 1.6, 1.2, res, 0.0, 0.0, 0.0, 0.3);
+
+    // a wall across x = 1 with a gap at high y
+    std::vector<smpl::Vector3> points;
+    for (double y = 0.0; y < 1.2; y += res) {
+        for (double z = 0.0; z < 1.2; z += res) {
+            points.emplace_back(1.0, y, z);
+        }
+    }
+    grid.addPointsToField(points);
+
+    PointRobotModel robot;
+    NullCollisionChecker checker;
+    CellSpace space(&grid);
+    BOOST_REQUIRE(space.init(&robot, &checker));
+
+    // an experience graph path around the wall, through free cells
+    auto& eg = space.egraph();
+    const int path[][3] = {
+        { 2, 2, 2 }, { 5, 9, 4 }, { 9, 14, 6 }, { 11, 14, 6 }, { 15, 9, 4 }, { 18, 2, 2 }
+    };
+    smpl::ExperienceGraph::node_id prev = 0;
+    for (size_t i = 0; i < sizeof(path) / sizeof(path[0]); ++i) {
+        BOOST_REQUIRE(grid.getDistance(path[i][0], path[i][1], path[i][2]) > 0.0);
+        smpl::RobotState state(1, (double)space.cellID(path[i][0], path[i][1], path[i][2]));
+        auto n = eg.insert_node(state);
+        if (i > 0) {
+            eg.insert_edge(prev, n);
+        }
+        prev = n;
+    }
+
+    smpl::GoalConstraint goal;
+    goal.type = smpl::GoalType::XYZ_GOAL;
+    goal.pose = smpl::Affine3::Identity();
+    grid.gridToWorld(18, 2, 2, goal.pose.translation().x(), goal.pose.translation().y(), goal.pose.translation().z());
+
+    smpl::DijkstraEgraphHeuristic3D serial;
+    BOOST_REQUIRE(serial.init(&space, &grid));
+    serial.setWeightEGraph(5.0);
+    serial.setThreadCount(1);
+    serial.updateGoal(goal);
+
+    smpl::DijkstraEgraphHeuristic3D parallel;
+    BOOST_REQUIRE(parallel.init(&space, &grid));
+    parallel.setWeightEGraph(5.0);
+    parallel.setThreadCount(3);
+    parallel.updateGoal(goal);
+
+    int mismatch_count = 0;
+    for (int id = 0; id < space.cellCount(); ++id) {
+        if (serial.GetGoalHeuristic(id) != parallel.GetGoalHeuristic(id)) {
+            ++mismatch_count;
+        }
+    }
+    BOOST_CHECK_EQUAL(mismatch_count, 0);
+
+    // the path through the experience graph is cheaper than the path around
+    // the wall through free space
+    int start_id = space.cellID(path[0][0], path[0][1], path[0][2]);
+    BOOST_CHECK(serial.GetGoalHeuristic(start_id) < 5 * 1000 * 16);
+}
+
+// Number the connected components of an experience graph by depth-first
+// search from the lowest unlabeled node, as the experience graph heuristics
+// did before the tables were shared.
+static int ComputeComponentsDFS(
+    const smpl::ExperienceGraph& eg,
+    std::vector<int>& component_ids)
+{
+    int comp_count = 0;
+    component_ids.assign(eg.num_nodes(), -1);
+    auto nodes = eg.nodes();
+    for (auto nit = nodes.first; nit != nodes.second; ++nit) {
+        if (component_ids[*nit] != -1) {
+            continue;
+        }
+
+        std::vector<smpl::ExperienceGraph::node_id> frontier;
+        frontier.push_back(*nit);
+        while (!frontier.empty()) {
+            auto n = frontier.back();
+            frontier.pop_back();
+
+            component_ids[n] = comp_count;
+
+            auto adj = eg.adjacent_nodes(n);
+            for (auto ait = adj.first; ait != adj.second; ++ait) {
+                if (component_ids[*ait] == -1) {
+                    frontier.push_back(*ait);
+                }
+            }
+        }
+
+        ++comp_count;
+    }
+    return comp_count;
+}
+
+static void InsertRandomEdges(
+    smpl::ExperienceGraph& eg,
+    size_t edge_count,
+    std::mt19937& rng)
+{
+    std::uniform_int_distribution<size_t> node(0, eg.num_nodes() - 1);
+    for (size_t i = 0; i < edge_count; ++i) {
+        eg.insert_edge(node(rng), node(rng));
+    }
+}
+
+// The union-find components must be numbered exactly as the depth-first
+// search numbered them, both for graphs small enough to be unioned on the
+// calling thread and for graphs whose edges are split across threads.
+BOOST_AUTO_TEST_CASE(ConnectedComponentsMatchDFSTest)
+{
+    std::mt19937 rng(5);
+    const size_t sizes[][2] = { { 100, 60 }, { 2000, 1500 }, { 60000, 50000 } };
+    for (auto& size : sizes) {
+        smpl::ExperienceGraph eg;
+        for (size_t i = 0; i < size[0]; ++i) {
+            eg.insert_node(smpl::RobotState(1, (double)i));
+        }
+        InsertRandomEdges(eg, size[1], rng);
+
+        std::vector<int> expected_ids;
+        int expected_count = ComputeComponentsDFS(eg, expected_ids);
+
+        std::vector<int> component_ids;
+        int component_count = smpl::ComputeConnectedComponents(eg, component_ids);
+
+        BOOST_CHECK_EQUAL(component_count, expected_count);
+        BOOST_CHECK(component_ids == expected_ids);
+        BOOST_CHECK(component_count > 1);
+    }
+}
+
+// The tables are rebuilt when, and only when, the graph changes.
+BOOST_AUTO_TEST_CASE(TablesUpdateOnGraphChangeTest)
+{
+    smpl::ExperienceGraph eg;
+    for (int i = 0; i < 4; ++i) {
+        eg.insert_node(smpl::RobotState(1, (double)i));
+    }
+    eg.insert_edge(0, 1);
+    eg.insert_edge(2, 3);
+
+    smpl::ExperienceGraphTables tables;
+    smpl::UpdateExperienceGraphTables(eg, tables);
+    BOOST_CHECK_EQUAL(tables.component_count, 2);
+    BOOST_CHECK(tables.component_ids == std::vector<int>({ 0, 0, 1, 1 }));
+
+    // an unchanged graph leaves the tables alone
+    tables.component_count = -1;
+    smpl::UpdateExperienceGraphTables(eg, tables);
+    BOOST_CHECK_EQUAL(tables.component_count, -1);
+
+    eg.insert_edge(1, 2);
+    smpl::UpdateExperienceGraphTables(eg, tables);
+    BOOST_CHECK_EQUAL(tables.component_count, 1);
+    BOOST_CHECK(tables.component_ids == std::vector<int>({ 0, 0, 0, 0 }));
+
+    // tables built from one graph are not reused for another
+    smpl::ExperienceGraph other;
+    other.insert_node(smpl::RobotState(1, 0.0));
+    smpl::UpdateExperienceGraphTables(other, tables);
+    BOOST_CHECK_EQUAL(tables.component_count, 1);
+    BOOST_CHECK(tables.component_ids == std::vector<int>({ 0 }));
+}
@@ -41,6 +41,7 @@
 #include <boost/test/unit_test.hpp>
 #include <boost/container/stable_vector.hpp>
 
+#include <smpl/heap/index_heap.h>
 #include <smpl/heap/intrusive_heap.h>
 
 #define LOGDEBUG 0
@@ -723,3 +724,207 @@ BOOST_AUTO_TEST_CASE(PushEraseTest)
         }
     }
 }
+
+struct index_position
+{
+    std::vector<std::uint32_t>* positions;
+
+    std::uint32_t& operator()(int i) const { return (*positions)[i]; }
+};
+
+typedef smpl::index_heap<int, index_position> index_heap_type;
+
+// Pop every element from the heap and check that they come out in order of
+// increasing key, with their positions reset.
+static void CheckIndexHeapOrder(
+    index_heap_type& h,
+    const std::vector<int>& keys,
+    const std::vector<std::uint32_t>& positions,
+    size_t expected_count)
+{
+    size_t count = 0;
+    int prev = std::numeric_limits<int>::min();
+    while (!h.empty()) {
+        int e = h.min();
+        BOOST_CHECK_EQUAL(h.min_key(), keys[e]);
+        BOOST_CHECK(keys[e] >= prev);
+        prev = keys[e];
+        h.pop();
+        BOOST_CHECK(!h.contains(e));
+        BOOST_CHECK_EQUAL(positions[e], 0);
+        ++count;
+    }
+    BOOST_CHECK_EQUAL(count, expected_count);
+}
+
+BOOST_AUTO_TEST_CASE(IndexHeapPushPopTest)
+{
+    std::vector<int> keys = { 8, 10, 4, 2, 12 };
+    std::vector<std::uint32_t> positions(keys.size(), 0);
+    index_heap_type h(index_position{ &positions });
+    BOOST_CHECK(h.empty());
+
+    h.push(0, keys[0]);
+    BOOST_CHECK_EQUAL(h.size(), 1);
+    BOOST_CHECK_EQUAL(h.min(), 0);
+
+    h.push(1, keys[1]);
+    BOOST_CHECK_EQUAL(h.min(), 0);
+
+    h.push(2, keys[2]);
+    BOOST_CHECK_EQUAL(h.min(), 2);
+
+    h.push(3, keys[3]);
+    BOOST_CHECK_EQUAL(h.min(), 3);
+
+    h.push(4, keys[4]);
+    BOOST_CHECK_EQUAL(h.min(), 3);
+    BOOST_CHECK_EQUAL(h.size(), 5);
+
+    for (int i = 0; i < 5; ++i) {
+        BOOST_CHECK(h.contains(i));
+    }
+
+    int order[] = { 3, 2, 0, 1, 4 };
+    for (int e : order) {
+        BOOST_CHECK_EQUAL(h.min(), e);
+        h.pop();
+        BOOST_CHECK(!h.contains(e));
+    }
+    BOOST_CHECK(h.empty());
+}
+
+BOOST_AUTO_TEST_CASE(IndexHeapDecreaseTest)
+{
+    std::vector<int> keys = { 8, 10, 4, 2, 12 };
+    std::vector<std::uint32_t> positions(keys.size(), 0);
+    index_heap_type h(index_position{ &positions });
+    for (int i = 0; i < (int)keys.size(); ++i) {
+        h.push(i, keys[i]);
+    }
+
+    keys[4] = 1;
+    h.decrease(4, keys[4]);
+    BOOST_CHECK_EQUAL(h.min(), 4);
+
+    keys[1] = 3;
+    h.decrease(1, keys[1]);
+    BOOST_CHECK_EQUAL(h.min(), 4);
+
+    CheckIndexHeapOrder(h, keys, positions, keys.size());
+}
+
+BOOST_AUTO_TEST_CASE(IndexHeapEraseTest)
+{
+    // Pushed in this order, the keys form the heap
+    //
+    //           1
+    //       10      2
+    //     11  12  3   4
+    //
+    // Erasing 11 moves 4 below 10, so the heap is only restored if 4
+    // percolates up.
+    std::vector<int> keys = { 1, 10, 2, 11, 12, 3, 4 };
+    std::vector<std::uint32_t> positions(keys.size(), 0);
+    index_heap_type h(index_position{ &positions });
+    for (int i = 0; i < (int)keys.size(); ++i) {
+        h.push(i, keys[i]);
+    }
+
+    h.erase(3);
+    BOOST_CHECK(!h.contains(3));
+    BOOST_CHECK_EQUAL(positions[3], 0);
+    BOOST_CHECK_EQUAL(h.size(), 6);
+
+    // erasing the last element in the heap
+    h.erase(6);
+    BOOST_CHECK(!h.contains(6));
+    BOOST_CHECK_EQUAL(h.size(), 5);
+
+    h.push(6, keys[6]);
+    CheckIndexHeapOrder(h, keys, positions, 6);
+}
+
+BOOST_AUTO_TEST_CASE(IndexHeapMakeTest)
+{
+    std::vector<int> keys = { 8, 10, 4, 2, 12, 6, 3, 7 };
+    std::vector<std::uint32_t> positions(keys.size(), 0);
+    index_heap_type h(index_position{ &positions });
+    for (int i = 0; i < (int)keys.size(); ++i) {
+        h.push(i, keys[i]);
+    }
+
+    // reverse the order of the keys and rebuild the heap
+    for (auto& e : h) {
+        keys[e.index] = -keys[e.index];
+        e.key = keys[e.index];
+    }
+    h.make();
+
+    for (auto& e : h) {
+        BOOST_CHECK_EQUAL(positions[e.index], (std::uint32_t)(&e - &*h.begin() + 1));
+    }
+
+    BOOST_CHECK_EQUAL(h.min(), 4);
+    CheckIndexHeapOrder(h, keys, positions, keys.size());
+}
+
+BOOST_AUTO_TEST_CASE(IndexHeapClearTest)
+{
+    std::vector<int> keys = { 8, 10, 4, 2, 12 };
+    std::vector<std::uint32_t> positions(keys.size(), 0);
+    index_heap_type h(index_position{ &positions });
+    for (int i = 0; i < (int)keys.size(); ++i) {
+        h.push(i, keys[i]);
+    }
+
+    h.clear();
+    BOOST_CHECK(h.empty());
+    BOOST_CHECK_EQUAL(h.size(), 0);
+    for (int i = 0; i < (int)keys.size(); ++i) {
+        BOOST_CHECK(!h.contains(i));
+        BOOST_CHECK_EQUAL(positions[i], 0);
+    }
+
+    // elements may be pushed again after the heap is cleared
+    h.push(1, keys[1]);
+    h.push(3, keys[3]);
+    BOOST_CHECK_EQUAL(h.min(), 3);
+    CheckIndexHeapOrder(h, keys, positions, 2);
+}
+
+BOOST_AUTO_TEST_CASE(IndexHeapPushEraseTest)
+{
+    // Test a variety of interleaved pushes and erases
+
+    std::vector<int> keys = { 8, 10, 4, 2, 12, 6, 3, 6, 10, 1, 5, 9 };
+    std::vector<std::uint32_t> positions(keys.size(), 0);
+    index_heap_type h(index_position{ &positions });
+    std::vector<bool> inheap(keys.size(), false);
+
+    std::default_random_engine rng;
+    std::uniform_int_distribution<int> dist(0, keys.size() - 1);
+
+    int num_trials = 1000;
+    for (int i = 0; i < num_trials; ++i) {
+        int r = dist(rng);
+        if (inheap[r]) {
+            h.erase(r);
+        } else {
+            h.push(r, keys[r]);
+        }
+        inheap[r] = !inheap[r];
+
+        int min_key = std::numeric_limits<int>::max();
+        for (size_t ei = 0; ei < keys.size(); ++ei) {
+            BOOST_CHECK_EQUAL(h.contains(ei), inheap[ei]);
+            if (inheap[ei]) {
+                min_key = std::min(min_key, keys[ei]);
+            }
+        }
+
+        if (!h.empty()) {
+            BOOST_CHECK_EQUAL(h.min_key(), min_key);
+        }
+    }
+}
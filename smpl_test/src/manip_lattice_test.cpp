@@ -0,0 +1,343 @@
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#define BOOST_TEST_MODULE ManipLatticeTest
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <smpl/collision_checker.h>
+#include <smpl/occupancy_grid.h>
+#include <smpl/distance_map/euclid_distance_map.h>
+#include <smpl/distance_map/hashed_distance_map.h>
+#include <smpl/graph/goal_constraint.h>
+#include <smpl/graph/manip_lattice.h>
+#include <smpl/graph/manip_lattice_action_space.h>
+#include <smpl/heuristic/bfs_heuristic.h>
+#include <smpl/heuristic/joint_dist_heuristic.h>
+#include <smpl/heuristic/zero_heuristic.h>
+#include <smpl/robot_model.h>
+
+// An (x, y) point robot within [0, 10] x [0, 10], whose planning link lies
+// in the plane z = 0.5
+class PointRobotModel : public smpl::ForwardKinematicsInterface
+{
+public:
+
+    PointRobotModel()
+    {
+        setPlanningJoints({ "x", "y" });
+    }
+
+    double minPosLimit(int jidx) const override { return 0.0; }
+    double maxPosLimit(int jidx) const override { return 10.0; }
+    bool hasPosLimit(int jidx) const override { return true; }
+    bool isContinuous(int jidx) const override { return false; }
+    double velLimit(int jidx) const override { return 0.0; }
+    double accLimit(int jidx) const override { return 0.0; }
+
+    bool checkJointLimits(const smpl::RobotState& state, bool verbose) override
+    {
+        return state[0] >= 0.0 && state[0] <= 10.0 &&
+                state[1] >= 0.0 && state[1] <= 10.0;
+    }
+
+    auto computeFK(const smpl::RobotState& state) -> smpl::Affine3 override
+    {
+        return smpl::Affine3(smpl::Translation3(state[0], state[1], 0.5));
+    }
+
+    Extension* getExtension(size_t class_code) override
+    {
+        if (class_code == smpl::GetClassCode<smpl::RobotModel>() ||
+            class_code == smpl::GetClassCode<smpl::ForwardKinematicsInterface>())
+        {
+            return this;
+        }
+        return nullptr;
+    }
+};
+
+// Collision checker for a point robot among circular obstacles
+class CircleCollisionChecker : public smpl::CollisionChecker
+{
+public:
+
+    std::vector<std::pair<Eigen::Vector2d, double>> obstacles;
+
+    Extension* getExtension(size_t class_code) override
+    {
+        if (class_code == smpl::GetClassCode<smpl::CollisionChecker>()) {
+            return this;
+        }
+        return nullptr;
+    }
+
+    bool isStateValid(const smpl::RobotState& state, bool verbose) override
+    {
+        Eigen::Vector2d p(state[0], state[1]);
+        for (auto& obstacle : obstacles) {
+            if ((p - obstacle.first).norm() <= obstacle.second) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool isStateToStateValid(
+        const smpl::RobotState& start,
+        const smpl::RobotState& finish,
+        bool verbose) override
+    {
+        std::vector<smpl::RobotState> path;
+        interpolatePath(start, finish, path);
+        for (auto& state : path) {
+            if (!isStateValid(state, verbose)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool interpolatePath(
+        const smpl::RobotState& start,
+        const smpl::RobotState& finish,
+        std::vector<smpl::RobotState>& path) override
+    {
+        for (int i = 0; i <= 10; ++i) {
+            double alpha = 0.1 * i;
+            path.push_back({
+                    (1.0 - alpha) * start[0] + alpha * finish[0],
+                    (1.0 - alpha) * start[1] + alpha * finish[1] });
+        }
+        return true;
+    }
+};
+
+struct PointLattice
+{
+    smpl::ManipLattice space;
+    smpl::ManipLatticeActionSpace actions;
+
+    PointLattice(PointRobotModel* robot, CircleCollisionChecker* checker)
+    {
+        BOOST_REQUIRE(space.init(robot, checker, { 0.25, 0.25 }, &actions));
+        BOOST_REQUIRE(actions.init(&space));
+        actions.addMotionPrim({ 0.25, 0.0 }, false);
+        actions.addMotionPrim({ 0.0, 0.25 }, false);
+        actions.addMotionPrim({ 0.25, 0.25 }, false);
+        actions.addMotionPrim({ 0.25, -0.25 }, false);
+        actions.addMotionPrim({ 1.0, 0.5 }, false);
+        actions.addMotionPrim({ 0.5, -1.0 }, false);
+
+        BOOST_REQUIRE(space.setStart({ 1.0, 1.0 }));
+
+        smpl::GoalConstraint goal;
+        goal.type = smpl::GoalType::JOINT_STATE_GOAL;
+        goal.angles = { 9.0, 9.0 };
+        goal.angle_tolerances = { 0.1, 0.1 };
+        BOOST_REQUIRE(space.setGoal(goal));
+    }
+};
+
+// GetTrueCost must return the same costs whether the actions of a lazy edge
+// are remembered, evicted, or never cached, including when edges are recorded
+// again by repeated expansions and consumed out of order.
+BOOST_AUTO_TEST_CASE(LazyActionCacheTest)
+{
+    PointRobotModel robot;
+    CircleCollisionChecker checker;
+    checker.obstacles.emplace_back(Eigen::Vector2d(2.0, 2.0), 0.6);
+    checker.obstacles.emplace_back(Eigen::Vector2d(3.0, 1.0), 0.4);
+    checker.obstacles.emplace_back(Eigen::Vector2d(1.5, 3.5), 0.5);
+
+    PointLattice cached(&robot, &checker);
+    PointLattice evicting(&robot, &checker);
+    PointLattice uncached(&robot, &checker);
+    evicting.space.setLazyActionCacheCapacity(3);
+    uncached.space.setLazyActionCacheCapacity(0);
+
+    PointLattice* lattices[] = { &cached, &evicting, &uncached };
+
+    // expand breadth-first from the start, expanding each state twice, and
+    // evaluate the edges of each expansion in reverse order. The lattices
+    // generate states in the same order, so state ids agree between them.
+    int start_id = cached.space.getStartStateID();
+    std::vector<int> frontier = { start_id };
+    std::vector<bool> expanded(start_id + 1, false);
+    expanded[start_id] = true;
+    int evaluated = 0;
+    int invalid = 0;
+    for (size_t i = 0; i < frontier.size() && i < 60; ++i) {
+        int state_id = frontier[i];
+
+        std::vector<int> succs[3];
+        for (int l = 0; l < 3; ++l) {
+            std::vector<int> costs;
+            std::vector<bool> true_costs;
+            lattices[l]->space.GetLazySuccs(state_id, &succs[l], &costs, &true_costs);
+            succs[l].clear();
+            lattices[l]->space.GetLazySuccs(state_id, &succs[l], &costs, &true_costs);
+            BOOST_REQUIRE(succs[l] == succs[0]);
+        }
+
+        for (auto it = succs[0].rbegin(); it != succs[0].rend(); ++it) {
+            int cost = cached.space.GetTrueCost(state_id, *it);
+            BOOST_CHECK_EQUAL(evicting.space.GetTrueCost(state_id, *it), cost);
+            BOOST_CHECK_EQUAL(uncached.space.GetTrueCost(state_id, *it), cost);
+            ++evaluated;
+            if (cost < 0) {
+                ++invalid;
+                continue;
+            }
+            if ((int)expanded.size() <= *it) {
+                expanded.resize(*it + 1, false);
+            }
+            if (!expanded[*it]) {
+                expanded[*it] = true;
+                frontier.push_back(*it);
+            }
+        }
+    }
+
+    BOOST_CHECK(evaluated > 0);
+    BOOST_CHECK(invalid > 0);
+}
+
+// Batched goal heuristics must match the per-state goal heuristics.
+BOOST_AUTO_TEST_CASE(GoalHeuristicsBatchTest)
+{
+    PointRobotModel robot;
+    CircleCollisionChecker checker;
+    checker.obstacles.emplace_back(Eigen::Vector2d(5.0, 5.0), 1.5);
+
+    smpl::ManipLattice space;
+    smpl::ManipLatticeActionSpace actions;
+    BOOST_REQUIRE(space.init(&robot, &checker, { 0.25, 0.25 }, &actions));
+    BOOST_REQUIRE(actions.init(&space));
+    actions.addMotionPrim({ 0.25, 0.0 }, false);
+    actions.addMotionPrim({ 0.0, 0.25 }, false);
+    actions.addMotionPrim({ 0.25, 0.25 }, false);
+    actions.addMotionPrim({ 0.25, -0.25 }, false);
+
+    // a wall the BFS must go around
+    smpl::OccupancyGrid grid(std::make_shared<smpl::EuclidDistanceMap>(
+            0.0, 0.0, -1.0, 10.0, 10.0, 3.0, 0.25, 1.0));
+    std::vector<Eigen::Vector3d> wall;
+    for (double y = 0.0; y < 7.0; y += 0.125) {
+        wall.emplace_back(6.0, y, 0.5);
+    }
+    grid.addPointsToField(wall);
+
+    smpl::ZeroHeuristic zero;
+    smpl::JointDistHeuristic joint_dist;
+    smpl::BfsHeuristic bfs;
+    BOOST_REQUIRE(zero.init(&space));
+    BOOST_REQUIRE(joint_dist.init(&space));
+    BOOST_REQUIRE(bfs.init(&space, &grid));
+    smpl::RobotHeuristic* heuristics[] = { &zero, &joint_dist, &bfs };
+    for (auto* h : heuristics) {
+        BOOST_REQUIRE(space.insertHeuristic(h));
+    }
+
+    BOOST_REQUIRE(space.setStart({ 1.0, 1.0 }));
+
+    smpl::GoalConstraint goal;
+    goal.type = smpl::GoalType::JOINT_STATE_GOAL;
+    goal.angles = { 9.0, 1.0 };
+    goal.angle_tolerances = { 0.1, 0.1 };
+    goal.pose = smpl::Affine3(smpl::Translation3(9.0, 1.0, 0.5));
+    BOOST_REQUIRE(space.setGoal(goal));
+    for (auto* h : heuristics) {
+        h->updateGoal(goal);
+    }
+
+    // create states breadth-first from the start
+    std::vector<int> state_ids = {
+        space.getStartStateID(), space.getGoalStateID()
+    };
+    for (size_t i = 0; i < state_ids.size() && state_ids.size() < 500; ++i) {
+        std::vector<int> succs, costs;
+        space.GetSuccs(state_ids[i], &succs, &costs);
+        for (int succ_id : succs) {
+            if (std::find(state_ids.begin(), state_ids.end(), succ_id) == state_ids.end()) {
+                state_ids.push_back(succ_id);
+            }
+        }
+    }
+    BOOST_REQUIRE(state_ids.size() >= 500);
+
+    for (auto* h : heuristics) {
+        std::vector<int> values(state_ids.size());
+        h->GetGoalHeuristics(state_ids.data(), state_ids.size(), values.data());
+        for (size_t i = 0; i < state_ids.size(); ++i) {
+            BOOST_CHECK_EQUAL(values[i], h->GetGoalHeuristic(state_ids[i]));
+        }
+    }
+
+    // the BFS heuristic is not trivially zero away from the goal
+    BOOST_CHECK(bfs.GetGoalHeuristic(space.getStartStateID()) > 0);
+}
+
+// After the grid moves, a new start must bring the BFS heuristic in line with
+// a BFS heuristic built on a grid created at the new origin.
+BOOST_AUTO_TEST_CASE(BfsResyncOnShiftTest)
+{
+    PointRobotModel robot;
+    CircleCollisionChecker checker;
+    PointLattice lattice(&robot, &checker);
+    auto& space = lattice.space;
+
+    auto make_grid = [](double origin_x) {
+        return smpl::OccupancyGrid(std::make_shared<smpl::HashedDistanceMap>(
+                origin_x, 0.0, -1.0, 10.0, 10.0, 3.0, 0.25, 1.0));
+    };
+
+    std::vector<Eigen::Vector3d> wall;
+    for (double y = 0.0; y < 7.0; y += 0.125) {
+        wall.emplace_back(6.0, y, 0.5);
+        wall.emplace_back(10.5, y + 3.0, 0.5);
+    }
+
+    auto grid = make_grid(0.0);
+    grid.addPointsToField(wall);
+
+    smpl::GoalConstraint goal;
+    goal.type = smpl::GoalType::JOINT_STATE_GOAL;
+    goal.angles = { 9.0, 1.0 };
+    goal.angle_tolerances = { 0.1, 0.1 };
+    goal.pose = smpl::Affine3(smpl::Translation3(9.0, 1.0, 0.5));
+
+    smpl::BfsHeuristic bfs;
+    BOOST_REQUIRE(bfs.init(&space, &grid));
+    bfs.updateGoal(goal);
+
+    // move the grid by 4 cells along x, bringing the second wall into it
+    BOOST_REQUIRE(grid.shiftOrigin(4, 0, 0));
+    grid.addPointsToField(wall);
+    bfs.updateStart({ 2.0, 1.0 });
+
+    auto fresh_grid = make_grid(1.0);
+    fresh_grid.addPointsToField(wall);
+    smpl::BfsHeuristic fresh;
+    BOOST_REQUIRE(fresh.init(&space, &fresh_grid));
+    fresh.updateGoal(goal);
+
+    std::vector<int> state_ids = { space.getStartStateID() };
+    for (size_t i = 0; i < state_ids.size() && state_ids.size() < 500; ++i) {
+        std::vector<int> succs, costs;
+        space.GetSuccs(state_ids[i], &succs, &costs);
+        for (int succ_id : succs) {
+            if (std::find(state_ids.begin(), state_ids.end(), succ_id) == state_ids.end()) {
+                state_ids.push_back(succ_id);
+            }
+        }
+    }
+    BOOST_REQUIRE(state_ids.size() >= 500);
+
+    for (int state_id : state_ids) {
+        BOOST_CHECK_EQUAL(bfs.GetGoalHeuristic(state_id), fresh.GetGoalHeuristic(state_id));
+    }
+}
@@ -0,0 +1,143 @@
+#include <atomic>
+#include <memory>
+#include <random>
+#include <vector>
+
+#define BOOST_TEST_MODULE OMPLBatchCheckTest
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <ompl/base/SpaceInformation.h>
+#include <ompl/base/StateValidityChecker.h>
+#include <ompl/base/spaces/RealVectorStateSpace.h>
+#include <smpl/collision_checker.h>
+#include <smpl_ompl_interface/ompl_interface.h>
+
+// States within a disk at the center of the unit square are invalid.
+class DiskValidityChecker : public ompl::base::StateValidityChecker
+{
+public:
+
+    DiskValidityChecker(const ompl::base::SpaceInformationPtr& si) :
+        ompl::base::StateValidityChecker(si)
+    { }
+
+    bool isValid(const ompl::base::State* state) const override
+    {
+        auto* s = state->as<ompl::base::RealVectorStateSpace::StateType>();
+        auto dx = s->values[0] - 0.5;
+        auto dy = s->values[1] - 0.5;
+        return dx * dx + dy * dy > 0.2 * 0.2;
+    }
+};
+
+struct DiskPlanner
+{
+    ompl::base::StateSpacePtr space;
+    ompl::base::SpaceInformationPtr si;
+    std::unique_ptr<smpl::OMPLPlanner> planner;
+    std::atomic<int> checker_count;
+
+    DiskPlanner(int num_threads) : checker_count(0)
+    {
+        auto real_space = std::make_shared<ompl::base::RealVectorStateSpace>(2);
+        real_space->setBounds(0.0, 1.0);
+        space = real_space;
+
+        si = std::make_shared<ompl::base::SpaceInformation>(space);
+        si->setStateValidityChecker(std::make_shared<DiskValidityChecker>(si));
+        si->setStateValidityCheckingResolution(0.01);
+        si->setup();
+
+        planner.reset(new smpl::OMPLPlanner(si));
+        planner->setStateValidityCheckerAllocator(
+                [this](const ompl::base::SpaceInformationPtr& si)
+                {
+                    ++checker_count;
+                    return std::make_shared<DiskValidityChecker>(si);
+                });
+        BOOST_REQUIRE(planner->params().setParam(
+                "num_threads", std::to_string(num_threads)));
+        planner->setup();
+    }
+
+    // Check a motion the way DiscreteMotionValidator does, using only
+    // per-state checks.
+    bool isMotionValid(const smpl::RobotState& start, const smpl::Action& motion)
+    {
+        auto* checker = planner->getCollisionChecker();
+        auto prev = smpl::MakeStateOMPL(space, start);
+        auto interm = smpl::MakeStateOMPL(space, start);
+        for (auto& waypoint : motion) {
+            if (!checker->isStateValid(waypoint)) {
+                return false;
+            }
+            auto curr = smpl::MakeStateOMPL(space, waypoint);
+            auto nd = space->validSegmentCount(prev.get(), curr.get());
+            for (auto j = 1u; j < nd; ++j) {
+                space->interpolate(
+                        prev.get(), curr.get(), (double)j / (double)nd, interm.get());
+                auto state = smpl::MakeStateSMPL(space.get(), interm.get());
+                if (!checker->isStateValid(state)) {
+                    return false;
+                }
+            }
+            prev = curr;
+        }
+        return true;
+    }
+};
+
+// Batch results must match per-state isStateValid results, whether the batch
+// is checked on the calling thread or by the collision checking threads.
+BOOST_AUTO_TEST_CASE(BatchMatchesStateChecksTest)
+{
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> coord(0.0, 1.0);
+    std::uniform_int_distribution<int> waypoint_count(1, 3);
+
+    for (int num_threads : { 1, 4 }) {
+        DiskPlanner p(num_threads);
+        BOOST_CHECK_EQUAL(p.checker_count.load(), num_threads > 1 ? num_threads : 0);
+
+        auto* batch = p.planner->getCollisionChecker()->
+                getExtension<smpl::BatchCollisionCheckExtension>();
+        BOOST_REQUIRE(batch != NULL);
+
+        int valid_count = 0;
+        int invalid_count = 0;
+        for (int b = 0; b < 20; ++b) {
+            smpl::RobotState start = { coord(rng), coord(rng) };
+
+            std::vector<smpl::Action> motions(50);
+            for (auto& motion : motions) {
+                auto n = waypoint_count(rng);
+                for (int i = 0; i < n; ++i) {
+                    motion.push_back({ coord(rng), coord(rng) });
+                }
+            }
+
+            std::vector<const smpl::Action*> motion_ptrs;
+            for (auto& motion : motions) {
+                motion_ptrs.push_back(&motion);
+            }
+
+            std::vector<bool> valid;
+            batch->isMotionBatchValid(start, motion_ptrs, valid);
+            BOOST_REQUIRE_EQUAL(valid.size(), motions.size());
+            for (size_t i = 0; i < motions.size(); ++i) {
+                auto expected = p.isMotionValid(start, motions[i]);
+                BOOST_CHECK_EQUAL(valid[i], expected);
+                if (expected) {
+                    ++valid_count;
+                } else {
+                    ++invalid_count;
+                }
+            }
+        }
+
+        // both outcomes are exercised
+        BOOST_CHECK(valid_count > 0);
+        BOOST_CHECK(invalid_count > 0);
+    }
+}
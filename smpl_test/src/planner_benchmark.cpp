@@ -0,0 +1,1067 @@
+/// \file planner_benchmark.cpp
+///
+/// Headless planning benchmark. Runs a fixed suite of start/goal queries
+/// through every configured combination of search, planning space, and
+/// heuristic and reports timing, throughput, memory, and solution cost
+/// statistics as JSON.
+///
+/// The benchmark intentionally avoids all ROS dependencies (no master, no
+/// parameter server, no message types). The robot is loaded from a URDF file
+/// via smpl_urdf_robot_model, collision spheres and the world grid dimensions
+/// are read from an sbpl_collision_checking collision model config, and the
+/// world is populated from the box obstacle (.env) files used by callPlanner.
+/// Build smpl with SMPL_CONSOLE_ROS=OFF for a binary that does not link
+/// roscpp at all.
+///
+/// Collision checking is performed by a minimal sphere-vs-distance-field
+/// checker defined here, so the numbers are comparable across machines without
+/// pulling in sbpl_collision_checking. Self-collisions are not checked.
+
+// standard includes
+#include <stdio.h>
+#include <sys/resource.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// system includes
+#include <boost/program_options.hpp>
+#include <sbpl/planners/planner.h>
+#include <smpl/collision_checker.h>
+#include <smpl/console/console.h>
+#include <smpl/graph/manip_lattice.h>
+#include <smpl/graph/manip_lattice_action_space.h>
+#include <smpl/heuristic/bfs_heuristic.h>
+#include <smpl/heuristic/euclid_dist_heuristic.h>
+#include <smpl/heuristic/joint_dist_heuristic.h>
+#include <smpl/occupancy_grid.h>
+#include <smpl/search/arastar.h>
+#include <smpl/search/awastar.h>
+#include <smpl/search/search_trace.h>
+#include <smpl/stl/memory.h>
+#include <smpl_urdf_robot_model/smpl_urdf_robot_model.h>
+#include <urdf_parser/urdf_parser.h>
+#include <yaml-cpp/yaml.h>
+
+namespace po = boost::program_options;
+
+struct CollisionSphere
+{
+    const smpl::urdf::Link* link;
+    Eigen::Vector3d center;
+    double radius;
+};
+
+struct BoxObstacle
+{
+    std::string id;
+    Eigen::Vector3d position;
+    Eigen::Vector3d size;
+};
+
+struct BenchmarkQuery
+{
+    std::string name;
+    smpl::RobotState start;
+    smpl::RobotState goal;
+};
+
+struct BenchmarkConfig
+{
+    // robot model
+    std::string group_name;
+    std::vector<std::string> planning_joints;
+    std::string chain_tip_link;
+    std::vector<std::pair<std::string, double>> reference_state;
+
+    // planning
+    std::unordered_map<std::string, double> discretization;
+    std::string mprim_filename;
+    bool use_short_dist_mprims = false;
+    double short_dist_mprims_thresh = 0.0;
+    double interpolation_resolution = 0.05;
+    double goal_angle_tolerance = 0.05;
+    double epsilon = 100.0;
+    double allowed_planning_time = 10.0;
+    double bfs_inflation_radius = 0.02;
+    int bfs_cost_per_cell = 100;
+
+    // combinations
+    std::vector<std::string> searches;
+    std::vector<std::string> spaces;
+    std::vector<std::string> heuristics;
+
+    std::vector<BenchmarkQuery> queries;
+};
+
+struct WorldConfig
+{
+    double size_x;
+    double size_y;
+    double size_z;
+    double origin_x;
+    double origin_y;
+    double origin_z;
+    double res_m;
+    double max_distance_m;
+};
+
+/// Sphere-based collision checker for the planning group, testing each sphere
+/// against the occupancy grid's distance field.
+class SphereCollisionChecker : public smpl::CollisionChecker
+{
+public:
+
+    SphereCollisionChecker(
+        smpl::urdf::URDFRobotModel* model,
+        const smpl::OccupancyGrid* grid,
+        std::vector<CollisionSphere> spheres,
+        double interpolation_resolution)
+    :
+        Extension(),
+        m_model(model),
+        m_grid(grid),
+        m_spheres(std::move(spheres)),
+        m_interp_res(interpolation_resolution)
+    {
+        InitRobotState(&m_state, model->robot_model);
+        SetVariablePositions(&m_state, GetVariablePositions(&model->robot_state));
+    }
+
+    auto checkCount() const -> std::size_t { return m_check_count; }
+    void resetCheckCount() { m_check_count = 0; }
+
+    /// \name Required Functions from Extension
+    ///@{
+    auto getExtension(size_t class_code) -> smpl::Extension* override
+    {
+        if (class_code == smpl::GetClassCode<smpl::CollisionChecker>()) {
+            return this;
+        }
+        return nullptr;
+    }
+    ///@}
+
+    /// \name Required Functions from CollisionChecker
+    ///@{
+    bool isStateValid(const smpl::RobotState& state, bool verbose) override;
+
+    bool isStateToStateValid(
+        const smpl::RobotState& start,
+        const smpl::RobotState& finish,
+        bool verbose) override;
+
+    bool interpolatePath(
+        const smpl::RobotState& start,
+        const smpl::RobotState& finish,
+        std::vector<smpl::RobotState>& path) override;
+    ///@}
+
+private:
+
+    smpl::urdf::URDFRobotModel* m_model;
+    const smpl::OccupancyGrid* m_grid;
+    std::vector<CollisionSphere> m_spheres;
+    double m_interp_res;
+
+    smpl::urdf::RobotState m_state;
+    std::size_t m_check_count = 0;
+};
+
+bool SphereCollisionChecker::isStateValid(
+    const smpl::RobotState& state,
+    bool verbose)
+{
+    ++m_check_count;
+
+    for (size_t i = 0; i < state.size(); ++i) {
+        SetVariablePosition(
+                &m_state, m_model->planning_to_state_variable[i], state[i]);
+    }
+
+    for (auto& sphere : m_spheres) {
+        auto* T_world_link = GetUpdatedLinkTransform(&m_state, sphere.link);
+        Eigen::Vector3d p = (*T_world_link) * sphere.center;
+        if (!m_grid->isInBounds(p.x(), p.y(), p.z())) {
+            continue;
+        }
+        if (m_grid->getDistanceFromPoint(p.x(), p.y(), p.z()) <= sphere.radius) {
+            if (verbose) {
+                SMPL_INFO("Sphere on link '%s' is in collision", sphere.link->name.c_str());
+            }
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool SphereCollisionChecker::isStateToStateValid(
+    const smpl::RobotState& start,
+    const smpl::RobotState& finish,
+    bool verbose)
+{
+    std::vector<smpl::RobotState> path;
+    if (!interpolatePath(start, finish, path)) {
+        return false;
+    }
+    for (auto& point : path) {
+        if (!isStateValid(point, verbose)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SphereCollisionChecker::interpolatePath(
+    const smpl::RobotState& start,
+    const smpl::RobotState& finish,
+    std::vector<smpl::RobotState>& path)
+{
+    auto max_diff = 0.0;
+    for (size_t i = 0; i < start.size(); ++i) {
+        max_diff = std::max(max_diff, std::fabs(finish[i] - start[i]));
+    }
+
+    auto num_waypoints = std::max(2, (int)std::ceil(max_diff / m_interp_res) + 1);
+    path.reserve(path.size() + num_waypoints);
+    for (int i = 0; i < num_waypoints; ++i) {
+        auto alpha = (double)i / (double)(num_waypoints - 1);
+        smpl::RobotState point(start.size());
+        for (size_t j = 0; j < start.size(); ++j) {
+            point[j] = (1.0 - alpha) * start[j] + alpha * finish[j];
+        }
+        path.push_back(std::move(point));
+    }
+    return true;
+}
+
+////////////
+// Config //
+////////////
+
+template <class T>
+static bool ReadParam(const YAML::Node& node, const char* key, T& value)
+{
+    auto param = node[key];
+    if (!param) {
+        return false;
+    }
+    value = param.as<T>();
+    return true;
+}
+
+static
+auto ParseMapFromString(const std::string& s)
+    -> std::unordered_map<std::string, double>
+{
+    std::unordered_map<std::string, double> map;
+    std::istringstream ss(s);
+    std::string key;
+    double value;
+    while (ss >> key >> value) {
+        map.insert(std::make_pair(key, value));
+    }
+    return map;
+}
+
+// Resolve a path relative to the directory containing another file.
+static
+auto ResolvePath(const std::string& relative_to, const std::string& path)
+    -> std::string
+{
+    if (path.empty() || path[0] == '/') {
+        return path;
+    }
+    auto slash = relative_to.find_last_of('/');
+    if (slash == std::string::npos) {
+        return path;
+    }
+    return relative_to.substr(0, slash + 1) + path;
+}
+
+static
+bool LoadBenchmarkConfig(const std::string& filename, BenchmarkConfig& config)
+{
+    YAML::Node root;
+    try {
+        root = YAML::LoadFile(filename);
+    } catch (const YAML::Exception& ex) {
+        SMPL_ERROR("Failed to load benchmark config '%s': %s", filename.c_str(), ex.what());
+        return false;
+    }
+
+    try {
+        auto robot_model = root["robot_model"];
+        if (!robot_model ||
+            !ReadParam(robot_model, "group_name", config.group_name) ||
+            !ReadParam(robot_model, "planning_joints", config.planning_joints) ||
+            !ReadParam(robot_model, "chain_tip_link", config.chain_tip_link))
+        {
+            SMPL_ERROR("Benchmark config requires robot_model/{group_name, planning_joints, chain_tip_link}");
+            return false;
+        }
+
+        for (auto entry : robot_model["reference_state"]) {
+            config.reference_state.emplace_back(
+                    entry.first.as<std::string>(), entry.second.as<double>());
+        }
+
+        auto planning = root["planning"];
+        std::string discretization;
+        if (!planning ||
+            !ReadParam(planning, "discretization", discretization) ||
+            !ReadParam(planning, "mprim_filename", config.mprim_filename))
+        {
+            SMPL_ERROR("Benchmark config requires planning/{discretization, mprim_filename}");
+            return false;
+        }
+        config.discretization = ParseMapFromString(discretization);
+        config.mprim_filename = ResolvePath(filename, config.mprim_filename);
+
+        ReadParam(planning, "use_short_dist_mprims", config.use_short_dist_mprims);
+        ReadParam(planning, "short_dist_mprims_thresh", config.short_dist_mprims_thresh);
+        ReadParam(planning, "interpolation_resolution", config.interpolation_resolution);
+        ReadParam(planning, "goal_angle_tolerance", config.goal_angle_tolerance);
+        ReadParam(planning, "epsilon", config.epsilon);
+        ReadParam(planning, "allowed_planning_time", config.allowed_planning_time);
+        ReadParam(planning, "bfs_inflation_radius", config.bfs_inflation_radius);
+        ReadParam(planning, "bfs_cost_per_cell", config.bfs_cost_per_cell);
+
+        auto combinations = root["combinations"];
+        if (!combinations ||
+            !ReadParam(combinations, "searches", config.searches) ||
+            !ReadParam(combinations, "spaces", config.spaces) ||
+            !ReadParam(combinations, "heuristics", config.heuristics))
+        {
+            SMPL_ERROR("Benchmark config requires combinations/{searches, spaces, heuristics}");
+            return false;
+        }
+
+        for (auto q : root["queries"]) {
+            BenchmarkQuery query;
+            query.name = q["name"].as<std::string>();
+            query.start = q["start"].as<std::vector<double>>();
+            query.goal = q["goal"].as<std::vector<double>>();
+            if (query.start.size() != config.planning_joints.size() ||
+                query.goal.size() != config.planning_joints.size())
+            {
+                SMPL_ERROR("Query '%s' does not match the number of planning joints", query.name.c_str());
+                return false;
+            }
+            config.queries.push_back(std::move(query));
+        }
+    } catch (const YAML::Exception& ex) {
+        SMPL_ERROR("Malformed benchmark config '%s': %s", filename.c_str(), ex.what());
+        return false;
+    }
+
+    return true;
+}
+
+// Gather the links of a collision group, including the links along each of its
+// chains and the links of each of its subgroups, as sbpl_collision_checking
+// does when it builds its collision groups.
+static
+bool ExpandCollisionGroup(
+    const YAML::Node& groups,
+    const smpl::urdf::RobotModel* model,
+    const std::string& group_name,
+    std::unordered_set<std::string>& expanding,
+    std::unordered_set<std::string>& links)
+{
+    if (!expanding.insert(group_name).second) {
+        SMPL_ERROR("Cycle in collision group config at group '%s'", group_name.c_str());
+        return false;
+    }
+
+    for (auto group : groups) {
+        if (group["name"].as<std::string>() != group_name) {
+            continue;
+        }
+
+        for (auto link : group["links"]) {
+            links.insert(link["name"].as<std::string>());
+        }
+
+        for (auto chain : group["chains"]) {
+            auto base = chain["base"].as<std::string>();
+            auto tip = chain["tip"].as<std::string>();
+
+            auto* link = GetLink(model, &tip);
+            if (link == NULL || GetLink(model, &base) == NULL) {
+                SMPL_WARN("Skipping chain (%s, %s) with unknown links", base.c_str(), tip.c_str());
+                continue;
+            }
+
+            // walk up from the tip to the base
+            links.insert(link->name);
+            while (link->name != base) {
+                if (link->parent == NULL) {
+                    SMPL_ERROR("(base: %s, tip: %s) is not a chain in the robot model", base.c_str(), tip.c_str());
+                    return false;
+                }
+                link = smpl::urdf::GetParentLink(link->parent);
+                links.insert(link->name);
+            }
+        }
+
+        for (auto subgroup : group["groups"]) {
+            if (!ExpandCollisionGroup(
+                    groups, model, subgroup.as<std::string>(), expanding, links))
+            {
+                return false;
+            }
+        }
+    }
+
+    expanding.erase(group_name);
+    return true;
+}
+
+// Read the world grid dimensions and the collision spheres of the planning
+// group's links from an sbpl_collision_checking collision model config.
+static
+bool LoadCollisionModelConfig(
+    const std::string& filename,
+    const smpl::urdf::RobotModel* model,
+    const std::string& group_name,
+    WorldConfig& world,
+    std::vector<CollisionSphere>& spheres)
+{
+    YAML::Node root;
+    try {
+        root = YAML::LoadFile(filename);
+    } catch (const YAML::Exception& ex) {
+        SMPL_ERROR("Failed to load collision model config '%s': %s", filename.c_str(), ex.what());
+        return false;
+    }
+
+    try {
+        auto wcm = root["world_collision_model"];
+        if (!wcm) {
+            SMPL_ERROR("Collision model config is missing 'world_collision_model'");
+            return false;
+        }
+        world.size_x = wcm["size_x"].as<double>();
+        world.size_y = wcm["size_y"].as<double>();
+        world.size_z = wcm["size_z"].as<double>();
+        world.origin_x = wcm["origin_x"].as<double>();
+        world.origin_y = wcm["origin_y"].as<double>();
+        world.origin_z = wcm["origin_z"].as<double>();
+        world.res_m = wcm["res_m"].as<double>();
+        world.max_distance_m = wcm["max_distance_m"].as<double>();
+
+        auto rcm = root["robot_collision_model"];
+
+        // restrict spheres to the links of the collision group that matches
+        // the planning group, if one exists
+        std::unordered_set<std::string> group_links;
+        std::unordered_set<std::string> expanding;
+        if (!ExpandCollisionGroup(
+                rcm["collision_groups"], model, group_name, expanding, group_links))
+        {
+            return false;
+        }
+
+        for (auto sphere_model : rcm["spheres_models"]) {
+            auto link_name = sphere_model["link_name"].as<std::string>();
+            if (!group_links.empty() && group_links.count(link_name) == 0) {
+                continue;
+            }
+
+            auto* link = GetLink(model, &link_name);
+            if (link == NULL) {
+                SMPL_WARN("Skipping spheres for unknown link '%s'", link_name.c_str());
+                continue;
+            }
+
+            for (auto s : sphere_model["spheres"]) {
+                CollisionSphere sphere;
+                sphere.link = link;
+                sphere.center = Eigen::Vector3d(
+                        s["x"].as<double>(),
+                        s["y"].as<double>(),
+                        s["z"].as<double>());
+                sphere.radius = s["radius"].as<double>();
+                spheres.push_back(sphere);
+            }
+        }
+    } catch (const YAML::Exception& ex) {
+        SMPL_ERROR("Malformed collision model config '%s': %s", filename.c_str(), ex.what());
+        return false;
+    }
+
+    return true;
+}
+
+// Parse a scene file in the format used by callPlanner:
+//
+//   <num objects>
+//   <id> <x> <y> <z> <size x> <size y> <size z>
+//   ...
+static
+bool LoadScene(const std::string& filename, std::vector<BoxObstacle>& obstacles)
+{
+    std::ifstream ifs(filename);
+    if (!ifs.is_open()) {
+        SMPL_ERROR("Failed to open scene file '%s'", filename.c_str());
+        return false;
+    }
+
+    int num_obs;
+    if (!(ifs >> num_obs)) {
+        SMPL_ERROR("Failed to read object count from scene file '%s'", filename.c_str());
+        return false;
+    }
+
+    for (int i = 0; i < num_obs; ++i) {
+        BoxObstacle box;
+        if (!(ifs >> box.id >>
+                box.position.x() >> box.position.y() >> box.position.z() >>
+                box.size.x() >> box.size.y() >> box.size.z()))
+        {
+            SMPL_ERROR("Failed to read object %d from scene file '%s'", i, filename.c_str());
+            return false;
+        }
+        obstacles.push_back(box);
+    }
+
+    return true;
+}
+
+static
+void AddBoxToGrid(smpl::OccupancyGrid& grid, const BoxObstacle& box)
+{
+    Eigen::Vector3d min = box.position - 0.5 * box.size;
+    Eigen::Vector3d max = box.position + 0.5 * box.size;
+
+    int gminx, gminy, gminz, gmaxx, gmaxy, gmaxz;
+    grid.worldToGrid(min.x(), min.y(), min.z(), gminx, gminy, gminz);
+    grid.worldToGrid(max.x(), max.y(), max.z(), gmaxx, gmaxy, gmaxz);
+
+    std::vector<Eigen::Vector3d> points;
+    for (int x = std::max(0, gminx); x <= std::min(gmaxx, grid.numCellsX() - 1); ++x) {
+    for (int y = std::max(0, gminy); y <= std::min(gmaxy, grid.numCellsY() - 1); ++y) {
+    for (int z = std::max(0, gminz); z <= std::min(gmaxz, grid.numCellsZ() - 1); ++z) {
+        Eigen::Vector3d p;
+        grid.gridToWorld(x, y, z, p.x(), p.y(), p.z());
+        points.push_back(p);
+    }
+    }
+    }
+
+    grid.addPointsToField(points);
+}
+
+/////////////
+// Results //
+/////////////
+
+struct RunResult
+{
+    std::string scene;
+    std::string query;
+    bool success = false;
+    double setup_time = 0.0;
+    double planning_time = 0.0;
+    double time_to_first_solution = 0.0;
+    int expansions = 0;
+    int expansions_first_solution = 0;
+    std::size_t collision_checks = 0;
+    int cost = -1;
+    double solution_eps = 0.0;
+    std::size_t path_length = 0;
+
+    // peak resident set size of the whole process at the end of the query,
+    // which includes every query run before it
+    long process_peak_rss_kb = 0;
+};
+
+struct CombinationResult
+{
+    std::string search;
+    std::string space;
+    std::string heuristic;
+    std::vector<RunResult> runs;
+};
+
+static long PeakRSSKilobytes()
+{
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return -1;
+    }
+    return usage.ru_maxrss; // kilobytes on Linux
+}
+
+static double Rate(double count, double secs)
+{
+    return secs > 0.0 ? count / secs : 0.0;
+}
+
+static auto Quantile(std::vector<int> values, double q) -> double
+{
+    if (values.empty()) return 0.0;
+    std::sort(begin(values), end(values));
+    auto pos = q * (double)(values.size() - 1);
+    auto lo = (size_t)std::floor(pos);
+    auto hi = (size_t)std::ceil(pos);
+    return values[lo] + (pos - (double)lo) * (values[hi] - values[lo]);
+}
+
+static auto JSONEscape(const std::string& s) -> std::string
+{
+    std::string out;
+    for (auto c : s) {
+        switch (c) {
+        case '"':   out += "\\\""; break;
+        case '\\':  out += "\\\\"; break;
+        case '\n':  out += "\\n"; break;
+        default:    out += c; break;
+        }
+    }
+    return out;
+}
+
+static
+void WriteResultsJSON(
+    std::ostream& o,
+    const std::string& urdf,
+    const std::vector<CombinationResult>& results)
+{
+    o << "{\n";
+    o << "  \"urdf\": \"" << JSONEscape(urdf) << "\",\n";
+    o << "  \"peak_rss_kb\": " << PeakRSSKilobytes() << ",\n";
+    o << "  \"combinations\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        auto& result = results[i];
+
+        std::vector<int> costs;
+        auto successes = 0;
+        for (auto& run : result.runs) {
+            if (run.success) {
+                ++successes;
+                costs.push_back(run.cost);
+            }
+        }
+        auto mean_cost = costs.empty() ? 0.0 :
+                (double)std::accumulate(begin(costs), end(costs), 0L) / (double)costs.size();
+
+        o << "    {\n";
+        o << "      \"planner_id\": \"" << result.search << "." << result.heuristic << "." << result.space << "\",\n";
+        o << "      \"search\": \"" << result.search << "\",\n";
+        o << "      \"space\": \"" << result.space << "\",\n";
+        o << "      \"heuristic\": \"" << result.heuristic << "\",\n";
+        o << "      \"success_rate\": " << Rate(successes, result.runs.size()) << ",\n";
+        o << "      \"cost\": { ";
+        o << "\"min\": " << Quantile(costs, 0.0) << ", ";
+        o << "\"p25\": " << Quantile(costs, 0.25) << ", ";
+        o << "\"median\": " << Quantile(costs, 0.5) << ", ";
+        o << "\"p75\": " << Quantile(costs, 0.75) << ", ";
+        o << "\"max\": " << Quantile(costs, 1.0) << ", ";
+        o << "\"mean\": " << mean_cost << " },\n";
+        o << "      \"runs\": [\n";
+        for (size_t j = 0; j < result.runs.size(); ++j) {
+            auto& run = result.runs[j];
+            o << "        { ";
+            o << "\"scene\": \"" << JSONEscape(run.scene) << "\", ";
+            o << "\"query\": \"" << JSONEscape(run.query) << "\", ";
+            o << "\"success\": " << (run.success ? "true" : "false") << ", ";
+            o << "\"setup_time\": " << run.setup_time << ", ";
+            o << "\"planning_time\": " << run.planning_time << ", ";
+            o << "\"time_to_first_solution\": " << run.time_to_first_solution << ", ";
+            o << "\"expansions\": " << run.expansions << ", ";
+            o << "\"expansions_first_solution\": " << run.expansions_first_solution << ", ";
+            o << "\"expansions_per_sec\": " << Rate(run.expansions, run.planning_time) << ", ";
+            o << "\"collision_checks\": " << run.collision_checks << ", ";
+            o << "\"collision_checks_per_sec\": " << Rate(run.collision_checks, run.planning_time) << ", ";
+            o << "\"cost\": " << run.cost << ", ";
+            o << "\"solution_eps\": " << run.solution_eps << ", ";
+            o << "\"path_length\": " << run.path_length << ", ";
+            o << "\"process_peak_rss_kb\": " << run.process_peak_rss_kb;
+            o << " }" << (j + 1 < result.runs.size() ? "," : "") << "\n";
+        }
+        o << "      ]\n";
+        o << "    }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    o << "  ]\n";
+    o << "}\n";
+}
+
+//////////////
+// Planning //
+//////////////
+
+struct BenchmarkContext
+{
+    smpl::urdf::URDFRobotModel* robot;
+    SphereCollisionChecker* checker;
+    const smpl::OccupancyGrid* grid;
+    const BenchmarkConfig* config;
+    smpl::SearchTrace* trace;
+};
+
+static
+auto MakeManipLattice(const BenchmarkContext& ctx)
+    -> std::unique_ptr<smpl::ManipLattice>
+{
+    // couple the lifetime of the action space to the lattice
+    struct SimpleManipLattice : public smpl::ManipLattice {
+        smpl::ManipLatticeActionSpace actions;
+    };
+
+    std::vector<double> resolutions;
+    for (auto& vname : ctx.robot->getPlanningJoints()) {
+        auto dit = ctx.config->discretization.find(vname);
+        if (dit == end(ctx.config->discretization)) {
+            SMPL_ERROR("Discretization for variable '%s' not found", vname.c_str());
+            return nullptr;
+        }
+        resolutions.push_back(dit->second);
+    }
+
+    auto space = smpl::make_unique<SimpleManipLattice>();
+    if (!space->init(ctx.robot, ctx.checker, resolutions, &space->actions) ||
+        !space->actions.init(space.get()))
+    {
+        SMPL_ERROR("Failed to initialize Manip Lattice");
+        return nullptr;
+    }
+
+    auto& actions = space->actions;
+    actions.useAmp(smpl::MotionPrimitive::SHORT_DISTANCE, ctx.config->use_short_dist_mprims);
+    actions.ampThresh(smpl::MotionPrimitive::SHORT_DISTANCE, ctx.config->short_dist_mprims_thresh);
+    if (!actions.load(ctx.config->mprim_filename)) {
+        SMPL_ERROR("Failed to load actions from file '%s'", ctx.config->mprim_filename.c_str());
+        return nullptr;
+    }
+
+    return std::move(space);
+}
+
+static
+auto MakeHeuristic(
+    const BenchmarkContext& ctx,
+    const std::string& name,
+    smpl::RobotPlanningSpace* space)
+    -> std::unique_ptr<smpl::RobotHeuristic>
+{
+    if (name == "bfs") {
+        auto h = smpl::make_unique<smpl::BfsHeuristic>();
+        h->setCostPerCell(ctx.config->bfs_cost_per_cell);
+        h->setInflationRadius(ctx.config->bfs_inflation_radius);
+        if (!h->init(space, ctx.grid)) return nullptr;
+        return std::move(h);
+    } else if (name == "euclid") {
+        auto h = smpl::make_unique<smpl::EuclidDistHeuristic>();
+        if (!h->init(space)) return nullptr;
+        return std::move(h);
+    } else if (name == "joint_distance") {
+        auto h = smpl::make_unique<smpl::JointDistHeuristic>();
+        if (!h->init(space)) return nullptr;
+        return std::move(h);
+    }
+
+    SMPL_ERROR("Unrecognized heuristic '%s'", name.c_str());
+    return nullptr;
+}
+
+static
+auto MakeSearch(
+    const std::string& name,
+    smpl::RobotPlanningSpace* space,
+    smpl::RobotHeuristic* heuristic,
+    double epsilon,
+    smpl::SearchTrace* trace)
+    -> std::unique_ptr<SBPLPlanner>
+{
+    if (name == "arastar") {
+        auto search = smpl::make_unique<smpl::ARAStar>(space, heuristic);
+        search->setTrace(trace);
+        search->set_initialsolution_eps(epsilon);
+        search->set_search_mode(false);
+        search->setTargetEpsilon(1.0);
+        search->setDeltaEpsilon(1.0);
+        search->setImproveSolution(false);
+        search->setBoundExpansions(true);
+        search->allowPartialSolutions(false);
+        return std::move(search);
+    } else if (name == "awastar") {
+        // AWA* does not support tracing and takes its initial suboptimality
+        // bound from set_initialsolution_eps() rather than the replan params
+        auto search = smpl::make_unique<smpl::AWAStar>(space, heuristic);
+        search->set_initialsolution_eps(epsilon);
+        search->set_search_mode(false);
+        return std::move(search);
+    }
+
+    SMPL_ERROR("Unrecognized search '%s'", name.c_str());
+    return nullptr;
+}
+
+static
+bool RunQuery(
+    const BenchmarkContext& ctx,
+    const std::string& search_name,
+    const std::string& space_name,
+    const std::string& heuristic_name,
+    const BenchmarkQuery& query,
+    RunResult& result)
+{
+    using clock = std::chrono::steady_clock;
+
+    auto setup_start = clock::now();
+
+    if (space_name != "manip") {
+        SMPL_ERROR("Unrecognized planning space '%s'", space_name.c_str());
+        return false;
+    }
+
+    auto space = MakeManipLattice(ctx);
+    if (!space) return false;
+
+    auto heuristic = MakeHeuristic(ctx, heuristic_name, space.get());
+    if (!heuristic) return false;
+
+    space->insertHeuristic(heuristic.get());
+
+    auto search = MakeSearch(
+            search_name,
+            space.get(),
+            heuristic.get(),
+            ctx.config->epsilon,
+            ctx.trace);
+    if (!search) return false;
+
+    // Joint-space goals are used for every combination; the goal pose is
+    // filled in from forward kinematics for the workspace heuristics.
+    smpl::GoalConstraint goal;
+    goal.type = smpl::GoalType::JOINT_STATE_GOAL;
+    goal.angles = query.goal;
+    goal.angle_tolerances.assign(query.goal.size(), ctx.config->goal_angle_tolerance);
+    goal.pose = ctx.robot->computeFK(query.goal);
+    goal.xyz_tolerance[0] = goal.xyz_tolerance[1] = goal.xyz_tolerance[2] = 0.015;
+    goal.rpy_tolerance[0] = goal.rpy_tolerance[1] = goal.rpy_tolerance[2] = 0.05;
+
+    if (!space->setStart(query.start) || !space->setGoal(goal)) {
+        SMPL_WARN("Query '%s' has an invalid start or goal", query.name.c_str());
+        return true;
+    }
+
+    if (!search->set_start(space->getStartStateID()) ||
+        !search->set_goal(space->getGoalStateID()))
+    {
+        SMPL_ERROR("Failed to set search start or goal");
+        return false;
+    }
+
+    result.setup_time = std::chrono::duration<double>(clock::now() - setup_start).count();
+
+    ReplanParams params(ctx.config->allowed_planning_time);
+    params.initial_eps = ctx.config->epsilon;
+    params.final_eps = 1.0;
+    params.dec_eps = 1.0;
+    params.return_first_solution = false;
+    params.repair_time = -1.0;
+
+    ctx.checker->resetCheckCount();
+
+    std::vector<int> solution;
+    auto cost = 0;
+    auto plan_start = clock::now();
+    result.success = search->replan(&solution, params, &cost);
+    result.planning_time = std::chrono::duration<double>(clock::now() - plan_start).count();
+
+    result.collision_checks = ctx.checker->checkCount();
+    result.expansions = search->get_n_expands();
+    result.process_peak_rss_kb = PeakRSSKilobytes();
+
+    if (result.success) {
+        result.cost = cost;
+        result.solution_eps = search->get_solution_eps();
+        result.time_to_first_solution = search->get_initial_eps_planning_time();
+        result.expansions_first_solution = search->get_n_expands_init_solution();
+
+        std::vector<smpl::RobotState> path;
+        if (space->extractPath(solution, path)) {
+            result.path_length = path.size();
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    std::string urdf_filename;
+    std::string collision_filename;
+    std::string config_filename;
+    std::vector<std::string> scene_filenames;
+    std::string output_filename;
+    std::string trace_filename;
+
+    po::options_description desc("Usage: planner_benchmark [options]");
+    desc.add_options()
+        ("help,h", "Print this message")
+        ("urdf", po::value<std::string>(&urdf_filename)->required(), "Path to the robot URDF")
+        ("collision-model", po::value<std::string>(&collision_filename)->required(), "Path to the collision model config (.yaml)")
+        ("config", po::value<std::string>(&config_filename)->required(), "Path to the benchmark config (.yaml)")
+        ("scene", po::value<std::vector<std::string>>(&scene_filenames)->multitoken(), "Scene files (.env) to run each query in")
+        ("output,o", po::value<std::string>(&output_filename), "Write JSON results to a file instead of stdout")
+        ("trace", po::value<std::string>(&trace_filename), "Write a trace of the expansions of each search to a file");
+
+    po::variables_map vm;
+    try {
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        if (vm.count("help")) {
+            std::cout << desc << std::endl;
+            return 0;
+        }
+        po::notify(vm);
+    } catch (const po::error& ex) {
+        std::cerr << ex.what() << '\n' << desc << std::endl;
+        return 1;
+    }
+
+    BenchmarkConfig config;
+    if (!LoadBenchmarkConfig(config_filename, config)) {
+        return 1;
+    }
+
+    smpl::SearchTrace trace;
+    if (!trace_filename.empty() && !trace.open(trace_filename)) {
+        return 1;
+    }
+
+    /////////////////
+    // Robot Model //
+    /////////////////
+
+    auto urdf = ::urdf::parseURDFFile(urdf_filename);
+    if (!urdf) {
+        SMPL_ERROR("Failed to parse URDF '%s'", urdf_filename.c_str());
+        return 1;
+    }
+
+    smpl::urdf::RobotModel robot_model;
+    if (!InitRobotModel(&robot_model, urdf.get())) {
+        SMPL_ERROR("Failed to initialize robot model");
+        return 1;
+    }
+
+    smpl::urdf::URDFRobotModel rm;
+    if (!Init(&rm, &robot_model, &config.planning_joints)) {
+        SMPL_ERROR("Failed to initialize URDF robot model");
+        return 1;
+    }
+
+    if (!SetPlanningLink(&rm, &config.chain_tip_link)) {
+        SMPL_ERROR("Failed to set planning link '%s'", config.chain_tip_link.c_str());
+        return 1;
+    }
+
+    smpl::urdf::RobotState reference_state;
+    InitRobotState(&reference_state, &robot_model);
+    for (auto& entry : config.reference_state) {
+        auto* var = GetVariable(&robot_model, &entry.first);
+        if (var == NULL) {
+            SMPL_WARN("Reference state variable '%s' not found", entry.first.c_str());
+            continue;
+        }
+        SetVariablePosition(&reference_state, var, entry.second);
+    }
+    SetReferenceState(&rm, GetVariablePositions(&reference_state));
+
+    WorldConfig world;
+    std::vector<CollisionSphere> spheres;
+    if (!LoadCollisionModelConfig(
+            collision_filename, &robot_model, config.group_name, world, spheres))
+    {
+        return 1;
+    }
+    SMPL_INFO("Loaded %zu collision spheres", spheres.size());
+
+    if (scene_filenames.empty()) {
+        scene_filenames.push_back(std::string());
+    }
+
+    std::vector<CombinationResult> results;
+    for (auto& search_name : config.searches) {
+    for (auto& space_name : config.spaces) {
+    for (auto& heuristic_name : config.heuristics) {
+        CombinationResult result;
+        result.search = search_name;
+        result.space = space_name;
+        result.heuristic = heuristic_name;
+
+        for (auto& scene_filename : scene_filenames) {
+            std::vector<BoxObstacle> obstacles;
+            if (!scene_filename.empty() && !LoadScene(scene_filename, obstacles)) {
+                return 1;
+            }
+
+            // rebuild the world for every scene so that runs are independent
+            smpl::OccupancyGrid grid(
+                    world.size_x, world.size_y, world.size_z,
+                    world.res_m,
+                    world.origin_x, world.origin_y, world.origin_z,
+                    world.max_distance_m);
+            for (auto& obstacle : obstacles) {
+                AddBoxToGrid(grid, obstacle);
+            }
+
+            SphereCollisionChecker checker(
+                    &rm, &grid, spheres, config.interpolation_resolution);
+
+            BenchmarkContext ctx;
+            ctx.robot = &rm;
+            ctx.checker = &checker;
+            ctx.grid = &grid;
+            ctx.config = &config;
+            ctx.trace = trace.isOpen() ? &trace : nullptr;
+
+            for (auto& query : config.queries) {
+                SMPL_INFO("Run %s.%s.%s on %s/%s",
+                        search_name.c_str(),
+                        heuristic_name.c_str(),
+                        space_name.c_str(),
+                        scene_filename.c_str(),
+                        query.name.c_str());
+                RunResult run;
+                run.scene = scene_filename;
+                run.query = query.name;
+                if (!RunQuery(ctx, search_name, space_name, heuristic_name, query, run)) {
+                    return 1;
+                }
+                result.runs.push_back(run);
+            }
+        }
+
+        results.push_back(std::move(result));
+    }
+    }
+    }
+
+    if (output_filename.empty()) {
+        WriteResultsJSON(std::cout, urdf_filename, results);
+    } else {
+        std::ofstream ofs(output_filename);
+        if (!ofs.is_open()) {
+            SMPL_ERROR("Failed to open '%s' for writing", output_filename.c_str());
+            return 1;
+        }
+        WriteResultsJSON(ofs, urdf_filename, results);
+    }
+
+    return 0;
+}
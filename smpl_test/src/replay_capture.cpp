@@ -0,0 +1,285 @@
+// standard includes
+#include <stdlib.h>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// system includes
+#include <moveit_msgs/MotionPlanResponse.h>
+#include <ros/ros.h>
+#include <sbpl_collision_checking/collision_space.h>
+#include <sbpl_kdl_robot_model/kdl_robot_model.h>
+#include <smpl/distance_map/euclid_distance_map.h>
+#include <smpl/ros/planner_interface.h>
+#include <smpl/ros/planning_capture.h>
+#include <smpl/stl/memory.h>
+
+#include "collision_space_scene.h"
+#include "pr2_allowed_collision_pairs.h"
+
+struct RobotModelConfig
+{
+    std::string group_name;
+    std::vector<std::string> planning_joints;
+    std::string kinematics_frame;
+    std::string chain_tip_link;
+};
+
+bool ReadRobotModelConfig(const ros::NodeHandle& nh, RobotModelConfig& config)
+{
+    if (!nh.getParam("group_name", config.group_name)) {
+        ROS_ERROR("Failed to read 'group_name' from the param server");
+        return false;
+    }
+
+    std::string planning_joint_list;
+    if (!nh.getParam("planning_joints", planning_joint_list)) {
+        ROS_ERROR("Failed to read 'planning_joints' from the param server");
+        return false;
+    }
+
+    std::stringstream joint_name_stream(planning_joint_list);
+    while (joint_name_stream.good() && !joint_name_stream.eof()) {
+        std::string jname;
+        joint_name_stream >> jname;
+        if (jname.empty()) {
+            continue;
+        }
+        config.planning_joints.push_back(jname);
+    }
+
+    if (!nh.getParam("kinematics_frame", config.kinematics_frame) ||
+        !nh.getParam("chain_tip_link", config.chain_tip_link))
+    {
+        ROS_ERROR("Failed to read 'kinematics_frame' or 'chain_tip_link' from the param server");
+        return false;
+    }
+    return true;
+}
+
+struct ReplayResult
+{
+    int error_code;
+    double planning_time;
+    int expansions;
+    int solution_cost;
+    bool time_limited;
+};
+
+// Reconstruct the planning environment recorded in a capture and re-run the
+// recorded request through a fresh PlannerInterface. The collision model is
+// built from the recorded configuration, or from default_cc_conf if the
+// capture has none.
+bool ReplayCapture(
+    const std::string& robot_description,
+    const RobotModelConfig& robot_config,
+    const smpl::collision::CollisionModelConfig& default_cc_conf,
+    const smpl::PlanningCapture& capture,
+    ReplayResult& result)
+{
+    // the world is only restored from the grid snapshot, so the collision
+    // checker of a capture that checked against a world of its own can not
+    // be rebuilt
+    if (!capture.grid_is_collision_world) {
+        ROS_ERROR("The capture's collision checker did not check against the captured grid (captured through MoveIt?)");
+        return false;
+    }
+
+    auto cc_conf = default_cc_conf;
+    if (!capture.collision_model_config.empty()) {
+        XmlRpc::XmlRpcValue config;
+        int offset = 0;
+        if (!config.fromXml(capture.collision_model_config, &offset) ||
+            !smpl::collision::CollisionModelConfig::Load(config, cc_conf))
+        {
+            ROS_ERROR("Failed to load the recorded Collision Model Config");
+            return false;
+        }
+    }
+
+    auto df = std::make_shared<smpl::EuclidDistanceMap>(
+            capture.grid_origin[0],
+            capture.grid_origin[1],
+            capture.grid_origin[2],
+            capture.grid_size[0],
+            capture.grid_size[1],
+            capture.grid_size[2],
+            capture.grid_resolution,
+            capture.grid_max_distance);
+
+    smpl::OccupancyGrid grid(df, false);
+    grid.addPointsToField(capture.occupied_voxels);
+
+    smpl::collision::CollisionSpace cc;
+    if (!cc.init(
+            &grid,
+            robot_description,
+            cc_conf,
+            robot_config.group_name,
+            robot_config.planning_joints))
+    {
+        ROS_ERROR("Failed to initialize Collision Space");
+        return false;
+    }
+
+    if (cc.robotCollisionModel()->name() == "pr2") {
+        smpl::collision::AllowedCollisionMatrix acm;
+        for (auto& pair : PR2AllowedCollisionPairs) {
+            acm.setEntry(pair.first, pair.second, true);
+        }
+        cc.setAllowedCollisionMatrix(acm);
+    }
+
+    // The world is restored from the occupancy snapshot; only the robot state
+    // is taken from the recorded request. The recorded attached objects
+    // include those of the start state.
+    CollisionSpaceScene scene;
+    scene.SetCollisionSpace(&cc);
+    auto start_state = capture.req.start_state;
+    start_state.attached_collision_objects.clear();
+    if (!scene.SetRobotState(start_state)) {
+        ROS_ERROR("Failed to set start state on Collision Space Scene");
+        return false;
+    }
+    for (auto& ao : capture.attached_objects) {
+        if (!scene.ProcessAttachedCollisionObject(ao)) {
+            ROS_ERROR("Failed to attach object '%s'", ao.object.id.c_str());
+            return false;
+        }
+    }
+    cc.setWorldToModelTransform(Eigen::Affine3d::Identity());
+
+    auto rm = smpl::make_unique<smpl::KDLRobotModel>();
+    if (!rm->init(
+            robot_description,
+            robot_config.kinematics_frame,
+            robot_config.chain_tip_link))
+    {
+        ROS_ERROR("Failed to initialize robot model.");
+        return false;
+    }
+
+    smpl::urdf::RobotState reference_state;
+    InitRobotState(&reference_state, &rm->m_robot_model);
+    auto& start_js = capture.req.start_state.joint_state;
+    for (size_t i = 0; i < start_js.name.size(); ++i) {
+        auto* var = GetVariable(&rm->m_robot_model, &start_js.name[i]);
+        if (var == NULL) {
+            continue;
+        }
+        SetVariablePosition(&reference_state, var, start_js.position[i]);
+    }
+    SetReferenceState(rm.get(), GetVariablePositions(&reference_state));
+
+    smpl::PlannerInterface planner(rm.get(), &cc, &grid);
+    if (!planner.init(capture.params)) {
+        ROS_ERROR("Failed to initialize Planner Interface");
+        return false;
+    }
+
+    moveit_msgs::MotionPlanResponse res;
+    auto success = planner.solve(capture.scene, capture.req, res);
+
+    auto stats = planner.getPlannerStats();
+    result.error_code = res.error_code.val;
+    result.planning_time = res.planning_time;
+    result.expansions = (int)stats["expansions"];
+    result.solution_cost = success ? (int)stats["solution cost"] : INFINITECOST;
+    result.time_limited = stats["time limited"] != 0.0;
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    ros::init(argc, argv, "replay_capture");
+    ros::NodeHandle nh;
+    ros::NodeHandle ph("~");
+
+    if (argc < 2) {
+        ROS_ERROR("Usage: replay_capture <capture> [<capture> ...]");
+        return 1;
+    }
+
+    std::string robot_description_param;
+    if (!nh.searchParam("robot_description", robot_description_param)) {
+        ROS_ERROR("Failed to find 'robot_description' key on the param server");
+        return 1;
+    }
+
+    std::string robot_description;
+    if (!nh.getParam(robot_description_param, robot_description)) {
+        ROS_ERROR("Failed to retrieve param 'robot_description' from the param server");
+        return 1;
+    }
+
+    RobotModelConfig robot_config;
+    if (!ReadRobotModelConfig(ros::NodeHandle("~robot_model"), robot_config)) {
+        ROS_ERROR("Failed to read robot model config from param server");
+        return 1;
+    }
+
+    smpl::collision::CollisionModelConfig cc_conf;
+    if (!smpl::collision::CollisionModelConfig::Load(ph, cc_conf)) {
+        ROS_ERROR("Failed to load Collision Model Config");
+        return 1;
+    }
+
+    // relative slowdown in wall time, beyond which a replay is reported as a
+    // regression
+    double time_tolerance;
+    ph.param("time_tolerance", time_tolerance, 0.2);
+
+    auto mismatches = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::string path(argv[i]);
+
+        smpl::PlanningCapture capture;
+        if (!smpl::ReadPlanningCapture(path, capture)) {
+            ++mismatches;
+            continue;
+        }
+
+        ReplayResult result;
+        if (!ReplayCapture(
+                robot_description, robot_config, cc_conf, capture, result))
+        {
+            ROS_ERROR("Failed to replay capture '%s'", path.c_str());
+            ++mismatches;
+            continue;
+        }
+
+        auto result_match =
+                result.error_code == capture.error_code &&
+                result.expansions == capture.expansions &&
+                result.solution_cost == capture.solution_cost;
+        auto time_regressed =
+                result.planning_time >
+                capture.planning_time * (1.0 + time_tolerance);
+
+        ROS_INFO("%s", path.c_str());
+        ROS_INFO("  planner id:    %s", capture.req.planner_id.c_str());
+        ROS_INFO("  error code:    %d -> %d", capture.error_code, result.error_code);
+        ROS_INFO("  planning time: %0.3f -> %0.3f", capture.planning_time, result.planning_time);
+        ROS_INFO("  expansions:    %d -> %d", capture.expansions, result.expansions);
+        ROS_INFO("  solution cost: %d -> %d", capture.solution_cost, result.solution_cost);
+
+        // the result of a search stopped by its time limit depends on how
+        // fast it ran, so results are only compared when both searches
+        // finished on their own
+        if (capture.time_limited) {
+            ROS_INFO("  recorded search was stopped by its time limit; results not compared");
+        } else if (result.time_limited) {
+            ROS_WARN("  search was stopped by its time limit, but the recorded search was not");
+            ++mismatches;
+        } else if (!result_match) {
+            ROS_WARN("  result differs from recorded run");
+            ++mismatches;
+        }
+        if (time_regressed) {
+            ROS_WARN("  planning time regressed by more than %0.0f%%", 100.0 * time_tolerance);
+            ++mismatches;
+        }
+    }
+
+    return mismatches == 0 ? 0 : 1;
+}
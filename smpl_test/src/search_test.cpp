@@ -0,0 +1,498 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2018, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#define BOOST_TEST_MODULE SearchTest
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <sbpl/heuristics/heuristic.h>
+#include <smpl/search/arastar.h>
+#include <smpl/search/bidirectional_wastar.h>
+#include <smpl/search/search_trace.h>
+
+// An 8-connected grid with random obstacles. Edges are symmetric, so the
+// predecessors of a cell are its successors.
+class GridSpace : public DiscreteSpaceInformation
+{
+public:
+
+    static const int Width = 24;
+    static const int Height = 24;
+
+    GridSpace(unsigned int seed, int obstacle_pct) : m_occupied(Width * Height)
+    {
+        std::mt19937 rng(seed);
+        for (size_t i = 0; i < m_occupied.size(); ++i) {
+            m_occupied[i] = (int)(rng() % 100) < obstacle_pct;
+        }
+    }
+
+    void setFree(int id) { m_occupied[id] = false; }
+    bool occupied(int id) const { return m_occupied[id]; }
+    void toggle(int id) { m_occupied[id] = !m_occupied[id]; }
+
+    // octile distance between two cells, a consistent heuristic
+    int distance(int a, int b) const
+    {
+        int dx = abs(a % Width - b % Width);
+        int dy = abs(a / Width - b / Width);
+        return 10 * std::max(dx, dy) + 4 * std::min(dx, dy);
+    }
+
+    // Return the cost of a path, or -1 if it is not a path in the graph.
+    int pathCost(const std::vector<int>& path)
+    {
+        int cost = 0;
+        for (size_t i = 1; i < path.size(); ++i) {
+            std::vector<int> succs, costs;
+            GetSuccs(path[i - 1], &succs, &costs);
+            auto it = std::find(succs.begin(), succs.end(), path[i]);
+            if (it == succs.end()) {
+                return -1;
+            }
+            cost += costs[it - succs.begin()];
+        }
+        return cost;
+    }
+
+    void GetSuccs(int state_id, std::vector<int>* succs, std::vector<int>* costs) override
+    {
+        if (m_occupied[state_id]) {
+            return;
+        }
+        int x = state_id % Width;
+        int y = state_id / Width;
+        for (int dx = -1; dx <= 1; ++dx) {
+        for (int dy = -1; dy <= 1; ++dy) {
+            if (!(dx | dy)) {
+                continue;
+            }
+            int nx = x + dx;
+            int ny = y + dy;
+            if (nx < 0 || ny < 0 || nx >= Width || ny >= Height) {
+                continue;
+            }
+            int n = ny * Width + nx;
+            if (m_occupied[n]) {
+                continue;
+            }
+            succs->push_back(n);
+            costs->push_back(dx && dy ? 14 : 10);
+        }
+        }
+    }
+
+    void GetPreds(int state_id, std::vector<int>* preds, std::vector<int>* costs) override
+    {
+        GetSuccs(state_id, preds, costs);
+    }
+
+    bool InitializeEnv(const char*) override { return true; }
+    bool InitializeMDPCfg(MDPConfig*) override { return true; }
+    int GetFromToHeuristic(int from_id, int to_id) override { return distance(from_id, to_id); }
+    int GetGoalHeuristic(int state_id) override { return 0; }
+    int GetStartHeuristic(int state_id) override { return 0; }
+    void SetAllActionsandAllOutcomes(CMDPSTATE*) override { }
+    void SetAllPreds(CMDPSTATE*) override { }
+    int SizeofCreatedEnv() override { return Width * Height; }
+    void PrintState(int, bool, FILE*) override { }
+    void PrintEnv_Config(FILE*) override { }
+
+private:
+
+    std::vector<bool> m_occupied;
+};
+
+class GridHeuristic : public Heuristic
+{
+public:
+
+    GridHeuristic(GridSpace* space, int start, int goal, bool start_heuristic) :
+        Heuristic(space),
+        m_space(space),
+        m_start(start),
+        m_goal(goal),
+        m_start_heuristic(start_heuristic)
+    { }
+
+    int GetGoalHeuristic(int state_id) override
+    {
+        return m_space->distance(state_id, m_goal);
+    }
+
+    int GetStartHeuristic(int state_id) override
+    {
+        return m_start_heuristic ? m_space->distance(m_start, state_id) : 0;
+    }
+
+    int GetFromToHeuristic(int from_id, int to_id) override
+    {
+        return m_space->distance(from_id, to_id);
+    }
+
+    void setGoal(int goal) { m_goal = goal; }
+
+private:
+
+    GridSpace* m_space;
+    int m_start;
+    int m_goal;
+    bool m_start_heuristic;
+};
+
+// At epsilon = 1, the bidirectional search must find paths as cheap as those
+// found by ARA*, with and without a start heuristic for the backward search.
+BOOST_AUTO_TEST_CASE(BidirectionalWAStarOptimalTest)
+{
+    std::mt19937 rng(1);
+    int solved_count = 0;
+    for (int trial = 0; trial < 100; ++trial) {
+        GridSpace space(trial, 25);
+        int start = rng() % (GridSpace::Width * GridSpace::Height);
+        int goal = rng() % (GridSpace::Width * GridSpace::Height);
+        space.setFree(start);
+        space.setFree(goal);
+
+        GridHeuristic heuristic(&space, start, goal, trial % 2 == 0);
+
+        smpl::ARAStar arastar(&space, &heuristic);
+        arastar.set_initialsolution_eps(1.0);
+        arastar.set_search_mode(false);
+        arastar.set_start(start);
+        arastar.set_goal(goal);
+
+        smpl::BidirectionalWAStar biwastar(&space, &heuristic);
+        biwastar.set_initialsolution_eps(1.0);
+        biwastar.set_start(start);
+        biwastar.set_goal(goal);
+
+        std::vector<int> ara_path;
+        int ara_cost;
+        bool ara_solved = arastar.replan(10.0, &ara_path, &ara_cost);
+
+        std::vector<int> bi_path;
+        int bi_cost;
+        bool bi_solved = biwastar.replan(10.0, &bi_path, &bi_cost);
+
+        BOOST_REQUIRE_EQUAL(bi_solved, ara_solved);
+        if (!bi_solved) {
+            continue;
+        }
+
+        ++solved_count;
+        BOOST_CHECK_EQUAL(bi_cost, ara_cost);
+        BOOST_REQUIRE(!bi_path.empty());
+        BOOST_CHECK_EQUAL(bi_path.front(), start);
+        BOOST_CHECK_EQUAL(bi_path.back(), goal);
+        BOOST_CHECK_EQUAL(space.pathCost(bi_path), bi_cost);
+    }
+
+    BOOST_CHECK(solved_count > 0);
+}
+
+// The cells whose edges change when a cell is toggled: the cell itself and its
+// neighbors, which are both the predecessors and successors of the changed
+// edges.
+class GridChangeQuery : public StateChangeQuery
+{
+public:
+
+    void add(int id)
+    {
+        int x = id % GridSpace::Width;
+        int y = id / GridSpace::Width;
+        for (int dx = -1; dx <= 1; ++dx) {
+        for (int dy = -1; dy <= 1; ++dy) {
+            int nx = x + dx;
+            int ny = y + dy;
+            if (nx < 0 || ny < 0 || nx >= GridSpace::Width || ny >= GridSpace::Height) {
+                continue;
+            }
+            m_changed.push_back(ny * GridSpace::Width + nx);
+        }
+        }
+    }
+
+    const std::vector<int>* getPredecessors() const override { return &m_changed; }
+    const std::vector<int>* getSuccessors() const override { return &m_changed; }
+
+private:
+
+    std::vector<int> m_changed;
+};
+
+// After obstacles are toggled, a search repaired incrementally must find paths
+// as cheap as a search from scratch.
+BOOST_AUTO_TEST_CASE(ARAStarIncrementalRepairTest)
+{
+    std::mt19937 rng(2);
+    int repaired_count = 0;
+    for (int trial = 0; trial < 40; ++trial) {
+        GridSpace space(trial, 20);
+        int start = rng() % (GridSpace::Width * GridSpace::Height);
+        int goal = rng() % (GridSpace::Width * GridSpace::Height);
+        space.setFree(start);
+        space.setFree(goal);
+
+        GridHeuristic heuristic(&space, start, goal, false);
+
+        smpl::ARAStar arastar(&space, &heuristic);
+        arastar.allowIncrementalRepair(true);
+        arastar.set_initialsolution_eps(1.0);
+        arastar.set_search_mode(false);
+        arastar.set_start(start);
+        arastar.set_goal(goal);
+
+        std::vector<int> path;
+        int cost;
+        arastar.replan(10.0, &path, &cost);
+
+        for (int update = 0; update < 10; ++update) {
+            GridChangeQuery changes;
+            for (int i = 0; i < 5; ++i) {
+                int id = rng() % (GridSpace::Width * GridSpace::Height);
+                if (id == start || id == goal) {
+                    continue;
+                }
+                space.toggle(id);
+                changes.add(id);
+            }
+            arastar.costs_changed(changes);
+
+            std::vector<int> repaired_path;
+            int repaired_cost;
+            bool repaired = arastar.replan(10.0, &repaired_path, &repaired_cost);
+
+            smpl::ARAStar scratch(&space, &heuristic);
+            scratch.set_initialsolution_eps(1.0);
+            scratch.set_search_mode(false);
+            scratch.set_start(start);
+            scratch.set_goal(goal);
+
+            std::vector<int> scratch_path;
+            int scratch_cost;
+            bool solved = scratch.replan(10.0, &scratch_path, &scratch_cost);
+
+            BOOST_REQUIRE_EQUAL(repaired, solved);
+            if (!repaired) {
+                continue;
+            }
+
+            ++repaired_count;
+            BOOST_CHECK_EQUAL(repaired_cost, scratch_cost);
+            BOOST_REQUIRE(!repaired_path.empty());
+            BOOST_CHECK_EQUAL(repaired_path.front(), start);
+            BOOST_CHECK_EQUAL(repaired_path.back(), goal);
+            BOOST_CHECK_EQUAL(space.pathCost(repaired_path), repaired_cost);
+        }
+    }
+
+    BOOST_CHECK(repaired_count > 0);
+}
+
+// When only the goal changes between calls to replan, the search continues
+// from its tree toward the new goal; it must find paths as cheap as a search
+// from scratch, whether or not it ran to the final epsilon before.
+BOOST_AUTO_TEST_CASE(ARAStarGoalChangeTest)
+{
+    std::mt19937 rng(3);
+    int solved_count = 0;
+    for (int trial = 0; trial < 40; ++trial) {
+        GridSpace space(trial, 20);
+        int start = rng() % (GridSpace::Width * GridSpace::Height);
+        int goal = rng() % (GridSpace::Width * GridSpace::Height);
+        space.setFree(start);
+        space.setFree(goal);
+
+        GridHeuristic heuristic(&space, start, goal, false);
+
+        smpl::ARAStar arastar(&space, &heuristic);
+        arastar.set_initialsolution_eps(trial % 2 == 0 ? 1.0 : 3.0);
+        arastar.set_search_mode(false);
+        arastar.set_start(start);
+        arastar.set_goal(goal);
+
+        std::vector<int> path;
+        int cost;
+        arastar.replan(10.0, &path, &cost);
+
+        for (int update = 0; update < 5; ++update) {
+            // the graph must not change, so the new goal is a free cell
+            do {
+                goal = rng() % (GridSpace::Width * GridSpace::Height);
+            } while (space.occupied(goal));
+            heuristic.setGoal(goal);
+            arastar.set_goal(goal);
+
+            std::vector<int> new_path;
+            int new_cost;
+            bool solved = arastar.replan(10.0, &new_path, &new_cost);
+
+            GridHeuristic scratch_heuristic(&space, start, goal, false);
+            smpl::ARAStar scratch(&space, &scratch_heuristic);
+            scratch.set_initialsolution_eps(1.0);
+            scratch.set_search_mode(false);
+            scratch.set_start(start);
+            scratch.set_goal(goal);
+
+            std::vector<int> scratch_path;
+            int scratch_cost;
+            bool scratch_solved = scratch.replan(10.0, &scratch_path, &scratch_cost);
+
+            BOOST_REQUIRE_EQUAL(solved, scratch_solved);
+            if (!solved) {
+                continue;
+            }
+
+            ++solved_count;
+            BOOST_CHECK_EQUAL(new_cost, scratch_cost);
+            BOOST_REQUIRE(!new_path.empty());
+            BOOST_CHECK_EQUAL(new_path.front(), start);
+            BOOST_CHECK_EQUAL(new_path.back(), goal);
+            BOOST_CHECK_EQUAL(space.pathCost(new_path), new_cost);
+        }
+    }
+
+    BOOST_CHECK(solved_count > 0);
+}
+
+static auto MakeRecord(
+    int state_id,
+    smpl::ExpansionRecord::Type type) -> smpl::ExpansionRecord
+{
+    smpl::ExpansionRecord r;
+    r.state_id = state_id;
+    r.queue = state_id % 3;
+    r.g = 10 * state_id;
+    r.h = 10 * state_id + 1;
+    r.f = 10 * state_id + 2;
+    r.succ_count = 10 * state_id + 3;
+    r.succ_time_ns = 10 * state_id + 4;
+    r.heur_time_ns = 10 * state_id + 5;
+    r.eval_time_ns = 10 * state_id + 6;
+    r.type = type;
+    return r;
+}
+
+static void CheckRecord(
+    const smpl::ExpansionRecord& a,
+    const smpl::ExpansionRecord& b)
+{
+    BOOST_CHECK_EQUAL(a.state_id, b.state_id);
+    BOOST_CHECK_EQUAL(a.queue, b.queue);
+    BOOST_CHECK_EQUAL(a.g, b.g);
+    BOOST_CHECK_EQUAL(a.h, b.h);
+    BOOST_CHECK_EQUAL(a.f, b.f);
+    BOOST_CHECK_EQUAL(a.succ_count, b.succ_count);
+    BOOST_CHECK_EQUAL(a.succ_time_ns, b.succ_time_ns);
+    BOOST_CHECK_EQUAL(a.heur_time_ns, b.heur_time_ns);
+    BOOST_CHECK_EQUAL(a.eval_time_ns, b.eval_time_ns);
+    BOOST_CHECK_EQUAL((int)a.type, (int)b.type);
+}
+
+// Every field written to a search trace must be read back unchanged.
+BOOST_AUTO_TEST_CASE(SearchTraceRoundTripTest)
+{
+    char path[] = "/tmp/search_trace_testXXXXXX";
+    int fd = mkstemp(path);
+    BOOST_REQUIRE(fd != -1);
+    close(fd);
+
+    auto expansion = MakeRecord(7, smpl::ExpansionRecord::Expansion);
+    auto evaluation = MakeRecord(12, smpl::ExpansionRecord::Evaluation);
+    std::vector<int> solution = { 3, 5, 7, 12 };
+
+    {
+        smpl::SearchTrace trace;
+        BOOST_REQUIRE(trace.open(path));
+        trace.beginSearch("test", 3, 12);
+        trace.beginIteration(2.5);
+        trace.recordExpansion(expansion);
+        trace.recordExpansion(evaluation);
+        trace.endSearch(true, 42, solution);
+        trace.beginSearch("empty", -1, -1);
+        trace.endSearch(false, -1, std::vector<int>());
+        trace.close();
+    }
+
+    smpl::SearchTraceReader reader;
+    BOOST_REQUIRE(reader.open(path));
+
+    smpl::SearchTraceEvent event;
+    BOOST_REQUIRE(reader.next(event));
+    BOOST_CHECK_EQUAL(event.type, smpl::SearchTraceEvent::Begin);
+    BOOST_CHECK_EQUAL(event.search, "test");
+    BOOST_CHECK_EQUAL(event.start_id, 3);
+    BOOST_CHECK_EQUAL(event.goal_id, 12);
+
+    BOOST_REQUIRE(reader.next(event));
+    BOOST_CHECK_EQUAL(event.type, smpl::SearchTraceEvent::Iteration);
+    BOOST_CHECK_EQUAL(event.eps, 2.5);
+
+    BOOST_REQUIRE(reader.next(event));
+    BOOST_CHECK_EQUAL(event.type, smpl::SearchTraceEvent::Expansion);
+    CheckRecord(event.expansion, expansion);
+
+    BOOST_REQUIRE(reader.next(event));
+    BOOST_CHECK_EQUAL(event.type, smpl::SearchTraceEvent::Expansion);
+    CheckRecord(event.expansion, evaluation);
+
+    BOOST_REQUIRE(reader.next(event));
+    BOOST_CHECK_EQUAL(event.type, smpl::SearchTraceEvent::End);
+    BOOST_CHECK(event.solved);
+    BOOST_CHECK_EQUAL(event.cost, 42);
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+            event.path.begin(), event.path.end(),
+            solution.begin(), solution.end());
+
+    BOOST_REQUIRE(reader.next(event));
+    BOOST_CHECK_EQUAL(event.type, smpl::SearchTraceEvent::Begin);
+    BOOST_CHECK_EQUAL(event.search, "empty");
+    BOOST_CHECK_EQUAL(event.start_id, -1);
+    BOOST_CHECK_EQUAL(event.goal_id, -1);
+
+    BOOST_REQUIRE(reader.next(event));
+    BOOST_CHECK_EQUAL(event.type, smpl::SearchTraceEvent::End);
+    BOOST_CHECK(!event.solved);
+    BOOST_CHECK_EQUAL(event.cost, -1);
+    BOOST_CHECK(event.path.empty());
+
+    BOOST_CHECK(!reader.next(event));
+    reader.close();
+    unlink(path);
+}
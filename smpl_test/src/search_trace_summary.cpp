@@ -0,0 +1,199 @@
+// Summarize search traces written by smpl::SearchTrace. For each search in the
+// trace, reports the expansions made with each suboptimality bound and from
+// each queue, how the search time divides between successor generation,
+// heuristic evaluation, and the search itself, how long the search spent on
+// heuristic plateaus, and the error of the heuristic along the solution path.
+
+#include <stdio.h>
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <smpl/search/search_trace.h>
+
+struct SearchSummary
+{
+    std::string search;
+    int start_id = -1;
+    int goal_id = -1;
+
+    std::vector<std::pair<double, int>> iterations; // (eps, expansions)
+    std::map<int, int> queue_expansions;
+    int expansions = 0;
+    int evaluations = 0;
+    long long succ_count = 0;
+
+    double succ_time = 0.0;
+    double heur_time = 0.0;
+    double eval_time = 0.0;
+
+    // A plateau is a run of expansions that fail to find a state with a lower
+    // heuristic value than any expanded before it in the same iteration.
+    unsigned int best_h = 0xFFFFFFFF;
+    int plateau = 0;
+    int max_plateau = 0;
+    int plateau_count = 0;
+    long long plateau_expansions = 0;
+
+    // g- and h-values of the last expansion of each state
+    std::unordered_map<int, std::pair<unsigned int, unsigned int>> expanded;
+
+    void add(const smpl::ExpansionRecord& r)
+    {
+        succ_time += 1e-9 * r.succ_time_ns;
+        heur_time += 1e-9 * r.heur_time_ns;
+        eval_time += 1e-9 * r.eval_time_ns;
+
+        if (r.type == smpl::ExpansionRecord::Evaluation) {
+            ++evaluations;
+            return;
+        }
+
+        ++expansions;
+        ++queue_expansions[r.queue];
+        succ_count += r.succ_count;
+        if (!iterations.empty()) {
+            ++iterations.back().second;
+        }
+        expanded[r.state_id] = std::make_pair(r.g, r.h);
+
+        if (r.h < best_h) {
+            best_h = r.h;
+            endPlateau();
+        } else {
+            ++plateau;
+        }
+    }
+
+    void endPlateau()
+    {
+        if (plateau > 0) {
+            ++plateau_count;
+            plateau_expansions += plateau;
+            max_plateau = std::max(max_plateau, plateau);
+        }
+        plateau = 0;
+    }
+};
+
+static void PrintSummary(
+    const SearchSummary& s,
+    bool solved,
+    int cost,
+    double elapsed,
+    const std::vector<int>& path)
+{
+    printf("%s: %d -> %d, %s", s.search.c_str(), s.start_id, s.goal_id, solved ? "solved" : "failed");
+    if (solved) {
+        printf(", cost %d", cost);
+    }
+    printf(", %0.3f ms\n", 1e3 * elapsed);
+
+    for (auto& it : s.iterations) {
+        printf("  eps %0.3f: %d expansions\n", it.first, it.second);
+    }
+    for (auto& q : s.queue_expansions) {
+        printf("  queue %d: %d expansions\n", q.first, q.second);
+    }
+    if (s.evaluations != 0) {
+        printf("  %d edge evaluations\n", s.evaluations);
+    }
+    printf("  %0.2f successors per expansion\n",
+            s.expansions ? (double)s.succ_count / s.expansions : 0.0);
+
+    auto percent = [&](double t) { return elapsed > 0.0 ? 100.0 * t / elapsed : 0.0; };
+    auto other = std::max(0.0, elapsed - s.succ_time - s.heur_time - s.eval_time);
+    printf("  time: successors %0.3f ms (%0.1f%%), heuristic %0.3f ms (%0.1f%%), ",
+            1e3 * s.succ_time, percent(s.succ_time),
+            1e3 * s.heur_time, percent(s.heur_time));
+    if (s.evaluations != 0) {
+        printf("evaluation %0.3f ms (%0.1f%%), ", 1e3 * s.eval_time, percent(s.eval_time));
+    }
+    printf("search %0.3f ms (%0.1f%%)\n", 1e3 * other, percent(other));
+
+    printf("  plateaus: %d, max depth %d, mean depth %0.1f, %0.1f%% of expansions\n",
+            s.plateau_count,
+            s.max_plateau,
+            s.plateau_count ? (double)s.plateau_expansions / s.plateau_count : 0.0,
+            s.expansions ? 100.0 * s.plateau_expansions / s.expansions : 0.0);
+
+    // Along the solution path, the true cost-to-go of a state is the solution
+    // cost less the state's g-value, taken from the state's last expansion.
+    if (solved && !path.empty()) {
+        int count = 0;
+        double sum_err = 0.0;
+        double max_err = 0.0;
+        double sum_ratio = 0.0;
+        for (int id : path) {
+            auto it = s.expanded.find(id);
+            if (it == s.expanded.end() || (int)it->second.first > cost) {
+                continue;
+            }
+            double to_go = cost - (double)it->second.first;
+            double err = to_go - (double)it->second.second;
+            ++count;
+            sum_err += std::fabs(err);
+            max_err = std::max(max_err, std::fabs(err));
+            if (to_go > 0.0) {
+                sum_ratio += it->second.second / to_go;
+            }
+        }
+        if (count != 0) {
+            printf("  heuristic error on path (%d states): mean %0.1f, max %0.1f, mean h / h* %0.3f\n",
+                    count, sum_err / count, max_err, sum_ratio / count);
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2) {
+        fprintf(stderr, "Usage: search_trace_summary <trace> [<trace> ...]\n");
+        return 1;
+    }
+
+    for (int i = 1; i < argc; ++i) {
+        smpl::SearchTraceReader reader;
+        if (!reader.open(argv[i])) {
+            fprintf(stderr, "Failed to open trace '%s'\n", argv[i]);
+            return 1;
+        }
+
+        printf("%s\n", argv[i]);
+
+        SearchSummary summary;
+        smpl::SearchTraceEvent event;
+        while (reader.next(event)) {
+            switch (event.type) {
+            case smpl::SearchTraceEvent::Begin:
+                summary = SearchSummary();
+                summary.search = event.search;
+                summary.start_id = event.start_id;
+                summary.goal_id = event.goal_id;
+                break;
+            case smpl::SearchTraceEvent::Iteration:
+                summary.endPlateau();
+                summary.best_h = 0xFFFFFFFF;
+                summary.iterations.push_back(std::make_pair(event.eps, 0));
+                break;
+            case smpl::SearchTraceEvent::Expansion:
+                summary.add(event.expansion);
+                break;
+            case smpl::SearchTraceEvent::End:
+                summary.endPlateau();
+                PrintSummary(
+                        summary,
+                        event.solved,
+                        event.cost,
+                        1e-9 * event.elapsed_ns,
+                        event.path);
+                break;
+            }
+        }
+    }
+
+    return 0;
+}
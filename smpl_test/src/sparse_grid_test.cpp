@@ -7,6 +7,7 @@
 #include <boost/test/unit_test.hpp>
 
 #include <smpl/grid/sparse_grid.h>
+#include <smpl/octree/pool_allocator.h>
 
 BOOST_AUTO_TEST_CASE(DefaultConstructorTest)
 {
@@ -355,4 +356,87 @@ BOOST_AUTO_TEST_CASE(ResizeTest)
     BOOST_CHECK_EQUAL(g.max_depth(), 3);
 }
 
+BOOST_AUTO_TEST_CASE(PoolAllocatorTest)
+{
+    using PoolGrid = smpl::SparseGrid<int, smpl::PoolAllocator<int>>;
+    PoolGrid g(0);
+    g.resize(32, 32, 32);
+
+    smpl::SparseGrid<int> ref(0);
+    ref.resize(32, 32, 32);
+
+    // repeatedly expand and collapse nodes
+    for (int i = 0; i < 4; ++i) {
+        for (int x = 0; x < 32; x += 3) {
+        for (int y = 0; y < 32; y += 5) {
+        for (int z = 0; z < 32; z += 7) {
+            auto val = (x + y + z + i) % 2;
+            g.set(x, y, z, val);
+            ref.set(x, y, z, val);
+        }
+        }
+        }
+    }
+
+    BOOST_CHECK_EQUAL(g.tree().num_nodes(), ref.tree().num_nodes());
+    for (int x = 0; x < 32; ++x) {
+    for (int y = 0; y < 32; ++y) {
+    for (int z = 0; z < 32; ++z) {
+        BOOST_REQUIRE_EQUAL(g.get(x, y, z), ref.get(x, y, z));
+    }
+    }
+    }
+
+    // copies get their own pool
+    PoolGrid cg(g);
+    cg.set(0, 0, 0, 5);
+    BOOST_CHECK_EQUAL(cg.get(0, 0, 0), 5);
+    BOOST_CHECK_NE(g.get(0, 0, 0), 5);
+}
+
+BOOST_AUTO_TEST_CASE(PoolAllocatorRebindTest)
+{
+    smpl::PoolAllocator<int> a;
+    smpl::PoolAllocator<double> b(a);
+    smpl::PoolAllocator<int> c(b);
+    BOOST_CHECK(b == a);
+    BOOST_CHECK(c == a);
+    BOOST_CHECK(smpl::PoolAllocator<int>() != a);
+
+    // memory allocated through an allocator may be returned through an
+    // allocator rebound from it and back
+    int* p = a.allocate(8);
+    c.deallocate(p, 8);
+    BOOST_CHECK_EQUAL(a.allocate(8), p);
+
+    // rebound allocators share the pools of the original allocator
+    std::size_t capacity = a.capacity();
+    double* q = b.allocate(8);
+    BOOST_CHECK(a.capacity() > capacity);
+    b.deallocate(q, 8);
+}
+
+BOOST_AUTO_TEST_CASE(CompactTest)
+{
+    smpl::SparseGrid<int, smpl::PoolAllocator<int>> g(0);
+    g.resize(16, 16, 16);
+    for (int x = 0; x < 16; x += 2) {
+        g.set(x, x, x, x);
+    }
+    auto num_nodes = g.tree().num_nodes();
+
+    g.compact();
+
+    BOOST_CHECK_EQUAL(g.tree().num_nodes(), num_nodes);
+    for (int x = 0; x < 16; ++x) {
+        BOOST_CHECK_EQUAL(g.get(x, x, x), x % 2 == 0 ? x : 0);
+    }
+
+    // the grandchildren of the root are allocated immediately after its
+    // children
+    auto* root = g.tree().root();
+    BOOST_REQUIRE(root->children && root->children[0].children);
+    BOOST_CHECK(root->children[0].children == root->children + 8);
+}
+
 // TODO: Test throwing constructor/destructor
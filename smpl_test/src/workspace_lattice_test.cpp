@@ -0,0 +1,264 @@
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#define BOOST_TEST_MODULE WorkspaceLatticeTest
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <smpl/angles.h>
+#include <smpl/collision_checker.h>
+#include <smpl/graph/workspace_lattice.h>
+#include <smpl/graph/workspace_lattice_action_space.h>
+#include <smpl/robot_model.h>
+
+// A free-floating body whose joint variables are the (x, y, z) position and
+// the (roll, pitch, yaw) orientation of its planning link. IK solutions are
+// unwound toward the seed, so the solutions for the same pose differ by
+// multiples of 2 pi depending on the seed, as with a seed-dependent solver.
+class FloatingBodyModel :
+    public smpl::ForwardKinematicsInterface,
+    public smpl::InverseKinematicsInterface,
+    public smpl::RedundantManipulatorInterface
+{
+public:
+
+    FloatingBodyModel()
+    {
+        setPlanningJoints({ "x", "y", "z", "roll", "pitch", "yaw" });
+    }
+
+    double minPosLimit(int jidx) const override { return 0.0; }
+    double maxPosLimit(int jidx) const override { return 0.0; }
+    bool hasPosLimit(int jidx) const override { return false; }
+    bool isContinuous(int jidx) const override { return jidx >= 3; }
+    double velLimit(int jidx) const override { return 0.0; }
+    double accLimit(int jidx) const override { return 0.0; }
+
+    bool checkJointLimits(const smpl::RobotState& state, bool verbose) override
+    {
+        return true;
+    }
+
+    auto computeFK(const smpl::RobotState& state) -> smpl::Affine3 override
+    {
+        return smpl::Translation3(state[0], state[1], state[2]) *
+                smpl::AngleAxis(state[5], smpl::Vector3::UnitZ()) *
+                smpl::AngleAxis(state[4], smpl::Vector3::UnitY()) *
+                smpl::AngleAxis(state[3], smpl::Vector3::UnitX());
+    }
+
+    bool computeIK(
+        const smpl::Affine3& pose,
+        const smpl::RobotState& start,
+        smpl::RobotState& solution,
+        smpl::ik_option::IkOption option) override
+    {
+        return computeFastIK(pose, start, solution);
+    }
+
+    bool computeIK(
+        const smpl::Affine3& pose,
+        const smpl::RobotState& start,
+        std::vector<smpl::RobotState>& solutions,
+        smpl::ik_option::IkOption option) override
+    {
+        smpl::RobotState solution;
+        if (!computeFastIK(pose, start, solution)) {
+            return false;
+        }
+        solutions.push_back(solution);
+        return true;
+    }
+
+    const int redundantVariableCount() const override { return 0; }
+    const int redundantVariableIndex(int rvidx) const override { return 0; }
+
+    bool computeFastIK(
+        const smpl::Affine3& pose,
+        const smpl::RobotState& start,
+        smpl::RobotState& solution) override
+    {
+        ++solve_count;
+        solution.resize(6);
+        solution[0] = pose.translation().x();
+        solution[1] = pose.translation().y();
+        solution[2] = pose.translation().z();
+        smpl::get_euler_zyx(pose.rotation(), solution[5], solution[4], solution[3]);
+        for (int i = 3; i < 6; ++i) {
+            solution[i] = start[i] +
+                    smpl::angles::shortest_angle_diff(solution[i], start[i]);
+        }
+        return true;
+    }
+
+    auto getExtension(size_t class_code) -> smpl::Extension* override
+    {
+        if (class_code == smpl::GetClassCode<smpl::RobotModel>() ||
+            class_code == smpl::GetClassCode<smpl::ForwardKinematicsInterface>() ||
+            class_code == smpl::GetClassCode<smpl::InverseKinematicsInterface>() ||
+            class_code == smpl::GetClassCode<smpl::RedundantManipulatorInterface>())
+        {
+            return this;
+        }
+        return nullptr;
+    }
+
+    std::uint64_t solve_count = 0;
+};
+
+class FreeSpaceCollisionChecker : public smpl::CollisionChecker
+{
+public:
+
+    auto getExtension(size_t class_code) -> smpl::Extension* override
+    {
+        if (class_code == smpl::GetClassCode<smpl::CollisionChecker>()) {
+            return this;
+        }
+        return nullptr;
+    }
+
+    bool isStateValid(const smpl::RobotState& state, bool verbose) override
+    {
+        return true;
+    }
+
+    bool isStateToStateValid(
+        const smpl::RobotState& start,
+        const smpl::RobotState& finish,
+        bool verbose) override
+    {
+        return true;
+    }
+
+    bool interpolatePath(
+        const smpl::RobotState& start,
+        const smpl::RobotState& finish,
+        std::vector<smpl::RobotState>& path) override
+    {
+        path = { start, finish };
+        return true;
+    }
+};
+
+// Actions of two waypoints, each moving one cell along a position axis or one
+// step of yaw, so that every waypoint after the first is a candidate for a
+// warm start and waypoints are shared between the actions of neighboring
+// states.
+class TwoStepActionSpace : public smpl::WorkspaceLatticeActionSpace
+{
+public:
+
+    smpl::WorkspaceLattice* space = nullptr;
+
+    void apply(
+        const smpl::WorkspaceLatticeState& state,
+        std::vector<smpl::WorkspaceAction>& actions) override
+    {
+        smpl::WorkspaceState cont_state;
+        space->stateCoordToWorkspace(state.coord, cont_state);
+
+        const int dims[] = { 0, 1, 2, 5 };
+        for (int d : dims) {
+            for (int dir = -1; dir <= 1; dir += 2) {
+                smpl::WorkspaceAction action;
+                auto waypoint = cont_state;
+                for (int step = 0; step < 2; ++step) {
+                    waypoint[d] += dir * space->resolution()[d];
+                    smpl::angles::normalize_euler_zyx(&waypoint[3]);
+                    action.push_back(waypoint);
+                }
+                actions.push_back(std::move(action));
+            }
+        }
+    }
+};
+
+struct FloatingBodyLattice
+{
+    FloatingBodyModel robot;
+    FreeSpaceCollisionChecker checker;
+    TwoStepActionSpace actions;
+    smpl::WorkspaceLattice space;
+
+    FloatingBodyLattice(bool memo, bool warm_start)
+    {
+        smpl::WorkspaceLattice::Params params;
+        params.res_x = 0.1;
+        params.res_y = 0.1;
+        params.res_z = 0.1;
+        params.R_count = 36;
+        params.P_count = 19;
+        params.Y_count = 12;
+        BOOST_REQUIRE(space.init(&robot, &checker, params, &actions));
+        actions.space = &space;
+        space.setIKMemoEnabled(memo);
+        space.setIKWarmStartEnabled(warm_start);
+        BOOST_REQUIRE(space.setStart({ 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 }));
+    }
+};
+
+// Successors must not depend on whether the IK memo or warm start is enabled,
+// and the IK counters must account for every waypoint.
+BOOST_AUTO_TEST_CASE(IKMemoAndWarmStartTest)
+{
+    FloatingBodyLattice plain(false, false);
+    FloatingBodyLattice memo(true, false);
+    FloatingBodyLattice warm(false, true);
+    FloatingBodyLattice both(true, true);
+    FloatingBodyLattice* lattices[] = { &plain, &memo, &warm, &both };
+
+    // expand breadth-first from the start; the lattices create states in the
+    // same order, so state ids agree between them
+    std::vector<int> frontier = { plain.space.getStartStateID() };
+    std::vector<bool> expanded(frontier.front() + 1, false);
+    expanded[frontier.front()] = true;
+    std::uint64_t action_count = 0;
+    for (size_t i = 0; i < frontier.size() && i < 300; ++i) {
+        std::vector<int> succs[4];
+        std::vector<int> costs[4];
+        for (int l = 0; l < 4; ++l) {
+            lattices[l]->space.GetSuccs(frontier[i], &succs[l], &costs[l]);
+            BOOST_REQUIRE(succs[l] == succs[0]);
+            BOOST_REQUIRE(costs[l] == costs[0]);
+        }
+        action_count += succs[0].size();
+
+        for (int succ_id : succs[0]) {
+            if ((int)expanded.size() <= succ_id) {
+                expanded.resize(succ_id + 1, false);
+            }
+            if (!expanded[succ_id]) {
+                expanded[succ_id] = true;
+                frontier.push_back(succ_id);
+            }
+        }
+    }
+
+    BOOST_REQUIRE(action_count > 0);
+
+    // every waypoint of every action was queried
+    for (auto* l : lattices) {
+        auto& stats = l->space.ikStats();
+        BOOST_CHECK_EQUAL(stats.queries, 2 * action_count);
+        BOOST_CHECK_EQUAL(stats.memo_hits + stats.solves, stats.queries);
+        BOOST_CHECK_EQUAL(stats.solves, l->robot.solve_count);
+    }
+
+    // without the memo every query is solved
+    BOOST_CHECK_EQUAL(plain.space.ikStats().memo_hits, 0);
+    BOOST_CHECK_EQUAL(warm.space.ikStats().memo_hits, 0);
+
+    // neighboring states share waypoints, and poses that differ only by the
+    // representation of their angles hit the memo
+    BOOST_CHECK(memo.space.ikStats().memo_hits > 0);
+    BOOST_CHECK(both.space.ikStats().memo_hits > 0);
+
+    // warm starts count only solves of second waypoints
+    BOOST_CHECK_EQUAL(plain.space.ikStats().warm_starts, 0);
+    BOOST_CHECK_EQUAL(memo.space.ikStats().warm_starts, 0);
+    BOOST_CHECK_EQUAL(warm.space.ikStats().warm_starts, action_count);
+    BOOST_CHECK(both.space.ikStats().warm_starts > 0);
+    BOOST_CHECK(both.space.ikStats().warm_starts < action_count);
+}